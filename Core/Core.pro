@@ -52,7 +52,11 @@ HEADERS += \
     reinforcementProblem.h \
     kmeans.h \
     glwidget.h \
-    glUtils.h
+    glUtils.h \
+    spatialHash.h \
+    objective.h \
+    modelArchive.h \
+    trainingControl.h
 
 SOURCES += \
 	canvas.cpp \
@@ -76,6 +80,9 @@ SOURCES += \
     glUtils.cpp \
     clusterer.cpp \
     canvas-drawing.cpp \
-    canvas-interaction.cpp
+    canvas-interaction.cpp \
+    spatialHash.cpp \
+    objective.cpp \
+    modelArchive.cpp
 
 RESOURCES +=
@@ -725,6 +725,19 @@ void Canvas::DrawSamples()
     if(!maps.samples.isNull() && drawnSamples == data->GetCount()) return;
     if(drawnSamples > data->GetCount()) drawnSamples = 0;
 
+    // large datasets: we only look at the samples inside the viewport
+    ivec visible;
+    bool bLarge = data->GetCount() > densityThreshold;
+    if(bLarge)
+    {
+        UpdateSampleIndex();
+        QPoint offset = mapToParent(QPoint(0,0));
+        ivec inside = sampleIndex.QueryRect(offset.x()-radius, offset.y()-radius, offset.x()+width()+radius, offset.y()+height()+radius);
+        visible.reserve(inside.size());
+        FOR(i, inside.size()) if(data->GetFlag(inside[i]) != _TRAJ) visible.push_back(inside[i]);
+        drawnSamples = 0; // culling depends on the whole dataset, we redraw everything
+    }
+
     if(drawnSamples==0 || maps.samples.isNull())
     {
         int w = width();
@@ -736,6 +749,22 @@ void Canvas::DrawSamples()
     QPainter painter(&maps.samples);
     painter.setRenderHint(QPainter::Antialiasing, true);
     painter.setRenderHint(QPainter::HighQualityAntialiasing);
+    if(bLarge)
+    {
+        if(visible.size() > densityThreshold) DrawSampleDensity(painter, visible);
+        else
+        {
+            QPoint offset = mapToParent(QPoint(0,0));
+            FOR(i, visible.size())
+            {
+                QPointF point(sampleIndex.X(visible[i]) - offset.x(), sampleIndex.Y(visible[i]) - offset.y());
+                if(xIndex == yIndex) point.setY(height()/2);
+                Canvas::drawSample(painter, point, radius, bDisplaySingle ? 0 : data->GetLabel(visible[i]));
+            }
+        }
+        drawnSamples = data->GetCount();
+        return;
+    }
     for(int i=drawnSamples; i<data->GetCount(); i++)
     {
         if(data->GetFlag(i) == _TRAJ) continue;
@@ -748,6 +777,89 @@ void Canvas::DrawSamples()
     drawnSamples = data->GetCount();
 }
 
+void Canvas::DrawSampleDensity(QPainter &painter, const ivec &visible)
+{
+    int w = width(), h = height();
+    if(!w || !h || !visible.size()) return;
+    QPoint offset = mapToParent(QPoint(0,0));
+
+    // we splat the samples in one accumulation buffer per class
+    std::map<int,int> classIndex;
+    ivec classLabels;
+    ivec sampleClass(visible.size());
+    FOR(i, visible.size())
+    {
+        int label = bDisplaySingle ? 0 : data->GetLabel(visible[i]);
+        if(!classIndex.count(label))
+        {
+            classIndex[label] = classLabels.size();
+            classLabels.push_back(label);
+        }
+        sampleClass[i] = classIndex[label];
+    }
+    int classCount = classLabels.size();
+    int pixelCount = w*h;
+    std::vector<float> density(pixelCount*classCount, 0.f);
+
+    int count = visible.size();
+#pragma omp parallel for
+    for(int i=0; i<count; i++)
+    {
+        int x = (int)(sampleIndex.X(visible[i]) - offset.x());
+        int y = xIndex == yIndex ? h/2 : (int)(sampleIndex.Y(visible[i]) - offset.y());
+        if(x < 0 || x >= w || y < 0 || y >= h) continue;
+        float &bin = density[(y*w + x)*classCount + sampleClass[i]];
+#pragma omp atomic
+        bin += 1.f;
+    }
+
+    // tone mapping: log-scaled opacity, colour is the class mixture in each pixel
+    float maxDensity = 0;
+    FOR(i, pixelCount)
+    {
+        float total = 0;
+        FOR(c, classCount) total += density[i*classCount + c];
+        maxDensity = max(maxDensity, total);
+    }
+    if(maxDensity == 0) return;
+    float logMax = logf(1.f + maxDensity);
+    fvec r(classCount), g(classCount), b(classCount);
+    FOR(c, classCount)
+    {
+        QColor color = SampleColor[classLabels[c]%SampleColorCnt];
+        if(classLabels[c]%SampleColorCnt == 0) color = Qt::black; // white would be invisible
+        r[c] = color.red();
+        g[c] = color.green();
+        b[c] = color.blue();
+    }
+    QImage image(w, h, QImage::Format_ARGB32);
+#pragma omp parallel for
+    for(int y=0; y<h; y++)
+    {
+        QRgb *line = (QRgb*)image.scanLine(y);
+        for(int x=0; x<w; x++)
+        {
+            const float *pixel = &density[(y*w + x)*classCount];
+            float total = 0, red = 0, green = 0, blue = 0;
+            FOR(c, classCount)
+            {
+                total += pixel[c];
+                red += pixel[c]*r[c];
+                green += pixel[c]*g[c];
+                blue += pixel[c]*b[c];
+            }
+            if(total == 0)
+            {
+                line[x] = qRgba(0,0,0,0);
+                continue;
+            }
+            int alpha = (int)(64 + 191*logf(1.f + total)/logMax);
+            line[x] = qRgba(red/total, green/total, blue/total, alpha);
+        }
+    }
+    painter.drawImage(0, 0, image);
+}
+
 void Canvas::DrawTargets(QPainter &painter)
 {
     painter.setBrush(Qt::NoBrush);
@@ -196,58 +196,27 @@ ivec Canvas::SelectSamples(QPointF center, float radius , fvec *weights)
 {
     ivec selection;
     if(weights) (*weights).clear();
-    int closest = 0;
-    float minDist = FLT_MAX;
-    FOR(i, data->GetCount())
+    UpdateSampleIndex();
+    if(radius > 0)
     {
-        QPointF dataPoint = toCanvasCoords(data->GetSample(i));
-        QPointF point = this->mapToParent(QPoint(dataPoint.x(), dataPoint.y()));
-        point -= center;
-        float dist = point.x()*point.x() + point.y()*point.y();
-        if(radius > 0)
-        {
-            if(!weights)
-            {
-                if(sqrtf(dist) < radius) selection.push_back(i);
-            }
-            else
-            {
-                if(sqrtf(dist) < radius*1.5f)
-                {
-                    selection.push_back(i);
-                    float weight = sqrtf(dist)/radius;
-                    (*weights).push_back(weight);
-                }
-            }
-        }
-        else
-        {
-            if(dist < minDist)
-            {
-                closest = i;
-                minDist = dist;
-            }
-        }
-    }
-    if(radius < 0)
-    {
-        selection.push_back(closest);
+        if(!weights) return sampleIndex.Query(center.x(), center.y(), radius);
+        selection = sampleIndex.Query(center.x(), center.y(), radius*1.5f, weights);
+        FOR(i, weights->size()) (*weights)[i] /= radius;
+        return selection;
     }
+    int closest = sampleIndex.Nearest(center.x(), center.y());
+    selection.push_back(max(closest, 0));
     return selection;
 }
 
 bool Canvas::DeleteData( QPointF center, float radius )
 {
     bool anythingDeleted = false;
-    FOR (i, data->GetCount()) {
-        QPointF dataPoint = toCanvasCoords(data->GetSample(i));
-        QPointF point = this->mapToParent(QPoint(dataPoint.x(), dataPoint.y()));
-        point -= center;
-        if (sqrt(point.x()*point.x() + point.y()*point.y()) < radius) {
-            anythingDeleted = true;
-            data->RemoveSample(i);
-            i--;
-        }
+    UpdateSampleIndex();
+    ivec erased = sampleIndex.Query(center.x(), center.y(), radius);
+    if (erased.size()) {
+        anythingDeleted = true;
+        data->RemoveSamples(erased);
     }
     FOR (i, data->GetObstacles().size()) {
         QPointF obstaclePoint= toCanvasCoords(data->GetObstacle(i).center);
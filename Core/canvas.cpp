@@ -37,6 +37,7 @@ using namespace std;
 
 //DatasetManager Canvas::data;
 bool Canvas::bCrossesAsDots = true;
+int Canvas::densityThreshold = 20000;
 
 Canvas::Canvas(QWidget *parent)
     : QWidget(parent),
@@ -67,6 +68,8 @@ Canvas::Canvas(QWidget *parent)
       center(2,0),
       xIndex(0), yIndex(1), zIndex(-1),
       canvasType(0),
+      sampleIndex(16.f),
+      sampleIndexRevision(0),
       data(new DatasetManager())
 {
     resize(640,480);
@@ -224,6 +227,53 @@ QRectF Canvas::canvasRect()
     return QRectF(tl[xIndex], tl[yIndex], (br-tl)[xIndex], (br-tl)[yIndex]);
 }
 
+void Canvas::UpdateSampleIndex()
+{
+    if(!data) return;
+    // the index lives in parent coordinates, same as the positions used by the drawing tools
+    QPoint offset = mapToParent(QPoint(0,0));
+    fvec view(9);
+    view[0] = zoom;
+    view[1] = xIndex < zooms.size() ? zooms[xIndex] : 1.f;
+    view[2] = yIndex < zooms.size() ? zooms[yIndex] : 1.f;
+    view[3] = xIndex < center.size() ? center[xIndex] : 0.f;
+    view[4] = yIndex < center.size() ? center[yIndex] : 0.f;
+    view[5] = xIndex + 1000*yIndex;
+    view[6] = width();
+    view[7] = height();
+    view[8] = offset.x() + 100000.f*offset.y();
+    const std::vector<fvec> &samples = data->GetSamplesRef();
+    if(view != sampleIndexView || data->GetEditRevision() != sampleIndexRevision || sampleIndex.GetCount() > samples.size())
+    {
+        sampleIndex.Clear();
+        sampleIndexView = view;
+        sampleIndexRevision = data->GetEditRevision();
+    }
+    if(sampleIndex.GetCount() == samples.size()) return;
+
+    float scaleX = view[0]*view[1]*height();
+    float scaleY = view[0]*view[2]*height();
+    float dx = width()/2.f + offset.x(), dy = height()/2.f;
+    for(int i=sampleIndex.GetCount(); i<samples.size(); i++)
+    {
+        const fvec &sample = samples[i];
+        float x = 0, y = 0;
+        if(sample.size() == 2 && center.size() > 2)
+        {
+            x = sample[0];
+            y = sample[1];
+        }
+        else
+        {
+            if(xIndex < sample.size()) x = sample[xIndex];
+            if(yIndex < sample.size()) y = sample[yIndex];
+        }
+        x = (x - view[3])*scaleX + dx;
+        y = height() - ((y - view[4])*scaleY + dy) + offset.y();
+        sampleIndex.Insert(i, x, y);
+    }
+}
+
 void Canvas::SetZoom(float zoom)
 {
     if(this->zoom == zoom) return;
@@ -21,6 +21,7 @@ Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
 
 #include "datasetManager.h"
 #include "mymaths.h"
+#include "spatialHash.h"
 #include <QWidget>
 #include <map>
 #include <QMouseEvent>
@@ -64,6 +65,7 @@ public:
 	~Canvas();
 
     static bool bCrossesAsDots;
+    static int densityThreshold; // above this many visible samples we draw a density map instead of glyphs
     bool DeleteData(QPointF center, float radius);
     ivec SelectSamples(QPointF center, float radius, fvec *weights=0);
     void DrawSamples();
@@ -74,6 +76,7 @@ public:
 	void DrawObstacles(QPainter &painter);
 	void DrawTrajectories(QPainter &painter);
 	void DrawSamples(QPainter &painter);
+    void DrawSampleDensity(QPainter &painter, const ivec &visible);
     void DrawSampleColors(QPainter &painter);
 	void DrawTargets(QPainter &painter);
 	void DrawLiveTrajectory(QPainter &painter);
@@ -152,6 +155,8 @@ public:
     bool SetDim(int xIndex, int yIndex, int zIndex=0);
 
 	std::map<int,fvec> centers;
+    SpatialHash sampleIndex; // screen-space positions of the samples, used for picking and culling
+    void UpdateSampleIndex();
 	int drawnSamples;
 	int drawnTrajectories;
 	int drawnTimeseries;
@@ -224,6 +229,10 @@ public:
 	}
 
     static QRgb GetColorMapValue(float value, int colorscheme);
+
+private:
+    fvec sampleIndexView; // view parameters (zoom, center, dims, size) the index was built with
+    u32 sampleIndexRevision;
 };
 
 #endif // _CANVAS_H_
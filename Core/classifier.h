@@ -26,6 +26,8 @@ Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
 #include <types.h>
 #include <mymaths.h>
 
+class ModelArchive;
+
 class Classifier
 {
 protected:
@@ -61,9 +63,14 @@ public:
     virtual fvec TestMulti(const fvec &sample) const { return fvec(1,Test(sample));}
     virtual float Test(const fvec &sample) const { return 0; }
     virtual float Test(const fVec &sample) const { if(dim==2) return Test((fvec)sample); fvec s = (fvec)sample; s.resize(dim,0); return Test(s);}
+    // TestMulti over a whole set of samples, for classifiers that are faster on batches
+    virtual std::vector<fvec> TestBatch(const std::vector<fvec> &samples) const { std::vector<fvec> res(samples.size()); FOR(i, samples.size()) res[i] = TestMulti(samples[i]); return res;}
     virtual const char *GetInfoString() const {return NULL;}
     virtual void SaveModel(const std::string filename) const {}
     virtual bool LoadModel(const std::string filename){return false;}
+    // binary model archive, returns false when the model cannot be stored that way
+    virtual bool SaveModel(ModelArchive &archive) const {return false;}
+    virtual bool LoadModel(const ModelArchive &archive){return false;}
     bool SingleClass() const {return bSingleClass;}
     bool UsesDrawTimer() const {return bUsesDrawTimer;}
     bool IsMultiClass() const {return bMultiClass;}
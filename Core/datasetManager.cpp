@@ -40,6 +40,8 @@ DatasetManager::DatasetManager(const int dimension)
     bProjected = false;
 	ID = IDCount++;
 	perm = NULL;
+    revision = 0;
+    editRevision = 0;
 }
 
 DatasetManager::~DatasetManager()
@@ -58,6 +60,8 @@ void DatasetManager::Clear()
 	rewards.Clear();
     categorical.clear();
 	KILL(perm);
+    revision++;
+    editRevision++;
 }
 
 void DatasetManager::AddSample(const fvec sample, const int label, const dsmFlags flag)
@@ -71,12 +75,14 @@ void DatasetManager::AddSample(const fvec sample, const int label, const dsmFlag
         {
             while(samples[i].size() < size) samples[i].push_back(0.f);
         }
+        if(samples.size()) editRevision++;
     }
 	samples.push_back(sample);
 	labels.push_back(label);
 	flags.push_back(flag);
 	KILL(perm);
 	perm = randPerm(samples.size());
+    revision++;
 }
 
 void DatasetManager::AddSamples(const std::vector< fvec > newSamples, const ivec newLabels, const std::vector<dsmFlags> newFlags)
@@ -90,6 +96,7 @@ void DatasetManager::AddSamples(const std::vector< fvec > newSamples, const ivec
         {
             while(samples[i].size() < size) samples[i].push_back(0.f);
         }
+        if(samples.size()) editRevision++;
     }
     FOR(i, newSamples.size())
 	{
@@ -104,6 +111,7 @@ void DatasetManager::AddSamples(const std::vector< fvec > newSamples, const ivec
 	else FOR(i, newSamples.size()) labels.push_back(0);
 	KILL(perm);
 	perm = randPerm(samples.size());
+    revision++;
 }
 
 void DatasetManager::AddSamples(const DatasetManager &newSamples)
@@ -129,6 +137,8 @@ void DatasetManager::RemoveSample(const unsigned int index)
 	samples.pop_back();
 	labels.pop_back();
 	flags.pop_back();
+    revision++;
+    editRevision++;
 
 	// we need to check if a sequence needs to be shortened
 	FOR(i, sequences.size())
@@ -160,17 +170,71 @@ void DatasetManager::RemoveSample(const unsigned int index)
 
 void DatasetManager::RemoveSamples(ivec indices)
 {
-    if(indices.size() > samples.size()) return;
-    // we sort the indices
-    sort(indices.begin(), indices.end(), less<int>());
-    int offset = 0;
+    if(!indices.size()) return;
+    bvec mask(samples.size(), false);
     FOR(i, indices.size())
     {
-        int index = indices[i] - offset;
-        if(index < 0 || index > samples.size()) continue;
-        RemoveSample(index);
-        offset++;
+        if(indices[i] < 0 || indices[i] >= samples.size()) continue;
+        mask[indices[i]] = true;
     }
+    RemoveSamples(mask);
+}
+
+void DatasetManager::RemoveSamples(const bvec &mask)
+{
+    // we compute the new position of each sample (-1 if it is removed)
+    int count = samples.size();
+    ivec newIndex(count, -1);
+    int kept = 0;
+    FOR(i, count)
+    {
+        if(i < mask.size() && mask[i]) continue;
+        newIndex[i] = kept++;
+    }
+    if(kept == count) return;
+    if(!kept)
+    {
+        Clear();
+        return;
+    }
+
+    // we compact the samples, labels and flags in a single pass
+    FOR(i, count)
+    {
+        int j = newIndex[i];
+        if(j == -1 || j == i) continue;
+        samples[j].swap(samples[i]);
+        labels[j] = labels[i];
+        flags[j] = flags[i];
+    }
+    samples.resize(kept);
+    labels.resize(kept);
+    flags.resize(kept);
+
+    // we remap the sequences onto their surviving samples
+    int seqCount = 0;
+    FOR(i, sequences.size())
+    {
+        int first = -1, last = -1;
+        for(int j=sequences[i].first; j<=sequences[i].second && j<count; j++)
+        {
+            if(newIndex[j] == -1) continue;
+            if(first == -1) first = newIndex[j];
+            last = newIndex[j];
+        }
+        if(first == -1) continue;
+        if(first == last) // a single sample is not a sequence anymore
+        {
+            flags[first] = _UNUSED;
+            continue;
+        }
+        sequences[seqCount++] = ipair(first, last);
+    }
+    sequences.resize(seqCount);
+    KILL(perm);
+    perm = randPerm(samples.size());
+    revision++;
+    editRevision++;
 }
 
 void DatasetManager::AddSequence(const int start, const int stop)
@@ -180,6 +244,7 @@ void DatasetManager::AddSequence(const int start, const int stop)
 	sequences.push_back(ipair(start,stop));
 	// sort sequences by starting value
 	std::sort(sequences.begin(), sequences.end());
+    revision++;
 }
 
 void DatasetManager::AddSequence(const ipair newSequence)
@@ -189,6 +254,7 @@ void DatasetManager::AddSequence(const ipair newSequence)
 	sequences.push_back(newSequence);
 	// sort sequences by starting value
 	std::sort(sequences.begin(), sequences.end());
+    revision++;
 }
 
 void DatasetManager::AddSequences(const std::vector< ipair > newSequences)
@@ -198,6 +264,7 @@ void DatasetManager::AddSequences(const std::vector< ipair > newSequences)
 	{
 		sequences.push_back(newSequences[i]);		
 	}
+    revision++;
 }
 
 void DatasetManager::RemoveSequence(const unsigned int index)
@@ -205,6 +272,7 @@ void DatasetManager::RemoveSequence(const unsigned int index)
 	if(index >= sequences.size()) return;
 	for(int i=index; i<sequences.size()-1; i++) sequences[i] = sequences[i+1];
 	sequences.pop_back();
+    revision++;
 }
 
 void DatasetManager::AddTimeSerie(const std::string name, const std::vector<fvec> data, const std::vector<long int>  timestamps)
@@ -295,6 +363,8 @@ void DatasetManager::ResetFlags()
 void DatasetManager::SetSample(const int index, const fvec sample)
 {
     if(index >= 0 && index < samples.size()) samples[index] = sample;
+    revision++;
+    editRevision++;
 }
 
 string DatasetManager::GetCategorical(const int dimension, const int value) const
@@ -472,159 +542,170 @@ std::vector< fvec > DatasetManager::GetSamples(const u32 count, const dsmFlags f
 	return selected;
 }
 
-std::vector< std::vector < fvec > > DatasetManager::GetTrajectories(const int resampleType, const int resampleCount_, const int centerType, const float dT, const int zeroEnding) const
+#define TRAJECTORY_CACHE_SIZE 4
+
+std::vector< std::vector < fvec > > DatasetManager::GetTrajectories(const int resampleType, const int resampleCount, const int centerType, const float dT, const int zeroEnding) const
 {
-    int resampleCount = resampleCount_;
-	// we split the data into trajectories
 	vector< vector<fvec> > trajectories;
 	if(!sequences.size() || !samples.size()) return trajectories;
-	int dim = samples[0].size();
-	trajectories.resize(sequences.size());
-	FOR(i, sequences.size())
-	{
-		int length = sequences[i].second-sequences[i].first+1;
-		trajectories[i].resize(length);
-		FOR(j, length)
-		{
-			trajectories[i][j].resize(dim*2);
-			// copy data
-			FOR(d, dim) trajectories[i][j][d] = samples[sequences[i].first + j][d];
-		}
-	}
 
-	switch(resampleType)
+	QMutexLocker lock(&trajectoryMutex);
+	// entries computed on older data are dropped, the others are reused if the parameters match
+	int index = -1;
+	for(int i=trajectoryCache.size()-1; i>=0; i--)
 	{
-	case 0: // none
+		if(trajectoryCache[i].revision != revision) trajectoryCache.erase(trajectoryCache.begin() + i);
+	}
+	FOR(i, trajectoryCache.size())
 	{
-		FOR(i,sequences.size())
+		const TrajectoryCache &cache = trajectoryCache[i];
+		if(cache.resampleType == resampleType && cache.resampleCount == resampleCount && cache.centerType == centerType
+				&& cache.dT == dT && cache.zeroEnding == zeroEnding)
 		{
-			int cnt = sequences[i].second-sequences[i].first+1;
-			if(resampleCount > cnt) resampleCount = cnt;
-		}
-		FOR(i, trajectories.size())
-		{
-			while(trajectories[i].size() > resampleCount) trajectories[i].pop_back();
+			index = i;
+			break;
 		}
 	}
-		break;
-	case 1: // uniform
+	if(index == -1)
 	{
-		FOR(i, trajectories.size())
-		{
-			vector<fvec> trajectory = trajectories[i];
-			trajectories[i] = interpolate(trajectory, resampleCount);
-		}
+		TrajectoryCache cache;
+		cache.resampleType = resampleType;
+		cache.resampleCount = resampleCount;
+		cache.centerType = centerType;
+		cache.dT = dT;
+		cache.zeroEnding = zeroEnding;
+		cache.revision = revision;
+		ComputeTrajectories(cache);
+		if(trajectoryCache.size() >= TRAJECTORY_CACHE_SIZE) trajectoryCache.erase(trajectoryCache.begin());
+		trajectoryCache.push_back(cache);
+		index = trajectoryCache.size()-1;
 	}
-		break;
-	case 2: // spline
+
+	const TrajectoryCache &cache = trajectoryCache[index];
+	int stride = cache.dim*2;
+	trajectories.resize(cache.count, vector<fvec>(cache.length));
+#pragma omp parallel for
+	for(int i=0; i<cache.count; i++)
 	{
-		FOR(i, trajectories.size())
+		FOR(j, cache.length)
 		{
-			vector<fvec> trajectory = trajectories[i];
-			trajectories[i] = interpolateSpline(trajectory, resampleCount);
+			const float *point = &cache.buffer[(i*cache.length + j)*stride];
+			trajectories[i][j] = fvec(point, point + stride);
 		}
 	}
-		break;
-	}
-
+	return trajectories;
+}
 
-	if(centerType)
+void DatasetManager::ComputeTrajectories(TrajectoryCache &cache) const
+{
+	int dim = samples[0].size();
+	int count = sequences.size();
+	int resampleCount = cache.resampleCount;
+	if(cache.resampleType == 0) // no resampling, the trajectories are cut to the shortest one
+	{
+		FOR(i, count) resampleCount = min(resampleCount, sequences[i].second-sequences[i].first+1);
+	}
+	int stride = dim*2;
+	cache.count = count;
+	cache.length = resampleCount;
+	cache.dim = dim;
+	cache.buffer.assign(count*resampleCount*stride, 0.f);
+
+	// each class is centered on the mean of the ends (or starts) of its trajectories
+	fvec offsets;
+	if(cache.centerType)
 	{
 		map<int,int> counts;
 		map<int,fvec> centers;
-		vector<int> trajLabels(sequences.size());
-		FOR(i, sequences.size())
+		ivec trajLabels(count);
+		FOR(i, count)
 		{
-			int index = centerType==1 ? sequences[i].second : sequences[i].first; // start
+			int index = cache.centerType==1 ? sequences[i].second : sequences[i].first; // start
 			int label = GetLabel(index);
 			trajLabels[i] = label;
 			if(!centers.count(label))
 			{
-				fvec center(dim,0);
-				centers[label] = center;
+				centers[label] = fvec(dim,0);
 				counts[label] = 0;
 			}
-			centers[label] += samples[index];
+			FOR(d, dim) centers[label][d] += samples[index][d];
 			counts[label]++;
 		}
-		for(map<int,int>::iterator p = counts.begin(); p!=counts.end(); ++p)
+		offsets.resize(count*dim);
+		FOR(i, count)
 		{
-			int label = p->first;
-			centers[label] /= p->second;
+			FOR(d, dim) offsets[i*dim + d] = centers[trajLabels[i]][d] / counts[trajLabels[i]];
 		}
-		FOR(i, trajectories.size())
+	}
+
+	// the trajectories are independent, each one is resampled, centered and differentiated by a single thread
+	float maxV = -FLT_MAX;
+#pragma omp parallel
+	{
+		float threadMaxV = -FLT_MAX;
+#pragma omp for schedule(dynamic) nowait
+		for(int i=0; i<count; i++)
 		{
-			if(centerType == 1)
+			float *trajectory = &cache.buffer[i*resampleCount*stride];
+			int first = sequences[i].first;
+			if(cache.resampleType == 0)
 			{
-				fvec difference = centers[trajLabels[i]] - trajectories[i].back();
-				FOR(j, resampleCount) trajectories[i][j] += difference;
+				FOR(j, resampleCount)
+				{
+					FOR(d, dim) trajectory[j*stride + d] = samples[first + j][d];
+				}
 			}
 			else
 			{
-				fvec difference = centers[trajLabels[i]] - trajectories[i][0];
-				FOR(j, resampleCount) trajectories[i][j] += difference;
+				int length = sequences[i].second-first+1;
+				vector<fvec> points(length);
+				FOR(j, length) points[j] = fvec(samples[first + j].begin(), samples[first + j].begin() + dim);
+				points = cache.resampleType == 1 ? interpolate(points, resampleCount) : interpolateSpline(points, resampleCount);
+				FOR(j, resampleCount)
+				{
+					FOR(d, dim) trajectory[j*stride + d] = points[j][d];
+				}
 			}
-		}
-	}
 
-	float maxV = -FLT_MAX;
-	// we compute the velocity
-	FOR(i, trajectories.size())
-	{
-		FOR(j, resampleCount-1)
-		{
-			FOR(d, dim)
+			if(cache.centerType)
 			{
-				float velocity = (trajectories[i][j+1][d] - trajectories[i][j][d]) / dT;
-				trajectories[i][j][dim + d] = velocity;
-				if(velocity > maxV) maxV = velocity;
+				const float *reference = trajectory + (cache.centerType==1 ? (resampleCount-1)*stride : 0);
+				fvec difference(dim);
+				FOR(d, dim) difference[d] = offsets[i*dim + d] - reference[d];
+				FOR(j, resampleCount)
+				{
+					FOR(d, dim) trajectory[j*stride + d] += difference[d];
+				}
 			}
-		}
-		if(!zeroEnding)
-		{
-			FOR(d, dim)
+
+			// we compute the velocity
+			FOR(j, resampleCount-1)
 			{
-				trajectories[i][resampleCount-1][dim + d] = trajectories[i][resampleCount-2][dim + d];
+				FOR(d, dim)
+				{
+					float velocity = (trajectory[(j+1)*stride + d] - trajectory[j*stride + d]) / cache.dT;
+					trajectory[j*stride + dim + d] = velocity;
+					if(velocity > threadMaxV) threadMaxV = velocity;
+				}
+			}
+			if(!cache.zeroEnding && resampleCount > 1)
+			{
+				FOR(d, dim) trajectory[(resampleCount-1)*stride + dim + d] = trajectory[(resampleCount-2)*stride + dim + d];
 			}
 		}
-	}
-
-	// we normalize the velocities as the variance of the data
-	fvec mean, sigma;
-	mean.resize(dim,0);
-	int cnt = 0;
-	sigma.resize(dim,0);
-	FOR(i, trajectories.size())
-	{
-		FOR(j, resampleCount)
-		{
-			mean += trajectories[i][j];
-			cnt++;
-		}
-	}
-	mean /= cnt;
-	FOR(i, trajectories.size())
-	{
-		FOR(j, resampleCount)
+#pragma omp critical
 		{
-			fvec diff = (mean - trajectories[i][j]);
-			FOR(d,dim) sigma[d] += diff[d]*diff[d];
+			if(threadMaxV > maxV) maxV = threadMaxV;
 		}
 	}
-	sigma /= cnt;
 
-	FOR(i, trajectories.size())
+	// the velocities are normalized by the largest one
+	int pointCount = count*resampleCount;
+#pragma omp parallel for
+	for(int i=0; i<pointCount; i++)
 	{
-		FOR(j, resampleCount)
-		{
-			FOR(d, dim)
-			{
-				trajectories[i][j][dim + d] /= maxV;
-				//trajectories[i][j][dim + d] /= sqrt(sigma[d]);
-			}
-		}
+		FOR(d, dim) cache.buffer[i*stride + dim + d] /= maxV;
 	}
-	return trajectories;
 }
 
 
@@ -795,6 +876,7 @@ bool DatasetManager::Load(const char *filename)
 	file.close();
 	KILL(perm);
 	perm = randPerm(samples.size());
+    revision++;
 	return samples.size() > 0;
 }
 
@@ -22,6 +22,7 @@ Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
 #include <vector>
 #include "public.h"
 #include <string.h>
+#include <QMutex>
 
 enum DatasetManagerFlags
 {
@@ -154,6 +155,23 @@ protected:
 
 	u32 *perm;
 
+	u32 revision; // incremented every time the samples or sequences change
+	u32 editRevision; // incremented when existing samples are modified or removed, appending samples leaves it untouched
+
+	// resampled trajectories for the last few sets of parameters, each in a single buffer
+	// of count x length points holding the dim positions followed by the dim velocities
+	struct TrajectoryCache
+	{
+		int resampleType, resampleCount, centerType, zeroEnding;
+		float dT;
+		u32 revision;
+		int count, length, dim;
+		fvec buffer;
+	};
+	mutable std::vector<TrajectoryCache> trajectoryCache;
+	mutable QMutex trajectoryMutex; // the cache is filled from const getters, which the training thread calls too
+	void ComputeTrajectories(TrajectoryCache &cache) const;
+
 public:
     bool bProjected;
     std::map<int, std::vector<std::string> > categorical;
@@ -169,6 +187,8 @@ public:
     int GetSize() const {return size;}
     int GetCount() const {return samples.size();}
     int GetDimCount() const;
+    u32 GetRevision() const {return revision;}
+    u32 GetEditRevision() const {return editRevision;}
     std::pair<fvec, fvec> GetBounds() const;
     static u32 GetClassCount(const ivec classes);
 
@@ -178,6 +198,7 @@ public:
     void AddSamples(const DatasetManager &newSamples);
     void RemoveSample(const unsigned int index);
     void RemoveSamples(ivec indices);
+    void RemoveSamples(const bvec &mask);
 
     fvec GetSample(const int index=0) const { return (index < samples.size()) ? samples[index] : fvec(); }
     fvec GetSampleDim(const int index, const ivec inputDims, const int outputDim=-1) const;
@@ -186,12 +207,13 @@ public:
     std::vector< fvec > GetSampleDims(const ivec inputDims, const int outputDim=-1) const ;
     std::vector< fvec > GetSampleDims(const std::vector<fvec> samples, const ivec inputDims, const int outputDim=-1) const ;
     void SetSample(const int index, const fvec sample);
-    void SetSamples(const std::vector<fvec> samples){this->samples = samples;}
+    void SetSamples(const std::vector<fvec> samples){this->samples = samples; revision++; editRevision++;}
+    const std::vector< fvec >& GetSamplesRef() const {return samples;}
 
     int GetLabel(const int index) const {return index < labels.size() ? labels[index] : 0;}
     ivec GetLabels() const {return labels;}
-	void SetLabel(int index, int label){if(index<labels.size())labels[index] = label;}
-    void SetLabels(ivec labels){this->labels = labels;}
+	void SetLabel(int index, int label){if(index<labels.size())labels[index] = label; QMutexLocker lock(&trajectoryMutex); trajectoryCache.clear();}
+    void SetLabels(ivec labels){this->labels = labels; QMutexLocker lock(&trajectoryMutex); trajectoryCache.clear();}
 
     std::string GetCategorical(const int dimension,const  int value) const ;
     bool IsCategorical(const int dimension) const ;
@@ -204,6 +226,7 @@ public:
 
     ipair const GetSequence(const unsigned int index) const {return index < sequences.size() ? sequences[index] : ipair(-1,-1);}
     std::vector< ipair > GetSequences() const {return sequences;}
+    // the trajectories are cached until the samples, sequences or labels change
     std::vector< std::vector<fvec> > GetTrajectories(const int resampleType, const int resampleCount, const int centerType, const float dT, const int zeroEnding) const ;
 
 	// functions to manage obstacles
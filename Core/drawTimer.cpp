@@ -625,12 +625,14 @@ void DrawTimer::Maximization()
     w = bigMap.width(), h = bigMap.height();
     painter2.setRenderHint(QPainter::Antialiasing, true);
     painter2.setPen(Qt::NoPen);
-    vector<fvec> visited = (*maximizer)->Visited();
-    for(int i=maximumVisitedCount; i<visited.size(); i++)
+    // we only get the points visited since the last frame
+    vector<fvec> visited = (*maximizer)->TakeRecentVisited();
+    fvec visitedValues = (*maximizer)->GetValues(visited);
+    FOR(i, visited.size())
     {
         fvec &sample = visited[i];
         // we want to paint the last visited points
-        double value = (*maximizer)->GetValue(sample);
+        double value = visitedValues[i];
         value = 255*max(0.,min(1.,value));
         QPointF point(sample[0]*w, sample[1]*h);
         painter2.setBrush(QColor(255,255-value, 255-value));
@@ -662,11 +664,11 @@ void DrawTimer::Maximization()
         if(o.colors.size()) o.colors.back() = QVector4D(0,0,0,1);
         // we replace all past points as history
 
-        for(int i=maximumVisitedCount; i<visited.size(); i++)
+        FOR(i, visited.size())
         {
             fvec &sample = visited[i];
             // we want to paint the last visited points
-            double value = (*maximizer)->GetValue(sample);
+            double value = visitedValues[i];
             value = max(0.,min(1.,value))*0.5;
             o.vertices.push_back(QVector3D(sample[0]*2-1, value+0.02, sample[1]*2-1));
             o.colors.push_back(QVector4D(0,0,0,1));
@@ -691,7 +693,7 @@ void DrawTimer::Maximization()
         }
         glw->mutex->unlock();
     }
-    maximumVisitedCount = visited.size();
+    maximumVisitedCount = (*maximizer)->VisitedCount();
 }
 
 void DrawTimer::Reinforce()
@@ -773,6 +775,44 @@ bool DrawTimer::VectorsFast(int count, int steps)
     return true;
 }
 
+QColor DrawTimer::GetMultiColor(Classifier *classifier, fvec val)
+{
+    QColor c;
+    if(!val.size()) return QColor(0,0,0);
+    else if(val.size() == 1)
+    {
+        float v = val[0];
+        int color = fabs(v)*128;
+        color = max(0,min(color, 255));
+        if(v > 0) c = QColor(color,0,0);
+        else c = QColor(color,color,color);
+    }
+    else
+    {
+        // we find the max
+        int maxVal = 0;
+        FOR(i, val.size()) if (val[maxVal] < val[i]) maxVal = i;
+        val[maxVal] *= 3;
+        float sum = 0;
+        FOR(i, val.size()) sum += fabs(val[i]);
+        sum = 1.f/sum;
+
+        float r=0,g=0,b=0;
+        FOR(j, val.size())
+        {
+            int index = (classifier->inverseMap[j]%SampleColorCnt);
+            r += SampleColor[index].red()*val[j]*sum;
+            g += SampleColor[index].green()*val[j]*sum;
+            b += SampleColor[index].blue()*val[j]*sum;
+        }
+        r = max(0.f, min(255.f, r));
+        g = max(0.f, min(255.f, g));
+        b = max(0.f, min(255.f, b));
+        c = QColor(r,g,b);
+    }
+    return c;
+}
+
 QColor DrawTimer::GetColor(Classifier *classifier, fvec sample, std::vector<Classifier*> *classifierMulti, ivec sourceDims)
 {
     if(sourceDims.size())
@@ -783,42 +823,7 @@ QColor DrawTimer::GetColor(Classifier *classifier, fvec sample, std::vector<Clas
     }
 
     QColor c;
-    if(classifier->IsMultiClass())
-    {
-        fvec val = classifier->TestMulti(sample);
-        if(!val.size()) return QColor(0,0,0);
-        else if(val.size() == 1)
-        {
-            float v = val[0];
-            int color = fabs(v)*128;
-            color = max(0,min(color, 255));
-            if(v > 0) c = QColor(color,0,0);
-            else c = QColor(color,color,color);
-        }
-        else
-        {
-            // we find the max
-            int maxVal = 0;
-            FOR(i, val.size()) if (val[maxVal] < val[i]) maxVal = i;
-            val[maxVal] *= 3;
-            float sum = 0;
-            FOR(i, val.size()) sum += fabs(val[i]);
-            sum = 1.f/sum;
-
-            float r=0,g=0,b=0;
-            FOR(j, val.size())
-            {
-                int index = (classifier->inverseMap[j]%SampleColorCnt);
-                r += SampleColor[index].red()*val[j]*sum;
-                g += SampleColor[index].green()*val[j]*sum;
-                b += SampleColor[index].blue()*val[j]*sum;
-            }
-            r = max(0.f, min(255.f, r));
-            g = max(0.f, min(255.f, g));
-            b = max(0.f, min(255.f, b));
-            c = QColor(r,g,b);
-        }
-    }
+    if(classifier->IsMultiClass()) c = GetMultiColor(classifier, classifier->TestMulti(sample));
     else
     {
         if(classifierMulti && (*classifierMulti).size())
@@ -929,6 +934,23 @@ bool DrawTimer::TestFast(int start, int stop)
         fromCanvas(samples[i], x, y, cheight, cwidth, zxh, zyh, xIndex, yIndex, center, bRestrictedDims);
     }
 
+    // multi-class classifiers get the whole batch at once, it is coloured without releasing
+    // the lock so that the classifier cannot be replaced in between
+    mutex->lock();
+    if((*classifier) && (*classifier)->IsMultiClass()) {
+        vector<fvec> batch = (*classifier)->TestBatch(samples);
+        if(batch.size() == samples.size()) {
+            vector<QRgb> colors(batch.size());
+            FOR(i, batch.size()) colors[i] = GetMultiColor(*classifier, batch[i]).rgb();
+            drawMutex.lock();
+            FOR(i, batch.size()) bigMap.setPixel(X[i], Y[i], colors[i]);
+            drawMutex.unlock();
+            mutex->unlock();
+            return true;
+        }
+    }
+    mutex->unlock();
+
     FOR(i, stop-start) {
         fvec& sample = samples[i];
         int x = X[i];
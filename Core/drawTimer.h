@@ -60,6 +60,7 @@ public:
     void Reinforce();
 	void Stop();
     static QColor GetColor(Classifier *classifier, fvec sample, std::vector<Classifier*> *classifierMulti=0, ivec sourceDims=ivec());
+    static QColor GetMultiColor(Classifier *classifier, fvec val);
 
 	Classifier **classifier;
 	Regressor **regressor;
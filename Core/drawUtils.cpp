@@ -1041,51 +1041,87 @@ public:
     fvec &front() {return trajectory.front();}
 };
 
-inline float StreamDistance(Streamline &s, vector<fvec> &mean)
+// points kept for each streamline when clustering them
+#define STREAM_SAMPLES 32
+
+// we resample the streamline backwards (from its end) to STREAM_SAMPLES points evenly spaced along its length
+void ResampleStream(const Streamline &s, float *buffer, int dim)
 {
-    float res = 0;
-    int dim = mean[0].size();
-    int length = min((int)mean.size(), s.length);
-    FOR(i, length)
+    const std::vector<fvec> &t = s.trajectory;
+    int length = t.size();
+    if(!length)
+    {
+        FOR(i, STREAM_SAMPLES*dim) buffer[i] = 0;
+        return;
+    }
+    fvec lengths(length, 0.f); // distance of each point from the end of the stream
+    for(int j=length-2; j>=0; j--)
+    {
+        float segment = 0;
+        FOR(d, dim) segment += (t[j+1][d]-t[j][d])*(t[j+1][d]-t[j][d]);
+        lengths[j] = lengths[j+1] + sqrtf(segment);
+    }
+    int j = length-1;
+    FOR(i, STREAM_SAMPLES)
     {
-        FOR(d, dim) res += (mean[i][d]-s[i][d])*(mean[i][d]-s[i][d]);
+        float target = lengths[0] * i / (float)(STREAM_SAMPLES-1);
+        while(j > 0 && lengths[j-1] <= target) j--;
+        float *point = buffer + i*dim;
+        if(j == 0 || lengths[j-1] == lengths[j])
+        {
+            FOR(d, dim) point[d] = t[j][d];
+            continue;
+        }
+        float w = (target - lengths[j]) / (lengths[j-1] - lengths[j]);
+        FOR(d, dim) point[d] = t[j][d] + (t[j-1][d]-t[j][d])*w;
     }
+}
+
+inline float StreamDistance(const float *s, const float *mean, int size)
+{
+    float res = 0;
+    FOR(i, size) res += (mean[i]-s[i])*(mean[i]-s[i]);
     return res;
 }
 
-ivec ClusterStreams(std::vector<Streamline> streams, int nbClusters, int maxIterations=5)
+ivec ClusterStreams(const std::vector<Streamline> &streams, int nbClusters, int maxIterations=5)
 {
     if(!streams.size()) return ivec();
     int count = streams.size();
     nbClusters = min(count, nbClusters);
-    vector< vector<fvec> > means(nbClusters); // the clusters 'mean' trajectories
-    ivec clusters(count); // the responsiblity (which cluster each stream belongs to
-
-    // first thing we do is to invert all streams so that we can follow them backwards
+    int dim = 0;
     FOR(i, count)
     {
-        std::reverse(streams[i].trajectory.begin(), streams[i].trajectory.end());
+        if(streams[i].trajectory.size()) dim = max(dim, (int)streams[i].trajectory[0].size());
     }
+    int size = STREAM_SAMPLES*dim;
+
+    // all the streams have the same length once resampled, we keep them in a single buffer
+    std::vector<float> buffers(count*size);
+#pragma omp parallel for
+    for(int i=0; i<count; i++) ResampleStream(streams[i], &buffers[i*size], dim);
 
     // we initialize by picking actual trajectories
+    std::vector<float> means(nbClusters*size); // the clusters 'mean' trajectories
     FOR(i, nbClusters)
     {
         int index = i * count / nbClusters;
-        means[i] = streams[index].trajectory;
+        std::copy(&buffers[index*size], &buffers[index*size] + size, &means[i*size]);
     }
 
+    ivec clusters(count, -1); // the responsiblity (which cluster each stream belongs to)
     FOR(it, maxIterations)
     {
         // we recompute the responsiblity for each cluster
-        qDebug() << "E Step" << it;
         ivec newClusters(count,0);
-        FOR(i, count)
+#pragma omp parallel for
+        for(int i=0; i<count; i++)
         {
             float minDist = FLT_MAX;
             int minInd = 0;
             FOR(j, nbClusters)
             {
-                float dist = StreamDistance(streams[i], means[j]);
+                float dist = StreamDistance(&buffers[i*size], &means[j*size], size);
                 if(dist < minDist)
                 {
                     minInd = j;
@@ -1097,42 +1133,19 @@ ivec ClusterStreams(std::vector<Streamline> streams, int nbClusters, int maxIter
         if(clusters == newClusters) break; // we've converged!
         clusters = newClusters;
 
-        // and now we compute the new means
-        qDebug() << "M Step" << it;
+        // and now we compute the new means (a cluster without streams keeps its old one)
         ivec counts(nbClusters,0);
-        vector<ivec> meanCounts(nbClusters);
+        std::vector<float> sums(nbClusters*size, 0.f);
         FOR(i, count)
         {
             int c = clusters[i];
-            if(!counts[c])
-            {
-                means[c] = streams[i].trajectory;
-                meanCounts[c].resize(streams[i].length,1);
-            }
-            else
-            {
-                FOR(j, streams[i].size())
-                {
-                    if(j < means[c].size())
-                    {
-                        means[c][j] += streams[i][j];
-                        meanCounts[c][j]++;
-                    }
-                    else
-                    {
-                        means[c].push_back(streams[i][j]);
-                        meanCounts[c].push_back(1);
-                    }
-                }
-            }
+            FOR(j, size) sums[c*size + j] += buffers[i*size + j];
             counts[c]++;
         }
         FOR(c, nbClusters)
         {
-            FOR(j, means[c].size())
-            {
-                means[c][j] /= meanCounts[c][j];
-            }
+            if(!counts[c]) continue;
+            FOR(j, size) means[c*size + j] = sums[c*size + j] / counts[c];
         }
     }
     return clusters;
@@ -1220,69 +1233,69 @@ inline int binFromVector(float *v)
     return bin;
 }
 
-fvec ComputeDynamicalEntropy(Dynamical *dynamical, fvec mins, fvec maxes, int gridSteps = 64, int hSteps = 16)
+// entropy of the flow directions over the cells of a single slab (constant z) of the hSteps^3 grid.
+// The field is only evaluated on the gridSteps^2 x ratio points that fall inside the slab
+void ComputeDynamicalEntropySlab(Dynamical *dynamical, const fvec &mins, const fvec &maxes, int gridSteps, int hSteps, int slab, fvec &H)
 {
-    // we begin by generating a dense grid of values
-    qDebug() << "dumping vectors to memory";
-    vector<fvec> grid(gridSteps*gridSteps*gridSteps);
-    fvec sample(3);
-    FOR(z, gridSteps)
+    int ratio = gridSteps/hSteps;
+    vector<fvec> samples(gridSteps*gridSteps*ratio, fvec(3));
+    FOR(z, ratio)
     {
-        sample[2] = z / (float)gridSteps * (maxes[2]-mins[2]) + mins[2];
+        float sz = (z + slab*ratio) / (float)gridSteps * (maxes[2]-mins[2]) + mins[2];
         FOR(y, gridSteps)
         {
-            sample[1] = y / (float)gridSteps * (maxes[1]-mins[1]) + mins[1];
+            float sy = y / (float)gridSteps * (maxes[1]-mins[1]) + mins[1];
             FOR(x, gridSteps)
             {
+                fvec &sample = samples[x + (y + z*gridSteps)*gridSteps];
                 sample[0] = x / (float)gridSteps * (maxes[0]-mins[0]) + mins[0];
-                fvec res = dynamical->Test(sample);
-//                res = res/sqrtf(res*res); // we normalize it
-                grid[x + (y + z*gridSteps)*gridSteps] = res;
+                sample[1] = sy;
+                sample[2] = sz;
             }
         }
     }
+    vector<fvec> grid = dynamical->TestBatch(samples);
 
     if(!tesssphere) tesssphere = tessellatedSphere(1);
-
-    // bins: binCount*binCount*binCount
     int binCount = tesssize;
-    int ratio = gridSteps/hSteps;
-    fvec H(hSteps*hSteps*hSteps);
-
-    FOR(i, hSteps)
+    int cellCount = hSteps*hSteps;
+#pragma omp parallel for
+    for(int cell=0; cell<cellCount; cell++)
     {
-        FOR(j, hSteps)
+        int j = cell / hSteps;
+        int k = cell % hSteps;
+        int bins[32];
+        FOR(d, 32) bins[d] = 0;
+        // we get the histogram for the current subcube
+        FOR(z,ratio)
         {
-            FOR(k, hSteps)
+            FOR(y,ratio)
             {
-                int bins[32];
-                FOR(d, 32) bins[d] = 0;
-                // we get the histogram for the current subcube
-                FOR(z,ratio)
-                {
-                    FOR(y,ratio)
-                    {
-                        FOR(x,ratio)
-                        {
-                            float *val = &grid[(x + k*ratio) + (y+j*ratio + (z+i*ratio)*gridSteps)*gridSteps][0];
-                            int bin = binFromVector(val);
-                            bins[bin] += 1;
-                        }
-                    }
-                }
-                float sum = ratio*ratio*ratio;
-                float entropy = 0;
-                FOR(d, binCount)
+                FOR(x,ratio)
                 {
-                    if(bins[d] == 0) continue;
-                    float p = bins[d]/sum;
-                    float e = p*log2(p);
-                    entropy -= e;
+                    float *val = &grid[(x + k*ratio) + (y+j*ratio + z*gridSteps)*gridSteps][0];
+                    int bin = binFromVector(val);
+                    bins[bin] += 1;
                 }
-                H[k + (j + i*hSteps)*hSteps] = entropy;
             }
         }
+        float sum = ratio*ratio*ratio;
+        float entropy = 0;
+        FOR(d, binCount)
+        {
+            if(bins[d] == 0) continue;
+            float p = bins[d]/sum;
+            float e = p*log2(p);
+            entropy -= e;
+        }
+        H[k + (j + slab*hSteps)*hSteps] = entropy;
     }
+}
+
+fvec ComputeDynamicalEntropy(Dynamical *dynamical, fvec mins, fvec maxes, int gridSteps = 64, int hSteps = 16)
+{
+    fvec H(hSteps*hSteps*hSteps, 0.f);
+    FOR(i, hSteps) ComputeDynamicalEntropySlab(dynamical, mins, maxes, gridSteps, hSteps, i, H);
     return H;
 }
 
@@ -1298,6 +1311,7 @@ GLObject DrawEntropyField(fvec H, float minv, float maxv, int hSteps)
         minH = min(minH, H[i]);
         maxH = max(maxH, H[i]);
     }
+    if(maxH <= minH) return o;
 
     FOR(i, hSteps)
     {
@@ -1569,6 +1583,26 @@ GLObject DrawStreamLines(vector<Streamline> streams, int xInd, int yInd, int zIn
     return o;
 }
 
+// we replace the old vector field (if there is one) with the new one
+void ReplaceDynamicalObject(GLWidget *glw, GLObject &o)
+{
+    glw->mutex->lock();
+    int oInd = -1;
+    FOR(i, glw->objects.size())
+    {
+        if(!glw->objectAlive[i]) continue;
+        if(std::find(glw->killList.begin(), glw->killList.end(), (int)i) != glw->killList.end()) continue;
+        if(glw->objects[i].objectType.contains("Dynamize"))
+        {
+            oInd = i;
+            break;
+        }
+    }
+    if(oInd != -1) glw->killList.push_back(oInd);
+    glw->AddObject(o);
+    glw->mutex->unlock();
+}
+
 void Draw3DDynamical(GLWidget *glw, Dynamical *dynamical, int displayStyle)
 {
     if(!dynamical) return;
@@ -1602,7 +1636,18 @@ void Draw3DDynamical(GLWidget *glw, Dynamical *dynamical, int displayStyle)
     int gridSteps = 80;
     int hSteps = 20;
     //int hRatio = gridSteps/hSteps;
-    fvec H = ComputeDynamicalEntropy(dynamical, fvec(dim,minv), fvec(dim,maxv), gridSteps, hSteps);
+    fvec H(hSteps*hSteps*hSteps, 0.f);
+    FOR(i, hSteps)
+    {
+        ComputeDynamicalEntropySlab(dynamical, fvec(dim,minv), fvec(dim,maxv), gridSteps, hSteps, i, H);
+        // the entropy field is shown while it is being computed, one slab at a time
+        if(displayStyle == 0 && i < hSteps-1)
+        {
+            GLObject field = DrawEntropyField(H, minv, maxv, hSteps);
+            ReplaceDynamicalObject(glw, field);
+            glw->repaint();
+        }
+    }
     vector< pair<float,int> > hList(H.size());
     float hSum = 0;
     float hmin = FLT_MAX, hmax = -FLT_MAX;
@@ -1658,15 +1703,27 @@ void Draw3DDynamical(GLWidget *glw, Dynamical *dynamical, int displayStyle)
     // we generate the trajectories
     int steps = 400;
     float maxSpeed = -FLT_MAX;
+    // all the streams move forward together, so that each step is a single batch for the dynamical
     vector<Streamline> streams(seeds.size());
+    vector<fvec> positions = seeds;
+    ivec active;
     FOR(i, seeds.size())
     {
-        sample = seeds[i];
-        Streamline s;
-        s.push_back(sample);
-        FOR(j, steps)
+        streams[i].push_back(seeds[i]);
+        streams[i].cluster = i;
+        active.push_back(i);
+    }
+    for(int j=0; j<steps && active.size(); j++)
+    {
+        vector<fvec> current(active.size());
+        FOR(a, active.size()) current[a] = positions[active[a]];
+        vector<fvec> velocities = dynamical->TestBatch(current);
+        ivec stillActive;
+        FOR(a, active.size())
         {
-            fvec res = dynamical->Test(sample);
+            int i = active[a];
+            fvec &sample = positions[i];
+            fvec res = velocities[a];
             if(dynamical->avoid)
             {
                 dynamical->avoid->SetObstacles(obstacles);
@@ -1676,12 +1733,12 @@ void Draw3DDynamical(GLWidget *glw, Dynamical *dynamical, int displayStyle)
             float speed = sqrtf((res*dT)*(res*dT));
             if(speed > maxSpeed) maxSpeed = speed;
             sample += res*dT;
-            if(speed < 1e-4) break;
-            if(sqrtf((sample - origin)*(sample - origin)) > diff*0.7) break;
-            s.push_back(sample);
+            if(speed < 1e-4) continue;
+            if(sqrtf((sample - origin)*(sample - origin)) > diff*0.7) continue;
+            streams[i].push_back(sample);
+            stillActive.push_back(i);
         }
-        s.cluster = i;
-        streams[i] = s;
+        active = stillActive;
     }
 
     GLObject o;
@@ -1701,21 +1758,7 @@ void Draw3DDynamical(GLWidget *glw, Dynamical *dynamical, int displayStyle)
         break;
     }
 
-    // we replace the old vector field (if there is one) with the new one
-    glw->mutex->lock();
-    int oInd = -1;
-    FOR(i, glw->objects.size())
-    {
-        if(!glw->objectAlive[i]) continue;
-        if(glw->objects[i].objectType.contains("Dynamize"))
-        {
-            oInd = i;
-            break;
-        }
-    }
-    if(oInd != -1) glw->killList.push_back(oInd);
-    glw->AddObject(o);
-    glw->mutex->unlock();
+    ReplaceDynamicalObject(glw, o);
 }
 
 void Draw3DMaximizer(GLWidget *glw, Maximizer *maximizer){}
@@ -25,6 +25,8 @@ Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
 
 extern "C" enum {DYN_SVR, DYN_RVM, DYN_GMR, DYN_GPR, DYN_KNN, DYN_MLP, DYN_LINEAR, DYN_LWPR, DYN_KRLS, DYN_SEDS, DYN_NONE} dynamicalType;
 
+class ModelArchive;
+
 class Dynamical
 {
 protected:
@@ -32,6 +34,7 @@ protected:
 	ivec classes;
 	ivec labels;
 	u32 dim;
+	bool bBackgroundTraining; // false when Train uses widgets and has to run on the GUI thread
 
 public:
 	std::vector<fvec> crossval;
@@ -42,18 +45,24 @@ public:
 	u32 count;
 	ObstacleAvoidance *avoid;
 
-	Dynamical(): type(DYN_NONE), count(100), dT(0.02f), avoid(0){}
+	Dynamical(): type(DYN_NONE), count(100), dT(0.02f), avoid(0), bBackgroundTraining(true){}
     virtual ~Dynamical(){if(avoid) delete avoid;}
     std::vector< std::vector<fvec> > GetTrajectories(){return trajectories;}
     int Dim(){return dim;}
+    bool BackgroundTraining() const {return bBackgroundTraining;}
 
     virtual void Train(std::vector< std::vector<fvec> > trajectories, ivec labels){}
     virtual std::vector<fvec> Test( const fvec &sample, const int count){ return std::vector<fvec>(); }
     virtual fvec Test( const fvec &sample){ return fvec(); }
     virtual fVec Test(const fVec &sample){ return fVec(Test((fvec)sample)); }
+    // Test over a whole set of samples, for dynamicals that are faster on batches
+    virtual std::vector<fvec> TestBatch(const std::vector<fvec> &samples){ std::vector<fvec> res(samples.size()); FOR(i, samples.size()) res[i] = Test(samples[i]); return res;}
     virtual const char *GetInfoString(){return NULL;}
     virtual void SaveModel(std::string filename){}
     virtual bool LoadModel(std::string filename){return false;}
+    // binary model archive, returns false when the model cannot be stored that way
+    virtual bool SaveModel(ModelArchive &archive) {return false;}
+    virtual bool LoadModel(const ModelArchive &archive){return false;}
 };
 
 #endif // _DYNAMICAL_H_
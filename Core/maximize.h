@@ -24,6 +24,8 @@ Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
 #include <mymaths.h>
 #include <QPainter>
 #include <glUtils.h>
+#include <objective.h>
+#include <random>
 
 class Maximizer
 {
@@ -33,20 +35,66 @@ protected:
 	bool bIterative;
 	bool bConverged;
 	fvec maximum;
-	std::vector< fvec > visited;
+	std::vector< fvec > visited; // uniform reservoir of the visited samples, at most visitedCapacity of them
+	std::vector< fvec > visitedRecent; // samples visited since the last call to TakeRecentVisited()
+	int visitedCount, visitedCapacity;
+	std::minstd_rand visitedRng; // separate stream, so that the reservoir does not perturb the optimizer's own draws
 	std::vector< fvec > history;
 	std::vector<double> historyValue;
 	double maximumValue;
 	float *data;
 	int evaluations;
+	Objective *objective; // what we are maximizing (by default the reward map in data)
+
+	// copies the reward map and uses it as objective, a NULL map keeps the current objective
+	void SetData(float *dataMap, fVec size)
+	{
+		if(data) delete [] data;
+		if(!dataMap)
+		{
+			w = h = 1;
+			data = new float[1];
+			data[0] = 0;
+			return;
+		}
+		w = size.x;
+		h = size.y;
+		data = new float[w*h];
+		memcpy(data, dataMap, w*h*sizeof(float));
+		SetObjective(new MapObjective(data, w, h));
+	}
+
+	void AddVisited(const fvec &sample)
+	{
+		visitedCount++;
+		if(visitedRecent.size() >= visitedCapacity) visitedRecent.erase(visitedRecent.begin(), visitedRecent.begin() + visitedRecent.size()/2);
+		visitedRecent.push_back(sample);
+		if(visited.size() < visitedCapacity)
+		{
+			visited.push_back(sample);
+			return;
+		}
+		// reservoir sampling: every visited sample has the same chance of being kept
+		int slot = visitedRng() % visitedCount;
+		if(slot < visitedCapacity) visited[slot] = sample;
+	}
 
 public:
 	int age, maxAge;
 	double stopValue;
 
-    Maximizer() : evaluations(0), stopValue(.99), maxAge(200), age(0), dim(2), bIterative(false) , bConverged(true), data(NULL), w(1), h(1), maximumValue(-FLT_MAX){ maximum.resize(2);}
-    virtual ~Maximizer(){if(data) delete [] data;}
+    Maximizer() : evaluations(0), stopValue(.99), maxAge(200), age(0), dim(2), bIterative(false) , bConverged(true), data(NULL), w(1), h(1), maximumValue(-FLT_MAX), objective(NULL), visitedCount(0), visitedCapacity(5000){ maximum.resize(2);}
+    virtual ~Maximizer(){if(data) delete [] data; if(objective) delete objective;}
     void Maximize(float *dataMap, int w, int h) {Train(dataMap,fVec(w,h));}
+    // maximizes an arbitrary N-dimensional objective (takes ownership of it)
+    void Maximize(Objective *objective, fvec startingPoint=fvec())
+    {
+        SetObjective(objective);
+        if(objective) dim = objective->GetDim();
+        Train(NULL, fVec(1,1), startingPoint);
+    }
+    void SetObjective(Objective *objective){if(this->objective && this->objective != objective) delete this->objective; this->objective = objective;}
+    Objective *GetObjective(){return objective;}
     bool hasConverged(){return bConverged;}
     void SetConverged(bool converged){bConverged = converged;}
     std::vector<fvec> &History(){return history;}
@@ -54,6 +102,9 @@ public:
     fvec &Maximum(){return maximum;}
     double MaximumValue(){return GetValue(maximum);}
     std::vector<fvec> &Visited(){return visited;}
+    int VisitedCount(){return visitedCount;}
+    // returns (and forgets) the samples visited since the last call
+    std::vector<fvec> TakeRecentVisited(){std::vector<fvec> recent; recent.swap(visitedRecent); return recent;}
     int &Evaluations(){return evaluations;}
     static float GetValue(fvec sample, float *data, int w, int h)
     {
@@ -64,11 +115,25 @@ public:
     }
     float GetValue(fvec sample)
 	{
+		if(objective) return objective->Value(sample);
 		int xIndex = max(0, min(w-1, (int)(sample[0]*w)));
 		int yIndex = max(0, min(h-1, (int)(sample[1]*h)));
 		int index = yIndex*w + xIndex;
 		return data[index];
 	}
+    // batched evaluation of a population, runs concurrently when the objective allows it
+    fvec GetValues(const std::vector<fvec> &samples)
+    {
+        if(objective) return objective->Values(samples);
+        fvec values(samples.size());
+        FOR(i, samples.size()) values[i] = GetValue(samples[i]);
+        return values;
+    }
+    fvec GetGradient(const fvec &sample)
+    {
+        if(objective) return objective->Gradient(sample);
+        return fvec(sample.size(), 0.f);
+    }
 
     virtual void Draw(QPainter &painter){}
     virtual std::vector<GLObject> DrawGL(){return std::vector<GLObject>();}
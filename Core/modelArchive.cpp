@@ -0,0 +1,276 @@
+/*********************************************************************
+MLDemos: A User-Friendly visualization toolkit for machine learning
+Copyright (C) 2010  Basilio Noris
+Contact: mldemos@b4silio.com
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Library General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free
+Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*********************************************************************/
+#include "public.h"
+#include "modelArchive.h"
+#include <QFile>
+#include <QDebug>
+
+using namespace std;
+
+// file layout (native byte order):
+//   signature, version, byte order mark, entry count
+//   for each entry: name length, name, offset from the start of the file, size in bytes
+//   the buffers, each starting on a 16 bytes boundary
+static const char archiveSignature[8] = {'M','L','D','M','O','D','E','L'};
+static const u32 archiveByteOrder = 0x01020304;
+#define ARCHIVE_ALIGN 16
+
+typedef unsigned long long archive_size;
+
+ModelArchive::ModelArchive()
+    : file(0), map(0)
+{
+}
+
+ModelArchive::~ModelArchive()
+{
+    Clear();
+}
+
+void ModelArchive::Clear()
+{
+    entries.clear();
+    contents.clear();
+    if(file)
+    {
+        if(map) file->unmap(map);
+        file->close();
+        DEL(file);
+    }
+    map = 0;
+}
+
+int ModelArchive::Find(const std::string &name) const
+{
+    FOR(i, entries.size())
+    {
+        if(entries[i].name == name) return i;
+    }
+    return -1;
+}
+
+void ModelArchive::Add(const std::string &name, const void *data, const size_t bytes)
+{
+    int index = Find(name);
+    if(index < 0)
+    {
+        index = entries.size();
+        entries.resize(index+1);
+        entries[index].name = name;
+    }
+    Entry &entry = entries[index];
+    entry.data.assign((const char *)data, (const char *)data + (data ? bytes : 0));
+    entry.mapped = 0;
+    entry.bytes = entry.data.size();
+}
+
+void ModelArchive::AddSamples(const std::string &name, const std::vector<fvec> &samples)
+{
+    u32 dim = samples.size() ? samples[0].size() : 0;
+    fvec values(1 + samples.size()*dim);
+    memcpy(&values[0], &dim, sizeof(u32));
+    FOR(i, samples.size())
+    {
+        FOR(d, dim) values[1 + i*dim + d] = d < samples[i].size() ? samples[i][d] : 0.f;
+    }
+    AddVector(name, values);
+}
+
+bool ModelArchive::AddFile(const std::string &name, FILE *file)
+{
+    if(!file) return false;
+    fflush(file);
+    if(fseek(file, 0, SEEK_END)) return false;
+    long size = ftell(file);
+    if(size < 0) return false;
+    rewind(file);
+    vector<char> data(size);
+    if(size && fread(&data[0], 1, size, file) != (size_t)size) return false;
+    Add(name, size ? &data[0] : 0, size);
+    return true;
+}
+
+bool ModelArchive::Save(const std::string &filename) const
+{
+    QFile out(QString::fromStdString(filename));
+    if(!out.open(QFile::WriteOnly)) return false;
+
+    archive_size header = sizeof(archiveSignature) + 3*sizeof(u32);
+    FOR(i, entries.size()) header += sizeof(u32) + entries[i].name.size() + 2*sizeof(archive_size);
+    vector<archive_size> offsets(entries.size());
+    archive_size offset = header;
+    FOR(i, entries.size())
+    {
+        offset = (offset + ARCHIVE_ALIGN-1) / ARCHIVE_ALIGN * ARCHIVE_ALIGN;
+        offsets[i] = offset;
+        offset += entries[i].bytes;
+    }
+
+    u32 version = ModelArchive::version, count = entries.size();
+    bool bOk = out.write(archiveSignature, sizeof(archiveSignature)) == sizeof(archiveSignature);
+    bOk &= out.write((const char *)&version, sizeof(u32)) == sizeof(u32);
+    bOk &= out.write((const char *)&archiveByteOrder, sizeof(u32)) == sizeof(u32);
+    bOk &= out.write((const char *)&count, sizeof(u32)) == sizeof(u32);
+    FOR(i, entries.size())
+    {
+        u32 length = entries[i].name.size();
+        archive_size bytes = entries[i].bytes;
+        bOk &= out.write((const char *)&length, sizeof(u32)) == sizeof(u32);
+        bOk &= out.write(entries[i].name.data(), length) == length;
+        bOk &= out.write((const char *)&offsets[i], sizeof(archive_size)) == sizeof(archive_size);
+        bOk &= out.write((const char *)&bytes, sizeof(archive_size)) == sizeof(archive_size);
+    }
+    const char padding[ARCHIVE_ALIGN] = {0};
+    FOR(i, entries.size())
+    {
+        archive_size gap = offsets[i] - out.pos();
+        if(gap) bOk &= out.write(padding, gap) == (qint64)gap;
+        const char *data = entries[i].mapped ? entries[i].mapped : (entries[i].bytes ? &entries[i].data[0] : 0);
+        if(entries[i].bytes) bOk &= out.write(data, entries[i].bytes) == (qint64)entries[i].bytes;
+    }
+    out.close();
+    if(!bOk) qDebug() << "Error: could not write the model archive" << QString::fromStdString(filename);
+    return bOk;
+}
+
+bool ModelArchive::IsArchive(const std::string &filename)
+{
+    QFile in(QString::fromStdString(filename));
+    if(!in.open(QFile::ReadOnly)) return false;
+    char signature[sizeof(archiveSignature)];
+    return in.read(signature, sizeof(signature)) == sizeof(signature) && !memcmp(signature, archiveSignature, sizeof(signature));
+}
+
+bool ModelArchive::Load(const std::string &filename)
+{
+    Clear();
+    file = new QFile(QString::fromStdString(filename));
+    if(!file->open(QFile::ReadOnly))
+    {
+        DEL(file);
+        return false;
+    }
+    archive_size size = file->size();
+    map = file->map(0, size);
+    const char *base = (const char *)map;
+    if(!map)
+    {
+        // some file systems do not support mapping, the archive is then read in one go
+        contents.resize(size);
+        if(size && file->read(&contents[0], size) != (qint64)size)
+        {
+            Clear();
+            return false;
+        }
+        base = size ? &contents[0] : 0;
+    }
+
+    archive_size position = sizeof(archiveSignature) + 3*sizeof(u32);
+    u32 fileVersion = 0, byteOrder = 0, count = 0;
+    bool bOk = size >= position && !memcmp(base, archiveSignature, sizeof(archiveSignature));
+    if(bOk)
+    {
+        memcpy(&fileVersion, base + sizeof(archiveSignature), sizeof(u32));
+        memcpy(&byteOrder, base + sizeof(archiveSignature) + sizeof(u32), sizeof(u32));
+        memcpy(&count, base + sizeof(archiveSignature) + 2*sizeof(u32), sizeof(u32));
+        bOk = fileVersion >= 1 && fileVersion <= ModelArchive::version && byteOrder == archiveByteOrder;
+    }
+    for(u32 i=0; bOk && i<count; i++)
+    {
+        u32 length = 0;
+        archive_size offset = 0, bytes = 0;
+        bOk = position + sizeof(u32) <= size;
+        if(!bOk) break;
+        memcpy(&length, base + position, sizeof(u32));
+        position += sizeof(u32);
+        bOk = position + length + 2*sizeof(archive_size) <= size;
+        if(!bOk) break;
+        Entry entry;
+        entry.name = string(base + position, length);
+        position += length;
+        memcpy(&offset, base + position, sizeof(archive_size));
+        memcpy(&bytes, base + position + sizeof(archive_size), sizeof(archive_size));
+        position += 2*sizeof(archive_size);
+        bOk = offset <= size && bytes <= size - offset;
+        entry.mapped = base + offset;
+        entry.bytes = bytes;
+        entries.push_back(entry);
+    }
+    if(!bOk)
+    {
+        qDebug() << "Error: not a valid model archive" << QString::fromStdString(filename);
+        Clear();
+    }
+    return bOk;
+}
+
+const char *ModelArchive::Data(const std::string &name, size_t *bytes) const
+{
+    int index = Find(name);
+    if(bytes) *bytes = 0;
+    if(index < 0) return 0;
+    const Entry &entry = entries[index];
+    if(bytes) *bytes = entry.bytes;
+    if(entry.mapped) return entry.mapped;
+    // empty entries still return a valid pointer, to tell them apart from missing ones
+    return entry.bytes ? &entry.data[0] : "";
+}
+
+std::string ModelArchive::GetString(const std::string &name) const
+{
+    size_t bytes = 0;
+    const char *data = Data(name, &bytes);
+    return data ? string(data, bytes) : string();
+}
+
+bool ModelArchive::GetSamples(const std::string &name, std::vector<fvec> &samples) const
+{
+    size_t bytes = 0;
+    const char *data = Data(name, &bytes);
+    if(!data || bytes < sizeof(u32) || bytes % sizeof(float)) return false;
+    u32 dim = 0;
+    memcpy(&dim, data, sizeof(u32));
+    size_t values = bytes / sizeof(float) - 1;
+    if(dim ? values % dim : values) return false;
+    size_t count = dim ? values / dim : 0;
+    samples.resize(count, fvec(dim));
+    FOR(i, count)
+    {
+        samples[i].resize(dim);
+        if(dim) memcpy(&samples[i][0], data + sizeof(float)*(1 + i*dim), dim*sizeof(float));
+    }
+    return true;
+}
+
+FILE *ModelArchive::OpenFile(const std::string &name) const
+{
+    size_t bytes = 0;
+    const char *data = Data(name, &bytes);
+    if(!data) return 0;
+    FILE *file = tmpfile();
+    if(!file) return 0;
+    if(bytes && fwrite(data, 1, bytes, file) != bytes)
+    {
+        fclose(file);
+        return 0;
+    }
+    rewind(file);
+    return file;
+}
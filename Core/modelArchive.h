@@ -0,0 +1,104 @@
+/*********************************************************************
+MLDemos: A User-Friendly visualization toolkit for machine learning
+Copyright (C) 2010  Basilio Noris
+Contact: mldemos@b4silio.com
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public License,
+version 3 as published by the Free Software Foundation.
+
+This library is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free
+Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*********************************************************************/
+#ifndef _MODEL_ARCHIVE_H_
+#define _MODEL_ARCHIVE_H_
+
+#include <vector>
+#include <string>
+#include <string.h>
+#include <stdio.h>
+#include "types.h"
+
+class QFile;
+
+// versioned binary container for trained models.
+// An archive holds the name of the plugin that produced the model, its parameters
+// (in the SaveParams text format) and a list of named buffers stored on 16 bytes boundaries.
+// Archives are read through a memory map, the buffers can then be used in place
+class ModelArchive
+{
+public:
+    static const unsigned int version = 1;
+
+    ModelArchive();
+    ~ModelArchive();
+    void Clear();
+
+    void SetPlugin(const std::string &name){AddString(".plugin", name);}
+    std::string Plugin() const {return GetString(".plugin");}
+    void SetParams(const std::string &params){AddString(".params", params);}
+    std::string Params() const {return GetString(".params");}
+
+    // the data is copied into the archive, an existing entry with the same name is replaced
+    void Add(const std::string &name, const void *data, const size_t bytes);
+    void AddString(const std::string &name, const std::string &value){Add(name, value.data(), value.size());}
+    template<class T> void AddValue(const std::string &name, const T &value){Add(name, &value, sizeof(T));}
+    template<class T> void AddVector(const std::string &name, const std::vector<T> &values){Add(name, values.size() ? &values[0] : 0, values.size()*sizeof(T));}
+    // samples are stored row by row, all with the dimension of the first one
+    void AddSamples(const std::string &name, const std::vector<fvec> &samples);
+    // copies the whole content of a file, for libraries that serialize through FILE pointers
+    bool AddFile(const std::string &name, FILE *file);
+    bool Save(const std::string &filename) const;
+
+    bool Load(const std::string &filename);
+    // checks the signature of the file without loading it
+    static bool IsArchive(const std::string &filename);
+    bool Has(const std::string &name) const {return Find(name) >= 0;}
+    // the buffer of an entry (in the mapped file after Load), NULL if the entry does not exist
+    const char *Data(const std::string &name, size_t *bytes=0) const;
+    template<class T> bool GetValue(const std::string &name, T &value) const
+    {
+        size_t bytes = 0;
+        const char *data = Data(name, &bytes);
+        if(!data || bytes != sizeof(T)) return false;
+        memcpy(&value, data, sizeof(T));
+        return true;
+    }
+    template<class T> bool GetVector(const std::string &name, std::vector<T> &values) const
+    {
+        size_t bytes = 0;
+        const char *data = Data(name, &bytes);
+        if(!data || bytes % sizeof(T)) return false;
+        values.resize(bytes / sizeof(T));
+        if(bytes) memcpy(&values[0], data, bytes);
+        return true;
+    }
+    std::string GetString(const std::string &name) const;
+    bool GetSamples(const std::string &name, std::vector<fvec> &samples) const;
+    // temporary file holding the buffer, ready to be read, NULL if the entry does not exist.
+    // The caller closes it
+    FILE *OpenFile(const std::string &name) const;
+
+private:
+    struct Entry
+    {
+        std::string name;
+        std::vector<char> data; // entries added to the archive
+        const char *mapped; // entries read from a file
+        size_t bytes;
+    };
+    std::vector<Entry> entries;
+    QFile *file;
+    u8 *map;
+    std::vector<char> contents; // used when the file cannot be mapped
+
+    int Find(const std::string &name) const;
+};
+
+#endif // _MODEL_ARCHIVE_H_
@@ -0,0 +1,191 @@
+/*********************************************************************
+MLDemos: A User-Friendly visualization toolkit for machine learning
+Copyright (C) 2010  Basilio Noris
+Contact: mldemos@b4silio.com
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Library General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free
+Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*********************************************************************/
+#include <math.h>
+#include "objective.h"
+#include "optimization_test_functions.h"
+
+/******************************************/
+/*                                        */
+/*    OBJECTIVE                           */
+/*                                        */
+/******************************************/
+fvec Objective::Gradient(const fvec &sample) const
+{
+    int dim = sample.size();
+    const float delta = 1e-3f;
+    std::vector<fvec> points(dim*2, sample);
+    FOR(d, dim)
+    {
+        points[2*d][d] += delta;
+        points[2*d+1][d] -= delta;
+    }
+    fvec values = Values(points);
+    fvec gradient(dim);
+    FOR(d, dim) gradient[d] = (values[2*d] - values[2*d+1]) / (2*delta);
+    return gradient;
+}
+
+fvec Objective::Values(const std::vector<fvec> &samples) const
+{
+    int count = samples.size();
+    fvec values(count);
+#pragma omp parallel for schedule(dynamic, 8)
+    for(int i=0; i<count; i++) values[i] = Value(samples[i]);
+    return values;
+}
+
+/******************************************/
+/*                                        */
+/*    MAP OBJECTIVE                       */
+/*                                        */
+/******************************************/
+float MapObjective::Value(const fvec &sample) const
+{
+    if(!data || sample.size() < 2) return 0;
+    int xIndex = max(0, min(w-1, (int)(sample[0]*w)));
+    int yIndex = max(0, min(h-1, (int)(sample[1]*h)));
+    return data[yIndex*w + xIndex];
+}
+
+fvec MapObjective::Gradient(const fvec &sample) const
+{
+    fvec gradient(sample.size(), 0.f);
+    if(!data || sample.size() < 2) return gradient;
+    float delta[2] = {1.f/w, 1.f/h};
+    FOR(d, 2)
+    {
+        fvec plus = sample, minus = sample;
+        plus[d] += delta[d];
+        minus[d] -= delta[d];
+        gradient[d] = (Value(plus) - Value(minus)) / (2*delta[d]);
+    }
+    return gradient;
+}
+
+/******************************************/
+/*                                        */
+/*    TEST OBJECTIVE                      */
+/*                                        */
+/******************************************/
+TestObjective::TestObjective(const int type, const int dim)
+    : type(type), dim(max(1, dim)),
+      minSpace(0.f), maxSpace(1.f), minVal(0.f), maxVal(1.f)
+{
+    // the value ranges are those of the 2D benchmarks drawn on the canvas, scaled with the dimension
+    switch(type)
+    {
+    case GRIEWANGK:
+        minSpace = -60.f;
+        maxSpace = 60.f;
+        minVal = 0;
+        maxVal = this->dim;
+        break;
+    case RASTRAGIN:
+        minSpace = -5.12f;
+        maxSpace = 5.12f;
+        minVal = 0;
+        maxVal = 41.f*this->dim;
+        break;
+    case SCHWEFEL:
+        minSpace = -500.f;
+        maxSpace = 500.f;
+        minVal = -419.f*this->dim;
+        maxVal = 419.f*this->dim;
+        break;
+    case ACKLEY:
+        minSpace = -2.f;
+        maxSpace = 2.f;
+        minVal = 0;
+        maxVal = 2.3504;
+        break;
+    case SIXHUMP:
+        this->dim = 2;
+        minSpace = -2;
+        maxSpace = 2;
+        minVal = -1.03159;
+        maxVal = 5.74;
+        break;
+    }
+}
+
+const char *TestObjective::GetTypeName(const int type)
+{
+    switch(type)
+    {
+    case GRIEWANGK: return "Griewangk";
+    case RASTRAGIN: return "Rastragin";
+    case SCHWEFEL: return "Schwefel";
+    case ACKLEY: return "Ackley";
+    case SIXHUMP: return "Six-Hump Camel";
+    }
+    return "";
+}
+
+float TestObjective::Value(const fvec &sample) const
+{
+    Eigen::VectorXd x(dim);
+    FOR(d, dim) x[d] = (d < sample.size() ? sample[d] : 0.5f)*(maxSpace - minSpace) + minSpace;
+    double value = 0;
+    switch(type)
+    {
+    case GRIEWANGK: value = griewangk(x)(0); break;
+    case RASTRAGIN: value = rastragin(x)(0); break;
+    case SCHWEFEL: value = schwefel(x)(0); break;
+    case ACKLEY: value = ackley(x)(0); break;
+    case SIXHUMP: value = sixhump(x)(0); break;
+    }
+    // the test functions are minimized, we turn them into a reward in [0,1]
+    value = (value - minVal)/(maxVal - minVal);
+    return 1.f - max(0.f, min(1.f, (float)value));
+}
+
+fvec TestObjective::Gradient(const fvec &sample) const
+{
+    if(!HasGradient()) return Objective::Gradient(sample);
+    fvec x(dim);
+    FOR(d, dim) x[d] = (d < sample.size() ? sample[d] : 0.5f)*(maxSpace - minSpace) + minSpace;
+    fvec gradient(dim, 0.f);
+    switch(type)
+    {
+    case GRIEWANGK:
+    {
+        // f = sum(x_i^2)/4000 - prod(cos(x_i/sqrt(i+1))) + 1
+        fvec cosines(dim);
+        FOR(d, dim) cosines[d] = cosf(x[d]/sqrtf(d+1.f));
+        FOR(d, dim)
+        {
+            float prod = 1.f;
+            FOR(i, dim) if(i != d) prod *= cosines[i];
+            gradient[d] = x[d]/2000.f + sinf(x[d]/sqrtf(d+1.f))/sqrtf(d+1.f)*prod;
+        }
+    }
+        break;
+    case RASTRAGIN:
+    {
+        // f = 10n + sum(x_i^2 - 10cos(2 pi x_i))
+        FOR(d, dim) gradient[d] = 2*x[d] + 20*M_PI*sinf(2*M_PI*x[d]);
+    }
+        break;
+    }
+    // chain rule through the rescaling of the domain and of the value
+    float scale = -(maxSpace - minSpace)/(maxVal - minVal);
+    FOR(d, dim) gradient[d] *= scale;
+    return gradient;
+}
@@ -0,0 +1,83 @@
+/*********************************************************************
+MLDemos: A User-Friendly visualization toolkit for machine learning
+Copyright (C) 2010  Basilio Noris
+Contact: mldemos@b4silio.com
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public License,
+version 3 as published by the Free Software Foundation.
+
+This library is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free
+Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*********************************************************************/
+#ifndef _OBJECTIVE_H_
+#define _OBJECTIVE_H_
+
+#include <vector>
+#include "types.h"
+
+// function to be maximized by a Maximizer, defined over the unit hypercube [0,1]^dim
+class Objective
+{
+public:
+    virtual ~Objective(){}
+    virtual int GetDim() const = 0;
+    virtual float Value(const fvec &sample) const = 0;
+    // analytic gradient, if available. Otherwise Gradient() uses central differences
+    virtual bool HasGradient() const {return false;}
+    virtual fvec Gradient(const fvec &sample) const;
+    // evaluates a whole population at once, the default implementation spreads it over all cores
+    // Value() must therefore be re-entrant
+    virtual fvec Values(const std::vector<fvec> &samples) const;
+    virtual const char *GetName() const {return "";}
+};
+
+// 2D reward map drawn on the canvas (the data is not owned)
+class MapObjective : public Objective
+{
+    const float *data;
+    int w, h;
+public:
+    MapObjective(const float *data, const int w, const int h) : data(data), w(w), h(h){}
+    int GetDim() const {return 2;}
+    float Value(const fvec &sample) const;
+    // finite differences over one pixel, anything smaller falls inside the same cell
+    fvec Gradient(const fvec &sample) const;
+    const char *GetName() const {return "Reward Map";}
+};
+
+// analytic benchmark functions (see optimization_test_functions.h), rescaled so that
+// the unit hypercube covers their usual domain and their global minimum has value 1
+class TestObjective : public Objective
+{
+public:
+    enum Type
+    {
+        GRIEWANGK = 0,
+        RASTRAGIN,
+        SCHWEFEL,
+        ACKLEY,
+        SIXHUMP,
+        TYPE_COUNT
+    };
+    TestObjective(const int type = GRIEWANGK, const int dim = 2);
+    int GetDim() const {return dim;}
+    float Value(const fvec &sample) const;
+    bool HasGradient() const {return type == GRIEWANGK || type == RASTRAGIN;}
+    fvec Gradient(const fvec &sample) const;
+    const char *GetName() const {return GetTypeName(type);}
+    static const char *GetTypeName(const int type);
+
+private:
+    int type, dim;
+    float minSpace, maxSpace;
+    float minVal, maxVal;
+};
+
+#endif // _OBJECTIVE_H_
@@ -31,7 +31,7 @@ static const double Pi() {return 3.14159265358979323846; }
 // Ackley's Path function
 // f10(x)=-a·exp(-b·sqrt(1/n·sum(x(i)^2)))-exp(1/n·sum(cos(c·x(i))))+a+exp(1)
 // a=20; b=0.2; c=2·pi; i=1:n; -32.768<=x(i)<=32.768.
-Eigen::VectorXd ackley(Eigen::VectorXd& x)
+inline Eigen::VectorXd ackley(Eigen::VectorXd& x)
 {
 	Eigen::VectorXd y(1);
 	double a=20, b=0.2, c=2*Pi();
@@ -51,7 +51,7 @@ Eigen::VectorXd ackley(Eigen::VectorXd& x)
 // Six-Humps function
 // fSixh(x1,x2)=(4-2.1·x1^2+x1^4/3)·x1^2+x1·x2+(-4+4·x2^2)·x2^2
 //   -3<=x1<=3, -2<=x2<=2.
-Eigen::VectorXd sixhump(Eigen::VectorXd& x)
+inline Eigen::VectorXd sixhump(Eigen::VectorXd& x)
 {
 	Eigen::VectorXd y(1);
 	int nvars = x.size();
@@ -65,7 +65,7 @@ Eigen::VectorXd sixhump(Eigen::VectorXd& x)
 
 // 1. Rastragin multi-modal function, uniformly distributed local minima, -5.12<=x(i)<=5.12, global minimum: f(x)=0; x(i)=0, i=1:n.
 // Function checked!
-Eigen::VectorXd rastragin(Eigen::VectorXd& x)
+inline Eigen::VectorXd rastragin(Eigen::VectorXd& x)
 {
 	Eigen::VectorXd y(1);
 
@@ -79,7 +79,7 @@ Eigen::VectorXd rastragin(Eigen::VectorXd& x)
 
 // 2. Schwefel's multi-modal function, deceptive, -500<=x(i)<=500, global minimum: f(x)=-n�418.9829; x(i)=420.9687, i=1:n. 
 // Function checked!
-Eigen::VectorXd schwefel(Eigen::VectorXd& x)
+inline Eigen::VectorXd schwefel(Eigen::VectorXd& x)
 {
 	Eigen::VectorXd y(1);
 
@@ -93,7 +93,7 @@ Eigen::VectorXd schwefel(Eigen::VectorXd& x)
 
 // 3. Griewangk multi-modal function with 163^nvars optima, only one is global
 // Function checked!
-Eigen::VectorXd griewangk(Eigen::VectorXd& x)
+inline Eigen::VectorXd griewangk(Eigen::VectorXd& x)
 {
 	//sleep(1);	//sleep for 10 ms
 	Eigen::VectorXd y(1);
@@ -115,7 +115,7 @@ Eigen::VectorXd griewangk(Eigen::VectorXd& x)
 
 // 4. Griewangk multi-modal function with 163^nvars optima, only one is global, with linear constraint
 // Function checked!
-Eigen::VectorXd griewangk_constrained(Eigen::VectorXd& x)
+inline Eigen::VectorXd griewangk_constrained(Eigen::VectorXd& x)
 {
 	Eigen::VectorXd y(2);
 	double prod;
@@ -144,7 +144,7 @@ Eigen::VectorXd griewangk_constrained(Eigen::VectorXd& x)
 // 5. Easy 1D-1var function with isolated optimum
 // Function checked!
 
-Eigen::VectorXd f_1disolated(Eigen::VectorXd& x)
+inline Eigen::VectorXd f_1disolated(Eigen::VectorXd& x)
 {
 	Eigen::VectorXd y(1);
 	y[0] = 2 - exp(-pow(((x[0]-0.2)/0.004),2)) - 0.8*exp(-pow(((x[0]-0.6)/0.4),2));
@@ -155,7 +155,7 @@ Eigen::VectorXd f_1disolated(Eigen::VectorXd& x)
 // 6. Easy 1D-1var function with isolated optimum
 // Function checked!
 
-Eigen::VectorXd f_1disolated2(Eigen::VectorXd& x)
+inline Eigen::VectorXd f_1disolated2(Eigen::VectorXd& x)
 {
 	Eigen::VectorXd y(1);
 	y[0] = 5 - exp(-pow(((x[0]-0.2)/0.004),2)) - 0.8*exp(-pow(((x[0]-0.6)/0.4),2))- exp(-pow(((x[1]-0.3)/0.003),2)) - 0.8*exp(-pow(((x[1]-0.1)/0.2),2));
@@ -164,7 +164,7 @@ Eigen::VectorXd f_1disolated2(Eigen::VectorXd& x)
 
 
 //BI-OBJECTIVE OPTIMIZATION PROBLEMS
-Eigen::VectorXd t1(Eigen::VectorXd& x)
+inline Eigen::VectorXd t1(Eigen::VectorXd& x)
 //INPUT: x: array with n decision variables (from 2 to inf)
 {
 	//sleep(1);	//sleep for 10 ms
@@ -186,7 +186,7 @@ Eigen::VectorXd t1(Eigen::VectorXd& x)
 	return y;
 }
 
-Eigen::VectorXd t2(Eigen::VectorXd& x)
+inline Eigen::VectorXd t2(Eigen::VectorXd& x)
 //INPUT: x: array with n decision variables (from 2 to inf)
 {
 	Eigen::VectorXd y(2);
@@ -213,7 +213,7 @@ Eigen::VectorXd t2(Eigen::VectorXd& x)
 	return y;
 }
 
-Eigen::VectorXd t3(Eigen::VectorXd& x)
+inline Eigen::VectorXd t3(Eigen::VectorXd& x)
 {
 	Eigen::VectorXd y(2);
 	double g, h, alfa;
@@ -238,7 +238,7 @@ Eigen::VectorXd t3(Eigen::VectorXd& x)
 
 }
 
-Eigen::VectorXd t4(Eigen::VectorXd& x)
+inline Eigen::VectorXd t4(Eigen::VectorXd& x)
 //INPUT: x: array with n decision variables (from 2 to inf)
 {
 	Eigen::VectorXd y(2);
@@ -263,7 +263,7 @@ Eigen::VectorXd t4(Eigen::VectorXd& x)
 
 }
 
-Eigen::VectorXd t5(Eigen::VectorXd& x)
+inline Eigen::VectorXd t5(Eigen::VectorXd& x)
 //INPUT: x: array with n decision variables (from 2 to inf)
 {
 	Eigen::VectorXd y(2);
@@ -295,7 +295,7 @@ Eigen::VectorXd t5(Eigen::VectorXd& x)
 
 }
 
-Eigen::VectorXd t6(Eigen::VectorXd& x)
+inline Eigen::VectorXd t6(Eigen::VectorXd& x)
 //INPUT: x: array with n decision variables (from 2 to inf)
 //		 m: number of decision variables concerning function f1
 
@@ -330,7 +330,7 @@ Eigen::VectorXd t6(Eigen::VectorXd& x)
 
 }
 
-Eigen::VectorXd t7(Eigen::VectorXd& x)
+inline Eigen::VectorXd t7(Eigen::VectorXd& x)
 //INPUT: x: array with 80 bits (0 or 1) --> 11 vars
 //Parameters(fixed): 	n1 bits for x1, n2 bits for x2,...x11
 
@@ -377,7 +377,7 @@ Eigen::VectorXd t7(Eigen::VectorXd& x)
 }
 
 // problem t3 with linear constraint
-Eigen::VectorXd t3c1(Eigen::VectorXd& x)
+inline Eigen::VectorXd t3c1(Eigen::VectorXd& x)
 {
 	Eigen::VectorXd y(3);
 	double g, h, alfa;
@@ -405,7 +405,7 @@ Eigen::VectorXd t3c1(Eigen::VectorXd& x)
 }
 
 //problem t3 with non linear constraint
-Eigen::VectorXd t3c2(Eigen::VectorXd& x)
+inline Eigen::VectorXd t3c2(Eigen::VectorXd& x)
 {
 	Eigen::VectorXd y(3);
 	double g, h, alfa;
@@ -433,7 +433,7 @@ Eigen::VectorXd t3c2(Eigen::VectorXd& x)
 }
 
 //problem t3 with non-linear constraint with disconnected feasible search space
-Eigen::VectorXd t3c3(Eigen::VectorXd& x)
+inline Eigen::VectorXd t3c3(Eigen::VectorXd& x)
 {
 	Eigen::VectorXd y(4);
 	double g, h, alfa;
@@ -475,7 +475,7 @@ Eigen::VectorXd t3c3(Eigen::VectorXd& x)
 }
 
 //Example for BBWORHP. x(1) is Integer and the global Optimum is (0.5, 1) with Objective Value 2.
-Eigen::VectorXd BB_1(Eigen::VectorXd& x)
+inline Eigen::VectorXd BB_1(Eigen::VectorXd& x)
 {
 	Eigen::VectorXd y(3);
 	
@@ -487,7 +487,7 @@ Eigen::VectorXd BB_1(Eigen::VectorXd& x)
 }
 
 //global Optimum (27, x1, 27, 78, x4) with value -32217.4 
-Eigen::VectorXd BB_2(Eigen::VectorXd& x)
+inline Eigen::VectorXd BB_2(Eigen::VectorXd& x)
 {
 	Eigen::VectorXd y(4);
 		double  a1 = 85.334407,
@@ -510,7 +510,7 @@ Eigen::VectorXd BB_2(Eigen::VectorXd& x)
 }
 
 //Global Optimum (0.2, 1.280624, 1.954483, 1, 0, 0, 1) with value 3.557463
-Eigen::VectorXd BB_3(Eigen::VectorXd& x)
+inline Eigen::VectorXd BB_3(Eigen::VectorXd& x)
 {
 	Eigen::VectorXd y(10);
 	
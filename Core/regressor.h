@@ -24,6 +24,8 @@ Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
 
 extern "C" enum {REGR_SVR, REGR_RVM, REGR_GMR, REGR_GPR, REGR_KNN, REGR_MLP, REGR_LINEAR, REGR_LWPR, REGR_KRLS, REGR_NONE} regressorType;
 
+class ModelArchive;
+
 class Regressor
 {
 protected:
@@ -40,6 +42,7 @@ protected:
 	s32 class2labels[255];
 	ivec labels2class;
 	bool bFixedThreshold;
+	bool bBackgroundTraining; // false when Train uses widgets and has to run on the GUI thread
 
 public:
 	std::vector<fvec> crossval;
@@ -48,17 +51,23 @@ public:
 	int type;
     int outputDim;
 
-    Regressor() : posClass(0), bFixedThreshold(true), classThresh(0.5f), classSpan(0.1f), outputDim(-1), type(REGR_NONE){}
+    Regressor() : posClass(0), bFixedThreshold(true), bBackgroundTraining(true), classThresh(0.5f), classSpan(0.1f), outputDim(-1), type(REGR_NONE){}
     std::vector <fvec> GetSamples(){return samples;}
     void SetOutputDim(int outputDim){this->outputDim = outputDim;}
+    bool BackgroundTraining() const {return bBackgroundTraining;}
     virtual ~Regressor(){}
 
     virtual void Train(std::vector< fvec > samples, ivec labels){}
     virtual fvec Test( const fvec &sample){ return fvec(); }
     virtual fVec Test(const fVec &sample){ if (dim==2) return fVec(Test((fvec)sample)); fvec s = (fvec)sample; s.resize(dim,0); return Test(s);}
+    // Test over a whole set of samples, for regressors that are faster on batches
+    virtual std::vector<fvec> TestBatch(const std::vector<fvec> &samples){ std::vector<fvec> res(samples.size()); FOR(i, samples.size()) res[i] = Test(samples[i]); return res;}
     virtual const char *GetInfoString(){return NULL;}
     virtual void SaveModel(std::string filename){}
     virtual bool LoadModel(std::string filename){return false;}
+    // binary model archive, returns false when the model cannot be stored that way
+    virtual bool SaveModel(ModelArchive &archive) {return false;}
+    virtual bool LoadModel(const ModelArchive &archive){return false;}
 };
 
 #endif // _REGRESSOR_H_
@@ -1,5 +1,6 @@
 #include "reinforcementProblem.h"
 #include "drawUtils.h"
+#include <algorithm>
 
 ReinforcementProblem::ReinforcementProblem()
     : dim(2), data(NULL), w(1), h(1),
@@ -76,6 +77,11 @@ void ReinforcementProblem::SetValue(fvec sample, float value)
 }
 
 float ReinforcementProblem::GetSimulationValue(fvec sample)
+{
+    return GetSimulationValue(sample, directions);
+}
+
+float ReinforcementProblem::GetSimulationValue(fvec sample, const fvec &directions) const
 {
     float reward = 0;
     switch(problemType)
@@ -86,12 +92,12 @@ float ReinforcementProblem::GetSimulationValue(fvec sample)
         {
         case 0: // Sum of Rewards
         {
-            reward += GetValue(sample);
+            reward += GetValue(sample, data, w, h);
             FOR(i, simulationSteps)
             {
-                fvec newSample = PerformAction(sample);
+                fvec newSample = NextStep(sample, directions);
                 if(newSample == sample) break;
-                reward += GetValue(newSample);
+                reward += GetValue(newSample, data, w, h);
                 sample = newSample;
             }
         }
@@ -99,11 +105,11 @@ float ReinforcementProblem::GetSimulationValue(fvec sample)
         case 1: // Sum - Harsh Turns (> 90 deg)
         {
             fvec direction(dim);
-            reward += GetValue(sample);
+            reward += GetValue(sample, data, w, h);
             FOR(i, simulationSteps)
             {
-                fvec newSample = PerformAction(sample);
-                float currentReward = GetValue(newSample);
+                fvec newSample = NextStep(sample, directions);
+                float currentReward = GetValue(newSample, data, w, h);
                 fvec newDirection = newSample - sample;
                 if(newSample == sample) break;
                 if(i && direction*newDirection < 0.f) currentReward = 0;
@@ -116,12 +122,12 @@ float ReinforcementProblem::GetSimulationValue(fvec sample)
         case 2: // Average
         {
             fvec direction(dim);
-            reward += GetValue(sample);
+            reward += GetValue(sample, data, w, h);
             int cnt = 0;
             FOR(i, simulationSteps)
             {
-                fvec newSample = PerformAction(sample);
-                float currentReward = GetValue(newSample);
+                fvec newSample = NextStep(sample, directions);
+                float currentReward = GetValue(newSample, data, w, h);
                 if(newSample == sample) break;
                 reward += currentReward;
                 sample = newSample;
@@ -132,29 +138,29 @@ float ReinforcementProblem::GetSimulationValue(fvec sample)
             break;
         case 3: // depleting reward
         {
-            // we backup the data
-            float *dataCopy = new float[w*h];
-            memcpy(dataCopy, data, w*h*sizeof(float));
+            // instead of copying the whole map we keep track of the depleted cells
+            ivec depleted;
+            depleted.reserve(simulationSteps+1);
 
             int xIndex = max(0, min(w-1, (int)(sample[0]*w)));
             int yIndex = max(0, min(h-1, (int)(sample[1]*h)));
             int index = yIndex*w + xIndex;
             reward += data[index];
-            data[index] = 0;
+            depleted.push_back(index);
             FOR(i, simulationSteps)
             {
-                fvec newSample = PerformAction(sample);
+                fvec newSample = NextStep(sample, directions);
                 if(newSample == sample)break;
                 xIndex = max(0, min(w-1, (int)(newSample[0]*w)));
                 yIndex = max(0, min(h-1, (int)(newSample[1]*h)));
                 index = yIndex*w + xIndex;
-                reward += data[index];
-                data[index] = 0;
+                if(std::find(depleted.begin(), depleted.end(), index) == depleted.end())
+                {
+                    reward += data[index];
+                    depleted.push_back(index);
+                }
                 sample = newSample;
             }
-            // we swap the backup
-            delete [] data;
-            data = dataCopy;
         }
             break;
         }
@@ -165,7 +171,7 @@ float ReinforcementProblem::GetSimulationValue(fvec sample)
     return reward;
 }
 
-inline fvec ReinforcementProblem::GetDeltaAt(int x, int y, fvec &directions)
+inline fvec ReinforcementProblem::GetDeltaAt(int x, int y, const fvec &directions) const
 {
     fvec delta(2, 0.f);
     int index = y*gridSize + x;
@@ -214,7 +220,7 @@ inline fvec ReinforcementProblem::GetDeltaAt(int x, int y, fvec &directions)
     return delta;
 }
 
-fvec ReinforcementProblem::NextStep(fvec sample, fvec directions)
+fvec ReinforcementProblem::NextStep(fvec sample, const fvec &directions) const
 {
     int index = 0;
     int mult = 0;
@@ -296,26 +302,49 @@ float ReinforcementProblem::GetReward()
     return GetReward(directions);
 }
 
-float ReinforcementProblem::GetReward(fvec directions)
+float ReinforcementProblem::GetReward(const fvec &directions)
 {
-    fvec backup = this->directions;
-    this->directions = directions;
-    fvec sample(dim);
-    float fullReward = 0;
-    stateValues = fvec(gridSize*gridSize,0);
-    FOR(i, gridSize*gridSize)
+    int stateCount = gridSize*gridSize;
+    stateValues = fvec(stateCount,0);
+#pragma omp parallel for
+    for(int i=0; i<stateCount; i++)
     {
+        fvec sample(dim);
         sample[0] = (i%gridSize + 0.5f)/(float)gridSize;
         sample[1] = (i/gridSize + 0.5f)/(float)gridSize;
-        float value = GetSimulationValue(sample);
-        stateValues[i] = value;
-        fullReward += value;
+        stateValues[i] = GetSimulationValue(sample, directions);
     }
-    fullReward /= (gridSize*gridSize);
-    this->directions = backup;
+    float fullReward = 0;
+    FOR(i, stateCount) fullReward += stateValues[i];
+    fullReward /= stateCount;
     return fullReward;
 }
 
+fvec ReinforcementProblem::GetRewards(const std::vector<fvec> &policies) const
+{
+    int stateCount = gridSize*gridSize;
+    int rolloutCount = policies.size()*stateCount;
+    // we flatten all (policy, starting state) pairs so that small populations still fill every core
+    fvec values(rolloutCount, 0);
+#pragma omp parallel for schedule(dynamic, 16)
+    for(int r=0; r<rolloutCount; r++)
+    {
+        int i = r % stateCount;
+        fvec sample(dim);
+        sample[0] = (i%gridSize + 0.5f)/(float)gridSize;
+        sample[1] = (i/gridSize + 0.5f)/(float)gridSize;
+        values[r] = GetSimulationValue(sample, policies[r / stateCount]);
+    }
+    // the sums are done serially so that results do not depend on the number of threads
+    fvec rewards(policies.size(), 0);
+    FOR(p, policies.size())
+    {
+        FOR(i, stateCount) rewards[p] += values[p*stateCount + i];
+        rewards[p] /= stateCount;
+    }
+    return rewards;
+}
+
 void ReinforcementProblem::Draw(QPainter &painter)
 {
     int w = painter.viewport().width(), h = painter.viewport().height();
@@ -32,13 +32,17 @@ public:
     float GetValue(fvec sample);
     void SetValue(fvec sample, float value);
     float GetSimulationValue(fvec sample);
+    // re-entrant rollout from the starting sample, the problem itself is never modified
+    float GetSimulationValue(fvec sample, const fvec &directions) const;
 
     // use the policy to decide which action to take, and perform the action
-    inline fvec GetDeltaAt(int x, int y, fvec &directions);
-    fvec NextStep(fvec sample, fvec directions);
+    inline fvec GetDeltaAt(int x, int y, const fvec &directions) const;
+    fvec NextStep(fvec sample, const fvec &directions) const;
     fvec PerformAction(fvec sample);
     float GetReward();
-    float GetReward(fvec directions);
+    float GetReward(const fvec &directions);
+    // evaluates a whole population of policies, rollouts are run concurrently
+    fvec GetRewards(const std::vector<fvec> &policies) const;
     void Draw(QPainter &painter);
     void Initialize(float *dataMap, fVec size, fvec startingPoint=fvec());
 };
@@ -0,0 +1,177 @@
+/*********************************************************************
+MLDemos: A User-Friendly visualization toolkit for machine learning
+Copyright (C) 2010  Basilio Noris
+Contact: mldemos@b4silio.com
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public License,
+version 3 as published by the Free Software Foundation.
+
+This library is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free
+Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*********************************************************************/
+#include <math.h>
+#include <float.h>
+#include <limits.h>
+#include <stdlib.h>
+#include "spatialHash.h"
+
+using namespace std;
+
+SpatialHash::SpatialHash(const float cellSize)
+    : cellSize(cellSize > 0 ? cellSize : 16.f)
+{
+    Clear();
+}
+
+void SpatialHash::Clear()
+{
+    xs.clear();
+    ys.clear();
+    cells.clear();
+    minCellX = minCellY = INT_MAX;
+    maxCellX = maxCellY = INT_MIN;
+}
+
+void SpatialHash::SetCellSize(const float cellSize)
+{
+    if(cellSize <= 0 || this->cellSize == cellSize) return;
+    this->cellSize = cellSize;
+    fvec oldX = xs, oldY = ys;
+    Clear();
+    FOR(i, oldX.size()) Insert(i, oldX[i], oldY[i]);
+}
+
+void SpatialHash::Insert(const int index, const float x, const float y)
+{
+    if(index != xs.size()) return;
+    xs.push_back(x);
+    ys.push_back(y);
+    int cx = cellOf(x), cy = cellOf(y);
+    cells[key(cx, cy)].push_back(index);
+    minCellX = min(minCellX, cx);
+    minCellY = min(minCellY, cy);
+    maxCellX = max(maxCellX, cx);
+    maxCellY = max(maxCellY, cy);
+}
+
+ivec SpatialHash::Query(const float x, const float y, const float radius, fvec *distances) const
+{
+    ivec selection;
+    if(distances) distances->clear();
+    if(xs.empty() || radius <= 0) return selection;
+    int cx0 = max(cellOf(x-radius), minCellX), cx1 = min(cellOf(x+radius), maxCellX);
+    int cy0 = max(cellOf(y-radius), minCellY), cy1 = min(cellOf(y+radius), maxCellY);
+    float radius2 = radius*radius;
+    std::vector< std::pair<int,float> > found;
+    for(int cx=cx0; cx<=cx1; cx++)
+    {
+        for(int cy=cy0; cy<=cy1; cy++)
+        {
+            CellMap::const_iterator it = cells.find(key(cx,cy));
+            if(it == cells.end()) continue;
+            const ivec &cell = it->second;
+            FOR(i, cell.size())
+            {
+                float dx = xs[cell[i]] - x, dy = ys[cell[i]] - y;
+                float dist = dx*dx + dy*dy;
+                if(dist < radius2) found.push_back(std::make_pair(cell[i], sqrtf(dist)));
+            }
+        }
+    }
+    // we keep the same ordering as a linear scan over the samples
+    sort(found.begin(), found.end());
+    selection.resize(found.size());
+    if(distances) distances->resize(found.size());
+    FOR(i, found.size())
+    {
+        selection[i] = found[i].first;
+        if(distances) (*distances)[i] = found[i].second;
+    }
+    return selection;
+}
+
+ivec SpatialHash::QueryRect(const float x0, const float y0, const float x1, const float y1) const
+{
+    ivec selection;
+    if(xs.empty()) return selection;
+    int cx0 = max(cellOf(min(x0,x1)), minCellX), cx1 = min(cellOf(max(x0,x1)), maxCellX);
+    int cy0 = max(cellOf(min(y0,y1)), minCellY), cy1 = min(cellOf(max(y0,y1)), maxCellY);
+    for(int cx=cx0; cx<=cx1; cx++)
+    {
+        for(int cy=cy0; cy<=cy1; cy++)
+        {
+            CellMap::const_iterator it = cells.find(key(cx,cy));
+            if(it == cells.end()) continue;
+            const ivec &cell = it->second;
+            FOR(i, cell.size())
+            {
+                float px = xs[cell[i]], py = ys[cell[i]];
+                if(px < min(x0,x1) || px > max(x0,x1) || py < min(y0,y1) || py > max(y0,y1)) continue;
+                selection.push_back(cell[i]);
+            }
+        }
+    }
+    sort(selection.begin(), selection.end());
+    return selection;
+}
+
+int SpatialHash::Nearest(const float x, const float y) const
+{
+    if(xs.empty()) return -1;
+    int cx = cellOf(x), cy = cellOf(y);
+    // number of rings needed to cover every occupied cell from the query cell
+    int maxRing = max(max(abs(cx-minCellX), abs(cx-maxCellX)), max(abs(cy-minCellY), abs(cy-maxCellY)));
+    int closest = -1;
+    float minDist = FLT_MAX;
+    // if the grid is sparse compared to the area we would have to search, a linear scan is cheaper
+    if((double)(2*maxRing+1)*(2*maxRing+1) > 4.0*cells.size() + 64)
+    {
+        // we still search the neighbourhood first, most queries are close to a sample
+        maxRing = min(maxRing, 2);
+    }
+    for(int r=0; r<=maxRing; r++)
+    {
+        for(int i=cx-r; i<=cx+r; i++)
+        {
+            for(int j=cy-r; j<=cy+r; j++)
+            {
+                if(i != cx-r && i != cx+r && j != cy-r && j != cy+r) continue; // only the ring itself
+                CellMap::const_iterator it = cells.find(key(i,j));
+                if(it == cells.end()) continue;
+                const ivec &cell = it->second;
+                FOR(k, cell.size())
+                {
+                    float dx = xs[cell[k]] - x, dy = ys[cell[k]] - y;
+                    float dist = dx*dx + dy*dy;
+                    if(dist < minDist || (dist == minDist && cell[k] < closest))
+                    {
+                        minDist = dist;
+                        closest = cell[k];
+                    }
+                }
+            }
+        }
+        // anything outside ring r is at least r*cellSize away
+        if(closest != -1 && sqrtf(minDist) <= r*cellSize) return closest;
+    }
+    if(closest != -1 && sqrtf(minDist) <= maxRing*cellSize) return closest;
+    // fallback: linear scan
+    FOR(i, xs.size())
+    {
+        float dx = xs[i] - x, dy = ys[i] - y;
+        float dist = dx*dx + dy*dy;
+        if(dist < minDist)
+        {
+            minDist = dist;
+            closest = i;
+        }
+    }
+    return closest;
+}
@@ -0,0 +1,65 @@
+/*********************************************************************
+MLDemos: A User-Friendly visualization toolkit for machine learning
+Copyright (C) 2010  Basilio Noris
+Contact: mldemos@b4silio.com
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public License,
+version 3 as published by the Free Software Foundation.
+
+This library is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free
+Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*********************************************************************/
+#ifndef _SPATIAL_HASH_H_
+#define _SPATIAL_HASH_H_
+
+#include <vector>
+#include <unordered_map>
+#include <math.h>
+#include "types.h"
+
+// uniform grid over 2d (screen space) points, used by the canvas
+// to pick, erase and cull samples without going through the whole dataset
+class SpatialHash
+{
+public:
+    SpatialHash(const float cellSize = 16.f);
+
+    void Clear();
+    void SetCellSize(const float cellSize);
+    float GetCellSize() const {return cellSize;}
+
+    // points are identified by their index, which must be inserted in increasing order
+    void Insert(const int index, const float x, const float y);
+    int GetCount() const {return xs.size();}
+    bool Empty() const {return xs.empty();}
+    float X(const int index) const {return xs[index];}
+    float Y(const int index) const {return ys[index];}
+
+    // returns the (sorted) indices of all points closer than radius, and optionally their distances
+    ivec Query(const float x, const float y, const float radius, fvec *distances=0) const;
+    // returns the (sorted) indices of all points inside the rectangle [x0,x1]x[y0,y1]
+    ivec QueryRect(const float x0, const float y0, const float x1, const float y1) const;
+    // returns the index of the closest point, or -1 if the hash is empty
+    int Nearest(const float x, const float y) const;
+
+private:
+    typedef long long CellKey;
+    typedef std::unordered_map<CellKey, ivec> CellMap;
+
+    inline int cellOf(const float v) const {float c = floorf(v / cellSize); return c != c ? 0 : (int)max(-1e9f, min(1e9f, c));}
+    inline static CellKey key(const int cx, const int cy) {return ((CellKey)cx << 32) ^ (CellKey)(unsigned int)cy;}
+
+    float cellSize;
+    fvec xs, ys;
+    CellMap cells;
+    int minCellX, minCellY, maxCellX, maxCellY;
+};
+
+#endif // _SPATIAL_HASH_H_
@@ -0,0 +1,71 @@
+/*********************************************************************
+MLDemos: A User-Friendly visualization toolkit for machine learning
+Copyright (C) 2010  Basilio Noris
+Contact: mldemos@b4silio.com
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public License,
+version 3 as published by the Free Software Foundation.
+
+This library is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free
+Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*********************************************************************/
+#ifndef _TRAINING_CONTROL_H_
+#define _TRAINING_CONTROL_H_
+
+#include <QAtomicInt>
+#include <QThread>
+#include <QVariant>
+
+#define TRAINING_CONTROL_PROPERTY "trainingControl"
+
+// cancellation token and progress of a training running in the background.
+// The control is attached to the thread doing the training, so that plugins can report
+// through the static functions without knowing who runs them: outside of a background
+// training Cancelled() is always false and Progress() does nothing.
+// Everything is inline, the Core library is linked statically into each plugin
+class TrainingControl
+{
+public:
+    TrainingControl() : cancelled(0), progress(-1) {}
+
+    void Cancel(){cancelled.storeRelease(1);}
+    bool IsCancelled() const {return cancelled.loadAcquire() != 0;}
+    // in thousandths, -1 until the algorithm reports anything
+    int GetProgress() const {return progress.loadAcquire();}
+    void SetProgress(float ratio){progress.storeRelease(ratio <= 0 ? 0 : (ratio >= 1 ? 1000 : int(ratio*1000)));}
+
+    void Attach(QThread *thread){thread->setProperty(TRAINING_CONTROL_PROPERTY, QVariant::fromValue((void*)this));}
+
+    // control of the training running in the calling thread, if any.
+    // Not to be called from inside openmp parallel regions
+    static TrainingControl *Current()
+    {
+        QThread *thread = QThread::currentThread();
+        if(!thread) return 0;
+        QVariant value = thread->property(TRAINING_CONTROL_PROPERTY);
+        return value.isValid() ? (TrainingControl*)value.value<void*>() : 0;
+    }
+    static bool Cancelled()
+    {
+        TrainingControl *control = Current();
+        return control && control->IsCancelled();
+    }
+    static void Progress(float ratio)
+    {
+        TrainingControl *control = Current();
+        if(control) control->SetProgress(ratio);
+    }
+
+private:
+    QAtomicInt cancelled;
+    QAtomicInt progress;
+};
+
+#endif // _TRAINING_CONTROL_H_
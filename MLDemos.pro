@@ -57,11 +57,12 @@ Example.file = $$ALGOPATH/Example/pluginExample.pro
 
 # input plugins
 INPUTPATH = _IOPlugins
-SUBDIRS += PCAFaces
+SUBDIRS += PCAFaces MatImport
 #SUBDIRS += ImportTimeseries
 PCAFaces.file = $$INPUTPATH/PCAFaces/pluginPCAFaces.pro
 RandomEmitter.file = $$INPUTPATH/RandomEmitter/pluginRandomEmitter.pro
 WebImport.file = $$INPUTPATH/WebImport/pluginWebImport.pro
 CSVImport.file = $$INPUTPATH/CSVImport/pluginCSVImport.pro
+MatImport.file = $$INPUTPATH/MatImport/pluginMatImport.pro
 ImportTimeseries.file = $$INPUTPATH/ImportTimeseries/pluginImportTimeseries.pro
 
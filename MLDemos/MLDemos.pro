@@ -79,7 +79,8 @@ HEADERS += basicMath.h \
     algorithmmanager.h \
     pluginmanager.h \
     pluginSelectionLists.h \
-    basewidget.h
+    basewidget.h \
+    trainingworker.h
 
 SOURCES += \
 	main.cpp \
@@ -94,6 +95,7 @@ SOURCES += \
     algorithmmanager.cpp \
     pluginmanager.cpp \
     basewidget.cpp \
+    trainingworker.cpp \
     mldemos-data.cpp \
     mldemos-manualselection.cpp \
     mldemos-draw.cpp \
@@ -24,26 +24,19 @@ using namespace std;
 
 void AlgorithmManager::Classify()
 {
-    if(!canvas || !canvas->data->GetCount()) return;
-    drawTimer->Stop();
-    drawTimer->Clear();
-    mutex->lock();
-    DEL(clusterer);
-    DEL(regressor);
-    DEL(dynamical);
-    if(!classifierMulti.size()) DEL(classifier);
-    classifier = 0;
-    sourceDims.clear();
-    FOR(i,classifierMulti.size()) DEL(classifierMulti[i]); classifierMulti.clear();
-    DEL(maximizer);
-    DEL(reinforcement);
-    DEL(projector);
-    lastTrainingInfo = "";
+    if(!canvas || !canvas->data->GetCount() || IsTraining()) return;
     if(!optionsClassify->algoList->count()) return;
     int tab = optionsClassify->algoList->currentIndex();
     if(tab >= classifiers.size() || !classifiers[tab]) return;
+    drawTimer->Stop();
+    mutex->lock();
+    DetachModels();
+    mutex->unlock();
+    lastTrainingInfo = "";
+    sourceDims.clear();
 
-    classifier = classifiers[tab]->GetClassifier();
+    // the new model stays out of the members until it is trained, the canvas keeps drawing the previous ones
+    Classifier *classifier = classifiers[tab]->GetClassifier();
     tabUsedForTraining = tab;
     float ratios [] = {.1f,.25f,1.f/3.f,.5f,2.f/3.f,.75f,.9f,1.f};
     int ratioIndex = optionsClassify->traintestRatioCombo->currentIndex();
@@ -56,7 +49,24 @@ void AlgorithmManager::Classify()
     }
 
     int positiveIndex = optionsClassify->binaryCheck->isChecked() ? optionsClassify->positiveSpin->value() : -1;
+    bTrainInBackground = true;
     bool trained = Train(classifier, trainRatio, trainList, positiveIndex);
+    bTrainInBackground = false;
+    if(bTrainingAborted)
+    {
+        bTrainingAborted = false;
+        DEL(classifier);
+        mutex->lock();
+        RestoreModels();
+        mutex->unlock();
+        emit UpdateInfo();
+        return;
+    }
+
+    mutex->lock();
+    DeletePreviousModels();
+    drawTimer->Clear();
+    this->classifier = classifier;
     if(trained)
     {
         classifiers[tab]->Draw(canvas, classifier);
@@ -288,7 +298,11 @@ bool AlgorithmManager::Train(Classifier *classifier, float trainRatio, bvec trai
     // do the actual training
     if(classifier->IsMultiClass() || !bMulticlass)
     {
-        classifier->Train(trainSamples, trainLabels);
+        if(!RunTraining([&]{classifier->Train(trainSamples, trainLabels);}))
+        {
+            KILL(perm);
+            return false;
+        }
         // fix the labels for binary classification
         if(classCount == 2)
         {
@@ -311,19 +325,29 @@ bool AlgorithmManager::Train(Classifier *classifier, float trainRatio, bvec trai
     {
         qDebug() << "we're going one-vs-all multiclass! (" << classCount << ")";
         // if we are going multiclass on a single-class classifier, we need to train N one-vs-all models
-        FOR(c, classCount)
-        {
-            int realClass = binaryInverseMap[c];
-            ivec trainLabelsBinary(trainLabels.size());
-            FOR(i, trainLabels.size())
+        vector<Classifier *> models(1, classifier);
+        for(int c=1; c<classCount; c++) models.push_back(classifiers[tabUsedForTraining]->GetClassifier());
+        bool bTrained = RunTraining([&]{
+            FOR(c, classCount)
             {
-                if(trainLabels[i] == realClass) trainLabelsBinary[i] = +1;
-                else trainLabelsBinary[i] = -1;
+                if(TrainingControl::Cancelled()) break;
+                int realClass = binaryInverseMap[c];
+                ivec trainLabelsBinary(trainLabels.size());
+                FOR(i, trainLabels.size())
+                {
+                    if(trainLabels[i] == realClass) trainLabelsBinary[i] = +1;
+                    else trainLabelsBinary[i] = -1;
+                }
+                models[c]->Train(trainSamples, trainLabelsBinary);
             }
-            if(c==0) classifierMulti.push_back(classifier);
-            else classifierMulti.push_back(classifiers[tabUsedForTraining]->GetClassifier());
-            classifierMulti.back()->Train(trainSamples, trainLabelsBinary);
+        });
+        if(!bTrained)
+        {
+            for(int c=1; c<classCount; c++) delete models[c];
+            KILL(perm);
+            return false;
         }
+        classifierMulti = models;
         classifier->classMap = binaryClassMap;
         classifier->inverseMap = binaryInverseMap;
     }
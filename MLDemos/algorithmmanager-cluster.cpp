@@ -85,26 +85,18 @@ float AlgorithmManager::ClusterFMeasure(std::vector<fvec> samples, ivec labels,
 
 void AlgorithmManager::Cluster()
 {
-    if(!canvas || !canvas->data->GetCount()) return;
-    drawTimer->Stop();
-    drawTimer->Clear();
-
-    QMutexLocker lock(mutex);
-    DEL(clusterer);
-    DEL(regressor);
-    DEL(dynamical);
-    if(!classifierMulti.size()) DEL(classifier);
-    classifier = 0;
-    sourceDims.clear();
-    FOR(i,classifierMulti.size()) DEL(classifierMulti[i]); classifierMulti.clear();
-    DEL(maximizer);
-    DEL(reinforcement);
-    DEL(projector);
-    lastTrainingInfo = "";
+    if(!canvas || !canvas->data->GetCount() || IsTraining()) return;
     if(!optionsCluster->algoList->count()) return;
     int tab = optionsCluster->algoList->currentIndex();
     if(tab >= clusterers.size() || !clusterers[tab]) return;
-    clusterer = clusterers[tab]->GetClusterer();
+    drawTimer->Stop();
+    mutex->lock();
+    DetachModels();
+    mutex->unlock();
+    lastTrainingInfo = "";
+    sourceDims.clear();
+    // the new model stays out of the members until it is trained, the canvas keeps drawing the previous ones
+    Clusterer *clusterer = clusterers[tab]->GetClusterer();
     tabUsedForTraining = tab;
     vector<bool> trainList;
     float ratios [] = {.1f,.25f,1.f/3.f,.5f,2.f/3.f,.75f,.9f,1.f};
@@ -117,7 +109,24 @@ void AlgorithmManager::Cluster()
     }
 
     float testError;
+    bTrainInBackground = true;
     Train(clusterer, trainRatio, trainList, &testError);
+    bTrainInBackground = false;
+    if(bTrainingAborted)
+    {
+        bTrainingAborted = false;
+        DEL(clusterer);
+        mutex->lock();
+        RestoreModels();
+        mutex->unlock();
+        emit UpdateInfo();
+        return;
+    }
+
+    QMutexLocker lock(mutex);
+    DeletePreviousModels();
+    drawTimer->Clear();
+    this->clusterer = clusterer;
 
     // we compute the stats on the clusters (f-measure, bic etc)
     ivec inputDims = GetInputDimensions();
@@ -211,7 +220,7 @@ void AlgorithmManager::Cluster()
 
 void AlgorithmManager::ClusterTest()
 {
-    if(!canvas || !canvas->data->GetCount()) return;
+    if(!canvas || !canvas->data->GetCount() || IsTraining()) return;
     drawTimer->Stop();
     drawTimer->Clear();
     QMutexLocker lock(mutex);
@@ -321,7 +330,7 @@ void AlgorithmManager::ClusterTest()
 
 void AlgorithmManager::ClusterOptimize()
 {
-    if(!canvas || !canvas->data->GetCount()) return;
+    if(!canvas || !canvas->data->GetCount() || IsTraining()) return;
     QMutexLocker lock(mutex);
     if(!optionsCluster->algoList->count()) return;
     int tab = optionsCluster->algoList->currentIndex();
@@ -497,7 +506,7 @@ void AlgorithmManager::ClusterOptimize()
 
 void AlgorithmManager::ClusterIterate()
 {
-    if(!canvas || !canvas->data->GetCount()) return;
+    if(!canvas || !canvas->data->GetCount() || IsTraining()) return;
     drawTimer->Stop();
     int tab = optionsCluster->algoList->currentIndex();
     if(tab >= clusterers.size() || !clusterers[tab]) return;
@@ -570,7 +579,7 @@ void AlgorithmManager::Train(Clusterer *clusterer, float trainRatio, bvec trainL
                 trainSamples.push_back(samples[i]);
             }
         }
-        clusterer->Train(trainSamples);
+        if(!RunTraining([&]{clusterer->Train(trainSamples);})) return;
     }
     else if(trainRatio < 1)
     {
@@ -581,10 +590,11 @@ void AlgorithmManager::Train(Clusterer *clusterer, float trainRatio, bvec trainL
         {
             trainSamples[i] = samples[perm[i]];
         }
-        clusterer->Train(trainSamples);
+        bool bTrained = RunTraining([&]{clusterer->Train(trainSamples);});
         delete [] perm;
+        if(!bTrained) return;
     }
-    else clusterer->Train(samples);
+    else if(!RunTraining([&]{clusterer->Train(samples);})) return;
     // we test the clusters to see how well they classify the samples
 
     if(!testFMeasures) return;
@@ -23,7 +23,7 @@ Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
 using namespace std;
 void AlgorithmManager::Compare()
 {
-    if(!canvas) return;
+    if(!canvas || IsTraining()) return;
     if(!compare->compareOptions.size()) return;
 
     QMutexLocker lock(mutex);
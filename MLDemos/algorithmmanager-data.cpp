@@ -24,6 +24,9 @@ using namespace std;
 
 void AlgorithmManager::Clear()
 {
+    // a training under way is dropped along with the models it would have replaced
+    CancelTraining();
+    DeletePreviousModels();
     if (!classifierMulti.size()) DEL(classifier);
     classifier = 0;
     FOR (i,classifierMulti.size()) DEL(classifierMulti[i]); classifierMulti.clear();
@@ -38,6 +41,69 @@ void AlgorithmManager::Clear()
     sourceDims.clear();
 }
 
+void AlgorithmManager::DetachModels()
+{
+    DeletePreviousModels();
+    previousModels.classifier = classifier;
+    previousModels.regressor = regressor;
+    previousModels.dynamical = dynamical;
+    previousModels.clusterer = clusterer;
+    previousModels.maximizer = maximizer;
+    previousModels.reinforcement = reinforcement;
+    previousModels.projector = projector;
+    previousModels.classifierMulti = classifierMulti;
+    previousModels.sourceDims = sourceDims;
+    previousModels.canvasSourceDims = canvas->sourceDims;
+    previousModels.tabUsedForTraining = tabUsedForTraining;
+    previousModels.lastTrainingInfo = lastTrainingInfo;
+    classifier = 0;
+    regressor = 0;
+    dynamical = 0;
+    clusterer = 0;
+    maximizer = 0;
+    reinforcement = 0;
+    projector = 0;
+    classifierMulti.clear();
+}
+
+void AlgorithmManager::RestoreModels()
+{
+    if (!classifierMulti.size()) DEL(classifier);
+    FOR (i,classifierMulti.size()) DEL(classifierMulti[i]);
+    DEL(regressor);
+    DEL(dynamical);
+    DEL(clusterer);
+    DEL(maximizer);
+    DEL(reinforcement);
+    DEL(projector);
+    classifier = previousModels.classifier;
+    regressor = previousModels.regressor;
+    dynamical = previousModels.dynamical;
+    clusterer = previousModels.clusterer;
+    maximizer = previousModels.maximizer;
+    reinforcement = previousModels.reinforcement;
+    projector = previousModels.projector;
+    classifierMulti = previousModels.classifierMulti;
+    sourceDims = previousModels.sourceDims;
+    canvas->sourceDims = previousModels.canvasSourceDims;
+    tabUsedForTraining = previousModels.tabUsedForTraining;
+    lastTrainingInfo = previousModels.lastTrainingInfo;
+    previousModels = TrainedModels();
+}
+
+void AlgorithmManager::DeletePreviousModels()
+{
+    if (!previousModels.classifierMulti.size()) DEL(previousModels.classifier);
+    FOR (i,previousModels.classifierMulti.size()) DEL(previousModels.classifierMulti[i]);
+    DEL(previousModels.regressor);
+    DEL(previousModels.dynamical);
+    DEL(previousModels.clusterer);
+    DEL(previousModels.maximizer);
+    DEL(previousModels.reinforcement);
+    DEL(previousModels.projector);
+    previousModels = TrainedModels();
+}
+
 void AlgorithmManager::ClearData()
 {
     sourceData.clear();
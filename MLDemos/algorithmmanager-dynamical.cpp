@@ -23,28 +23,38 @@ using namespace std;
 
 void AlgorithmManager::Dynamize()
 {
-    if(!canvas || !canvas->data->GetCount() || !canvas->data->GetSequences().size()) return;
-    drawTimer->Stop();
-    drawTimer->Clear();
-    QMutexLocker lock(mutex);
-    DEL(clusterer);
-    DEL(regressor);
-    DEL(dynamical);
-    if(!classifierMulti.size()) DEL(classifier);
-    classifier = 0;
-    sourceDims.clear();
-    FOR(i,classifierMulti.size()) DEL(classifierMulti[i]); classifierMulti.clear();
-    DEL(maximizer);
-    DEL(reinforcement);
-    DEL(projector);
-    lastTrainingInfo = "";
+    if(!canvas || !canvas->data->GetCount() || !canvas->data->GetSequences().size() || IsTraining()) return;
     if(!optionsDynamic->algoList->count()) return;
     int tab = optionsDynamic->algoList->currentIndex();
     if(tab >= dynamicals.size() || !dynamicals[tab]) return;
-    dynamical = dynamicals[tab]->GetDynamical();
+    drawTimer->Stop();
+    mutex->lock();
+    DetachModels();
+    mutex->unlock();
+    lastTrainingInfo = "";
+    sourceDims.clear();
+    // the new model stays out of the members until it is trained, the canvas keeps drawing the previous ones
+    Dynamical *dynamical = dynamicals[tab]->GetDynamical();
     tabUsedForTraining = tab;
 
+    bTrainInBackground = dynamical->BackgroundTraining();
     Train(dynamical);
+    bTrainInBackground = false;
+    if(bTrainingAborted)
+    {
+        bTrainingAborted = false;
+        DEL(dynamical);
+        mutex->lock();
+        RestoreModels();
+        mutex->unlock();
+        emit UpdateInfo();
+        return;
+    }
+
+    QMutexLocker lock(mutex);
+    DeletePreviousModels();
+    drawTimer->Clear();
+    this->dynamical = dynamical;
     dynamicals[tab]->Draw(canvas,dynamical);
     glw->clearLists();
     if(canvas->canvasType == 1)
@@ -142,7 +152,7 @@ void AlgorithmManager::Dynamize()
 
 void AlgorithmManager::Avoidance()
 {
-    if(!canvas || !dynamical) return;
+    if(!canvas || !dynamical || IsTraining()) return;
     if(!optionsDynamic->obstacleCombo->count()) return;
     drawTimer->Stop();
     QMutexLocker lock(mutex);
@@ -182,7 +192,7 @@ fvec AlgorithmManager::Train(Dynamical *dynamical)
     vector< vector<fvec> > trajectories = canvas->data->GetTrajectories(resampleType, count, centerType, dT, zeroEnding);
     interpolate(trajectories[0],count);
 
-    dynamical->Train(trajectories, trajLabels);
+    if(!RunTraining([&]{dynamical->Train(trajectories, trajLabels);})) return fvec();
     return Test(dynamical, trajectories, trajLabels);
 }
 
@@ -19,17 +19,66 @@ Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
 *********************************************************************/
 #include "algorithmmanager.h"
 #include "mldemos.h"
+#include "modelArchive.h"
 
 using namespace std;
 
+// models are stored in a binary archive along with the name and parameters of their plugin,
+// models that cannot be archived fall back to the text format of their plugin
+template<class Interface>
+static void ArchivePlugin(ModelArchive &archive, Interface *plugin, const char *algorithm)
+{
+    QString params;
+    QTextStream stream(&params);
+    plugin->SaveParams(stream);
+    stream.flush();
+    archive.AddString(".algorithm", algorithm);
+    archive.SetPlugin(plugin->GetName().toStdString());
+    archive.SetParams(params.toStdString());
+}
+
+// returns the tab of the plugin that saved the archive, with its parameters restored
+template<class Interface>
+static int ArchiveTab(const ModelArchive &archive, const QList<Interface *> &plugins, const char *algorithm)
+{
+    if(archive.GetString(".algorithm") != algorithm) return -1;
+    QString name = QString::fromStdString(archive.Plugin());
+    FOR(i, plugins.size())
+    {
+        if(!plugins[i] || plugins[i]->GetName() != name) continue;
+        QString params = QString::fromStdString(archive.Params());
+        QTextStream stream(&params);
+        QString paramName;
+        float paramValue;
+        while(!stream.atEnd())
+        {
+            stream >> paramName >> paramValue;
+            if(!paramName.isEmpty()) plugins[i]->LoadParams(paramName, paramValue);
+        }
+        return i;
+    }
+    qDebug() << "no plugin named" << name << "to load the model";
+    return -1;
+}
+
 void AlgorithmManager::LoadClassifier()
 {
+    if(IsTraining()) return;
     QString filename = QFileDialog::getOpenFileName(mldemos, tr("Load Model"), "", tr("Model (*.model)"));
     if(filename.isEmpty()) return;
     int tab = optionsClassify->algoList->currentIndex();
+    ModelArchive archive;
+    bool bArchive = ModelArchive::IsArchive(filename.toStdString());
+    if(bArchive)
+    {
+        if(!archive.Load(filename.toStdString())) return;
+        tab = ArchiveTab(archive, classifiers, "classifier");
+        if(tab < 0) return;
+        optionsClassify->algoList->setCurrentIndex(tab);
+    }
     if(tab >= classifiers.size() || !classifiers[tab]) return;
     Classifier *classifier = classifiers[tab]->GetClassifier();
-    bool ok = classifier->LoadModel(filename.toStdString());
+    bool ok = bArchive ? classifier->LoadModel(archive) : classifier->LoadModel(filename.toStdString());
     if(ok)
     {
         if(!classifierMulti.size()) DEL(this->classifier);
@@ -53,17 +102,30 @@ void AlgorithmManager::SaveClassifier()
     QString filename = QFileDialog::getSaveFileName(mldemos, tr("Save Model"), "", tr("Model (*.model)"));
     if(filename.isEmpty()) return;
     if(!filename.endsWith(".model")) filename += ".model";
-    classifier->SaveModel(filename.toStdString());
+    ModelArchive archive;
+    if(tabUsedForTraining < classifiers.size() && classifiers[tabUsedForTraining]) ArchivePlugin(archive, classifiers[tabUsedForTraining], "classifier");
+    if(classifier->SaveModel(archive)) archive.Save(filename.toStdString());
+    else classifier->SaveModel(filename.toStdString());
 }
 
 void AlgorithmManager::LoadRegressor()
 {
+    if(IsTraining()) return;
     QString filename = QFileDialog::getOpenFileName(mldemos, tr("Load Model"), "", tr("Model (*.model)"));
     if(filename.isEmpty()) return;
     int tab = optionsRegress->algoList->currentIndex();
+    ModelArchive archive;
+    bool bArchive = ModelArchive::IsArchive(filename.toStdString());
+    if(bArchive)
+    {
+        if(!archive.Load(filename.toStdString())) return;
+        tab = ArchiveTab(archive, regressors, "regressor");
+        if(tab < 0) return;
+        optionsRegress->algoList->setCurrentIndex(tab);
+    }
     if(tab >= regressors.size() || !regressors[tab]) return;
     Regressor *regressor = regressors[tab]->GetRegressor();
-    bool ok = regressor->LoadModel(filename.toStdString());
+    bool ok = bArchive ? regressor->LoadModel(archive) : regressor->LoadModel(filename.toStdString());
     if(ok)
     {
         DEL(this->regressor);
@@ -84,17 +146,30 @@ void AlgorithmManager::SaveRegressor()
     QString filename = QFileDialog::getSaveFileName(mldemos, tr("Save Model"), "", tr("Model (*.model)"));
     if(filename.isEmpty()) return;
     if(!filename.endsWith(".model")) filename += ".model";
-    regressor->SaveModel(filename.toStdString());
+    ModelArchive archive;
+    if(tabUsedForTraining < regressors.size() && regressors[tabUsedForTraining]) ArchivePlugin(archive, regressors[tabUsedForTraining], "regressor");
+    if(regressor->SaveModel(archive)) archive.Save(filename.toStdString());
+    else regressor->SaveModel(filename.toStdString());
 }
 
 void AlgorithmManager::LoadDynamical()
 {
+    if(IsTraining()) return;
     QString filename = QFileDialog::getOpenFileName(mldemos, tr("Load Model"), "", tr("Model (*.model)"));
     if(filename.isEmpty()) return;
     int tab = optionsDynamic->algoList->currentIndex();
+    ModelArchive archive;
+    bool bArchive = ModelArchive::IsArchive(filename.toStdString());
+    if(bArchive)
+    {
+        if(!archive.Load(filename.toStdString())) return;
+        tab = ArchiveTab(archive, dynamicals, "dynamical");
+        if(tab < 0) return;
+        optionsDynamic->algoList->setCurrentIndex(tab);
+    }
     if(tab >= dynamicals.size() || !dynamicals[tab]) return;
     Dynamical *dynamical = dynamicals[tab]->GetDynamical();
-    bool ok = dynamical->LoadModel(filename.toStdString());
+    bool ok = bArchive ? dynamical->LoadModel(archive) : dynamical->LoadModel(filename.toStdString());
     if(ok)
     {
         DEL(this->dynamical);
@@ -118,5 +193,8 @@ void AlgorithmManager::SaveDynamical()
     QString filename = QFileDialog::getSaveFileName(mldemos, tr("Save Model"), "", tr("Model (*.model)"));
     if(filename.isEmpty()) return;
     if(!filename.endsWith(".model")) filename += ".model";
-    dynamical->SaveModel(filename.toStdString());
+    ModelArchive archive;
+    if(tabUsedForTraining < dynamicals.size() && dynamicals[tabUsedForTraining]) ArchivePlugin(archive, dynamicals[tabUsedForTraining], "dynamical");
+    if(dynamical->SaveModel(archive)) archive.Save(filename.toStdString());
+    else dynamical->SaveModel(filename.toStdString());
 }
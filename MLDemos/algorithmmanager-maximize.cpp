@@ -18,13 +18,16 @@ License along with this library; if not, write to the Free
 Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
 *********************************************************************/
 #include "algorithmmanager.h"
+#include "mldemos.h"
 #include <qcontour.h>
 
 using namespace std;
 
 void AlgorithmManager::Maximize()
 {
-    if(!canvas) return;
+    if(!canvas || IsTraining()) return;
+    // the map is redrawn so that it shows the function being optimized
+    if(optionsMaximize->benchmarkObjectiveCheck->isChecked()) mldemos->BenchmarkButton();
     if(canvas->maps.reward.isNull()) return;
     QMutexLocker lock(mutex);
     drawTimer->Stop();
@@ -177,7 +180,12 @@ void AlgorithmManager::Train(Maximizer *maximizer)
         startingPoint[1] = drand48();
     }
     //data = canvas->data->GetReward()->GetRewardFloat();
-    maximizer->Train(data, fVec(w,h), startingPoint);
+    if(optionsMaximize->benchmarkObjectiveCheck->isChecked())
+    {
+        // the benchmark is evaluated analytically rather than through the (quantized) reward map
+        maximizer->Maximize(new TestObjective(optionsMaximize->benchmarkCombo->currentIndex(), 2), startingPoint);
+    }
+    else maximizer->Train(data, fVec(w,h), startingPoint);
     maximizer->age = 0;
     delete [] data;
 }
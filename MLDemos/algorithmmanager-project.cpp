@@ -25,25 +25,18 @@ using namespace std;
 void AlgorithmManager::Project()
 {
     std::cout<< "AlgorithmManager::Project()" << std::endl;
-    if(!canvas || !canvas->data->GetCount()) return;
-    QMutexLocker lock(mutex);
-    drawTimer->Stop();
-    drawTimer->Clear();
-    DEL(clusterer);
-    DEL(regressor);
-    DEL(dynamical);
-    if(!classifierMulti.size()) DEL(classifier);
-    classifier = 0;
-    sourceDims.clear();
-    FOR(i,classifierMulti.size()) DEL(classifierMulti[i]); classifierMulti.clear();
-    DEL(maximizer);
-    DEL(reinforcement);
-    DEL(projector);
-    lastTrainingInfo = "";
+    if(!canvas || !canvas->data->GetCount() || IsTraining()) return;
     if(!optionsProject->algoList->count()) return;
     int tab = optionsProject->algoList->currentIndex();
     if(tab >= projectors.size() || !projectors[tab]) return;
-    projector = projectors[tab]->GetProjector();
+    drawTimer->Stop();
+    mutex->lock();
+    DetachModels();
+    mutex->unlock();
+    lastTrainingInfo = "";
+    sourceDims.clear();
+    // the new model stays out of the members until it is trained, the canvas keeps drawing the previous ones
+    Projector *projector = projectors[tab]->GetProjector();
     projectors[tab]->SetParams(projector);
 
     tabUsedForTraining = tab;
@@ -60,7 +53,26 @@ void AlgorithmManager::Project()
         // we get the list of samples that are checked
         trainList = GetManualSelection();
     }
+    bTrainInBackground = true;
     Train(projector, trainList);
+    bTrainInBackground = false;
+    if(bTrainingAborted)
+    {
+        bTrainingAborted = false;
+        DEL(projector);
+        mutex->lock();
+        // the data goes back to the previous projection
+        if(bHasSource && projectedData.size() == canvas->data->GetCount()) canvas->data->SetSamples(projectedData);
+        RestoreModels();
+        mutex->unlock();
+        emit UpdateInfo();
+        return;
+    }
+
+    QMutexLocker lock(mutex);
+    DeletePreviousModels();
+    drawTimer->Clear();
+    this->projector = projector;
     if(!bHasSource)
     {
         sourceData = canvas->data->GetSamples();
@@ -92,7 +104,7 @@ void AlgorithmManager::Project()
 
 void AlgorithmManager::ProjectManifold()
 {
-    if(!canvas || !canvas->data->GetCount()) return;
+    if(!canvas || !canvas->data->GetCount() || IsTraining()) return;
     QMutexLocker lock(mutex);
     drawTimer->Stop();
     drawTimer->Clear();
@@ -150,6 +162,7 @@ void AlgorithmManager::ProjectManifold()
 
 void AlgorithmManager::ProjectRevert()
 {
+    if(IsTraining()) return;
     QMutexLocker lock(mutex);
     drawTimer->Stop();
     drawTimer->Clear();
@@ -187,7 +200,7 @@ void AlgorithmManager::ProjectRevert()
 
 void AlgorithmManager::ProjectReproject()
 {
-    if(!canvas || !canvas->data->GetCount()) return;
+    if(!canvas || !canvas->data->GetCount() || IsTraining()) return;
     mutex->lock();
     sourceData = canvas->data->GetSamples();
     sourceLabels = canvas->data->GetLabels();
@@ -210,7 +223,12 @@ void AlgorithmManager::Train(Projector *projector, bvec trainList)
                 trainLabels.push_back(canvas->data->GetLabel(i));
             }
         }
-        projector->Train(trainSamples, trainLabels);
+        RunTraining([&]{projector->Train(trainSamples, trainLabels);});
+    }
+    else
+    {
+        vector<fvec> samples = canvas->data->GetSamples();
+        ivec labels = canvas->data->GetLabels();
+        RunTraining([&]{projector->Train(samples, labels);});
     }
-    else projector->Train(canvas->data->GetSamples(), canvas->data->GetLabels());
 }
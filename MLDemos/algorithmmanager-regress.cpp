@@ -24,22 +24,7 @@ using namespace std;
 
 void AlgorithmManager::Regression()
 {
-    if(!canvas || !canvas->data->GetCount()) return;
-    drawTimer->Stop();
-    drawTimer->Clear();
-
-    QMutexLocker lock(mutex);
-    DEL(clusterer);
-    DEL(regressor);
-    DEL(dynamical);
-    if(!classifierMulti.size()) DEL(classifier);
-    classifier = 0;
-    sourceDims.clear();
-    FOR(i,classifierMulti.size()) DEL(classifierMulti[i]); classifierMulti.clear();
-    DEL(maximizer);
-    DEL(reinforcement);
-    DEL(projector);
-    lastTrainingInfo = "";
+    if(!canvas || !canvas->data->GetCount() || IsTraining()) return;
     if(!optionsRegress->algoList->count()) return;
     int tab = optionsRegress->algoList->currentIndex();
     if(tab >= regressors.size() || !regressors[tab]) return;
@@ -47,6 +32,12 @@ void AlgorithmManager::Regression()
     ivec inputDims = GetInputDimensions();
     //ivec inputDims = optionsRegress->inputDimButton->isChecked() ? GetInputDimensions() : ivec();
     if(inputDims.size()==1 && inputDims[0] == outputDim) return;
+    drawTimer->Stop();
+    mutex->lock();
+    DetachModels();
+    mutex->unlock();
+    lastTrainingInfo = "";
+    sourceDims.clear();
     if(inputDims.size() && mldemos->ui.restrictDimCheck->isChecked()) outputDim = inputDims.back();
 
     int outputIndexInList = -1;
@@ -65,7 +56,8 @@ void AlgorithmManager::Regression()
         emit DisplayOptionsChanged();
     }
 
-    regressor = regressors[tab]->GetRegressor();
+    // the new model stays out of the members until it is trained, the canvas keeps drawing the previous ones
+    Regressor *regressor = regressors[tab]->GetRegressor();
     tabUsedForTraining = tab;
 
     float ratios [] = {.1f,.25f,1.f/3.f,.5f,2.f/3.f,.75f,.9f,1.f};
@@ -79,7 +71,24 @@ void AlgorithmManager::Regression()
         trainList = GetManualSelection();
     }
 
+    bTrainInBackground = regressor->BackgroundTraining();
     Train(regressor, outputDim, trainRatio, trainList);
+    bTrainInBackground = false;
+    if(bTrainingAborted)
+    {
+        bTrainingAborted = false;
+        DEL(regressor);
+        mutex->lock();
+        RestoreModels();
+        mutex->unlock();
+        emit UpdateInfo();
+        return;
+    }
+
+    QMutexLocker lock(mutex);
+    DeletePreviousModels();
+    drawTimer->Clear();
+    this->regressor = regressor;
     regressors[tab]->Draw(canvas, regressor);
     glw->clearLists();
     if(canvas->canvasType == 1)
@@ -174,7 +183,7 @@ void AlgorithmManager::Train(Regressor *regressor, int outputDim, float trainRat
 
     fvec trainErrors, testErrors;
     if(trainRatio == 1.f && !trainList.size()) {
-        regressor->Train(samples, labels);
+        if(!RunTraining([&]{regressor->Train(samples, labels);})) return;
         trainErrors.clear();
         FOR(i, samples.size())
         {
@@ -217,7 +226,11 @@ void AlgorithmManager::Train(Regressor *regressor, int outputDim, float trainRat
                 testLabels[i] = labels[perm[i+trainCnt]];
             }
         }
-        regressor->Train(trainSamples, trainLabels);
+        if(!RunTraining([&]{regressor->Train(trainSamples, trainLabels);}))
+        {
+            KILL(perm);
+            return;
+        }
         FOR(i, trainCnt) {
             fvec sample = trainSamples[i];
             fvec res = regressor->Test(sample);
@@ -24,7 +24,7 @@ using namespace std;
 
 void AlgorithmManager::Reinforce()
 {
-    if(!canvas) return;
+    if(!canvas || IsTraining()) return;
     if(canvas->maps.reward.isNull()) return;
     QMutexLocker lock(mutex);
     drawTimer->Stop();
@@ -38,6 +38,9 @@ AlgorithmManager::AlgorithmManager(MLDemos *mldemos, Canvas *canvas, GLWidget *g
       maximizer(0),
       reinforcement(0),
       projector(0),
+      trainingWorker(0),
+      bTrainInBackground(false),
+      bTrainingAborted(false),
       mutex(mutex),
       drawTimer(drawTimer),
       compare(compare),
@@ -233,7 +236,15 @@ AlgorithmManager::AlgorithmManager(MLDemos *mldemos, Canvas *canvas, GLWidget *g
 
 AlgorithmManager::~AlgorithmManager()
 {
+    // MLDemos does not close while a training is running (see MLDemos::closeEvent),
+    // this only makes sure that the worker never outlives the manager
+    if(trainingWorker)
+    {
+        trainingWorker->control.Cancel();
+        trainingWorker->wait();
+    }
     mutex->lock();
+    DeletePreviousModels();
     DEL(clusterer);
     DEL(regressor);
     DEL(dynamical);
@@ -257,6 +268,41 @@ AlgorithmManager::~AlgorithmManager()
     DEL(algorithmWidget);
 }
 
+bool AlgorithmManager::RunTraining(std::function<void()> job)
+{
+    bTrainingAborted = false;
+    if(!bTrainInBackground || trainingWorker)
+    {
+        job();
+        return true;
+    }
+
+    // the interface stays responsive while the worker trains: the canvas keeps the
+    // previous models until the caller swaps the new one in
+    trainingWorker = new TrainingWorker(job);
+    QProgressDialog progress(tr("Training..."), tr("Abort"), 0, 0, mldemos);
+    progress.setWindowModality(Qt::NonModal);
+    progress.setMinimumDuration(500);
+    progress.setValue(0);
+    trainingWorker->start(QThread::LowPriority);
+    while(!trainingWorker->isFinished())
+    {
+        int value = trainingWorker->control.GetProgress();
+        if(progress.wasCanceled()) trainingWorker->control.Cancel();
+        else if(value >= 0)
+        {
+            if(progress.maximum() != 1000) progress.setRange(0, 1000);
+            progress.setValue(value);
+        }
+        qApp->processEvents(QEventLoop::AllEvents, 50);
+        trainingWorker->wait(20);
+    }
+    trainingWorker->wait();
+    bTrainingAborted = trainingWorker->control.IsCancelled();
+    DEL(trainingWorker);
+    return !bTrainingAborted;
+}
+
 QStringList AlgorithmManager::GetInfoFiles()
 {
     QStringList infoFiles;
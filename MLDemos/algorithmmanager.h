@@ -2,6 +2,7 @@
 #define ALGORITHMMANAGER_H
 
 #include <QList>
+#include <functional>
 #include "canvas.h"
 #include "classifier.h"
 #include "regressor.h"
@@ -16,6 +17,7 @@
 #include "drawTimer.h"
 #include "gridsearch.h"
 #include "basewidget.h"
+#include "trainingworker.h"
 
 #include "ui_algorithmOptions.h"
 #include "ui_optsClassify.h"
@@ -30,6 +32,25 @@
 
 class MLDemos;
 
+// the models currently on the canvas, put aside while a new one trains in the background
+struct TrainedModels
+{
+    TrainedModels() : classifier(0), regressor(0), dynamical(0), clusterer(0), maximizer(0),
+        reinforcement(0), projector(0), tabUsedForTraining(0) {}
+    Classifier *classifier;
+    Regressor *regressor;
+    Dynamical *dynamical;
+    Clusterer *clusterer;
+    Maximizer *maximizer;
+    Reinforcement *reinforcement;
+    Projector *projector;
+    std::vector<Classifier *> classifierMulti;
+    ivec sourceDims;
+    ivec canvasSourceDims;
+    int tabUsedForTraining;
+    QString lastTrainingInfo;
+};
+
 class AlgorithmManager : public QObject
 {
     Q_OBJECT
@@ -84,6 +105,10 @@ public:
     std::vector<fvec> projectedData;
     ivec sourceLabels;
     ivec sourceDims;
+    TrainedModels previousModels;
+    TrainingWorker *trainingWorker;
+    bool bTrainInBackground;
+    bool bTrainingAborted;
 
     Canvas *canvas;
     GLWidget *glw;
@@ -126,6 +151,15 @@ public:
     void DrawClassifiedSamples(Canvas *canvas, Classifier *classifier, std::vector<Classifier *> classifierMulti);
     void UpdateLearnedModel();
 
+    // runs the plugin side of a training, in the background when requested by the caller
+    // (with a progress dialog and an abort button), returns false if the training was aborted
+    bool RunTraining(std::function<void()> job);
+    bool IsTraining() const {return trainingWorker != 0;}
+    void CancelTraining(){if(trainingWorker) trainingWorker->control.Cancel();}
+    void DetachModels();
+    void RestoreModels();
+    void DeletePreviousModels();
+
     std::vector<bool> GetManualSelection();
     ivec GetInputDimensions();
     QStringList GetInfoFiles();
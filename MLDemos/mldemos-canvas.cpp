@@ -18,7 +18,7 @@ License along with this library; if not, write to the Free
 Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
 *********************************************************************/
 #include "mldemos.h"
-#include "optimization_test_functions.h"
+#include "objective.h"
 
 void MLDemos::FitToData()
 {
@@ -337,80 +337,19 @@ void MLDemos::BenchmarkButton()
     QImage image(w, h, QImage::Format_ARGB32);
     image.fill(qRgb(255,255,255));
 
-    int dim = 2;
-    float minSpace = 0.f;
-    float maxSpace = 1.f;
-    float minVal = FLT_MAX;
-    float maxVal = -FLT_MAX;
-    switch (type)
-    {
-    case 0: // griewangk
-        minSpace = -60.f;
-        maxSpace = 60.f;
-        minVal = 0;
-        maxVal = 2;
-        break;
-    case 1: // rastragin
-        minSpace = -5.12f;
-        maxSpace = 5.12f;
-        minVal = 0;
-        maxVal = 82;
-        break;
-    case 2: // schwefel
-        minSpace = -500.f;
-        maxSpace = 500.f;
-        minVal = -838;
-        maxVal = 838;
-        break;
-    case 3: // ackley
-        minSpace = -2.f;
-        maxSpace = 2.f;
-        minVal = 0;
-        maxVal = 2.3504;
-        break;
-    case 4: // michalewicz
-        minSpace = -2;
-        maxSpace = 2;
-        minVal = -1.03159;
-        maxVal = 5.74;
-        //		minVal = -1.03159;
-        //		maxVal = 55.74;
-        break;
+    // we paint the same objective the maximizers optimize when asked to work on the function itself
+    TestObjective objective(type, 2);
+    std::vector<fvec> points(w*h, fvec(2));
+    FOR (i, w) {
+        FOR (j, h) {
+            points[j*w + i][0] = i/(float)w;
+            points[j*w + i][1] = j/(float)h;
+        }
     }
-
-    bool bSetValues = minVal == FLT_MAX;
-    Eigen::VectorXd x(2);
-    fVec point;
-    float value = 0;
+    fvec values = objective.Values(points);
     FOR (i, w) {
-        x[0] = i/(float)w*(maxSpace - minSpace) + minSpace;
         FOR (j, h) {
-            x[1] = j/(float)h*(maxSpace - minSpace) + minSpace;
-            switch (type)
-            {
-            case 0:
-                value = griewangk(x)(0);
-                break;
-            case 1:
-                value = rastragin(x)(0);
-                break;
-            case 2:
-                value = schwefel(x)(0);
-                break;
-            case 3:
-                value = ackley(x)(0);
-                break;
-            case 4:
-                value = sixhump(x)(0);
-                break;
-            }
-            if (bSetValues) {
-                if (value < minVal) minVal = value;
-                if (value > maxVal) maxVal = value;
-            } else {
-                value = (value-minVal)/(maxVal-minVal);
-            }
-            int color = 255.f*max(0.f,min(1.f,value));
+            int color = 255.f*(1.f - values[j*w + i]);
             image.setPixel(i,j,qRgba(255, color, color, 255));
         }
     }
@@ -123,6 +123,14 @@ MLDemos::~MLDemos()
 
 void MLDemos::closeEvent(QCloseEvent *event)
 {
+    // a background training runs its event loop inside an AlgorithmManager call:
+    // we abort it and close again once that call has returned
+    if (algo && algo->IsTraining()) {
+        algo->CancelTraining();
+        event->ignore();
+        QTimer::singleShot(100, this, SLOT(close()));
+        return;
+    }
     qApp->quit();
 }
 
@@ -28,6 +28,9 @@ Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
 #include "classifier.h"
 #include "regressor.h"
 #include <fstream>
+#include <string>
+#include <cstring>
+#include <cfloat>
 
 using namespace std;
 
@@ -805,51 +808,226 @@ void MLDemos::LoadParams( QString filename )
     //actionAlgorithms->setChecked(algo->algorithmWidget->isVisible());
 }
 
+// the outputs are exported one chunk of samples at a time: each chunk is scored through the
+// batch entry points of the algorithm, then formatted in parallel blocks that are written in order
+#define EXPORT_CHUNK 65536
+#define EXPORT_BLOCK 1024
+enum ExportFormat {EXPORT_TEXT, EXPORT_NPY, EXPORT_RAW};
+
+// writes value as QString::arg does (%g, 6 significant digits) and returns the end of the text
+static char *FormatFloat(char *out, float value)
+{
+    if(value != value) {memcpy(out, "nan", 3); return out+3;}
+    if(value < 0 || (value == 0 && 1/value < 0)) *out++ = '-';
+    double v = fabs((double)value);
+    if(v == 0) {*out++ = '0'; return out;}
+    if(v > FLT_MAX) {memcpy(out, "inf", 3); return out+3;}
+    // 6 significant digits in an integer mantissa, corrected for the imprecision of log10
+    int e = (int)floor(log10(v));
+    double scaled = e > 5 ? v / pow(10., e-5) : v * pow(10., 5-e);
+    while(scaled >= 999999.5) {scaled /= 10; e++;}
+    while(scaled < 99999.5) {scaled *= 10; e--;}
+    // ties are rounded to even, as printf does
+    long mantissa = (long)floor(scaled);
+    double remainder = scaled - mantissa;
+    if(remainder > 0.5 || (remainder == 0.5 && mantissa%2)) mantissa++;
+    if(mantissa >= 1000000) {mantissa /= 10; e++;}
+    char digits[6];
+    for(int i=5; i>=0; i--, mantissa /= 10) digits[i] = '0' + mantissa%10;
+    int n = 6;
+    while(n > 1 && digits[n-1] == '0') n--;
+
+    if(e < -4 || e >= 6)
+    {
+        *out++ = digits[0];
+        if(n > 1)
+        {
+            *out++ = '.';
+            for(int i=1; i<n; i++) *out++ = digits[i];
+        }
+        *out++ = 'e';
+        *out++ = e < 0 ? '-' : '+';
+        if(e < 0) e = -e;
+        if(e >= 100) *out++ = '0' + e/100;
+        *out++ = '0' + (e/10)%10;
+        *out++ = '0' + e%10;
+    }
+    else if(e >= 0)
+    {
+        for(int i=0; i<=e; i++) *out++ = digits[i];
+        if(n > e+1)
+        {
+            *out++ = '.';
+            for(int i=e+1; i<n; i++) *out++ = digits[i];
+        }
+    }
+    else
+    {
+        *out++ = '0';
+        *out++ = '.';
+        for(int i=0; i<-e-1; i++) *out++ = '0';
+        for(int i=0; i<n; i++) *out++ = digits[i];
+    }
+    return out;
+}
+
+static char *FormatInt(char *out, int value)
+{
+    char digits[12];
+    unsigned int v = value < 0 ? -(unsigned int)value : value;
+    int n = 0;
+    do {digits[n++] = '0' + v%10; v /= 10;} while(v);
+    if(value < 0) *out++ = '-';
+    while(n) *out++ = digits[--n];
+    return out;
+}
+
+// one line per row: the sample, its label and the results, or only the results when there are no labels
+static void FormatRows(std::string &text, const vector<fvec> &samples, const ivec &labels, const vector<fvec> &results, int first, int last)
+{
+    char line[64];
+    for(int i=first; i<last; i++)
+    {
+        if(labels.size())
+        {
+            FOR(d, samples[i].size())
+            {
+                char *end = FormatFloat(line, samples[i][d]);
+                *end++ = ',';
+                text.append(line, end-line);
+            }
+            char *end = FormatInt(line, labels[i]);
+            *end++ = ',';
+            text.append(line, end-line);
+        }
+        FOR(d, results[i].size())
+        {
+            char *end = FormatFloat(line, results[i][d]);
+            if(d < results[i].size()-1) *end++ = ',';
+            text.append(line, end-line);
+        }
+        text += '\n';
+    }
+}
+
+// numpy array header (format version 1.0) for a little- or big-endian float32 matrix
+static void WriteNpyHeader(QFile &file, int rows, int columns)
+{
+    const unsigned short one = 1;
+    bool bLittleEndian = *(const unsigned char*)&one == 1;
+    char dict[128];
+    int length = sprintf(dict, "{'descr': '%cf4', 'fortran_order': False, 'shape': (%d, %d), }", bLittleEndian ? '<' : '>', rows, columns);
+    // the header is padded with spaces and a newline so that the data is 64-byte aligned
+    int padding = 64 - (10 + length + 1) % 64;
+    if(padding == 64) padding = 0;
+    std::string header("\x93NUMPY\x01\x00", 8);
+    int headerLength = length + padding + 1;
+    header += (char)(headerLength & 0xff);
+    header += (char)(headerLength >> 8);
+    header.append(dict, length);
+    header.append(padding, ' ');
+    header += '\n';
+    file.write(header.data(), header.size());
+}
+
 void MLDemos::ExportOutput()
 {
     if(!algo->classifier && !algo->regressor && !algo->clusterer && !algo->projector) return;
-    QString filename = QFileDialog::getSaveFileName((QWidget*)this, tr("Save Output Data"), "", tr("Data (*.txt *.csv)"));
+    QString filter;
+    QString filename = QFileDialog::getSaveFileName((QWidget*)this, tr("Save Output Data"), "",
+                                                    tr("Data (*.txt *.csv);;NumPy array (*.npy);;Raw float32 (*.raw)"), &filter);
     if(filename.isEmpty()) return;
-    if(!filename.endsWith(".txt") && !filename.endsWith(".csv")) filename += ".txt";
+    if(!filename.endsWith(".txt") && !filename.endsWith(".csv") && !filename.endsWith(".npy") && !filename.endsWith(".raw"))
+    {
+        if(filter.contains("*.npy")) filename += ".npy";
+        else if(filter.contains("*.raw")) filename += ".raw";
+        else filename += ".txt";
+    }
+    ExportFormat format = filename.endsWith(".npy") ? EXPORT_NPY : filename.endsWith(".raw") ? EXPORT_RAW : EXPORT_TEXT;
 
     QFile file(filename);
     file.open(QFile::WriteOnly);
-    QTextStream out(&file);
     if(!file.isOpen()) return;
 
-    if(algo->classifier || algo->clusterer || algo->regressor)
+    // projections only export the projected values of the source samples
+    bool bProjection = !algo->classifier && !algo->clusterer && !algo->regressor;
+    const vector<fvec> &source = bProjection ? algo->projector->source : canvas->data->GetSamplesRef();
+    const ivec &sourceDims = algo->sourceDims;
+    int count = source.size();
+    if(format == EXPORT_TEXT && !bProjection) file.write("#Sample(n-dims) Label ComputedValue(s)\n");
+
+    int columns = -1;
+    for(int start=0; start<count; start+=EXPORT_CHUNK)
     {
-        out << "#Sample(n-dims) Label ComputedValue(s)\n";
-        vector<fvec> samples = algo->sourceDims.size() ? canvas->data->GetSampleDims(algo->sourceDims) : canvas->data->GetSamples();
-        ivec labels = canvas->data->GetLabels();
-        FOR(i, samples.size())
+        int chunk = min(EXPORT_CHUNK, count-start);
+        vector<fvec> samples(chunk);
+        ivec labels;
+        if(bProjection) std::copy(source.begin()+start, source.begin()+start+chunk, samples.begin());
+        else
         {
-            fvec &sample = samples[i];
-            fvec res;
-            if(algo->classifier) res = algo->classifier->TestMulti(sample);
-            else if (algo->clusterer) res = algo->clusterer->Test(sample);
-            else if (algo->regressor) res = algo->regressor->Test(sample);
-            FOR(d, sample.size()) out << QString("%1,").arg(sample[d]);
-            out << QString("%1,").arg(labels[i]);
-            FOR(d, res.size()) out << QString("%1%2").arg(res[d]).arg(d<res.size()-1?",":"");
-            out << "\n";
+            labels.resize(chunk);
+#pragma omp parallel for
+            for(int i=0; i<chunk; i++)
+            {
+                const fvec &sample = source[start+i];
+                if(sourceDims.size())
+                {
+                    samples[i].resize(sourceDims.size());
+                    FOR(d, sourceDims.size()) samples[i][d] = sample[sourceDims[d]];
+                }
+                else samples[i] = sample;
+                labels[i] = canvas->data->GetLabel(start+i);
+            }
         }
-    }
-    else if(algo->projector)
-    {
-        //out << "#Sample x (n-dims), Label, Projected x (m-dims)\n";
-        vector<fvec> samples = algo->projector->source;
-        //ivec labels = canvas->data->GetLabels();
-        FOR(i, samples.size())
+
+        // the algorithms are not all re-entrant: the parallelism of the scoring is left to their batch methods
+        vector<fvec> results;
+        if(algo->classifier) results = algo->classifier->TestBatch(samples);
+        else if(algo->regressor) results = algo->regressor->TestBatch(samples);
+        else
+        {
+            results.resize(chunk);
+            FOR(i, chunk) results[i] = algo->clusterer ? algo->clusterer->Test(samples[i]) : algo->projector->Project(samples[i]);
+        }
+
+        if(format != EXPORT_TEXT)
+        {
+            // binary rows must all have the size of the first one
+            if(columns == -1)
+            {
+                columns = (bProjection ? 0 : samples[0].size() + 1) + results[0].size();
+                if(format == EXPORT_NPY) WriteNpyHeader(file, count, columns);
+            }
+            fvec values(chunk*columns, 0.f);
+#pragma omp parallel for
+            for(int i=0; i<chunk; i++)
+            {
+                float *row = &values[i*columns];
+                int c = 0;
+                if(!bProjection)
+                {
+                    for(int d=0; d<(int)samples[i].size() && c<columns; d++) row[c++] = samples[i][d];
+                    if(c < columns) row[c++] = labels[i];
+                }
+                for(int d=0; d<(int)results[i].size() && c<columns; d++) row[c++] = results[i][d];
+            }
+            file.write((const char*)&values[0], values.size()*sizeof(float));
+            continue;
+        }
+
+        int blockCount = (chunk + EXPORT_BLOCK - 1) / EXPORT_BLOCK;
+        vector<std::string> blocks(blockCount);
+#pragma omp parallel for schedule(dynamic)
+        for(int b=0; b<blockCount; b++)
         {
-            fvec &sample = samples[i];
-            fvec projected = algo->projector->Project(sample);
-            //FOR(d, sample.size()) out << QString("%1,").arg(sample[d]);
-            //out << QString("%1").arg(labels[i]);
-            FOR(d, projected.size()) out << QString("%1%2").arg(projected[d]).arg(d<projected.size()-1?",":"");
-            out << "\n";
+            int first = b*EXPORT_BLOCK;
+            int last = min(chunk, first + EXPORT_BLOCK);
+            blocks[b].reserve((last-first)*16*(samples[first].size() + results[first].size() + 1));
+            FormatRows(blocks[b], samples, labels, results, first, last);
         }
+        FOR(b, blockCount) file.write(blocks[b].data(), blocks[b].size());
     }
+    if(format == EXPORT_NPY && columns == -1) WriteNpyHeader(file, 0, 0);
     file.close();
 }
 
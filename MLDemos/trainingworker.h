@@ -0,0 +1,41 @@
+/*********************************************************************
+MLDemos: A User-Friendly visualization toolkit for machine learning
+Copyright (C) 2010  Basilio Noris
+Contact: mldemos@b4silio.com
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public License,
+version 3 as published by the Free Software Foundation.
+
+This library is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free
+Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*********************************************************************/
+#ifndef _TRAINING_WORKER_H_
+#define _TRAINING_WORKER_H_
+
+#include <functional>
+#include <QThread>
+#include "trainingControl.h"
+
+// runs a single training job in its own thread, with its control attached to the thread
+// so that the plugins can report their progress and check for cancellation
+class TrainingWorker : public QThread
+{
+public:
+    TrainingWorker(std::function<void()> job, QObject *parent=0);
+    TrainingControl control;
+
+protected:
+    void run();
+
+private:
+    std::function<void()> job;
+};
+
+#endif // _TRAINING_WORKER_H_
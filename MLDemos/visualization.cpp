@@ -6,6 +6,7 @@
 #include <QPainter>
 #include <QBitmap>
 #include <QDebug>
+#include "newmat11/newmatap.h"
 
 using namespace std;
 
@@ -856,6 +857,113 @@ void Visualization::GenerateIndividualPlot()
     ui->scrollArea->setVerticalScrollBarPolicy(Qt::ScrollBarAlwaysOn);
 }
 
+// the samples stored one dimension after the other, so that each dimension is contiguous
+static fvec ColumnMajor(const vector<fvec> &samples, int dim)
+{
+    int count = samples.size();
+    fvec columns((size_t)count*dim);
+#pragma omp parallel for
+    for(int i=0; i<count; i++)
+    {
+        FOR(d, dim) columns[(size_t)d*count + i] = samples[i][d];
+    }
+    return columns;
+}
+
+// kernel densities of large inputs are computed on a regular grid: the samples are linearly
+// binned on the grid, which is then convolved with the sampled gaussian kernel through an FFT
+#define KDE_OVERSAMPLING 4 // grid points per density bin
+#define KDE_SUPPORT 5 // kernel support, in bandwidths
+#define KDE_DIRECT_COST (1<<20) // samples x bins below which the kernels are summed directly
+
+struct KernelDensityGrid
+{
+    double h, start, delta; // bandwidth, position of the first grid point and grid spacing
+    int size, first, step; // number of grid points, grid index of the first bin and grid points between bins
+    dvec weights;
+};
+
+static double KernelBandwidth(float sigma, int count)
+{
+    return sigma*pow(4./3.,0.2)*pow(count,-0.2);
+}
+
+// returns false when the kernels should rather be summed directly
+static bool KernelDensityGridSetup(KernelDensityGrid &grid, double h, int count, float minv, float maxv, int bins)
+{
+    if(!(maxv > minv) || (double)count*bins <= KDE_DIRECT_COST) return false;
+    grid.h = h;
+    grid.step = KDE_OVERSAMPLING;
+    grid.delta = (maxv-minv)/((double)bins*grid.step);
+    double extent = ceil(KDE_SUPPORT*h/grid.delta);
+    if(extent > 1<<20) return false; // the range is degenerate compared to the bandwidth
+    grid.first = (int)extent;
+    grid.size = bins*grid.step + 2*grid.first;
+    grid.start = minv - grid.first*grid.delta;
+    grid.weights.assign(grid.size, 0);
+    return true;
+}
+
+static void KernelDensityGridBin(KernelDensityGrid &grid, const float *data, int count)
+{
+    double *weights = &grid.weights[0];
+    FOR(i, count)
+    {
+        double x = (data[i] - grid.start) / grid.delta;
+        if(!(x >= 0) || x >= grid.size-1) continue; // beyond the kernel support (or not a number)
+        int k = (int)x;
+        double r = x - k;
+        weights[k] += 1-r;
+        weights[k+1] += r;
+    }
+}
+
+// not re-entrant: newmat keeps a global trace of its calls
+static fvec KernelDensityGridConvolve(const KernelDensityGrid &grid, int count, int bins)
+{
+    // the circular convolution must be long enough for the kernel not to wrap around the grid
+    int n = 2;
+    while(n < grid.size + grid.first) n <<= 1;
+    ColumnVector signal(n), kernel(n);
+    signal = 0.0;
+    kernel = 0.0;
+    FOR(i, grid.size) signal.element(i) = grid.weights[i];
+    double scale = 1 / (sqrt(2*M_PI)*count*grid.h);
+    for(int j=-grid.first; j<=grid.first; j++)
+    {
+        double a = j*grid.delta / grid.h;
+        kernel.element((j+n)%n) = exp(-0.5*a*a)*scale;
+    }
+    ColumnVector signalRe, signalIm, kernelRe, kernelIm, result;
+    RealFFT(signal, signalRe, signalIm);
+    RealFFT(kernel, kernelRe, kernelIm);
+    ColumnVector productRe = SP(signalRe, kernelRe) - SP(signalIm, kernelIm);
+    ColumnVector productIm = SP(signalRe, kernelIm) + SP(signalIm, kernelRe);
+    RealFFTI(productRe, productIm, result);
+    fvec density(bins);
+    FOR(i, bins) density[i] = max(0., result.element(grid.first + i*grid.step));
+    return density;
+}
+
+static fvec KernelDensityDirect(const float *data, int count, double h, float minv, float maxv, int bins)
+{
+    fvec density(bins,0);
+    double scale = 1 / sqrt(2*M_PI);
+    FOR(i, bins)
+    {
+        double iV = double(i)/bins*(maxv-minv) + minv;
+        double x = 0;
+        FOR(j, count)
+        {
+            double a = (data[j]-iV) / h;
+            double k = exp(-0.5*a*a)*scale;
+            x += k;
+        }
+        density[i] = x / (count*h);
+    }
+    return density;
+}
+
 void adaptFontSize(QPainter * painter, int flags, QRectF rect, QString text){
     QFont font = painter->font();
     QRect fontBoundRect;
@@ -869,23 +977,14 @@ void adaptFontSize(QPainter * painter, int flags, QRectF rect, QString text){
 
 void Visualization::GenerateCorrelationPlot()
 {
-    std::vector<fvec> samples = data->GetSamples();
+    const std::vector<fvec> &samples = data->GetSamplesRef();
     ivec labels = data->GetLabels();
     if(!samples.size()) return;
     int dim = samples[0].size();
     int gridX = dim;
     int gridY = dim;
     int flavorType = ui->flavorCombo->currentIndex();
-
-    fvec mins(dim, FLT_MAX), maxes(dim, -FLT_MIN);
-    FOR(d, dim)
-    {
-        FOR(i, samples.size())
-        {
-            mins[d] = min(mins[d], samples[i][d]);
-            maxes[d] = max(maxes[d], samples[i][d]);
-        }
-    }
+    int count = samples.size();
 
     int pad = 20;
     int w = max(24,min(100, (ui->scrollArea->width()-12-2*pad)/gridX));
@@ -899,32 +998,63 @@ void Visualization::GenerateCorrelationPlot()
     // sum((x - muX)*(y-muY)) / sqrt(sigmaX*sigmaY);
     // or
     // (n*sum(x*y) - sum(x)*sum(y))/(sqrt(n*sum(x*x)-(sum(x)^2)*sqrt(n*sum(y*y)-(sum(y)^2));
-
-    fvec sums(dim,0), sqsum(dim,0);
-    FOR(i, samples.size())
-    {
-        FOR(d, dim)
+    // the bounds, sums and cross products are gathered in a single pass over blocks of samples,
+    // each thread accumulates its blocks before the partial sums are merged
+    fvec columns = ColumnMajor(samples, dim);
+    fvec mins(dim, FLT_MAX), maxes(dim, -FLT_MIN);
+    dvec sums(dim,0), products(dim*dim,0); // the diagonal of products holds the sums of squares
+    const int blockSize = 1024;
+    int blockCount = (count + blockSize - 1) / blockSize;
+#pragma omp parallel
+    {
+        fvec threadMins(dim, FLT_MAX), threadMaxes(dim, -FLT_MIN);
+        dvec threadSums(dim,0), threadProducts(dim*dim,0);
+#pragma omp for schedule(dynamic) nowait
+        for(int b=0; b<blockCount; b++)
+        {
+            int first = b*blockSize;
+            int length = min(blockSize, count-first);
+            FOR(d1, dim)
+            {
+                const float *x = &columns[(size_t)d1*count + first];
+                double sum = 0;
+                FOR(i, length)
+                {
+                    threadMins[d1] = min(threadMins[d1], x[i]);
+                    threadMaxes[d1] = max(threadMaxes[d1], x[i]);
+                    sum += x[i];
+                }
+                threadSums[d1] += sum;
+                FOR(d2, d1+1)
+                {
+                    const float *y = &columns[(size_t)d2*count + first];
+                    double a = 0;
+                    FOR(i, length) a += x[i]*y[i];
+                    threadProducts[dim*d1 + d2] += a;
+                }
+            }
+        }
+#pragma omp critical
         {
-            sums[d] += samples[i][d];
-            sqsum[d] += samples[i][d]*samples[i][d];
+            FOR(d, dim)
+            {
+                mins[d] = min(mins[d], threadMins[d]);
+                maxes[d] = max(maxes[d], threadMaxes[d]);
+                sums[d] += threadSums[d];
+            }
+            FOR(i, dim*dim) products[i] += threadProducts[i];
         }
     }
 
-    double n = samples.size();
+    double n = count;
     dvec corr(dim*dim, 0);
     FOR(d, dim) corr[dim*d + d] = 1.f;
     FOR(d1, dim)
     {
         FOR(d2, d1)
         {
-            if(d1==d2) continue;
-            double a=0;
-            FOR(i, samples.size())
-            {
-                a += samples[i][d1]*samples[i][d2];
-            }
-            double rho = n*a - sums[d1]*sums[d2];
-            rho /= sqrt(n*sqsum[d1] - sums[d1]*sums[d1])*sqrt(n*sqsum[d2] - sums[d2]*sums[d2]);
+            double rho = n*products[dim*d1 + d2] - sums[d1]*sums[d2];
+            rho /= sqrt(n*products[dim*d1 + d1] - sums[d1]*sums[d1])*sqrt(n*products[dim*d2 + d2] - sums[d2]*sums[d2]);
             corr[dim*d1 + d2] = rho;
             corr[dim*d2 + d1] = rho;
         }
@@ -1068,7 +1198,9 @@ void Visualization::GenerateCorrelationPlot()
                     painter.setPen(Qt::black);
                     painter.setOpacity(0.5);
                     int rad = 3;
-                    FOR(i, samples.size())
+                    // large datasets are thinned out, the cell cannot show more points anyway
+                    int stride = max(1, count/2000);
+                    for(int i=0; i<count; i+=stride)
                     {
                         float x = (samples[i][d1]-mins[d1])/(maxes[d1]-mins[d1])*(w-2*(rad+1)) + center.x() - w/2 + (rad+1);
                         float y = (1.f-(samples[i][d2]-mins[d2])/(maxes[d2]-mins[d2]))*(h-2*(rad+1)) + center.y() - h/2 + (rad+1);
@@ -1091,37 +1223,63 @@ void Visualization::GenerateCorrelationPlot()
 
 void Visualization::GenerateSampleDistancePlot()
 {
-    std::vector<fvec> samples = data->GetSamples();
-    ivec labels = data->GetLabels();
+    const std::vector<fvec> &samples = data->GetSamplesRef();
     if(!samples.size()) return;
     int dim = samples[0].size();
     if(!dim) return;
-    int count = samples.size();
 
-    // we need to make a big fat matrix with all the sample distances
-    float *D = new float[count*count];
-    float maxD = 0;
+    int pad = 30;
+    int mapW = (ui->scrollArea->width()-12) - pad*2, mapH = (ui->scrollArea->height()-12) - pad*2;
+
+    // the matrix is never shown larger than the display: beyond that we keep evenly spaced samples
+    int count = min((int)samples.size(), max(256, max(mapW, mapH)));
+    fvec points((size_t)count*dim);
     FOR(i, count)
     {
-        D[i*count + i] = 0;
-        FOR(j, i)
+        const fvec &sample = samples[(size_t)i*samples.size()/count];
+        FOR(d, dim) points[i*dim + d] = sample[d];
+    }
+
+    // we need to make a big fat matrix with all the sample distances, computed in square tiles
+    const int tileSize = 32;
+    int tileCount = (count + tileSize - 1) / tileSize;
+    fvec D((size_t)count*count, 0);
+    float maxD = 0;
+#pragma omp parallel
+    {
+        float threadMaxD = 0;
+#pragma omp for schedule(dynamic) nowait
+        for(int t=0; t<tileCount*tileCount; t++)
         {
-            float distance = 0;
-            FOR(d, dim)
+            int ti = t / tileCount, tj = t % tileCount;
+            if(tj > ti) continue;
+            int iEnd = min(count, (ti+1)*tileSize);
+            int jEnd = min(count, (tj+1)*tileSize);
+            for(int i=ti*tileSize; i<iEnd; i++)
             {
-                float dist = samples[i][d]-samples[j][d];
-                distance += dist*dist;
+                const float *a = &points[i*dim];
+                for(int j=tj*tileSize; j<jEnd && j<i; j++)
+                {
+                    const float *b = &points[j*dim];
+                    float distance = 0;
+                    FOR(d, dim)
+                    {
+                        float dist = a[d]-b[d];
+                        distance += dist*dist;
+                    }
+                    distance = sqrtf(distance);
+                    threadMaxD = max(threadMaxD, distance);
+                    D[(size_t)i*count + j] = distance;
+                    D[(size_t)j*count + i] = distance;
+                }
             }
-            distance = sqrtf(distance);
-            maxD = max(maxD, distance);
-            D[i*count + j] = distance;
-            D[j*count + i] = distance;
+        }
+#pragma omp critical
+        {
+            maxD = max(maxD, threadMaxD);
         }
     }
 
-    int pad = 30;
-    int mapW = (ui->scrollArea->width()-12) - pad*2, mapH = (ui->scrollArea->height()-12) - pad*2;
-
     ui->scrollArea->setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
     ui->scrollArea->setVerticalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
     QPixmap pixmap = QPixmap(ui->scrollArea->width()-2, ui->scrollArea->height()-2);
@@ -1134,23 +1292,27 @@ void Visualization::GenerateSampleDistancePlot()
     font.setPointSize(9);
     painter.setFont(font);
 
-    FOR(i, count)
+    // the matrix is symmetric, row j of the image is row j of the matrix
+    float scale = maxD > 0 ? 255/maxD : 0;
+#pragma omp parallel for
+    for(int j=0; j<count; j++)
     {
-        FOR(j, count)
+        QRgb *line = (QRgb*)image.scanLine(j);
+        const float *row = &D[(size_t)j*count];
+        FOR(i, count)
         {
-            float dist = D[i*count + j];
-            image.setPixel(i,j,qRgb(dist/maxD*255,dist/maxD*255,dist/maxD*255));
+            int value = row[i]*scale;
+            line[i] = qRgb(value, value, value);
         }
     }
     painter.drawPixmap(pad,pad,QPixmap::fromImage(image).scaled(QSize(mapW, mapH), Qt::IgnoreAspectRatio, Qt::SmoothTransformation));
 
-    delete [] D;
     displayPixmap = pixmap;
 }
 
 void Visualization::GenerateDensityPlot()
 {
-    std::vector<fvec> samples = data->GetSamples();
+    const std::vector<fvec> &samples = data->GetSamplesRef();
     ivec labels = data->GetLabels();
     if(!samples.size()) return;
     int dim = samples[0].size();
@@ -1159,15 +1321,19 @@ void Visualization::GenerateDensityPlot()
     int inputType = ui->inputCombo->currentIndex();
     int classCount = data->GetClassCount(labels);
     int count = inputType ? dim : classCount;
-    int D = min(dim, ui->x1Combo->currentIndex());
+    int D = min(dim-1, ui->x1Combo->currentIndex());
+    int sampleCount = samples.size();
 
+    fvec columns = ColumnMajor(samples, dim);
     fvec mins(dim, FLT_MAX), maxes(dim, -FLT_MIN);
-    FOR(d, dim)
+#pragma omp parallel for
+    for(int d=0; d<dim; d++)
     {
-        FOR(i, samples.size())
+        const float *column = &columns[(size_t)d*sampleCount];
+        FOR(i, sampleCount)
         {
-            mins[d] = min(mins[d], samples[i][d]);
-            maxes[d] = max(maxes[d], samples[i][d]);
+            mins[d] = min(mins[d], column[i]);
+            maxes[d] = max(maxes[d], column[i]);
         }
     }
 
@@ -1185,60 +1351,72 @@ void Visualization::GenerateDensityPlot()
     int cnt=0;
     FOR(i, labels.size()) if(!classMap.count(labels[i])) classMap[labels[i]] = cnt++;
 
-    vector<fvec> densities(count);
-    int densityBins = inputType ? 256 : 128;
-    fvec maxDensities(count, -FLT_MAX);
-    fvec sumDensities(densityBins,0);
+    // each density is computed on a contiguous series: a dimension, or the values of one class along D
+    vector<fvec> classData;
+    vector<const float*> series(count);
+    ivec seriesCount(count);
     if(inputType)
     {
         FOR(d, count)
         {
-            float mean=0, sigma=0;
-            fvec data(samples.size());
-            FOR(i, samples.size())
-            {
-                data[i] = samples[i][d];
-                mean += data[i];
-            }
-            mean /= data.size();
-            FOR(i, data.size()) sigma += (data[i]-mean)*(data[i]-mean);
-            sigma /= data.size();
-            sigma = sqrtf(sigma);
-            densities[d] = KernelDensity(data, sigma, mins[d], maxes[d], densityBins);
-            FOR(i, densityBins)
-            {
-                if(maxDensities[d] < densities[d][i]) maxDensities[d] = densities[d][i];
-                sumDensities[i] += densities[d][i];
-            }
+            series[d] = &columns[(size_t)d*sampleCount];
+            seriesCount[d] = sampleCount;
         }
     }
     else
     {
+        // the classes are taken in the order of their labels
         int c=0;
-        FORIT(classMap, int, int)
+        FORIT(classMap, int, int) it->second = c++;
+        classData.resize(count);
+        const float *column = &columns[(size_t)D*sampleCount];
+        FOR(i, sampleCount) classData[classMap[labels[i]]].push_back(column[i]);
+        FOR(c, count)
         {
-            float mean=0, sigma=0;
-            int meanCount=0;
-            int label = it->first;
-            fvec data;
-            FOR(i, samples.size())
-            {
-                if(labels[i] != label) continue;
-                data.push_back(samples[i][D]);
-                mean += samples[i][D];
-                meanCount++;
-            }
-            mean /= meanCount;
-            FOR(i, data.size()) sigma += (data[i]-mean)*(data[i]-mean);
-            sigma /= data.size();
-            sigma = sqrtf(sigma);
-            densities[c] = KernelDensity(data, sigma, mins[D], maxes[D], densityBins);
-            FOR(i, densityBins)
-            {
-                if(maxDensities[c] < densities[c][i]) maxDensities[c] = densities[c][i];
-                sumDensities[i] += densities[c][i];
-            }
-            c++;
+            series[c] = classData[c].size() ? &classData[c][0] : 0;
+            seriesCount[c] = classData[c].size();
+        }
+    }
+
+    vector<fvec> densities(count);
+    int densityBins = inputType ? 256 : 128;
+    vector<KernelDensityGrid> grids(count);
+    ivec bGrid(count, 0);
+#pragma omp parallel for schedule(dynamic)
+    for(int c=0; c<count; c++)
+    {
+        const float *values = series[c];
+        int n = seriesCount[c];
+        float low = mins[inputType ? c : D];
+        float high = maxes[inputType ? c : D];
+        float mean=0, sigma=0;
+        FOR(i, n) mean += values[i];
+        mean /= n;
+        FOR(i, n) sigma += (values[i]-mean)*(values[i]-mean);
+        sigma /= n;
+        sigma = sqrtf(sigma);
+        if(!n || sigma==0 || sigma != sigma) densities[c] = fvec(densityBins, 0);
+        else
+        {
+            double h = KernelBandwidth(sigma, n);
+            bGrid[c] = KernelDensityGridSetup(grids[c], h, n, low, high, densityBins);
+            if(bGrid[c]) KernelDensityGridBin(grids[c], values, n);
+            else densities[c] = KernelDensityDirect(values, n, h, low, high, densityBins);
+        }
+    }
+    FOR(c, count)
+    {
+        if(bGrid[c]) densities[c] = KernelDensityGridConvolve(grids[c], seriesCount[c], densityBins);
+    }
+
+    fvec maxDensities(count, -FLT_MAX);
+    fvec sumDensities(densityBins,0);
+    FOR(c, count)
+    {
+        FOR(i, densityBins)
+        {
+            if(maxDensities[c] < densities[c][i]) maxDensities[c] = densities[c][i];
+            sumDensities[i] += densities[c][i];
         }
     }
     float maxDensity = -FLT_MAX;
@@ -2593,24 +2771,13 @@ fvec Visualization::Density(fvec data, float minv, float maxv, int bins)
     return density;
 }
 
-fvec Visualization::KernelDensity(fvec data, float sigma, float minv, float maxv, int bins)
+fvec Visualization::KernelDensity(const fvec &data, float sigma, float minv, float maxv, int bins)
 {
-    fvec density(bins,0);
-    if(!data.size() || sigma==0 || sigma != sigma) return density;
+    if(!data.size() || sigma==0 || sigma != sigma) return fvec(bins,0);
     const int count = data.size();
-    double scale = 1 / sqrt(2*M_PI);
-    double h = sigma*pow(4./3.,0.2)*pow(count,-0.2);
-    FOR(i, bins)
-    {
-        double iV = double(i)/bins*(maxv-minv) + minv;
-        double x = 0;
-        FOR(j, count)
-        {
-            double a = (data[j]-iV) / h;
-            double k = exp(-0.5*a*a)*scale;
-            x += k;
-        }
-        density[i] = x / (count*h);
-    }
-    return density;
+    double h = KernelBandwidth(sigma, count);
+    KernelDensityGrid grid;
+    if(!KernelDensityGridSetup(grid, h, count, minv, maxv, bins)) return KernelDensityDirect(&data[0], count, h, minv, maxv, bins);
+    KernelDensityGridBin(grid, &data[0], count);
+    return KernelDensityGridConvolve(grid, count, bins);
 }
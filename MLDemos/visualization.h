@@ -38,7 +38,7 @@ private:
     QPixmap GetRadialPixmap(std::map<int,std::vector< std::pair<fvec,fvec> > > classGraphData, int inputType, int dim, int classCount, int index, int w, int h, fvec mins, fvec maxes);
     fvec BoxPlot(fvec data);
     fvec Density(fvec data, float minv, float maxv, int bins=11);
-    fvec KernelDensity(fvec data, float sigma, float minv, float maxv, int bins=31);
+    fvec KernelDensity(const fvec &data, float sigma, float minv, float maxv, int bins=31);
 public:
     explicit Visualization(Canvas *canvas, QWidget *parent = 0);
     ~Visualization();
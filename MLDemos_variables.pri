@@ -81,6 +81,15 @@ win32{
 # Boost
     CONFIG += boost
 
+# OpenMP : used to parallelize the heavier loops (the code runs serially without it)
+    CONFIG += openmp
+
+# zlib : compressed (v7) MATLAB files in the MatImport plugin
+!win32: CONFIG += zlib
+
+# HDF5 : MATLAB v7.3 files in the MatImport plugin
+#    CONFIG += hdf5
+
 ############################################
 # PATHS for the BOOST and OPENCV libraries #
 ############################################
@@ -223,6 +232,27 @@ CONFIG(boost){
     }
 }
 
+# ZLIB
+CONFIG(zlib){
+    DEFINES += MLDEMOS_ZLIB
+    LIBS += -lz
+}
+
+# HDF5
+CONFIG(hdf5){
+    DEFINES += MLDEMOS_HDF5
+    LIBS += -lhdf5
+}
+
+# OPENMP
+CONFIG(openmp){
+    win32-g++|unix:!macx{
+        QMAKE_CXXFLAGS += -fopenmp
+        QMAKE_CFLAGS += -fopenmp
+        LIBS += -fopenmp
+    }
+}
+
 ###############
 # Misc. stuff #
 ###############
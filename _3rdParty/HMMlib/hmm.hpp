@@ -259,7 +259,8 @@ namespace hmmlib {
     const HMMMatrix<float_type, sse_float_type> &T = *trans_prob;
     const HMMMatrix<float_type, sse_float_type> &E = *emission_prob;
 		
-    HMMMatrix<float_type, sse_float_type> &T_t = *(new HMMMatrix<float_type, sse_float_type>(T.get_no_columns(), T.get_no_rows()));
+    boost::shared_ptr<HMMMatrix<float_type, sse_float_type> > T_t_ptr(new HMMMatrix<float_type, sse_float_type>(T.get_no_columns(), T.get_no_rows()));
+    HMMMatrix<float_type, sse_float_type> &T_t = *T_t_ptr;
     T.transpose(T_t);
 		
     const int length = obsseq.size();
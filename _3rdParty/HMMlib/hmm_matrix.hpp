@@ -96,7 +96,7 @@ namespace hmmlib {
   template<typename float_type, typename sse_float_type>
   inline HMMMatrix<float_type, sse_float_type> &
   HMMMatrix<float_type, sse_float_type>::operator=(float_type val) {
-    reset(val);
+    this->reset(val);
     return *this;
   }
 
@@ -53,6 +53,10 @@
 /* A null Jacobi rotation for the whitening is smaller than
    RELATIVE_W_THRESHOLD/sqrt(T) where T is the number of samples */
 
+#define PARALLEL_MIN_SAMPLES 256
+/* Below this many samples the loops over T run serially: starting a thread
+   team costs more than the work, e.g. when projecting one sample at a time */
+
 
 void OutOfMemory() 
 {
@@ -111,8 +115,11 @@ double NonIdentity (double *Mat, int p)
 
 
 /* X=Trans*X : computes IN PLACE the transformation X=Trans*X.  X: nxT, Trans: nxn */
+/* The columns are independent: they are shared among the threads */
 void Transform (double *X, double *Trans, int n, int T)  
 {
+#pragma omp parallel if(T >= PARALLEL_MIN_SAMPLES)
+  {
   double *Tx ; /* buffer for a column vector */
   int i,s,t ;
   int Xind, Xstart, Xstop ;
@@ -121,6 +128,7 @@ void Transform (double *X, double *Trans, int n, int T)
   Tx = (double *) calloc(n, sizeof(double)) ; 
   if (Tx == NULL) OutOfMemory() ;
 
+#pragma omp for schedule(static)
   for (t=0; t<T; t++)
     {
       Xstart = t * n ;
@@ -139,23 +147,43 @@ void Transform (double *X, double *Trans, int n, int T)
 	X[Xind]=Tx[i] ;
     }
   free(Tx) ;
+  }
 }
 
 
+/* Moment estimations below: each thread accumulates the moments of a chunk of
+   samples in its own buffer, and the buffers are summed at the end */
+
 void EstCovMat(double *R, double *A, int m, int T)
 {
-  int i, j, t ;
-  double *x ;
+  int i, j ;
   double ust = 1.0 / (double) T ;
 
   for (i=0; i<m; i++)
     for (j=i; j<m; j++)
       R[i+j*m] = 0.0 ;
   
-  for (t=0, x=A; t<T; t++, x+=m)
+#pragma omp parallel private(i,j) if(T >= PARALLEL_MIN_SAMPLES)
+  {
+    int t ;
+    double *x ;
+    double *Rt = (double *) calloc(m*m, sizeof(double)) ;
+    if (Rt == NULL) OutOfMemory() ;
+
+#pragma omp for schedule(static)
+    for (t=0; t<T; t++) {
+      x = A + t*m ;
+      for (i=0; i<m; i++)
+	for (j=i; j<m; j++)
+	  Rt[i+j*m] += x[i]* x[j]; 
+    }
+
+#pragma omp critical
     for (i=0; i<m; i++)
       for (j=i; j<m; j++)
-	R[i+j*m] += x[i]* x[j]; 
+	R[i+j*m] += Rt[i+j*m] ;
+    free(Rt) ;
+  }
   
   for (i=0; i<m; i++)
     for (j=i; j<m; j++) {
@@ -381,47 +409,66 @@ void ComputeWhitener (double *W, double *X, int n, int T)
 /* X: nxT, C: nxnxn.  Computes a stack of n cumulant matrices.  */
 void EstCumMats ( double *C, double *X, int n, int T) 
 {
-  double *x  ; /* pointer to a data vector in the data matrix  */
-  double *tm ; /* temp matrix */
   double *R  ; /* EXX' : WE DO NOT ASSUME WHITE DATA */
 
-  double xk2, xijkk, xij ;
+  double xijkk, xij ;
   double ust = 1.0 / (float) T ; 
 
   int n2 = n*n ;
   int n3 = n*n*n ;
-  int i,j,k,t, kdec, index ;
+  int i,j,k, kdec ;
 
   Message0(3, "Memory allocation and reset...\n");
-  tm = (double *) calloc(n*n, sizeof(double)) ; 
   R  = (double *) calloc(n*n, sizeof(double)) ; 
 
-  if (tm == NULL || R == NULL) OutOfMemory() ;
+  if (R == NULL) OutOfMemory() ;
 
   for (i=0; i<n3; i++) C[i] = 0.0 ;
   for (i=0; i<n2; i++) R[i] = 0.0 ;
 
   Message0(3, "Computing some moments...\n");
-  for (t=0, x=X; t<T; t++, x+=n)
-    {
-      for (i=0; i<n; i++)   /* External product (and accumulate for the covariance)  */
-	for (j=i; j<n; j++) /* We do not set the symmetric parts yet */
+#pragma omp parallel private(i,j,k,kdec,xij) if(T >= PARALLEL_MIN_SAMPLES)
+  {
+    double *x  ; /* pointer to a data vector in the data matrix  */
+    double xk2 ;
+    int t, index ;
+    double *tm = (double *) calloc(n*n, sizeof(double)) ; /* temp matrix */
+    double *Rt = (double *) calloc(n*n, sizeof(double)) ;
+    double *Ct = (double *) calloc(n*n*n, sizeof(double)) ;
+    if (tm == NULL || Rt == NULL || Ct == NULL) OutOfMemory() ;
+
+#pragma omp for schedule(static)
+    for (t=0; t<T; t++)
+      {
+        x = X + t*n ;
+        for (i=0; i<n; i++)   /* External product (and accumulate for the covariance)  */
+	  for (j=i; j<n; j++) /* We do not set the symmetric parts yet */
+	    {
+	      xij        = x[i]*x[j] ;
+	      tm[i+j*n]  = xij  ;
+	      Rt[i+j*n] += xij  ;
+	    }
+
+        /* Accumulate */
+        for (k=0; k<n; k++)
 	  {
-	    xij        = x[i]*x[j] ;
-	    tm[i+j*n]  = xij  ;
-	    R[i+j*n]  += xij  ;
+	    xk2  = tm[k+k*n] ;       /* x_k^2 */
+	    kdec = k*n2 ;            /* pre_computed shift to address the k-th matrx */
+	    for (i=0; i<n; i++)
+	      for (j=i, index=i+i*n; j<n; j++, index+=n)
+	        Ct[index+kdec] += xk2 * tm[index] ; /* filling the lower part is postponed  */
 	  }
+      }
 
-      /* Accumulate */
-      for (k=0; k<n; k++)
-	{
-	  xk2  = tm[k+k*n] ;       /* x_k^2 */
-	  kdec = k*n2 ;            /* pre_computed shift to address the k-th matrx */
-	  for (i=0; i<n; i++)
-	    for (j=i, index=i+i*n; j<n; j++, index+=n)
-	      C[index+kdec] += xk2 * tm[index] ; /* filling the lower part is postponed  */
-	}
+#pragma omp critical
+    {
+      for (i=0; i<n2; i++) R[i] += Rt[i] ;
+      for (i=0; i<n3; i++) C[i] += Ct[i] ;
     }
+    free(tm) ;
+    free(Rt) ;
+    free(Ct) ;
+  }
   
   
   Message0(3, "From moments to cumulants...\n");  
@@ -445,7 +492,6 @@ void EstCumMats ( double *C, double *X, int n, int T)
 	C[i+j*n+kdec] = xijkk ;
 	C[j+i*n+kdec] = xijkk ;
       }
-  free(tm) ;
   free(R) ;
 }
 
@@ -457,9 +503,11 @@ void EstCumTens ( double *C, double *X, int n, int T)
   int n2 = n*n ;
   int n3 = n*n*n ;
   int n4 = n*n*n*n ;
-  int i,j,k,l,t ;
-  double Cijkl, xi, xij, xijk, *x ;
+  int i,j,k,l ;
+  double Cijkl ;
   double ust = 1.0 / (float) T ; 
+  /* number of moments with i<=j<=k<=l, accumulated in this order */
+  int npacked = n*(n+1)*(n+2)*(n+3)/24 ;
 
   double *R = (double *) calloc(n*n, sizeof(double)) ; 
   /* To store Cov(x).  Recomputed: no whiteness assumption here*/
@@ -468,12 +516,47 @@ void EstCumTens ( double *C, double *X, int n, int T)
   for (i=0; i<n4; i++) C[i] = 0.0 ;
   for (i=0; i<n2; i++) R[i] = 0.0 ;
 
-  Message0(3, "Computing 2nd order cumulants...\n"); 
-  /* accumulation */
-  for(t=0, x=X; t<T; t++, x+=n)
-    for (i=0; i<n; i++)
-      for (j=i; j<n; j++)
-	  R[i+j*n] += x[i] * x[j] ;
+  Message0(3, "Computing 2nd and 4th order moments...\n"); 
+#pragma omp parallel private(i,j,k,l) if(T >= PARALLEL_MIN_SAMPLES)
+  {
+    int t, p ;
+    double xi, xij, xijk, *x ;
+    double *Rt = (double *) calloc(n*n, sizeof(double)) ;
+    double *Mt = (double *) calloc(npacked, sizeof(double)) ;
+    if (Rt == NULL || Mt == NULL) OutOfMemory() ;
+
+    /* accumulation */
+#pragma omp for schedule(static)
+    for(t=0; t<T; t++) {
+      x = X + t*n ;
+      for (i=0; i<n; i++)
+        for (j=i; j<n; j++)
+	  Rt[i+j*n] += x[i] * x[j] ;
+      for (i=0, p=0; i<n; i++) {
+        xi = x[i] ;
+        for (j=i; j<n; j++) {
+	  xij = xi *x[j] ;
+	  for (k=j; k<n; k++) {
+	    xijk = xij*x[k] ;
+	    for (l=k; l<n; l++, p++) 
+	      Mt[p] += xijk*x[l];
+	  }
+        }
+      }
+    }
+
+#pragma omp critical
+    {
+      for (i=0; i<n2; i++) R[i] += Rt[i] ;
+      for (i=0, p=0; i<n; i++)
+        for (j=i; j<n; j++)
+	  for (k=j; k<n; k++)
+	    for (l=k; l<n; l++, p++)
+	      MC(i,j,k,l) += Mt[p] ;
+    }
+    free(Rt) ;
+    free(Mt) ;
+  }
   /* normalization and symmetrization */
   for (i=0; i<n; i++)
     for (j=i; j<n; j++) {
@@ -481,20 +564,6 @@ void EstCumTens ( double *C, double *X, int n, int T)
       R[j+i*n] = R[i+j*n] ;
     }
   
-  Message0(3, "Computing 4th order cumulants...\n");
-  /* accumulation */
-  for(t=0, x=X; t<T; t++, x+=n)
-    for (i=0; i<n; i++) {
-      xi = x[i] ;
-      for (j=i; j<n; j++) {
-	xij = xi *x[j] ;
-	for (k=j; k<n; k++) {
-	  xijk = xij*x[k] ;
-	  for (l=k; l<n; l++) 
-	    MC(i,j,k,l) += xijk*x[l];
-	}
-      }
-    }
   /* normalization, mom2cum, and symmetrization */
   for (i=0; i<n; i++) 
     for (j=i; j<n; j++) 
@@ -54,6 +54,8 @@ Optimizer::Optimizer(int NVAR, int NCONS, Eigen::VectorXd LOWERBOUND, Eigen::Vec
 	m_indexInit = 0;
     m_filenameInit = 0;
 	data = 0;
+	m_batchModel = 0;
+	m_batchData = 0;
 }
 
 Optimizer::~Optimizer() {
@@ -153,6 +155,12 @@ bool Optimizer::loadFirstGuessSolutionFromFile(int nvar, string name, Eigen::Mat
 	return flagread;
 }
 
+void Optimizer::setBatchModel(void (*model)(int count, int dim, double **x, double *y, void *userData), void *userData)
+{
+	m_batchModel = model;
+	m_batchData = userData;
+}
+
 void Optimizer::SetData(float *data, int w, int h)
 {
 	this->data = data;
@@ -194,6 +202,16 @@ void Optimizer::evaluateParticles(const int iternumber, const bool useOpenMP, in
 {
 	if(!swarm || !Jswarm || !Cswarm) return;
 
+	if(m_batchModel && constraintCount == 0 && objectiveCount == 1)
+	{
+		double *values = new double[swarmsize];
+		m_batchModel(swarmsize, dim, swarm, values, m_batchData);
+		for(int i=0;i<swarmsize;i++) Jswarm[i][0] = values[i];
+		modelEvaluationsCount += swarmsize;
+		delete [] values;
+		return;
+	}
+
 	Eigen::VectorXd var(dim), objconst(objectiveCount+constraintCount);
 	int chunk=1; double penalty=0;
 
@@ -68,6 +68,9 @@ public:
 
 	// model: function that returns the objective values and the constraints values (or violation depends on the algorithm used)
 	void setModel(Eigen::VectorXd (*model)(Eigen::VectorXd& x));
+	// batch model: evaluates the whole swarm (count x dim) in a single call, fills the objective values y (count)
+	// only used for unconstrained single-objective problems, it takes precedence over the data map and m_model
+	void setBatchModel(void (*model)(int count, int dim, double **x, double *y, void *userData), void *userData);
 	void setProblemName( string name);
 	void setPrintLevel(int i);
 	void setInitialization(int init, char* file_name = 0, int index = 0){initType = init; m_filenameInit = file_name; m_indexInit = index; }
@@ -104,6 +107,8 @@ protected:
 	Eigen::VectorXd m_bestFeasible; // best feasible solution if m_feasibleOnly option is on
 	float *data;
 	int dataW, dataH;
+	void (*m_batchModel)(int count, int dim, double **x, double *y, void *userData);
+	void *m_batchData;
 
 	int opt_print_level;		//0: no info messages printed on console, the final results are saved in the files; 1: optimization results printed on console and saved to files; 2: iteration results printed on console and to files; 3: iteration and initialization results print
 	int initType;		// = 0: random initialization, = 1: initialization from a given solution, = 2: initialization from a given file
@@ -32,6 +32,7 @@
 
 
 #include <cstdlib>
+#include <algorithm>
 
 //extern "C" {
 
@@ -294,6 +295,36 @@ public :
         fgmm_regression(c_reg,input,output,covar);
 	};
 
+	/**
+   * Perform the regression on count input points at once : 
+   * the points are split in blocks shared among threads, each 
+   * with its own regression workspace. 
+   *
+   * @param inputs : count x ninput array (row order) 
+   * @param outputs : alloc'd count x (dim-ninput) array 
+   * @param covar : alloc'd array for count covariances, or NULL
+   */
+	void doRegressionBatch(const _fgmm_real * inputs, int count, _fgmm_real * outputs, _fgmm_real * covar=NULL)
+	{
+		int noutput = dim - ninput;
+		int covarSize = noutput*(noutput+1)/2;
+		int blockCount = (count + FGMM_REG_BLOCK - 1) / FGMM_REG_BLOCK;
+#pragma omp parallel if(blockCount > 1)
+		{
+			struct fgmm_reg_ws * ws = NULL;
+			fgmm_regression_ws_alloc(&ws, c_reg);
+#pragma omp for schedule(dynamic)
+			for(int b=0; b<blockCount; b++)
+			{
+				int start = b*FGMM_REG_BLOCK;
+				int length = std::min(FGMM_REG_BLOCK, count - start);
+				fgmm_regression_batch(c_reg, ws, inputs + start*ninput, length, outputs + start*noutput,
+									  covar ? covar + start*covarSize : NULL);
+			}
+			fgmm_regression_ws_free(&ws);
+		}
+	};
+
 
 	/**
    * Conditional sampling from the model : 
@@ -355,6 +355,42 @@ void fgmm_regression_init(struct fgmm_reg * reg);
 void fgmm_regression(struct fgmm_reg * reg, const _fgmm_real * inputs, 
 		     _fgmm_real * outputs, _fgmm_real * covar);
 
+/**
+ * scratch memory for the regression. fgmm_regression uses the one 
+ * held by the regression structure, so it can't be called from several 
+ * threads at once. The _ws variants below take the workspace from the 
+ * caller instead : with one workspace per thread, the same regression 
+ * can be queried concurrently. 
+ */
+struct fgmm_reg_ws;
+
+void fgmm_regression_ws_alloc(struct fgmm_reg_ws ** ws, struct fgmm_reg * reg);
+
+void fgmm_regression_ws_free(struct fgmm_reg_ws ** ws);
+
+/**
+ * does the regression, using the workspace ws 
+ */
+void fgmm_regression_ws(struct fgmm_reg * reg, struct fgmm_reg_ws * ws,
+			const _fgmm_real * inputs, 
+			_fgmm_real * outputs, _fgmm_real * covar);
+
+/**
+ * inputs evaluated together against each gaussian in fgmm_regression_batch
+ */
+#define FGMM_REG_BLOCK 64
+
+/**
+ * does the regression on count inputs at once 
+ * @param inputs : count x input_len table (row order) 
+ * @param outputs : count x output_len table, alloc'd by user 
+ * @param covar : count covariances (symetric matrix order), alloc'd 
+ *                by user, or NULL 
+ */
+void fgmm_regression_batch(struct fgmm_reg * reg, struct fgmm_reg_ws * ws,
+			   const _fgmm_real * inputs, int count,
+			   _fgmm_real * outputs, _fgmm_real * covar);
+
 
 /**
  * Conditional sampling
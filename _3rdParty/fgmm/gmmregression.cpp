@@ -27,6 +27,51 @@
 #include <assert.h>
 #include "regression.h"
 
+/* output covariance of one gaussian, 
+   Sigma^ii - (Sigma^i0) (Sigma^00)-1 (Sigma^0i), which does not depend on the input */
+static void fgmm_regression_covar_g(struct gaussian_reg * gr)
+{
+	int i,j,k,off;
+	_fgmm_real element;
+	_fgmm_real * tmp = gr->reg->vec1;
+	_fgmm_real * tmp2 = gr->reg->vec2;
+	_fgmm_real * covar = gr->reg_covar;
+
+	k=0;
+	for(i=0;i<gr->reg->output_len;i++)
+    {
+		for(j=i;j<gr->reg->output_len;j++)
+		{
+			covar[k] = smat_get_value(gr->gauss->covar,
+									  gr->reg->output_dim[i] ,
+									  gr->reg->output_dim[j]);
+			k++;
+		}
+    }
+
+	for(i=0 ; i<gr->reg->output_len ; i++)
+	{
+
+		for(j=0;j<gr->reg->input_len;j++)
+			tmp[j] = gr->reg_matrix[i*gr->reg->input_len+j];
+
+		smat_tforward(gr->subgauss->covar_cholesky,tmp,tmp2);
+		smat_tbackward(gr->subgauss->covar_cholesky,tmp2,tmp);
+
+		element = 0.;
+		off = 0;
+
+		for(j=0;j<(i+1);j++)
+		{
+			for(k=0;k<gr->reg->input_len;k++) // scalar product here
+				element += gr->reg_matrix[i*gr->reg->input_len + k]*tmp[k];
+			// column wise filling ..
+			covar[i+off] -= element;
+			off += (gr->reg->output_len - j - 1);
+		}
+	}
+}
+
 void fgmm_regression_init_g(struct gaussian_reg * gr)
 {
 	int i,j;
@@ -48,6 +93,10 @@ void fgmm_regression_init_g(struct gaussian_reg * gr)
 																		gr->reg->input_dim[i]);
 		}
     }
+	if(gr->reg_covar != NULL)
+		free(gr->reg_covar);
+	gr->reg_covar = (_fgmm_real*) malloc(sizeof(_fgmm_real) * gr->reg->covar_size);
+	fgmm_regression_covar_g(gr);
 	//dump(gr->subgauss);
 }
 
@@ -70,15 +119,10 @@ void fgmm_regression_gaussian(struct gaussian_reg* gr,
 	/*_fgmm_real result[gr->output_len];*/
 	int j=0,i=0;
 	_fgmm_real  * tmp, * tmp2;
-	_fgmm_real element;
-	int off,k;
 
 	tmp = gr->reg->vec1;
 	tmp2 = gr->reg->vec2;
 
-	/* OPT : this computation is also done for the
-     subgauss pdf (ie weight of the gaussian in the regression .. */
-
 	for(;i<gr->reg->input_len;i++)
 		tmp[i] = inputs[i] - gr->subgauss->mean[i];
 
@@ -94,41 +138,146 @@ void fgmm_regression_gaussian(struct gaussian_reg* gr,
 		}
     }
 
-	k=0;
-	for(i=0;i<result->covar->dim;i++)
-    {
-		for(j=i;j<result->covar->dim;j++)
-		{
-			result->covar->_[k] = smat_get_value(gr->gauss->covar,
-												 gr->reg->output_dim[i] ,
-												 gr->reg->output_dim[j]);
-			k++;
-		}
-    }
+	for(i=0;i<result->covar->_size;i++)
+		result->covar->_[i] = gr->reg_covar[i];
+}
 
-	for(i=0 ; i<gr->reg->output_len ; i++)
+void fgmm_regression_ws_alloc(struct fgmm_reg_ws ** ws, struct fgmm_reg * reg)
+{
+	struct fgmm_reg_ws * w = (struct fgmm_reg_ws *) malloc(sizeof(struct fgmm_reg_ws));
+	w->vec1 = (_fgmm_real *) malloc(sizeof(_fgmm_real) * reg->input_len);
+	w->vec2 = (_fgmm_real *) malloc(sizeof(_fgmm_real) * reg->input_len);
+	w->weights = (_fgmm_real *) malloc(sizeof(_fgmm_real) * reg->model->nstates * FGMM_REG_BLOCK);
+	w->likelihood = (_fgmm_real *) malloc(sizeof(_fgmm_real) * FGMM_REG_BLOCK);
+	*ws = w;
+}
+
+void fgmm_regression_ws_free(struct fgmm_reg_ws ** ws)
+{
+	struct fgmm_reg_ws * w = *ws;
+	if(w == NULL) return;
+	free(w->vec1);
+	free(w->vec2);
+	free(w->weights);
+	free(w->likelihood);
+	free(w);
+	*ws = NULL;
+}
+
+/* regression of at most FGMM_REG_BLOCK inputs. The inputs go through 
+   each gaussian in turn, so that its parameters stay in cache */
+static void fgmm_regression_block(struct fgmm_reg * reg, struct fgmm_reg_ws * ws,
+								  const _fgmm_real * inputs, int count,
+								  _fgmm_real * result, _fgmm_real * covar)
+{
+	int in_len = reg->input_len;
+	int out_len = reg->output_len;
+	int state,n,i,j;
+	_fgmm_real dist, weight, weight2;
+	_fgmm_real * tmp = ws->vec1;
+	_fgmm_real * tmp2 = ws->vec2;
+	_fgmm_real * pichol;
+
+	for(i=0;i<count*out_len;i++)
+		result[i] = 0;
+	if(covar != NULL)
 	{
+		for(i=0;i<count*reg->covar_size;i++)
+			covar[i] = 0.;
+	}
+	for(n=0;n<count;n++)
+		ws->likelihood[n] = 0;
 
-		for(j=0;j<gr->reg->input_len;j++)
-			tmp[j] = gr->reg_matrix[i*gr->reg->input_len+j];
+	for(state=0;state<reg->model->nstates;state++)
+    {
+		struct gaussian_reg * gr = &reg->subgauss[state];
+		struct gaussian * sub = gr->subgauss;
+		for(n=0;n<count;n++)
+		{
+			const _fgmm_real * x = inputs + n*in_len;
+			_fgmm_real * out = result + n*out_len;
+			// weight of the gaussian, as gaussian_pdf (smat_sesq) but without allocating
+			pichol = sub->icovar_cholesky->_;
+			for(i=0;i<in_len;i++)
+				tmp2[i] = 0;
+			dist = 0;
+			for(i=0;i<in_len;i++)
+			{
+				tmp2[i] += x[i] - sub->mean[i];
+				tmp2[i] *= *pichol++;
+				for(j=i+1;j<in_len;j++)
+					tmp2[j] -= (*pichol++)*tmp2[i];
+				dist += tmp2[i]*tmp2[i];
+			}
+			weight = expf(-.5*dist)*sub->nfactor;
+			if(weight == 0) weight = FLT_MIN;
 
-		smat_tforward(gr->subgauss->covar_cholesky,tmp,tmp2);
-		smat_tbackward(gr->subgauss->covar_cholesky,tmp2,tmp);
+			for(i=0;i<in_len;i++)
+				tmp[i] = x[i] - sub->mean[i];
+			smat_tforward(sub->covar_cholesky,tmp,tmp2);
+			smat_tbackward(sub->covar_cholesky,tmp2,tmp);
 
-		element = 0.;
-		off = 0;
+			for(i=0;i<out_len;i++)
+			{
+				_fgmm_real mean = gr->gauss->mean[reg->output_dim[i]];
+				for(j=0;j<in_len;j++)
+					mean += gr->reg_matrix[i*in_len + j]*tmp[j];
+				out[i] += weight * mean;
+			}
+			ws->weights[state*FGMM_REG_BLOCK + n] = weight;
+			ws->likelihood[n] += weight;
+		}
+    }
 
-		for(j=0;j<(i+1);j++)
+	for(n=0;n<count;n++)
+	{
+		_fgmm_real likelihood = ws->likelihood[n];
+		_fgmm_real * out = result + n*out_len;
+		if(likelihood > FLT_MIN)
 		{
-			for(k=0;k<gr->reg->input_len;k++) // scalar product here
-				element += gr->reg_matrix[i*gr->reg->input_len + k]*tmp[k];
-			// column wise filling ..
-			result->covar->_[i+off] -= element;
-			off += (gr->reg->output_len - j - 1);
+			if(covar != NULL)
+			{
+				_fgmm_real * c = covar + n*reg->covar_size;
+				for(state=0;state<reg->model->nstates;state++)
+				{
+					weight2 = ws->weights[state*FGMM_REG_BLOCK + n] / likelihood;
+					weight2 *= weight2;
+					for(i=0;i<reg->covar_size;i++)
+						c[i] += weight2 * reg->subgauss[state].reg_covar[i];
+				}
+			}
+			for(i=0;i<out_len;i++)
+				out[i] /= likelihood;
+		}
+		else
+		{
+			for(i=0;i<out_len;i++) out[i] = 0;
 		}
 	}
 }
 
+void fgmm_regression_batch(struct fgmm_reg * reg, struct fgmm_reg_ws * ws,
+						   const _fgmm_real * inputs, int count,
+						   _fgmm_real * result, _fgmm_real * covar)
+{
+	int start, len;
+	if(!reg || !ws || !inputs ) return;
+	for(start=0;start<count;start+=FGMM_REG_BLOCK)
+	{
+		len = count - start < FGMM_REG_BLOCK ? count - start : FGMM_REG_BLOCK;
+		fgmm_regression_block(reg, ws, inputs + start*reg->input_len, len,
+							  result + start*reg->output_len,
+							  covar != NULL ? covar + start*reg->covar_size : NULL);
+	}
+}
+
+void fgmm_regression_ws(struct fgmm_reg * reg, struct fgmm_reg_ws * ws,
+						const _fgmm_real * inputs,
+						_fgmm_real * result, _fgmm_real * covar)
+{
+	fgmm_regression_batch(reg, ws, inputs, 1, result, covar);
+}
+
 /** use a fgmm_ref struct to perform regression 
  * result and covare stores resulting mean and covariance (covariance 
  * is in magic smat order .. 
@@ -141,56 +290,8 @@ void fgmm_regression(struct fgmm_reg * reg,
 					 _fgmm_real * result, // outputs    (reg->output_len) /!\ alloc'd by user
 					 _fgmm_real * covar)  // out covar  (reg->output_len ** 2/2)  /!\ alloc'd
 {
-	_fgmm_real weight2 = 0;
-	_fgmm_real likelihood = 0;
-	int state = 0;
-	int i=0;
 	if(!reg || !inputs ) return;
-	for(i=0;i<reg->output_len;i++)
-		result[i] = 0;
-
-	if(covar != NULL)
-    {
-		for(i=0;i<reg->loc_model->covar->_size;i++)
-			covar[i] = 0.;
-    }
-
-	for(;state<reg->model->nstates;state++)
-    {
-		reg->weights[state] = gaussian_pdf(reg->subgauss[state].subgauss,inputs);
-		fgmm_regression_gaussian(&reg->subgauss[state],inputs,reg->loc_model);
-
-		for(i=0;i<reg->output_len;i++)
-			result[i] += reg->weights[state] * reg->loc_model->mean[i];
-		if(covar != NULL)
-		{
-			for(i=0;i<reg->loc_model->covar->_size;i++)
-				reg->covs[state][i] = reg->loc_model->covar->_[i];
-		}
-		likelihood += reg->weights[state];
-    }
-	if(likelihood > FLT_MIN)
-	{
-		if(covar != NULL)
-		{
-			for(state=0;state<reg->model->nstates;state++)
-			{
-				weight2 = reg->weights[state] / likelihood;
-                weight2 *= weight2;
-                for(i=0;i<reg->loc_model->covar->_size;i++)
-                {
-                    covar[i] += weight2 * reg->covs[state][i];
-                }
-			}
-		}
-
-		for(i=0;i<reg->output_len;i++)
-			result[i] /= likelihood;
-	}
-	else
-	{
-		for(i=0;i<reg->output_len;i++) result[i] = 0;
-	}
+	fgmm_regression_batch(reg, reg->ws, inputs, 1, result, covar);
 }
 
 
@@ -225,10 +326,7 @@ void fgmm_regression_alloc(struct fgmm_reg ** regression,
 	// for holding temp results in computations ..
 	reg->vec1 = (_fgmm_real *) malloc(sizeof(_fgmm_real) * input_len);
 	reg->vec2 = (_fgmm_real *) malloc(sizeof(_fgmm_real) * input_len);
-	reg->weights = (_fgmm_real *) malloc(sizeof(_fgmm_real) * gmm->nstates);
-	reg->loc_model = (struct gaussian *) malloc(sizeof(struct gaussian));
-	gaussian_init(reg->loc_model, output_len);
-	reg->covs = (_fgmm_real **) malloc(sizeof(_fgmm_real*) * gmm->nstates);
+	reg->covar_size = output_len * (output_len + 1) / 2;
 
 	reg->subgauss = (struct gaussian_reg*) malloc(sizeof(struct gaussian_reg) * reg->model->nstates);
 	for(;state < reg->model->nstates ; state++)
@@ -236,9 +334,10 @@ void fgmm_regression_alloc(struct fgmm_reg ** regression,
 		reg->subgauss[state].gauss = &gmm->gauss[state];
 		reg->subgauss[state].reg = reg;
 		reg->subgauss[state].reg_matrix = NULL;
+		reg->subgauss[state].reg_covar = NULL;
 		reg->subgauss[state].subgauss = NULL;
-		reg->covs[state] = (_fgmm_real *) malloc(sizeof(_fgmm_real) * reg->loc_model->covar->_size);
     }
+	fgmm_regression_ws_alloc(&reg->ws, reg);
 	*regression = reg;
 }
 
@@ -287,19 +386,17 @@ void fgmm_regression_free(struct fgmm_reg ** regression)
 	free(reg->vec2);
 	for(;g<reg->model->nstates;g++)
     {
-		free(reg->covs[g]);
 		if(reg->subgauss[g].reg_matrix != NULL)
 			free( reg->subgauss[g].reg_matrix );
+		if(reg->subgauss[g].reg_covar != NULL)
+			free( reg->subgauss[g].reg_covar );
 		if(reg->subgauss[g].subgauss != NULL)
 		{
 			gaussian_free(reg->subgauss[g].subgauss);
 			free(reg->subgauss[g].subgauss);
 		}
     }
-	free(reg->covs);
-	free(reg->weights);
-	gaussian_free(reg->loc_model);
-	free(reg->loc_model);
+	fgmm_regression_ws_free(&reg->ws);
 	free( reg->subgauss );
 	free( reg );
 	*regression = NULL;
@@ -32,6 +32,15 @@ struct gaussian_reg {
   struct gaussian * subgauss; // input subgaussian Used to compute the weight of this
   struct fgmm_reg * reg;             // pointer to reg structure holding info on in/out dimensions ..
   _fgmm_real * reg_matrix; // store in->out A matrix 
+  _fgmm_real * reg_covar;  // output covariance, it does not depend on the input 
+};
+
+/* scratch memory for one regression query (or one block of queries) */
+struct fgmm_reg_ws {
+  _fgmm_real * vec1;       // local projection of the input on the current gaussian
+  _fgmm_real * vec2;       // .... for inversion.
+  _fgmm_real * weights;    // weight of each gaussian for each input of the block (nstates * FGMM_REG_BLOCK)
+  _fgmm_real * likelihood; // sum of the weights for each input of the block
 };
 
 
@@ -51,9 +60,8 @@ struct fgmm_reg {
 
   _fgmm_real * vec1; // hold the local projection of input on the current gaussian
   _fgmm_real * vec2; // .... for inversion. 
-  _fgmm_real * weights; // weight of each gaussian
-  struct gaussian * loc_model; // holding reg result for one gaussian
-  _fgmm_real ** covs;          // holding covariances for every gaussian
+  int covar_size;    // size of the output covariance (symmetric matrix order)
+  struct fgmm_reg_ws * ws; // workspace used by fgmm_regression
   
 };
 
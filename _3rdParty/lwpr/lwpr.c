@@ -25,14 +25,6 @@ Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
 #include <string.h>
 #include <stdlib.h>
 
-#if NUM_THREADS > 1
-   #ifdef WIN32
-      #include <windows.h>
-   #else
-      #include <pthread.h> 
-   #endif
-#endif
-
 
 int lwpr_init_model(LWPR_Model *model, int nIn, int nOut, const char *name) {
 
@@ -233,8 +225,21 @@ int lwpr_update(LWPR_Model *model, const double *x, const double *y, double *yp,
    for (i=0;i<model->nIn;i++) model->xn[i]=x[i]/model->norm_in[i];
    for (i=0;i<model->nOut;i++) model->yn[i]=y[i]/model->norm_out[i];   
    
+   if (model->nOut > 1 && NUM_THREADS >= model->nOut) {
+      /* The output dimensions are independent, each one is updated by its
+      ** own thread with its own share of the workspaces */
+      int share = NUM_THREADS / model->nOut;
+#pragma omp parallel for private(ypi,maxw) reduction(|:code)
+      for (i=0;i<model->nOut;i++) {
+         code |= lwpr_aux_update_one(model, i, model->xn, model->yn[i], &ypi, &maxw, model->ws + i*share, share);
+         if (max_w!=NULL) max_w[i]=maxw;
+         if (yp!=NULL) yp[i]=ypi * model->norm_out[i];
+      }
+      return code;
+   }
+   
    for (i=0;i<model->nOut;i++) {
-      code |= lwpr_aux_update_one(model, i, model->xn, model->yn[i], &ypi, &maxw);   
+      code |= lwpr_aux_update_one(model, i, model->xn, model->yn[i], &ypi, &maxw, model->ws, NUM_THREADS);   
       if (max_w!=NULL) max_w[i]=maxw;
       if (yp!=NULL) yp[i]=ypi * model->norm_out[i];
    }
@@ -243,6 +248,48 @@ int lwpr_update(LWPR_Model *model, const double *x, const double *y, double *yp,
 
 
 
+void lwpr_predict_batch(const LWPR_Model *model, int count, const double *x, double cutoff, double *y, double *conf, double *max_w) {
+   int nIn = model->nIn;
+   int nOut = model->nOut;
+   int slice;
+   
+   /* The queries are split in as many slices as there are workspaces, each slice
+   ** normalises its inputs in its own buffer, so that the model stays untouched */
+#pragma omp parallel for if(count > 1)
+   for (slice=0;slice<NUM_THREADS;slice++) {
+      int start = (int) (((long) count * slice) / NUM_THREADS);
+      int end = (int) (((long) count * (slice+1)) / NUM_THREADS);
+      int i,n,dim;
+      LWPR_ThreadData TD;
+      double *xn;
+      
+      if (start >= end) continue;
+      xn = (double *) LWPR_MALLOC(nIn*sizeof(double));
+      if (xn == NULL) continue;
+      
+      TD.model = model;
+      TD.xn = xn;
+      TD.ws = &model->ws[slice];
+      TD.cutoff = cutoff;
+      
+      for (n=start;n<end;n++) {
+         for (i=0;i<nIn;i++) xn[i]=x[n*nIn+i]/model->norm_in[i];
+         for (dim=0;dim<nOut;dim++) {
+            TD.dim = dim;
+            if (conf == NULL) {
+               (void) lwpr_aux_predict_one_T(&TD);
+            } else {
+               (void) lwpr_aux_predict_conf_one_T(&TD);
+               conf[n*nOut+dim] = model->norm_out[dim]*TD.w_sec;
+            }
+            if (max_w!=NULL) max_w[n*nOut+dim] = TD.w_max;
+            y[n*nOut+dim] = model->norm_out[dim]*TD.yn;
+         }
+      }
+      LWPR_FREE(xn);
+   }
+}
+
 #if NUM_THREADS == 1
 /* Predictions (and Jacobians) without multi-threading
 ** We directly use the thread-based functions anyway */
@@ -367,7 +414,8 @@ void lwpr_predict_JH(const LWPR_Model *model, const double *x, double cutoff, do
 #else
 
 /* Multi-threaded predictions (and Jacobians)
-** Each thread is responsible for a complete submodel (output dimension)
+** Each thread is responsible for a complete submodel (output dimension),
+** the threads come from the OpenMP runtime
 */
 void lwpr_predict(const LWPR_Model *model, const double *x, double cutoff, double *y, double *conf, double *max_w) {
    int i,dim;
@@ -375,14 +423,6 @@ void lwpr_predict(const LWPR_Model *model, const double *x, double cutoff, doubl
    
    void *(*predict_func)(void *);
    
-#ifdef WIN32
-   HANDLE thread[NUM_THREADS-1];
-   DWORD ID[NUM_THREADS-1];
-#else
-   pthread_t thread[NUM_THREADS-1];
-   int rc[NUM_THREADS-1];      
-#endif
-
    predict_func = (conf==NULL) ? lwpr_aux_predict_one_T : lwpr_aux_predict_conf_one_T;
  
    for (i=0;i<model->nIn;i++) model->xn[i]=x[i]/model->norm_in[i];
@@ -399,36 +439,13 @@ void lwpr_predict(const LWPR_Model *model, const double *x, double cutoff, doubl
       int todo = model->nOut - dim;
       if (todo > NUM_THREADS) todo=NUM_THREADS;
       
-      for (i=0;i<todo-1;i++) {
+#pragma omp parallel for if(todo > 1)
+      for (i=0;i<todo;i++) {
          TD[i].dim = dim+i;
-#ifdef WIN32
-         thread[i] = CreateThread(NULL,0, predict_func ,&TD[i],0, &ID[i]);
-#else
-         rc[i] = pthread_create(&thread[i], NULL, predict_func , &TD[i]);
-#endif         
-      }      
-      i = todo-1;
-      TD[i].dim = dim + i;
-      (void) predict_func(&TD[i]);
-
-      y[dim+i] = TD[i].yn;
-      if (conf!=NULL) conf[dim+i] = model->norm_out[dim+i] * TD[i].w_sec; 
-      if (max_w!=NULL) max_w[dim+i] = TD[i].w_max;
-
-      for (i=0;i<todo-1;i++) {      
-#ifdef WIN32
-         if (thread[i]!=NULL) {
-            WaitForSingleObject(thread[i],INFINITE);
-            CloseHandle(thread[i]);            
-#else
-         if (rc[i]==0) {
-            pthread_join(thread[i],NULL);
-#endif            
-         } else { 
-            /* Thread could not be started, do its calculations now */         
-            (void) predict_func(&TD[i]);       
-         }
+         (void) predict_func(&TD[i]);
+      }
 
+      for (i=0;i<todo;i++) {
          y[dim+i] = TD[i].yn;
          if (conf!=NULL) conf[dim+i] = model->norm_out[dim+i] * TD[i].w_sec;
          if (max_w!=NULL) max_w[dim+i] = TD[i].w_max;
@@ -439,18 +456,11 @@ void lwpr_predict(const LWPR_Model *model, const double *x, double cutoff, doubl
 }
 
 
+
 void lwpr_predict_J(const LWPR_Model *model, const double *x, double cutoff, double *y, double *J) {
    int i,j,dim;
    LWPR_ThreadData TD[NUM_THREADS];
    
-#ifdef WIN32
-   HANDLE thread[NUM_THREADS-1];
-   DWORD ID[NUM_THREADS-1];
-#else
-   pthread_t thread[NUM_THREADS-1];
-   int rc[NUM_THREADS-1];      
-#endif
-
    for (i=0;i<model->nIn;i++) model->xn[i]=x[i]/model->norm_in[i];
 
    for (i=0;i<NUM_THREADS;i++) {
@@ -465,32 +475,10 @@ void lwpr_predict_J(const LWPR_Model *model, const double *x, double cutoff, dou
       int todo = model->nOut - dim;
       if (todo > NUM_THREADS) todo=NUM_THREADS;
       
-      for (i=0;i<todo-1;i++) {
+#pragma omp parallel for if(todo > 1)
+      for (i=0;i<todo;i++) {
          TD[i].dim = dim+i;
-#ifdef WIN32
-         thread[i] = CreateThread(NULL,0, lwpr_aux_predict_one_J_T ,&TD[i],0, &ID[i]);
-#else
-         rc[i] = pthread_create(&thread[i], NULL, lwpr_aux_predict_one_J_T , &TD[i]);
-#endif         
-      }     
-       
-      i = todo-1;
-      TD[i].dim = dim + i;
-      lwpr_aux_predict_one_J_T(&TD[i]);
-
-      for (i=0;i<todo-1;i++) {      
-#ifdef WIN32
-         if (thread[i]!=NULL) {
-            WaitForSingleObject(thread[i],INFINITE);
-            CloseHandle(thread[i]);
-#else
-         if (rc[i]==0) {
-            pthread_join(thread[i],NULL);
-#endif            
-         } else { 
-            /* Thread could not be started, do its calculations now */
-            lwpr_aux_predict_one_J_T(&TD[i]);       
-         }
+         (void) lwpr_aux_predict_one_J_T(&TD[i]);
       }
       
       for (i=0;i<todo;i++) {
@@ -512,14 +500,6 @@ void lwpr_predict_JcJ(const LWPR_Model *model, const double *x, double cutoff, d
    int i,j,dim;
    LWPR_ThreadData TD[NUM_THREADS];
    
-#ifdef WIN32
-   HANDLE thread[NUM_THREADS-1];
-   DWORD ID[NUM_THREADS-1];
-#else
-   pthread_t thread[NUM_THREADS-1];
-   int rc[NUM_THREADS-1];      
-#endif
-
    for (i=0;i<model->nIn;i++) model->xn[i]=x[i]/model->norm_in[i];
 
    for (i=0;i<NUM_THREADS;i++) {
@@ -534,32 +514,10 @@ void lwpr_predict_JcJ(const LWPR_Model *model, const double *x, double cutoff, d
       int todo = model->nOut - dim;
       if (todo > NUM_THREADS) todo=NUM_THREADS;
       
-      for (i=0;i<todo-1;i++) {
+#pragma omp parallel for if(todo > 1)
+      for (i=0;i<todo;i++) {
          TD[i].dim = dim+i;
-#ifdef WIN32
-         thread[i] = CreateThread(NULL,0, lwpr_aux_predict_one_JcJ_T ,&TD[i],0, &ID[i]);
-#else
-         rc[i] = pthread_create(&thread[i], NULL, lwpr_aux_predict_one_JcJ_T_T , &TD[i]);
-#endif         
-      }     
-       
-      i = todo-1;
-      TD[i].dim = dim + i;
-      lwpr_aux_predict_one_JcJ_T(&TD[i]);
-
-      for (i=0;i<todo-1;i++) {      
-#ifdef WIN32
-         if (thread[i]!=NULL) {
-            WaitForSingleObject(thread[i],INFINITE);
-            CloseHandle(thread[i]);
-#else
-         if (rc[i]==0) {
-            pthread_join(thread[i],NULL);
-#endif            
-         } else { 
-            /* Thread could not be started, do its calculations now */
-            lwpr_aux_predict_one_JcJ_T(&TD[i]);       
-         }
+         (void) lwpr_aux_predict_one_JcJ_T(&TD[i]);
       }
       
       for (i=0;i<todo;i++) {
@@ -586,14 +544,6 @@ void lwpr_predict_JH(const LWPR_Model *model, const double *x, double cutoff, do
    int i,j,dim;
    LWPR_ThreadData TD[NUM_THREADS];
    
-#ifdef WIN32
-   HANDLE thread[NUM_THREADS-1];
-   DWORD ID[NUM_THREADS-1];
-#else
-   pthread_t thread[NUM_THREADS-1];
-   int rc[NUM_THREADS-1];      
-#endif
-
    for (i=0;i<model->nIn;i++) model->xn[i]=x[i]/model->norm_in[i];
 
    for (i=0;i<NUM_THREADS;i++) {
@@ -608,32 +558,10 @@ void lwpr_predict_JH(const LWPR_Model *model, const double *x, double cutoff, do
       int todo = model->nOut - dim;
       if (todo > NUM_THREADS) todo=NUM_THREADS;
       
-      for (i=0;i<todo-1;i++) {
+#pragma omp parallel for if(todo > 1)
+      for (i=0;i<todo;i++) {
          TD[i].dim = dim+i;
-#ifdef WIN32
-         thread[i] = CreateThread(NULL,0, lwpr_aux_predict_one_gH_T ,&TD[i],0, &ID[i]);
-#else
-         rc[i] = pthread_create(&thread[i], NULL, lwpr_aux_predict_one_gH_T , &TD[i]);
-#endif         
-      }     
-       
-      i = todo-1;
-      TD[i].dim = dim + i;
-      lwpr_aux_predict_one_gH_T(&TD[i]);
-
-      for (i=0;i<todo-1;i++) {      
-#ifdef WIN32
-         if (thread[i]!=NULL) {
-            WaitForSingleObject(thread[i],INFINITE);
-            CloseHandle(thread[i]);
-#else
-         if (rc[i]==0) {
-            pthread_join(thread[i],NULL);
-#endif            
-         } else { 
-            /* Thread could not be started, do its calculations now */
-            lwpr_aux_predict_one_gH_T(&TD[i]);       
-         }
+         (void) lwpr_aux_predict_one_gH_T(&TD[i]);
       }
       
       for (i=0;i<todo;i++) {
@@ -316,6 +316,21 @@ void lwpr_predict_JcJ(const LWPR_Model *model, const double *x,
 void lwpr_predict_JH(const LWPR_Model *model, const double *x, 
       double cutoff, double *y, double *J, double *H);      
 
+/** \brief Computes the predictions of an LWPR model for a set of input vectors. The queries
+      are spread over the model's workspaces (and threads, if any), so that this is also faster
+      than repeated calls to lwpr_predict for univariate models.
+   \param[in] model  Must point to a valid LWPR_Model structure
+   \param[in] count  Number of input vectors
+   \param[in] x      Input vectors, must point to an array of <em>count*nIn</em> doubles, one vector after the other
+   \param[in] cutoff A threshold parameter (usually 0.001) as in lwpr_predict
+   \param[out] y     Output vectors, must point to an array of <em>count*nOut</em> doubles
+   \param[out] conf  Confidence bounds per output. Must be NULL or point to an array of <em>count*nOut</em> doubles
+   \param[out] max_w Maximum activation per output. Must be NULL or point to an array of <em>count*nOut</em> doubles
+   \ingroup LWPR_C
+*/
+void lwpr_predict_batch(const LWPR_Model *model, int count, const double *x, 
+      double cutoff, double *y, double *conf, double *max_w);
+
 /** \brief Updates an LWPR model with a given input/output pair (x,y). Optionally
       returns the model's prediction for y and the maximal activation of all receptive fields.
   
@@ -432,6 +432,32 @@ class LWPR_Object {
       lwpr_predict(&model, &x[0], cutoff, &yp[0], &confidence[0], &maxW[0]);
       return yp;
    } 
+
+   /** \brief Computes the predictions of an LWPR model for a set of
+      input vectors, spread over the model's workspaces (and threads).
+      Also computes confidence bounds per output dimension.
+
+      \param[in] X      Input vectors, one after the other (count*nIn elements)
+      \param[out] confidence   Vector to store the confidence bounds (count*nOut elements),
+         will be resized if necessary
+      \param[in] cutoff A threshold parameter (default = 0.001). 
+         Receptive fields with activation below the cutoff are ignored
+      \return    Predicted output vectors, one after the other (count*nOut elements)
+      \exception LWPR_Exception::BAD_INPUT_DIM  
+         if the size of X is not a multiple of the input dimension
+   */
+   doubleVec predictBatch(const doubleVec& X, doubleVec& confidence, double cutoff = 0.001) {
+      if (X.size() % model.nIn) {
+         throw LWPR_Exception(LWPR_Exception::BAD_INPUT_DIM);
+      }      
+      int count = X.size() / model.nIn;
+      doubleVec yp(count * model.nOut);   
+      if (confidence.size()!=yp.size()) confidence.resize(yp.size());
+      if (!count) return yp;
+
+      lwpr_predict_batch(&model, count, &X[0], cutoff, &yp[0], &confidence[0], NULL);
+      return yp;
+   } 
    
    /** \brief Sets a spherical initial distance metric
       \param delta   Width parameter, distance matrix will be delta * eye(nIn)
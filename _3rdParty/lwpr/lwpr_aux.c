@@ -26,14 +26,6 @@ Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
 #include <stdlib.h>
 #include <stdio.h>
 
-#if NUM_THREADS > 1
-   #ifdef WIN32
-      #include <windows.h>
-   #else
-      #include <pthread.h> 
-   #endif
-#endif
-
 void lwpr_aux_dist_derivatives(int nIn,int nInS,double *dwdM, double *dJ2dM, double *ddwdMdM, double *ddJ2dMdM,
          double w, double dwdq, double ddwdqdq, 
          const double *RF_D, const double *RF_M, const double *dx,
@@ -990,70 +982,35 @@ int lwpr_aux_update_one_add_prune(LWPR_Model *model, LWPR_ThreadData *TD, int di
    return 1;   
 }
 
-int lwpr_aux_update_one(LWPR_Model *model, int dim, const double *xn, double yn, double *y_pred, double *max_w) {
+int lwpr_aux_update_one(LWPR_Model *model, int dim, const double *xn, double yn, double *y_pred, double *max_w, LWPR_Workspace *ws, int numWS) {
    LWPR_ThreadData TD[NUM_THREADS];
    int i;
+   
+   /* Splitting the receptive fields only pays off if each slice gets enough of them */
+   int slices = model->sub[dim].numRFS / LWPR_MIN_RFS_PER_THREAD;
+   if (slices > numWS) slices = numWS;
+   if (slices > NUM_THREADS) slices = NUM_THREADS;
+   if (slices < 1) slices = 1;
 
-#if NUM_THREADS > 1
-   #ifdef WIN32
-      HANDLE thread[NUM_THREADS-1];
-      DWORD ID[NUM_THREADS-1];
-   #else
-      pthread_t thread[NUM_THREADS-1];
-      int rc[NUM_THREADS-1];      
-   #endif
-#endif
-
-   for (i=0;i<NUM_THREADS;i++) {
+   for (i=0;i<slices;i++) {
       TD[i].model = model;
       TD[i].dim = dim;
       TD[i].xn = xn;
       TD[i].yn = yn;
-      TD[i].incr = NUM_THREADS;
+      TD[i].incr = slices;
       TD[i].start = i;
       TD[i].end = model->sub[dim].numRFS;
-      TD[i].ws = &model->ws[i];
+      TD[i].ws = &ws[i];
    }
 
-#if NUM_THREADS > 1
-   #ifdef WIN32
-      for (i=0;i<NUM_THREADS-1;i++) {
-         thread[i] = CreateThread(NULL,0,lwpr_aux_update_one_T,&TD[i],0, &ID[i]);
-      }
-   #else
-      for (i=0;i<NUM_THREADS-1;i++) {   
-         rc[i] = pthread_create(&thread[i], NULL, lwpr_aux_update_one_T, &TD[i]);
-      }      
-   #endif
-#endif
-
-   (void) lwpr_aux_update_one_T(&TD[NUM_THREADS-1]);      
-   
-#if NUM_THREADS > 1
-   /* Wait for other threads to finish, or do their calculations if they
-   ** couldn't be spawned in the first place */
-   #ifdef WIN32
-      for (i=0;i<NUM_THREADS-1;i++) {
-         if (thread[i]!=NULL) {
-            WaitForSingleObject(thread[i],INFINITE);
-            CloseHandle(thread[i]);
-         } else {
-            (void) lwpr_aux_update_one_T(&TD[i]);       
-         }
-      }
-   #else
-      for (i=0;i<NUM_THREADS-1;i++) {
-         if (rc[i]==0) {
-            pthread_join(thread[i],NULL);
-         } else {
-            (void) lwpr_aux_update_one_T(&TD[i]);       
-         }
-      }
-   #endif
+#pragma omp parallel for if(slices > 1)
+   for (i=0;i<slices;i++) {
+      (void) lwpr_aux_update_one_T(&TD[i]);
+   }
    
    /* Accumulate statistics in TD[0] */
 
-   for (i=1;i<NUM_THREADS;i++) {
+   for (i=1;i<slices;i++) {
       TD[0].sum_w += TD[i].sum_w;
       TD[0].yp += TD[i].yp;
       if (TD[i].w_max > TD[0].w_max) {
@@ -1081,7 +1038,6 @@ int lwpr_aux_update_one(LWPR_Model *model, int dim, const double *xn, double yn,
          }
       }
    }
-#endif
 
    if (TD[0].sum_w > 0.0) {
       *y_pred = TD[0].yp/TD[0].sum_w;
@@ -1110,6 +1066,8 @@ int lwpr_aux_update_one(LWPR_Model *model, int dim, const double *xn, double yn,
 ** overhead of creating multiple threads per submodel is significant.
 ** On the other hand, updates are rather slow, and we wish to speed up
 ** also models with univariate outputs.
+** Many predictions of a univariate model are best done with lwpr_predict_batch,
+** which spreads the queries over the workspaces.
 */
 void *lwpr_aux_predict_one_T(void *ptr) {
    LWPR_ThreadData *TD = (LWPR_ThreadData *) ptr;
@@ -229,12 +229,14 @@ int lwpr_aux_init_rf(LWPR_ReceptiveField *RF, const LWPR_Model *model,
    \param[in]  yn       Normalised input sample (specific to output dimension "dim")
    \param[out] y_pred   Prediction for yn after update
    \param[out] max_w    Maximum activation over all receptive fields
+   \param[in]  ws       Workspaces the receptive fields can be split over
+   \param[in]  numWS    Number of workspaces in ws
    \return
       - 1 in case of success
       - 0 if a receptive field would have to be added, but memory allocation failed
 */      
 int lwpr_aux_update_one(LWPR_Model *model, int dim, const double *xn, 
-      double yn, double *y_pred, double *max_w);
+      double yn, double *y_pred, double *max_w, LWPR_Workspace *ws, int numWS);
 
 /** \brief Thread function for updating a subset of receptive fields 
    \param[in] ptr    Pointer to an LWPR_ThreadData structure
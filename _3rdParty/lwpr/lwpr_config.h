@@ -11,6 +11,18 @@
    to the desired number of threads. The number of cores in your machine is a good
    starting point, but how much speed improvement you get really depends on the machine,
    its configuration, and the learning task at hand.
+   The threads are taken from OpenMP, NUM_THREADS is the number of workspaces
+   the updates and batched predictions are split over.
    \ingroup LWPR_C
 */   
+#ifdef _OPENMP
+#define NUM_THREADS     8
+#else
 #define NUM_THREADS     1
+#endif
+
+/** Minimum number of receptive fields handled by each thread during an update,
+   below this the threads cost more than they bring.
+   \ingroup LWPR_C
+*/   
+#define LWPR_MIN_RFS_PER_THREAD  16
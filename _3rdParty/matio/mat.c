@@ -1626,6 +1626,203 @@ Mat_VarReadDataLinear(mat_t *mat,matvar_t *matvar,void *data,int start,
     return err;
 }
 
+static double
+GetDoubleElement(matvar_t *matvar,size_t i)
+{
+    void *data = matvar->data;
+
+    if ( matvar->isComplex )
+        data = ((mat_complex_split_t*)data)->Re;
+    switch ( matvar->class_type ) {
+        case MAT_C_DOUBLE: return ((double*)data)[i];
+        case MAT_C_SINGLE: return ((float*)data)[i];
+#ifdef HAVE_MAT_INT64_T
+        case MAT_C_INT64:  return (double)((mat_int64_t*)data)[i];
+#endif /* HAVE_MAT_INT64_T */
+#ifdef HAVE_MAT_UINT64_T
+        case MAT_C_UINT64: return (double)((mat_uint64_t*)data)[i];
+#endif /* HAVE_MAT_UINT64_T */
+        case MAT_C_INT32:  return ((mat_int32_t*)data)[i];
+        case MAT_C_UINT32: return ((mat_uint32_t*)data)[i];
+        case MAT_C_INT16:  return ((mat_int16_t*)data)[i];
+        case MAT_C_UINT16: return ((mat_uint16_t*)data)[i];
+        case MAT_C_INT8:   return ((mat_int8_t*)data)[i];
+        case MAT_C_UINT8:  return ((mat_uint8_t*)data)[i];
+        default:           return 0;
+    }
+}
+
+static void
+BlockToDouble(mat_t *mat,void *raw,enum matio_types data_type,double *data,
+    int count)
+{
+    int i;
+
+#define MAT_BLOCK_CONVERT(T,SWAP) \
+    for ( i = 0; i < count; i++ ) { \
+        T *v = (T*)raw + i; \
+        if ( mat->byteswap ) \
+            (void)SWAP(v); \
+        data[i] = (double)*v; \
+    }
+    switch ( data_type ) {
+        case MAT_T_DOUBLE: MAT_BLOCK_CONVERT(double,Mat_doubleSwap); break;
+        case MAT_T_SINGLE: MAT_BLOCK_CONVERT(float,Mat_floatSwap); break;
+#ifdef HAVE_MAT_INT64_T
+        case MAT_T_INT64:  MAT_BLOCK_CONVERT(mat_int64_t,Mat_int64Swap); break;
+#endif /* HAVE_MAT_INT64_T */
+#ifdef HAVE_MAT_UINT64_T
+        case MAT_T_UINT64: MAT_BLOCK_CONVERT(mat_uint64_t,Mat_uint64Swap); break;
+#endif /* HAVE_MAT_UINT64_T */
+        case MAT_T_INT32:  MAT_BLOCK_CONVERT(mat_int32_t,Mat_int32Swap); break;
+        case MAT_T_UINT32: MAT_BLOCK_CONVERT(mat_uint32_t,Mat_uint32Swap); break;
+        case MAT_T_INT16:  MAT_BLOCK_CONVERT(mat_int16_t,Mat_int16Swap); break;
+        case MAT_T_UINT16: MAT_BLOCK_CONVERT(mat_uint16_t,Mat_uint16Swap); break;
+        case MAT_T_INT8:
+            for ( i = 0; i < count; i++ )
+                data[i] = ((mat_int8_t*)raw)[i];
+            break;
+        case MAT_T_UINT8:
+            for ( i = 0; i < count; i++ )
+                data[i] = ((mat_uint8_t*)raw)[i];
+            break;
+        default:
+            for ( i = 0; i < count; i++ )
+                data[i] = 0;
+            break;
+    }
+#undef MAT_BLOCK_CONVERT
+}
+
+/** @brief Reads the real part of a numeric MAT variable block by block
+ *
+ * Reads the data of a numeric variable in consecutive blocks of at most
+ * @c blocksize elements converted to double, and hands each block over to
+ * @c callback. Compressed variables keep their zlib state from one block to
+ * the next, so that the data is inflated only once and a single block is held
+ * in memory. Version 4 and 7.3 files are read in one go and then handed over
+ * block by block. The variable must have been read by Mat_VarReadInfo or
+ * Mat_VarReadNextInfo.
+ * @ingroup MAT
+ * @param mat MAT file to read data from
+ * @param matvar MAT variable information
+ * @param data buffer of at least @c blocksize doubles
+ * @param blocksize number of elements in a block
+ * @param callback called with the block, the linear index of its first
+ *        element and its length; a non-zero return value stops the reading
+ * @param user pointer handed over to @c callback
+ * @retval 0 on success, 1 on error, 2 if @c callback stopped the reading
+ */
+int
+Mat_VarReadDataBlocks(mat_t *mat,matvar_t *matvar,double *data,int blocksize,
+    int (*callback)(const double *data,size_t start,int count,void *user),
+    void *user)
+{
+    int err = 0, i, count;
+    size_t nmemb = 1, start, j, data_size;
+    enum matio_types data_type;
+    mat_int32_t tag[2];
+    void *raw;
+    long fpos;
+#if defined(HAVE_ZLIB)
+    z_stream z;
+#endif
+
+    if ( (mat == NULL) || (matvar == NULL) || (data == NULL) ||
+         (callback == NULL) || (blocksize < 1) || (mat->fp == NULL) )
+        return 1;
+    if ( (matvar->class_type < MAT_C_DOUBLE) ||
+         (matvar->class_type > MAT_C_UINT64) )
+        return 1;
+
+    for ( i = 0; i < matvar->rank; i++ )
+        nmemb *= matvar->dims[i];
+
+    if ( mat->version != MAT_FT_MAT5 ) {
+        /* Keep the position of the file for Mat_VarReadNextInfo, version
+         * 7.3 files are not FILE pointers but an HDF5 handle */
+        if ( mat->version != MAT_FT_MAT73 ) {
+            fpos = ftell(mat->fp);
+            if ( matvar->data == NULL )
+                ReadData(mat,matvar);
+            fseek(mat->fp,fpos,SEEK_SET);
+        } else if ( matvar->data == NULL ) {
+            ReadData(mat,matvar);
+        }
+        if ( matvar->data == NULL )
+            return 1;
+        for ( start = 0; start < nmemb && !err; start += count ) {
+            count = (nmemb-start < (size_t)blocksize) ? (int)(nmemb-start) : blocksize;
+            for ( j = 0; j < (size_t)count; j++ )
+                data[j] = GetDoubleElement(matvar,start+j);
+            if ( callback(data,start,count,user) )
+                err = 2;
+        }
+        return err;
+    }
+
+    /* The elements of a block are read in their stored type, which is at
+     * most as large as a double, and converted in place */
+    raw = malloc(blocksize*sizeof(double));
+    if ( raw == NULL )
+        return 1;
+    /* Keep the position of the file for Mat_VarReadNextInfo */
+    fpos = ftell(mat->fp);
+
+    fseek(mat->fp,matvar->internal->datapos,SEEK_SET);
+    if ( matvar->compression == MAT_COMPRESSION_NONE ) {
+        fread(tag,4,2,mat->fp);
+        if ( mat->byteswap ) {
+            Mat_int32Swap(tag);
+            Mat_int32Swap(tag+1);
+        }
+        data_type = tag[0] & 0x000000ff;
+        data_size = Mat_SizeOf(data_type);
+        if ( tag[0] & 0xffff0000 ) /* Data is packed in the tag */
+            fseek(mat->fp,-4,SEEK_CUR);
+        for ( start = 0; start < nmemb && !err; start += count ) {
+            count = (nmemb-start < (size_t)blocksize) ? (int)(nmemb-start) : blocksize;
+            if ( fread(raw,data_size,count,mat->fp) != (size_t)count ) {
+                err = 1;
+                break;
+            }
+            BlockToDouble(mat,raw,data_type,data,count);
+            if ( callback(data,start,count,user) )
+                err = 2;
+        }
+#if defined(HAVE_ZLIB)
+    } else if ( matvar->compression == MAT_COMPRESSION_ZLIB ) {
+        matvar->internal->z->avail_in = 0;
+        if ( inflateCopy(&z,matvar->internal->z) != Z_OK ) {
+            free(raw);
+            fseek(mat->fp,fpos,SEEK_SET);
+            return 1;
+        }
+        InflateDataType(mat,&z,tag);
+        if ( mat->byteswap )
+            Mat_int32Swap(tag);
+        data_type = tag[0] & 0x000000ff;
+        data_size = Mat_SizeOf(data_type);
+        if ( !(tag[0] & 0xffff0000) ) /* Data is NOT packed in the tag */
+            InflateDataType(mat,&z,tag+1);
+        for ( start = 0; start < nmemb && !err; start += count ) {
+            count = (nmemb-start < (size_t)blocksize) ? (int)(nmemb-start) : blocksize;
+            InflateData(mat,&z,raw,count*data_size);
+            BlockToDouble(mat,raw,data_type,data,count);
+            if ( callback(data,start,count,user) )
+                err = 2;
+        }
+        inflateEnd(&z);
+#endif
+    } else {
+        err = 1;
+    }
+    free(raw);
+    fseek(mat->fp,fpos,SEEK_SET);
+
+    return err;
+}
+
 /** @brief Reads the information of the next variable in a MAT file
  *
  * Reads the next variable's information (class,flags-complex/global/logical,
@@ -288,6 +288,10 @@ EXTERN int        Mat_VarReadData(mat_t *mat,matvar_t *matvar,void *data,
 EXTERN int        Mat_VarReadDataAll(mat_t *mat,matvar_t *matvar);
 EXTERN int        Mat_VarReadDataLinear(mat_t *mat,matvar_t *matvar,void *data,
                       int start,int stride,int edge);
+EXTERN int        Mat_VarReadDataBlocks(mat_t *mat,matvar_t *matvar,
+                      double *data,int blocksize,
+                      int (*callback)(const double *data,size_t start,
+                      int count,void *user),void *user);
 EXTERN matvar_t  *Mat_VarReadInfo( mat_t *mat, const char *name );
 EXTERN matvar_t  *Mat_VarReadNext( mat_t *mat );
 EXTERN matvar_t  *Mat_VarReadNextInfo( mat_t *mat );
@@ -54,7 +54,9 @@
 #define HAVE_DLFCN_H 1
 
 /* Have HDF5 */
-/* #undef HAVE_HDF5 */
+#ifdef MLDEMOS_HDF5
+#define HAVE_HDF5 1
+#endif
 
 /* Define to 1 if you have the `m' library (-lm). */
 #define HAVE_LIBM 1
@@ -116,8 +118,12 @@
 /* Have vsnprintf */
 #define HAVE_VSNPRINTF /**/
 
-/* Have zlib */
+/* Have zlib (CONFIG += zlib in MLDemos_variables.pri) */
+#ifdef MLDEMOS_ZLIB
+#define HAVE_ZLIB 1
+#else
 #undef HAVE_ZLIB
+#endif
 
 /* Have va_copy */
 /* #undef HAVE___VA_COPY */
@@ -129,8 +135,12 @@
    */
 #define LT_OBJDIR ".libs/"
 
-/* MAT v7.3 file support */
+/* MAT v7.3 file support (CONFIG += hdf5 in MLDemos_variables.pri) */
+#ifdef MLDEMOS_HDF5
+#define MAT73 1
+#else
 #define MAT73 0
+#endif
 
 /* Platform */
 #define MATIO_PLATFORM "x86_64-apple-darwin10.8.0"
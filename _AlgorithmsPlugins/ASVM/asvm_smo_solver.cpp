@@ -23,6 +23,25 @@
 #include "svm.h"
 #include <iomanip>
 
+// err[i] += w1*k1[i] + w2*k2[i] for the free multipliers (0 < x < C), in a single branchless sweep
+static void sweepErrors(double *err, const double *x, const double *k1, const double *k2, double w1, double w2, double C, unsigned int count)
+{
+	for(unsigned int i=0; i<count; i++)
+	{
+		double step = w1*k1[i] + w2*k2[i];
+		err[i] += ((x[i] > 0) & (x[i] < C)) ? step : 0.0;
+	}
+}
+
+static void sweepErrors(double *err, const double *x, const double *k1, double w1, double C, unsigned int count)
+{
+	for(unsigned int i=0; i<count; i++)
+	{
+		double step = w1*k1[i];
+		err[i] += ((x[i] > 0) & (x[i] < C)) ? step : 0.0;
+	}
+}
+
 void ASVM_SMO_Solver::configure(const char* filename)
 {
 	int dum;
@@ -146,14 +165,12 @@ int ASVM_SMO_Solver::learn(asvmdata& input1, unsigned int tclass, asvm* svmobj)
 
 		dlabels[i] = copy_data->labels[i];
 
+	// matkgh is stored as a single block, we keep the same layout
 	ker_matrix = new double*[M+P+N];
-	for(i=0;i<M+P+N;i++)
-	{
-		ker_matrix[i] = new double[M+P+N];
-		for(j=0;j<M+P+N;j++)
-			ker_matrix[i][j] = copy_data->matkgh[i][j];
-
-	}
+	ker_matrix[0] = new double[(M+P+N)*(M+P+N)];
+	memcpy(ker_matrix[0], copy_data->matkgh[0], (M+P+N)*(M+P+N)*sizeof(double));
+	for(i=1;i<M+P+N;i++)
+		ker_matrix[i] = ker_matrix[0] + i*(M+P+N);
 
 	for(i=0;i<M;i++)
 	{
@@ -245,6 +262,15 @@ int ASVM_SMO_Solver::learn(asvmdata& input1, unsigned int tclass, asvm* svmobj)
 	cout<<"Time elapsed    : "<<elapsed<<" sec."<<endl;
 	cout<<"*****************************************************************"<<endl<<endl;
 
+	delete [] ker_matrix[0];
+	delete [] ker_matrix;
+	delete [] err_cache_alpha;
+	delete [] err_cache_beta;
+	delete [] H_ii;
+	delete [] dlabels;
+	delete [] x_smo;
+	delete copy_data;
+
 	if(iter >= max_iter)
 	{
 		cout<<"WARNING: Max iterations exceeded!!"<<endl;
@@ -447,38 +473,15 @@ bool ASVM_SMO_Solver::takeStepForAlpha(unsigned int i1, unsigned int i2, double
 	}
 
 
-	register double *xptr = x_smo;
-	register double *kerptr1 = ker_matrix[i1];
-	register double *kerptr2 = ker_matrix[i2];
-	register double *errptr = err_cache_alpha;
-	register double *errptr2 = err_cache_beta;
+	// i1 and i2 have just been recomputed, the sweeps skip them
 	double theMax = err_cache_alpha[maximum_alpha];
 	double theMin = err_cache_alpha[minimum_alpha];
-	unsigned int i=0;
-	for(;i<M;++i)
-	{
-		if (i!=i1 && i!=i2 && *xptr > 0 && *xptr<Cparam)
-		{
-			*errptr += w1*(*kerptr1) + w2*(*kerptr2);
-			if(*errptr > theMax)
-				maximum_alpha = i;
-			if(*errptr < theMin)
-				minimum_alpha = i;
-		}
-		++xptr;
-		++errptr;
-		++kerptr1;
-		++kerptr2;
-	}
-	for(;i<M+P;++i)
-	{
-		if(*xptr > 0 && *xptr < Cparam)
-			*errptr2 += w1*(*kerptr1) + w2*(*kerptr2);
-		++xptr;
-		++errptr2;
-		++kerptr1;
-		++kerptr2;
-	}
+	double e1 = err_cache_alpha[i1], e2 = err_cache_alpha[i2];
+	sweepErrors(err_cache_alpha, x_smo, ker_matrix[i1], ker_matrix[i2], w1, w2, Cparam, M);
+	sweepErrors(err_cache_beta, x_smo + M, ker_matrix[i1] + M, ker_matrix[i2] + M, w1, w2, Cparam, P);
+	err_cache_alpha[i1] = e1;
+	err_cache_alpha[i2] = e2;
+	updateExtrema(i1, i2, theMin, theMax);
 
 	/*
 	unsigned int i;
@@ -553,35 +556,14 @@ bool ASVM_SMO_Solver::takeStepForBeta(unsigned int i1, double E1)
 	if(beta_new > 0 && beta_new < Cparam)
 		err_cache_beta[i1-M] = forward_beta(i1);
 
-	register double *xptr = x_smo;
-	register double *kerptr1 = ker_matrix[i1];
-	register double *errptr = err_cache_alpha;
-	register double *errptr2 = err_cache_beta;
 	double theMax = err_cache_alpha[maximum_alpha];
 	double theMin = err_cache_alpha[minimum_alpha];
-	unsigned int i=0;
-	for(;i<M;++i)
-	{
-		if (*xptr > 0 && *xptr<Cparam)
-		{
-			*errptr += bdiff*(*kerptr1);
-			if(*errptr > theMax)
-				maximum_alpha = i;
-			if(*errptr < theMin)
-				minimum_alpha = i;
-		}
-		++xptr;
-		++errptr;
-		++kerptr1;
-	}
-	for(;i<M+P;++i)
-	{
-		if ( i!=i1 && *xptr > 0 && *xptr < Cparam )
-			*errptr2 += bdiff*(*kerptr1);
-		++xptr;
-		++errptr2;
-		++kerptr1;
-	}
+	double e1 = err_cache_beta[i1-M];
+	sweepErrors(err_cache_alpha, x_smo, ker_matrix[i1], bdiff, Cparam, M);
+	sweepErrors(err_cache_beta, x_smo + M, ker_matrix[i1] + M, bdiff, Cparam, P);
+	err_cache_beta[i1-M] = e1;
+	updateExtrema(M, M, theMin, theMax);
+
 	/*
 	unsigned int i;
 
@@ -627,22 +609,12 @@ bool ASVM_SMO_Solver::takeStepForGamma(unsigned int i1, double E1)
 
 	x_smo[i1] = gamma_new;
 
-	unsigned int i;
-
-	for(i=0;i<M;i++)
-		if (x_smo[i] > 0 && x_smo[i] < Cparam)
-		{
-			err_cache_alpha[i] += ker_matrix[i][i1]*gdiff;
-
-			if(err_cache_alpha[i] > err_cache_alpha[maximum_alpha])
-			maximum_alpha = i;
-			if(err_cache_alpha[i] < err_cache_alpha[minimum_alpha])
-			minimum_alpha = i;
-		}
-
-	for(i=M;i<M+P;i++)
-		if(x_smo[i] > 0 && x_smo[i] < Cparam)
-			err_cache_beta[i-M] += ker_matrix[i][i1]*gdiff;
+	// the kernel matrix is symmetric, row i1 holds column i1
+	double theMax = err_cache_alpha[maximum_alpha];
+	double theMin = err_cache_alpha[minimum_alpha];
+	sweepErrors(err_cache_alpha, x_smo, ker_matrix[i1], gdiff, Cparam, M);
+	sweepErrors(err_cache_beta, x_smo + M, ker_matrix[i1] + M, gdiff, Cparam, P);
+	updateExtrema(M, M, theMin, theMax);
 
 	return true;
 }
@@ -668,26 +640,29 @@ void ASVM_SMO_Solver::updateB0()
 
 	Bparam = fnc/cnt;
 
-	register double *errptr = err_cache_alpha;
-	xptr = x_smo;
 	double theMax = err_cache_alpha[maximum_alpha];
 	double theMin = err_cache_alpha[minimum_alpha];
-
+	double bdiff = b_old - Bparam;
 	for(i=0;i<M;i++)
-	{
-		if(*xptr > 0 && *xptr < Cparam)
-		{
-			*errptr += b_old - Bparam;
-
-			if(*errptr > theMax)
-				maximum_alpha = i;
-			if(*errptr < theMin)
-				minimum_alpha = i;
-		}
+		err_cache_alpha[i] += ((x_smo[i] > 0) & (x_smo[i] < Cparam)) ? bdiff : 0.0;
+	updateExtrema(M, M, theMin, theMax);
+}
 
-		++xptr;
-		++errptr;
+// the free alpha errors that went beyond the extrema from before the sweep become the new ones (the last one found wins)
+void ASVM_SMO_Solver::updateExtrema(unsigned int skip1, unsigned int skip2, double theMin, double theMax)
+{
+	int newMax = maximum_alpha, newMin = minimum_alpha;
+	for(unsigned int i=0;i<M;i++)
+	{
+		if(i==skip1 || i==skip2 || x_smo[i] <= 0 || x_smo[i] >= Cparam)
+			continue;
+		if(err_cache_alpha[i] > theMax)
+			newMax = i;
+		if(err_cache_alpha[i] < theMin)
+			newMin = i;
 	}
+	maximum_alpha = newMax;
+	minimum_alpha = newMin;
 }
 
 double ASVM_SMO_Solver::forward_alpha(int index)
@@ -717,10 +692,7 @@ double ASVM_SMO_Solver::forward(int index)
 	while(i<M)
 	{
 		tmp = (*kerptr)*(*xptr);
-		if(*dlabptr==1)
-			fval += tmp;
-		else
-			fval -= tmp;
+		fval += (*dlabptr)*tmp;
 		++kerptr;
 		++dlabptr;
 		++xptr;
@@ -86,6 +86,7 @@ private:
 	bool  examineForBeta(unsigned int index);
 	bool  examineForGamma(unsigned int index);
 	void updateB0();
+	void updateExtrema(unsigned int skip1, unsigned int skip2, double theMin, double theMax);
 
 	bool takeStepForAlpha(unsigned int i1, unsigned int i2, double E2);
 	bool takeStepForBeta(unsigned int i1, double E1);
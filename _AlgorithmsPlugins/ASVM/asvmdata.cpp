@@ -1,7 +1,25 @@
 
 #include "asvmdata.h"
+#include <algorithm>
 using namespace std;
 
+// the modulation matrix is a single block, matkgh[i] points to its i-th row
+static double **allocKGH(int size)
+{
+	double **matkgh = new double*[std::max(size, 1)];
+	matkgh[0] = new double[size*size];
+	for(int i=1; i<size; i++) matkgh[i] = matkgh[0] + i*size;
+	return matkgh;
+}
+
+static void freeKGH(double **&matkgh)
+{
+	if(!matkgh) return;
+	delete [] matkgh[0];
+	delete [] matkgh;
+	matkgh = 0;
+}
+
 void asvmdata::printToFile(const char* filename)
 {
 	FILE* fp = fopen(filename, "w");
@@ -111,12 +129,8 @@ asvmdata::asvmdata(const asvmdata& other)
     if(other.matkgh)
     {
         int matkghCount = num_alpha + num_beta + dim;
-        matkgh = new double*[matkghCount];
-        for(int i=0; i<matkghCount; i++)
-        {
-            matkgh[i] = new double[matkghCount];
-            memcpy(matkgh[i], other.matkgh[i], matkghCount*sizeof(double));
-        }
+        matkgh = allocKGH(matkghCount);
+        memcpy(matkgh[0], other.matkgh[0], matkghCount*matkghCount*sizeof(double));
     }else matkgh = 0;
 
 	tar.resize(other.tar.size());
@@ -157,16 +171,7 @@ asvmdata::asvmdata(const asvmdata& other)
 
 asvmdata::~asvmdata()
 {
-    if(matkgh)
-    {
-        int matkghCount = num_alpha + num_beta + dim;
-        for(int i=0; i<matkghCount; i++)
-        {
-            delete [] matkgh[i];
-        }
-        delete [] matkgh;
-        matkgh = 0;
-    }
+    freeKGH(matkgh);
     if(labels)
     {
         delete [] labels;
@@ -186,16 +191,7 @@ asvmdata& asvmdata::operator=(const asvmdata& other)
 	target_class = other.target_class;
 
     isOkay = other.isOkay;
-    if(matkgh)
-    {
-        int matkghCount = num_alpha + num_beta + dim;
-        for(int i=0; i<matkghCount; i++)
-        {
-            delete [] matkgh[i];
-        }
-        delete [] matkgh;
-        matkgh = 0;
-    }
+    freeKGH(matkgh);
     num_alpha = other.num_alpha;
     num_beta = other.num_beta;
     KILL(labels);
@@ -207,12 +203,8 @@ asvmdata& asvmdata::operator=(const asvmdata& other)
     if(other.matkgh)
     {
         int matkghCount = num_alpha + num_beta + dim;
-        matkgh = new double*[matkghCount];
-        for(int i=0; i<matkghCount; i++)
-        {
-            matkgh[i] = new double[matkghCount];
-            memcpy(matkgh[i], other.matkgh[i], matkghCount*sizeof(double));
-        }
+        matkgh = allocKGH(matkghCount);
+        memcpy(matkgh[0], other.matkgh[0], matkghCount*matkghCount*sizeof(double));
     }
 
 
@@ -301,6 +293,7 @@ void asvmdata::preprocess(unsigned int tclass)
 //	beta_indices = new unsigned int[num_beta];
 
 	int count=0;
+	KILL(labels);
 	labels = new int[num_alpha];
 
 	for(unsigned int i=0;i<tar.size();i++)
@@ -405,284 +398,113 @@ void asvmdata::setParams(const char *_kernel_type, double _kernel_width, double
 	initial = _initial_guess;
 }
 
-void asvmdata::updateModulationKernel()
+// Fills the upper triangle of rows [first, last) of the (symmetric) modulation matrix
+//   [ K    G   -Gs  ]
+//   [ G'   H   -Hs  ]
+//   [-Gs' -Hs'  Hss ]
+// points and velocities are stored row by row, the m beta points start at betaStart
+template<class Kernel>
+static void fillModulationKernel(const Kernel &kernel, double **matkgh, const double *points, const double *vels, const int *labels,
+								 const double *targ, int p, int m, int n, int betaStart, int first, int last)
 {
-
-	unsigned int p = num_alpha ;
-	unsigned int m = num_beta;
-	unsigned int n = dim;
-
-	unsigned int i,j,k;
-	unsigned int a,b,c;
-	double* temp1 = new double[dim];
-	double* temp2 = new double[dim];
-	double** temp3 = new double*[dim];
-	for(i=0; i<n; i++)
-		temp3[i] = new double[dim];
-
-
-	const char* type1 = type;
-	double lambda1 = lambda;
-
-	//calculating full K matrix
-	double** K = new double*[p];
-	for(i=0; i<p ; i++)
-		K[i] = new double[p];
-
-	int l=0, d=0;
-	for( i=0; i<tar.size(); i++)
-		for( j=0; j<tar[i].traj.size(); j++)
-			for( k=0; k<tar[i].traj[j].nPoints-1 ; k++)
-			{
-				for( a=0; a<tar.size(); a++)
-					for( b=0; b<tar[a].traj.size(); b++)
-						for(  c=0; c<tar[a].traj[b].nPoints-1 ; c++)
-						{
-							K[l][d] = tar[i].traj[j].y[k]*tar[a].traj[b].y[c]*
-									getkernel(tar[i].traj[j].coords[k], tar[a].traj[b].coords[c], lambda1, type1, dim);
-							d++;
-						}
-				l++;
-				d = 0;
-			}
-
-	//calculating full G matrix
-	l =0;
-	d =0;
-	double** G = new double*[p];
-	for(i=0; i<p; i++)
-		G[i] = new double[m];
-
-	for( i=0; i<tar.size(); i++)
-		for( j=0; j<tar[i].traj.size(); j++)
-			for( k=0; k<tar[i].traj[j].nPoints-1 ; k++)
-			{
-				for( b=0; b<tar[target_class].traj.size(); b++)
-					for( c=0; c<tar[target_class].traj[b].nPoints -1; c++)
-					{
-
-						getfirstkernelderivative(tar[i].traj[j].coords[k], tar[target_class].traj[b].coords[c], lambda1, type1, 2, temp1, dim);
-						G[l][d] = tar[i].traj[j].y[k]*arraydot(tar[target_class].traj[b].vel[c], temp1, dim);
-						d++;
-					}
-				l++;
-				d=0;
-			}
-
-
-	//calculating full Gs matrix
-	l=0;
-    //d=0;
-	double** Gs = new double*[p];
-	for(i=0; i<p; i++)
-		Gs[i] = new double[n];
-	for( i=0; i<tar.size(); i++)
-		for( j=0; j<tar[i].traj.size(); j++)
-			for( k=0; k<tar[i].traj[j].nPoints-1 ; k++)
-			{
-				for(a=0; a<dim; a++)
-				{
-					getfirstkernelderivative(tar[i].traj[j].coords[k], tar[target_class].targ, lambda1, type1, 2, temp1, dim);
-					for(b=0; b<dim; b++)
-					{
-						if(b==a)
-							temp2[b] = 1;
-						else
-							temp2[b] = 0;
-					}
-					Gs[l][a] = tar[i].traj[j].y[k]*arraydot(temp2, temp1, dim);
-
-				}
-				l++;
-			}
-
-	//calculating full H matrix
-	l =0;
-	d =0;
-	double** H = new double*[m];
-	for(i=0; i<m; i++)
-		H[i] = new double[m];
-
-	for( j=0; j<tar[target_class].traj.size(); j++)
-		for(k=0; k<tar[target_class].traj[j].nPoints-1 ; k++)
-		{
-			for( b=0; b<tar[target_class].traj.size(); b++)
-				for(c=0; c<tar[target_class].traj[b].nPoints-1 ; c++)
-				{
-
-					getsecondkernelderivative(tar[target_class].traj[j].coords[k], tar[target_class].traj[b].coords[c], dim, lambda1, type1, temp3);
-					VectorMatrixMultipy(tar[target_class].traj[j].vel[k], temp3, temp1, dim, dim);
-					H[l][d] = arraydot(tar[target_class].traj[b].vel[c], temp1, dim);
-					d++;
-				}
-			l++;
-			d = 0;
-		}
-
-
-	//calculating full Hs matrix
-	l =0;
-    //d =0;
-	double** Hs = new double*[m];
-	for(i=0; i<m; i++)
-		Hs[i] = new double[n];
-
-	for( j=0; j<tar[target_class].traj.size(); j++)
-		for(k=0; k<tar[target_class].traj[j].nPoints-1 ; k++)
+	double *der = new double[n];
+	double *unit = new double[n];
+	for(int a=0; a<n; a++) unit[a] = 0.0;
+	for(int i=first; i<last; i++)
+	{
+		double *row = matkgh[i];
+		if(i < p)
 		{
-
-			for(a=0; a<dim; a++)
+			const double *x = points + i*n;
+			for(int j=i; j<p; j++)
+				row[j] = labels[i]*labels[j]*kernel.value(x, points + j*n, n);
+			for(int j=0; j<m; j++)
 			{
-				for(b=0; b<dim; b++)
-					if(b==a)
-						temp2[b] = 1;
-					else
-						temp2[b] = 0;
-
-				getsecondkernelderivative(tar[target_class].traj[j].coords[k], tar[target_class].targ, dim, lambda1, type1, temp3);
-				VectorMatrixMultipy(tar[target_class].traj[j].vel[k], temp3, temp1, dim, dim);
-				Hs[l][a] = arraydot(temp2, temp1, dim);
-
+				const double *v = vels + (betaStart+j)*n;
+				kernel.gradient(x, points + (betaStart+j)*n, der, n);
+				double dot = 0.0;
+				for(int a=0; a<n; a++) dot += v[a]*der[a];
+				row[p+j] = labels[i]*dot;
 			}
-			l++;
-		}
-
-
-	//calculating full Hss matrix
-    //l =0;
-    //d =0;
-	double** Hss = new double*[n];
-    for(i=0; i<n; i++) Hss[i] = new double[n];
-
-	for(i=0; i<n; i++)
-		for(j=0; j<n; j++)
-		{
-			for(b=0; b<n; b++)
-				if(b==i)
-					temp2[b] = 1;
-				else
-					temp2[b] = 0;
-			getsecondkernelderivative(tar[target_class].targ, tar[target_class].targ, dim, lambda1, type1, temp3);
-			VectorMatrixMultipy(temp2, temp3, temp1, dim, dim);
-			for(b=0; b<n; b++)
-				if(b==j)
-					temp2[b] = 1;
-				else
-					temp2[b] = 0;
-			Hss[i][j] = arraydot(temp2, temp1, dim);
-		}
-	/*
-
-		double** tmpkgh = new double*[p+m+n];
-		for(i=0; i<p+m+n; i++)
-			tmpkgh[i] = new double[p+m+n];
-
-	for(i =0; i< p; i++)
-		for(j =0; j< p; j++)
-			tmpkgh[i][j] = K[i][j];
-
-	for(i =0; i< p; i++)
-		for(j =0; j<m; j++)
-		{
-			tmpkgh[i][j+ p] = G[i][j];
-			tmpkgh[j+p][i] = G[i][j];
+			kernel.gradient(x, targ, der, n);
+			for(int a=0; a<n; a++) row[p+m+a] = -labels[i]*der[a];
 		}
-
-	for(i =0; i<m; i++)
-		for(j =0; j<m; j++)
-			tmpkgh[i+p][j+p] = H[i][j];
-
-	for(i =0; i<p; i++)
-		for(j =0; j<n; j++)
+		else if(i < p+m)
 		{
-			tmpkgh[i][j+p + m] = - Gs[i][j];
-			tmpkgh[j+ p + m][i] = - Gs[i][j];
+			const double *x = points + (betaStart+i-p)*n;
+			const double *v = vels + (betaStart+i-p)*n;
+			for(int j=i-p; j<m; j++)
+				row[p+j] = kernel.hessian(x, points + (betaStart+j)*n, v, vels + (betaStart+j)*n, n);
+			kernel.hessianrow(x, targ, v, der, n);
+			for(int a=0; a<n; a++) row[p+m+a] = -der[a];
 		}
-
-
-	for(i =0; i< m; i++)
-		for(j =0; j< n; j++)
+		else
 		{
-			tmpkgh[i+ p][j+ p + m] = -Hs[i][j];
-			tmpkgh[j+ p + m][i+ p] = -Hs[i][j];
+			int a = i-p-m;
+			unit[a] = 1.0;
+			kernel.hessianrow(targ, targ, unit, der, n);
+			unit[a] = 0.0;
+			for(int b=a; b<n; b++) row[p+m+b] = der[b];
 		}
-
-	for( i=0; i<dim; i++)
-		for( j =0; j<dim; j++)
-			tmpkgh[i+ p + m][j+ p + m] = Hss[i][j];
-	 */
-	unsigned int matkgh_size = num_alpha + num_beta + dim;
-	matkgh = new double*[matkgh_size];
-    for( i=0; i<matkgh_size; i++) matkgh[i] = new double[matkgh_size];
-	/*
-	//removing unwanted rows, cols
-	for( i=0;i<num_alpha;i++)
-	{
-		for( j=0;j<num_alpha;j++)
-			matkgh[i][j] = tmpkgh[alpha_indices[i]][alpha_indices[j]];
-
-		for( j=0;j<num_beta;j++)
-			matkgh[i][j+num_alpha] = tmpkgh[alpha_indices[i]][p + beta_indices[j]];
-
-		for( j=0;j<dim;j++)
-			matkgh[i][j+num_alpha + num_beta] = tmpkgh[alpha_indices[i]][p + m + j];
 	}
-	for( i=0;i<num_beta;i++)
-	{
-		for( j=0;j<num_alpha;j++)
-			matkgh[num_alpha + i][j] = tmpkgh[p+beta_indices[i]][alpha_indices[j]];
-
-		for( j=0;j<num_beta;j++)
-			matkgh[num_alpha + i][j+num_alpha] = tmpkgh[p+beta_indices[i]][p + beta_indices[j]];
+	delete [] der;
+	delete [] unit;
+}
 
-		for( j=0;j<dim;j++)
-			matkgh[num_alpha + i][j+num_alpha + num_beta] = tmpkgh[p+beta_indices[i]][p + m + j];
-	}
-	for( i=0;i<dim;i++)
+void asvmdata::updateModulationKernel()
+{
+	int p = num_alpha;
+	int m = num_beta;
+	int n = dim;
+	int size = p + m + n;
+
+	// contiguous copies of the alpha points, the beta points are the ones of the target class
+	double *points = new double[p*n];
+	double *vels = new double[p*n];
+	int betaStart = 0;
+	int index = 0;
+	for(unsigned int i=0; i<tar.size(); i++)
 	{
-		for(j=0;j<num_alpha;j++)
-			matkgh[num_alpha + num_beta + i][j] = tmpkgh[p+m+i][alpha_indices[j]];
-
-		for(j=0;j<num_beta;j++)
-			matkgh[num_alpha +  num_beta + i][j+num_alpha] = tmpkgh[p+m+i][p + beta_indices[j]];
-
-		for(j=0;j<dim;j++)
-			matkgh[num_alpha +  num_beta + i][j+num_alpha + num_beta] = tmpkgh[p+m+i][p + m + j];
+		if(i == target_class) betaStart = index;
+		for(unsigned int j=0; j<tar[i].traj.size(); j++)
+			for(unsigned int k=0; k<tar[i].traj[j].nPoints-1; k++, index++)
+			{
+				memcpy(points + index*n, tar[i].traj[j].coords[k], n*sizeof(double));
+				memcpy(vels + index*n, tar[i].traj[j].vel[k], n*sizeof(double));
+			}
 	}
-	 */
 
-	for( i=0;i<num_alpha;i++)
+	freeKGH(matkgh);
+	matkgh = allocKGH(size);
+	int kernelType = getkerneltype(type);
+	if(kernelType == ASVM_KERNEL_INVALID)
 	{
-		for( j=0;j<num_alpha;j++)
-			matkgh[i][j] = K[i][j];
-
-		for( j=0;j<num_beta;j++)
-			matkgh[i][j+num_alpha] = G[i][j];
-
-		for( j=0;j<dim;j++)
-			matkgh[i][j+num_alpha + num_beta] = -Gs[i][j];
+		cout<<"\nInvalid kernel type specified in updateModulationKernel!";
+		memset(matkgh[0], 0, size*size*sizeof(double));
 	}
-	for( i=0;i<num_beta;i++)
-	{
-		for( j=0;j<num_alpha;j++)
-			matkgh[num_alpha + i][j] = G[j][i];
-
-		for( j=0;j<num_beta;j++)
-			matkgh[num_alpha + i][j+num_alpha] = H[i][j];
-
-		for( j=0;j<dim;j++)
-			matkgh[num_alpha + i][j+num_alpha + num_beta] = -Hs[i][j];
-	}
-	for( i=0;i<dim;i++)
+	else
 	{
-		for(j=0;j<num_alpha;j++)
-			matkgh[num_alpha + num_beta + i][j] = -Gs[j][i];
-
-		for(j=0;j<num_beta;j++)
-			matkgh[num_alpha +  num_beta + i][j+num_alpha] = -Hs[j][i];
-
-		for(j=0;j<dim;j++)
-			matkgh[num_alpha +  num_beta + i][j+num_alpha + num_beta] = Hss[i][j];
+		// the type is resolved once, each block of rows is then filled by a single thread
+		const double *targ = tar[target_class].targ;
+		int blockCount = (size + KGH_BLOCK - 1) / KGH_BLOCK;
+#pragma omp parallel for schedule(dynamic)
+		for(int b=0; b<blockCount; b++)
+		{
+			int first = b*KGH_BLOCK;
+			int last = std::min(size, first + KGH_BLOCK);
+			if(kernelType == ASVM_KERNEL_RBF)
+				fillModulationKernel(RBFKernel(lambda), matkgh, points, vels, labels, targ, p, m, n, betaStart, first, last);
+			else
+				fillModulationKernel(PolyKernel(lambda), matkgh, points, vels, labels, targ, p, m, n, betaStart, first, last);
+		}
+		// the lower triangle is mirrored once the upper one is complete
+#pragma omp parallel for schedule(dynamic, KGH_BLOCK)
+		for(int i=1; i<size; i++)
+		{
+			double *row = matkgh[i];
+			for(int j=0; j<i; j++) row[j] = matkgh[j][i];
+		}
 	}
-
+	delete [] points;
+	delete [] vels;
 }
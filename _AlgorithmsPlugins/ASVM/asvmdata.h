@@ -8,6 +8,8 @@
 using namespace std;
 
 #define VEL_NORM_TOL 1e-4
+// rows of the modulation matrix filled by one thread at a time
+#define KGH_BLOCK 32
 
 struct trajectory{
     unsigned int dim;
@@ -52,6 +52,13 @@ double norm2(double *x, int m)
 	return sum;
 }
 
+int getkerneltype(const char* type)
+{
+	if(strcmp(type, "rbf") == 0) return ASVM_KERNEL_RBF;
+	if(strcmp(type, "poly") == 0) return ASVM_KERNEL_POLY;
+	return ASVM_KERNEL_INVALID;
+}
+
 double getkernel(double *x1, double *x2, double lambda, const char* type, int n)
 {
 	double ker_val = 0.0;
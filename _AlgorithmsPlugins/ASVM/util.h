@@ -9,6 +9,9 @@
 #define KILL(a) {if(a!=0) {delete [] a; a = 0;}}
 #endif
 
+enum {ASVM_KERNEL_INVALID, ASVM_KERNEL_RBF, ASVM_KERNEL_POLY};
+int getkerneltype(const char* type);
+
 double getkernel(double *x1, double *x2, double lambda, const char* type, int n);
 bool getfirstkernelderivative(double *x1, double *x2, double lambda, const char* type, int der_wrt, double* der_val, int n);
 bool getsecondkernelderivative(double *x1, double *x2, int n, double lambda, const char *type, double **hesval);
@@ -19,4 +22,88 @@ void MatrixVectorMultipy(double **MatrixB, double *VectorA, double *Result, int
 double arraydot(double *x, double *y, int m);
 double norm(double *x, int m);
 double norm2(double *x, int m);
+
+// Kernels selected at compile time, with the same conventions as the functions above:
+// gradient() is the derivative wrt x2, hessian() is u' * d2k/dx1dx2 * v
+// and hessianrow() fills (u' * d2k/dx1dx2), a row of length n
+struct RBFKernel
+{
+	double lambda;
+	RBFKernel(double lambda) : lambda(lambda){}
+	inline double value(const double *x1, const double *x2, int n) const
+	{
+		double d2 = 0.0;
+		for(int i=0; i<n; i++) d2 += (x1[i]-x2[i])*(x1[i]-x2[i]);
+		return exp(-lambda*d2);
+	}
+	inline void gradient(const double *x1, const double *x2, double *der, int n) const
+	{
+		double d2 = 0.0;
+		for(int i=0; i<n; i++)
+		{
+			der[i] = x1[i] - x2[i];
+			d2 += der[i]*der[i];
+		}
+		double temp = 2*lambda*exp(-lambda*d2);
+		for(int i=0; i<n; i++) der[i] *= temp;
+	}
+	inline double hessian(const double *x1, const double *x2, const double *u, const double *v, int n) const
+	{
+		double d2 = 0.0, ud = 0.0, vd = 0.0, uv = 0.0;
+		for(int i=0; i<n; i++)
+		{
+			double diff = x1[i] - x2[i];
+			d2 += diff*diff;
+			ud += u[i]*diff;
+			vd += v[i]*diff;
+			uv += u[i]*v[i];
+		}
+		return 2*lambda*exp(-lambda*d2)*(uv - 2*lambda*ud*vd);
+	}
+	inline void hessianrow(const double *x1, const double *x2, const double *u, double *row, int n) const
+	{
+		double d2 = 0.0, ud = 0.0;
+		for(int i=0; i<n; i++)
+		{
+			double diff = x1[i] - x2[i];
+			d2 += diff*diff;
+			ud += u[i]*diff;
+		}
+		double temp = 2*lambda*exp(-lambda*d2);
+		for(int i=0; i<n; i++) row[i] = temp*(u[i] - 2*lambda*ud*(x1[i]-x2[i]));
+	}
+};
+
+struct PolyKernel
+{
+	double lambda;
+	PolyKernel(double lambda) : lambda(lambda){}
+	inline double dot(const double *x1, const double *x2, int n) const
+	{
+		double val = 0.0;
+		for(int i=0; i<n; i++) val += x1[i]*x2[i];
+		return val;
+	}
+	inline double value(const double *x1, const double *x2, int n) const
+	{
+		return pow(dot(x1, x2, n)+1, lambda);
+	}
+	inline void gradient(const double *x1, const double *x2, double *der, int n) const
+	{
+		double temp = lambda*pow(dot(x1, x2, n)+1, lambda-1);
+		for(int i=0; i<n; i++) der[i] = temp*x1[i];
+	}
+	inline double hessian(const double *x1, const double *x2, const double *u, const double *v, int n) const
+	{
+		double tmp = dot(x1, x2, n) + 1;
+		return lambda*pow(tmp, lambda-2)*(tmp*dot(u, v, n) + (lambda-1)*dot(u, x2, n)*dot(x1, v, n));
+	}
+	inline void hessianrow(const double *x1, const double *x2, const double *u, double *row, int n) const
+	{
+		double tmp = dot(x1, x2, n) + 1;
+		double scale = lambda*pow(tmp, lambda-2);
+		double ux2 = dot(u, x2, n);
+		for(int i=0; i<n; i++) row[i] = scale*(tmp*u[i] + (lambda-1)*ux2*x1[i]);
+	}
+};
 #endif
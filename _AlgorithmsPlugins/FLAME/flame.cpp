@@ -27,6 +27,7 @@ Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
 #include <string.h>
 #include <math.h>
 #include <stdio.h>
+#include "ANN/ANN.h"
 
 using namespace std;
 
@@ -251,11 +252,117 @@ void Flame_Clear( Flame *self ) {
         self->N = self->K = self->KMAX = self->cso_count = 0;
 }
 
+/* Number of rows scanned together, and number of columns compared
+ * to a whole block of rows before moving to the next ones. */
+#define FLAME_BLOCK_ROWS 32
+#define FLAME_BLOCK_COLS 512
+
+/* Above this dimension a kd-tree is not faster than a plain scan. */
+#define FLAME_TREE_MAXDIM 16
+
+/* Max-heap (on the distance) holding the max nearest candidates of an object. */
+static void NeighborHeap_Push( IndexFloat *heap, int *size, int max, int index, float value ) {
+        int i, child;
+        if( *size < max ){
+                i = (*size) ++;
+                while( i > 0 && heap[ (i-1)/2 ].value < value ){
+                        heap[i] = heap[ (i-1)/2 ];
+                        i = (i-1)/2;
+                }
+        }else{
+                if( value >= heap[0].value ) return;
+                i = 0;
+                while( (child = 2*i+1) < max ){
+                        if( child+1 < max && heap[child].value < heap[child+1].value ) child ++;
+                        if( heap[child].value <= value ) break;
+                        heap[i] = heap[child];
+                        i = child;
+                }
+        }
+        heap[i].index = index;
+        heap[i].value = value;
+}
+
+/* Nearest neighbors of every object by comparing it to all the others.
+ * The objects are processed by blocks of rows, concurrently, and each
+ * block goes through the columns in tiles so that they are reused from
+ * the cache by all the rows of the block.
+ * If m==0, data is distance matrix. */
+static void Flame_ScanNeighbors( Flame *self, float *data[], int n, int m ) {
+        int MAX = self->KMAX;
+        int blocks = (n + FLAME_BLOCK_ROWS - 1) / FLAME_BLOCK_ROWS;
+        int b;
+#pragma omp parallel
+        {
+                IndexFloat *heaps = (IndexFloat*) calloc( FLAME_BLOCK_ROWS*MAX, sizeof(IndexFloat) );
+                int sizes[FLAME_BLOCK_ROWS];
+#pragma omp for schedule(dynamic)
+                for(b=0; b<blocks; b++){
+                        int i, j, j0, first = b*FLAME_BLOCK_ROWS;
+                        int last = first + FLAME_BLOCK_ROWS < n ? first + FLAME_BLOCK_ROWS : n;
+                        memset( sizes, 0, sizeof(sizes) );
+                        for(j0=0; j0<n; j0+=FLAME_BLOCK_COLS){
+                                int j1 = j0 + FLAME_BLOCK_COLS < n ? j0 + FLAME_BLOCK_COLS : n;
+                                for(i=first; i<last; i++){
+                                        IndexFloat *heap = heaps + (i-first)*MAX;
+                                        int *size = sizes + (i-first);
+                                        for(j=j0; j<j1; j++){
+                                                if( j == i ) continue;
+                                                float value = m ? self->distfunc( data[i], data[j], m ) : data[i][j];
+                                                NeighborHeap_Push( heap, size, MAX, j, value );
+                                        }
+                                }
+                        }
+                        for(i=first; i<last; i++){
+                                IndexFloat *heap = heaps + (i-first)*MAX;
+                                PartialQuickSort( heap, 0, sizes[i-first]-1, MAX );
+                                for(j=0; j<MAX; j++){
+                                        self->graph[i][j] = heap[j].index;
+                                        self->dists[i][j] = heap[j].value;
+                                }
+                        }
+                }
+                free( heaps );
+        }
+}
+
+/* Euclidean or Manhattan nearest neighbors, using a kd-tree. */
+static void Flame_TreeNeighbors( Flame *self, float *data[], int n, int m ) {
+        int i, j, k;
+        int MAX = self->KMAX;
+        int euclidean = self->distfunc == Flame_Euclidean;
+        ANNpointArray points = annAllocPts( n, m );
+        for(i=0; i<n; i++) for(j=0; j<m; j++) points[i][j] = data[i][j];
+        /* The metric is global to ANN (and defaults to the L-inf norm). */
+        ANN::MetricType = euclidean ? ANN_METRIC2 : ANN_METRIC1;
+        ANN::MetricPower = euclidean ? 2 : 1;
+        ANNkd_tree *kdTree = new ANNkd_tree( points, n, m );
+        ANNidxArray ids = new ANNidx[MAX+1];
+        ANNdistArray dists = new ANNdist[MAX+1];
+        /* ANN keeps its search state in globals, the queries cannot run concurrently. */
+        for(i=0; i<n; i++){
+                kdTree->annkSearch( points[i], MAX+1, ids, dists, 0 );
+                /* The object itself is usually the first one, but not
+                 * necessarily when it has duplicates. */
+                for(j=0, k=0; j<=MAX && k<MAX; j++){
+                        if( ids[j] == i ) continue;
+                        self->graph[i][k] = ids[j];
+                        /* ANN returns squared euclidean distances. */
+                        self->dists[i][k] = euclidean ? sqrt( dists[j] ) : dists[j];
+                        k ++;
+                }
+        }
+        delete [] ids;
+        delete [] dists;
+        delete kdTree;
+        annDeallocPts( points );
+        annClose();
+}
+
 /* If m==0, data is distance matrix. */
 void Flame_SetMatrix( Flame *self, float *data[], int n, int m ) {
-        int i, j, k;
+        int i;
         int MAX = sqrt( n ) + 10;
-        IndexFloat *vals = (IndexFloat*) calloc( n, sizeof(IndexFloat) );
         if( MAX >= n ) MAX = n - 1;
 
         Flame_Clear( self );
@@ -273,27 +380,14 @@ void Flame_SetMatrix( Flame *self, float *data[], int n, int m ) {
                 self->graph[i] = (int*) calloc( MAX, sizeof(int) );
                 self->dists[i] = (float*) calloc( MAX, sizeof(float) );
                 self->weights[i] = (float*) calloc( MAX, sizeof(float) );
-                if( m ==0 ){
-                        /* data is distance matrix. */
-                        for(j=0; j<n; j++){
-                                vals[j].index = j;
-                                vals[j].value = data[i][j];
-                        }
-                }else{
-                        /* data is raw data matrix. */
-                        for(j=0; j<n; j++){
-                                vals[j].index = j;
-                                vals[j].value = self->distfunc( data[i], data[j], m );
-                        }
-                }
-                PartialQuickSort( vals, 0, n-1, MAX+1 );
-                /* Store MAX number of nearest neighbors. */
-                for(j=0; j<MAX; j++){
-                        self->graph[i][j] = vals[j+1].index;
-                        self->dists[i][j] = vals[j+1].value;
-                }
         }
-        free( vals );
+        if( MAX <= 0 ) return;
+        /* Store MAX number of nearest neighbors. */
+        if( m > 0 && m <= FLAME_TREE_MAXDIM &&
+            ( self->distfunc == Flame_Euclidean || self->distfunc == Flame_Manhattan ) )
+                Flame_TreeNeighbors( self, data, n, m );
+        else
+                Flame_ScanNeighbors( self, data, n, m );
 }
 
 void Flame_SetDataMatrix( Flame *self, float *data[], int n, int m, int dt ) {
@@ -317,6 +411,7 @@ void Flame_DefineSupports( Flame *self, int knn, float thd ) {
 
         if( knn > kmax ) knn = kmax;
         self->K = knn;
+#pragma omp parallel for private(j, k, d, sum)
         for(i=0; i<n; i++) {
                 /* To include all the neighbors that have distances equal to the
                  * distance of the most distant one of the K-Nearest Neighbors */
@@ -373,17 +468,33 @@ void Flame_DefineSupports( Flame *self, int knn, float thd ) {
         free( density );
 }
 
+/* Membership of an object as a linear combination of the memberships
+ * of its nearest neighbors, read from the previous iteration. */
+static double Flame_Propagate( Flame *self, int i, float **previous, float *fuzzy ) {
+        int j, k, m = self->cso_count;
+        int knn = self->nncounts[i];
+        int *ids = self->graph[i];
+        float *wt = self->weights[i];
+        double dev = 0.0;
+        for(j=0; j<=m; j++) fuzzy[j] = 0.0;
+        for(k=0; k<knn; k++){
+                float *neighbor = previous[ ids[k] ];
+                for(j=0; j<=m; j++) fuzzy[j] += wt[k] * neighbor[j];
+        }
+        for(j=0; j<=m; j++) dev += (fuzzy[j] - previous[i][j]) * (fuzzy[j] - previous[i][j]);
+        return dev;
+}
+
 void Flame_LocalApproximation( Flame *self, int steps, float epsilon) {
         int i, j, k, t, n = self->N, m = self->cso_count;
-        float **fuzzyships = self->fuzzyships;
+        float **fuzzyships = (float**)calloc( n, sizeof(float*) );
         float **fuzzyships2 = (float**)calloc( n, sizeof(float*) );
         char *obtypes = self->obtypes;
-        char even = 0;
         double dev = 0;
 
         k = 0;
         for(i=0; i<n; i++){
-                fuzzyships[i] = (float*) realloc( fuzzyships[i], (m+1)*sizeof(float) );
+                fuzzyships[i] = (float*) realloc( self->fuzzyships[i], (m+1)*sizeof(float) );
                 fuzzyships2[i] = (float*) calloc( m+1, sizeof(float) );
                 memset( fuzzyships[i], 0, (m+1)*sizeof(float) );
                 if( obtypes[i] == OBT_SUPPORT ){
@@ -402,49 +513,37 @@ void Flame_LocalApproximation( Flame *self, int steps, float epsilon) {
                                 fuzzyships[i][j] = fuzzyships2[i][j] = 1.0/(m+1);
                 }
         }
+        /* Each sweep reads the memberships of the previous one and writes
+         * into the other buffer, so that the objects can be updated
+         * concurrently and in any order. */
         for(t=0; t<steps; t++){
+                float **previous = fuzzyships;
+                float **current = fuzzyships2;
                 dev = 0;
+#pragma omp parallel for schedule(dynamic, 256) reduction(+:dev)
                 for(i=0; i<n; i++){
-                        int knn = self->nncounts[i];
-                        int *ids = self->graph[i];
-                        float *wt = self->weights[i];
-                        float *fuzzy = fuzzyships[i];
-                        float **fuzzy2 = fuzzyships2;
+                        if( obtypes[i] != OBT_NORMAL ) continue;
+                        float *fuzzy = current[i];
                         double sum = 0.0;
-                        if( self->obtypes[i] != OBT_NORMAL ) continue;
-                        if( even ){
-                                fuzzy = fuzzyships2[i];
-                                fuzzy2 = fuzzyships;
-                        }
-                        /* Update membership of an object by a linear combination of
-                         * the memberships of its nearest neighbors. */
-                        for(j=0; j<=m; j++){
-                                fuzzy[j] = 0.0;
-                                for(k=0; k<knn; k++) fuzzy[j] += wt[k] * fuzzy2[ ids[k] ][j];
-                                dev += (fuzzy[j] - fuzzy2[i][j]) * (fuzzy[j] - fuzzy2[i][j]);
-                                sum += fuzzy[j];
-                        }
+                        int j;
+                        dev += Flame_Propagate( self, i, previous, fuzzy );
+                        for(j=0; j<=m; j++) sum += fuzzy[j];
                         for(j=0; j<=m; j++) fuzzy[j] = fuzzy[j] / sum;
                 }
-                even = ! even;
+                fuzzyships = current;
+                fuzzyships2 = previous;
                 if( dev < epsilon ) break;
         }
         self->steps = t;
         /* update the membership of all objects to remove clusters
          * that contains only the CSO. */
+#pragma omp parallel for schedule(dynamic, 256)
+        for (i=0; i<n; i++) Flame_Propagate( self, i, fuzzyships, fuzzyships2[i] );
         for (i=0; i<n; i++){
-                int knn = self->nncounts[i];
-                int *ids = self->graph[i];
-                float *wt = self->weights[i];
-                float *fuzzy = fuzzyships[i];
-                float **fuzzy2 = fuzzyships2;
-                for(j=0; j<=m; j++){
-                        fuzzy[j] = 0.0;
-                        for(k=0; k<knn; k++) fuzzy[j] += wt[k] * fuzzy2[ ids[k] ][j];
-                        dev += (fuzzy[j] - fuzzy2[i][j]) * (fuzzy[j] - fuzzy2[i][j]);
-                }
+                self->fuzzyships[i] = fuzzyships2[i];
+                free( fuzzyships[i] );
         }
-        for (i=0; i<n; i++) free( fuzzyships2[i] );
+        free( fuzzyships );
         free( fuzzyships2 );
 }
 
@@ -63,14 +63,12 @@ std::vector<fvec> DynamicalGMR::Test( const fvec &sample, int count)
 	FOR(i, count) res[i].resize(dim,0);
 	if(!gmm) return res;
 	fvec velocity; velocity.resize(dim,0);
-	float *sigma = new float[dim*(dim+1)/2];
 	FOR(i, count)
 	{
 		res[i] = start;
 		start += velocity*dT;
-		gmm->doRegression(&start[0], &velocity[0], sigma);
+		gmm->doRegression(&start[0], &velocity[0]);
 	}
-	delete [] sigma;
 	return res;
 }
 
@@ -79,25 +77,30 @@ fvec DynamicalGMR::Test( const fvec &sample)
 	dim = sample.size();
 	fvec res; res.resize(dim, 0);
 	if(!gmm) return res;
-	float *velocity = new float[dim];
-	float *sigma = new float[dim*(dim+1)/2];
-	gmm->doRegression(&sample[0], velocity, sigma);
-    FOR(d, dim) res[d] = velocity[d];
-	delete [] velocity;
-	delete [] sigma;
+	gmm->doRegression(&sample[0], &res[0]);
 	return res;
 }
 
-
 fVec DynamicalGMR::Test( const fVec &sample)
 {
 	fVec res;
 	if(!gmm) return res;
-	fVec velocity;
-	float *sigma = new float[(dim*2)*((dim*2)+1)/2];
-	gmm->doRegression(sample._, velocity._, sigma);
-	res = velocity;
-	delete [] sigma;
+	gmm->doRegression(sample._, res._);
+	return res;
+}
+
+std::vector<fvec> DynamicalGMR::TestBatch(const std::vector<fvec> &samples)
+{
+	int count = samples.size();
+	std::vector<fvec> res(count);
+	if(!count) return res;
+	dim = samples[0].size();
+	FOR(i, count) res[i].resize(dim, 0);
+	if(!gmm) return res;
+	fvec inputs(count*dim), velocities(count*dim);
+	FOR(i, count) FOR(d, dim) inputs[i*dim + d] = samples[i][d];
+	gmm->doRegressionBatch(&inputs[0], count, &velocities[0]);
+	FOR(i, count) FOR(d, dim) res[i][d] = velocities[i*dim + d];
 	return res;
 }
 
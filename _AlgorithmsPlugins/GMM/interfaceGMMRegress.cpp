@@ -286,13 +286,17 @@ void RegrGMM::DrawModel(Canvas *canvas, QPainter &painter, Regressor *regressor)
 	fvec sample;sample.resize(2, 0);
 	painter.setBrush(Qt::NoBrush);
     QPainterPath path, pathUp, pathDown, pathUpUp, pathDownDown;
+	std::vector<fvec> samples(steps);
+	FOR(x, steps) samples[x] = canvas->toSampleCoords(x, 0);
+	std::vector<fvec> results;
+	if(steps && samples[0].size() <= 2) results = ((RegressorGMR*)regressor)->TestBatch(samples);
 	FOR(x, steps)
 	{
-        sample = canvas->toSampleCoords(x, 0);
+        sample = samples[x];
         int dim = sample.size();
         if(dim > 2) continue;
         if(outputDim==-1) outputDim = dim-1;
-        fvec res = regressor->Test(sample);
+        fvec &res = results[x];
 		if(res[0] != res[0] || res[1] != res[1]) continue;
         sample[outputDim] = res[0];
         QPointF point = canvas->toCanvasCoords(sample);
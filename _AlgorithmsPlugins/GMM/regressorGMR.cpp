@@ -95,6 +95,29 @@ fVec RegressorGMR::Test( const fVec &sample)
 	return res;
 }
 
+std::vector<fvec> RegressorGMR::TestBatch(const std::vector<fvec> &samples)
+{
+	int count = samples.size();
+	std::vector<fvec> res(count, fvec(2,0));
+	if(!gmm || !count) return res;
+	int dim = samples[0].size();
+	fvec inputs(count*(dim-1)), estimates(count), sigmas(count);
+	FOR(i, count)
+	{
+		float *x = &inputs[i*(dim-1)];
+		FOR(d, dim-1) x[d] = samples[i][d];
+		// the desired output is swapped with the last dimension, as in Test
+		if(outputDim != -1 && outputDim < dim-1) x[outputDim] = samples[i][dim-1];
+	}
+	gmm->doRegressionBatch(&inputs[0], count, &estimates[0], &sigmas[0]);
+	FOR(i, count)
+	{
+		res[i][0] = estimates[i];
+		res[i][1] = sqrt(sigmas[i]);
+	}
+	return res;
+}
+
 void RegressorGMR::SetParams(u32 nbClusters, u32 covarianceType, u32 initType)
 {
 	this->nbClusters = nbClusters;
@@ -37,6 +37,7 @@ public:
 	void Train(std::vector< fvec > samples, ivec labels);
 	fvec Test( const fvec &sample);
 	fVec Test( const fVec &sample);
+	std::vector<fvec> TestBatch(const std::vector<fvec> &samples);
     const char *GetInfoString();
     void SaveModel(std::string filename);
     bool LoadModel(std::string filename);
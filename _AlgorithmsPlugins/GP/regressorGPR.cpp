@@ -19,6 +19,7 @@ Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
 *********************************************************************/
 #include <public.h>
 #include "regressorGPR.h"
+#include "modelArchive.h"
 #include <QDebug>
 #include <nlopt/nlopt.hpp>
 
@@ -317,6 +318,39 @@ float RegressorGPR::GetLikelihood(float mean, float sigma, float point)
     return expf(exponent)*divider;
 }
 
+bool RegressorGPR::SaveModel(ModelArchive &archive)
+{
+    if(!sogp || !bTrained) return false;
+    // the basis vectors and the gaussian process matrices go through the binary format of SOGP
+    FILE *file = tmpfile();
+    bool bOk = file && sogp->printTo(file, false) && archive.AddFile("gpr.sogp", file);
+    if(file) fclose(file);
+    archive.AddValue("gpr.outputDim", outputDim);
+    return bOk;
+}
+
+bool RegressorGPR::LoadModel(const ModelArchive &archive)
+{
+    int outputDim;
+    if(!archive.GetValue("gpr.outputDim", outputDim)) return false;
+    FILE *file = archive.OpenFile("gpr.sogp");
+    if(!file) return false;
+    SOGP *loaded = new SOGP();
+    bool bOk = loaded->readFrom(file, false);
+    fclose(file);
+    if(!bOk || !loaded->size())
+    {
+        delete loaded;
+        return false;
+    }
+    if(sogp) delete sogp;
+    sogp = loaded;
+    dim = sogp->dim();
+    this->outputDim = outputDim;
+    bTrained = true;
+    return true;
+}
+
 void RegressorGPR::Clear()
 {
     bTrained = false;
@@ -46,6 +46,8 @@ public:
 	fvec Test(const fvec &sample);
 	fVec Test(const fVec &sample);
     const char *GetInfoString();
+    bool SaveModel(ModelArchive &archive);
+    bool LoadModel(const ModelArchive &archive);
 
     void SetParams(double p1, double p2, int capacity, int kType, int d=1, bool bOptimize=false, bool bOptimizeLikelihood=true){param1=p1; param2=p2; kernelType=kType; degree = d;this->capacity=capacity;this->bOptimize=bOptimize;this->bOptimizeLikelihood=bOptimizeLikelihood;}
     SOGP *GetModel(){return sogp;}
@@ -36,6 +36,7 @@ ClassifierHMM::~ClassifierHMM()
         DEL(b[i]);
         DEL(a[i]);
     }
+    FOR(i, fastHMM.size()) DEL(fastHMM[i]);
 }
 
 fvec ClassifierHMM::Train(std::vector< std::vector<fvec> > trajectories, ivec labels)
@@ -56,6 +57,8 @@ fvec ClassifierHMM::Train(std::vector< std::vector<fvec> > trajectories, ivec la
             DEL(a[i]);
         }
     }
+    FOR(i, fastHMM.size()) DEL(fastHMM[i]);
+    fastHMM.clear();
 
     //int nbDimensions = dim/2; This is only true for the dynamic case, not for the classifier HMM
     int nbDimensions = dim;
@@ -97,6 +100,21 @@ fvec ClassifierHMM::Train(std::vector< std::vector<fvec> > trajectories, ivec la
         data[(int)(labels[i]-1)].push_back(trajectories[i]);
     }
 
+    // HMMlib: the sequences of each class are shared among the threads at each Baum-Welch iteration.
+    // Joint discrete alphabets that would not fit in memory are trained on LAMP instead
+    if(engine == 1 && FastHMM::Supports(nbDimensions, isGaussian, nbSymbols))
+    {
+        FOR(i, NClass)
+        {
+            FastHMM *hmm = new FastHMM(nbStates, nbDimensions, isGaussian, nbSymbols);
+            hmm->Init(data[i], whichInitialVector, whichTransitionMatrix, seed);
+            // same average distance per step as CHMM::FindDistance
+            normalizedLogProb[i] = (float)-hmm->Train(data[i]);
+            fastHMM.push_back(hmm);
+        }
+        return normalizedLogProb;
+    }
+
     FOR(i, NClass)
     {
 
@@ -190,6 +208,24 @@ fvec ClassifierHMM::Test( const std::vector< std::vector<fvec> > &trajectories)
 
 fvec ClassifierHMM::Test( const std::vector<fvec> &trajectory)
 {
+    if(fastHMM.size())
+    {
+        std::vector<fvec> sequence = trajectory;
+        FOR(j, sequence.size())
+        {
+            FOR(d, sequence[j].size()) sequence[j][d] *= (float)nbSym;
+        }
+        fvec logLik(fastHMM.size());
+        FOR(i, fastHMM.size()) logLik[i] = -fastHMM[i]->LogLikelihood(sequence) / max(1, (int)sequence.size());
+        if(fastHMM.size() == 2)
+        {
+            fvec res(1);
+            res[0] = logLik[1] - logLik[0];
+            return res;
+        }
+        return logLik;
+    }
+
     fvec logLik(learnedHMM.size());
     std::vector< std::vector<fvec> > SingletonTraj;
     SingletonTraj.resize(1);
@@ -232,7 +268,7 @@ fvec ClassifierHMM::Test( const std::vector<fvec> &trajectory)
 
 }
 
-void ClassifierHMM::SetParams(int nbSymbol, int states, int trainType, int obsType, int initType, int transType)
+void ClassifierHMM::SetParams(int nbSymbol, int states, int trainType, int obsType, int initType, int transType, int engine)
 {
     this->nbSym = nbSymbol;
     this->states = states;
@@ -240,6 +276,7 @@ void ClassifierHMM::SetParams(int nbSymbol, int states, int trainType, int obsTy
     this->obsType = obsType;
     this->initType = initType;
     this->transType = transType;
+    this->engine = engine;
 }
 
 char *ClassifierHMM::GetInfoString()
@@ -248,8 +285,9 @@ char *ClassifierHMM::GetInfoString()
     sprintf(text, "HMM\n");
     sprintf(text, "%sNumber of Symbols: %d\n", text, nbSym);
     sprintf(text, "%sStates: %d\n", text, states);
+    sprintf(text, "%sEngine: %s\n", text, engine == 1 ? "HMMlib" : "LAMP");
     sprintf(text, "%sTraining Method\n", text);
-    switch(trainType)
+    switch(engine == 1 ? 0 : trainType)
     {
     case 0:
         sprintf(text, "%sBaum-Welch\n", text);
@@ -18,26 +18,28 @@
 #include <LAMP_HMM/explicitDurationTrans.h>
 #include <LAMP_HMM/initStateProb.h>
 #include <LAMP_HMM/hmm.h>
+#include "fastHMM.h"
 
 class ClassifierHMM : public Classifier
 {
 public:
-    int states, trainType, obsType, initType, transType, nbSym;
+    int states, trainType, obsType, initType, transType, nbSym, engine;
     std::vector<CStateTrans*> a;
     std::vector<CObsProb*> b;
     std::vector<CInitStateProb*> pi;
     std::vector<CHMM*> learnedHMM;
+    std::vector<FastHMM*> fastHMM; // engine 1: HMMlib, Baum-Welch only
     std::vector< std::vector<fvec> > trajectories;
     std::vector< std::vector<std::vector<fvec> > > data;
 public:
-    ClassifierHMM() : nbSym(1), states(1), trainType(1), obsType(0), initType(0), transType(0), a(0), b(0), pi(0), learnedHMM(0){};
+    ClassifierHMM() : nbSym(1), states(1), trainType(1), obsType(0), initType(0), transType(0), engine(0), a(0), b(0), pi(0), learnedHMM(0){};
     ~ClassifierHMM();
     fvec Train(std::vector< std::vector<fvec> > trajectories, ivec labels);
     fvec Test(const std::vector<fvec> &trajectory);
     char *GetInfoString();
     bool IsOrphanedState(int HMMClass, int state);
     bool handlesTrajectories(){return true;}
-    void SetParams(int mixtures, int states, int trainType, int obsType, int initType, int transType);
+    void SetParams(int mixtures, int states, int trainType, int obsType, int initType, int transType, int engine=0);
     bool LoadModel();
     void SaveModel();
     void GenerateData(std::vector<fvec> &samples, ivec &labels, std::vector<ipair> &sequences, bool &projected);
@@ -0,0 +1,71 @@
+/*********************************************************************
+MLDemos: A User-Friendly visualization toolkit for machine learning
+Copyright (C) 2010  Basilio Noris
+Contact: mldemos@b4silio.com
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public License,
+version 3 as published by the Free Software Foundation.
+
+This library is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free
+Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*********************************************************************/
+#include "drawFastHMM.h"
+#include "canvas.h"
+#include "drawUtils.h"
+
+using namespace std;
+
+void DrawFastHMM(Canvas *canvas, QPainter &painter, const std::vector<FastHMM*> &models,
+                 const std::vector< std::vector< std::vector<fvec> > > &data, float scale)
+{
+    FOR(k, models.size())
+    {
+        FastHMM *model = models[k];
+        if(model->IsGaussian())
+        {
+            fvec sigma(3, 0);
+            FOR(i, model->States())
+            {
+                fvec mean = model->Mean(i);
+                fvec sigmas = model->Sigma(i);
+                FOR(d, mean.size()) mean[d] *= scale;
+                sigma[0] = sigmas[0]*scale;
+                sigma[2] = sigmas.size() > 1 ? sigmas[1]*scale : sigma[0];
+
+                painter.setPen(QPen(Qt::black, 2));
+                DrawEllipse(&mean[0], &sigma[0], 0.5, &painter, canvas);
+                painter.setPen(QPen(Qt::black, 1));
+                DrawEllipse(&mean[0], &sigma[0], 1, &painter, canvas);
+
+                QPointF point = canvas->toCanvasCoords(mean);
+                QColor color = SampleColor[(i+1)%SampleColorCnt];
+                painter.setPen(QPen(Qt::black, 12));
+                painter.drawEllipse(point, 8, 8);
+                painter.setPen(QPen(color,4));
+                painter.drawEllipse(point, 8, 8);
+            }
+        }
+
+        if(k >= data.size()) continue;
+        FOR(i, data[k].size())
+        {
+            const std::vector<fvec> &trajectory = data[k][i];
+            ivec stateSequence;
+            model->Viterbi(trajectory, stateSequence);
+            FOR(j, stateSequence.size())
+            {
+                fvec sample = trajectory[j];
+                FOR(d, sample.size()) sample[d] *= scale;
+                QPointF point = canvas->toCanvasCoords(sample);
+                Canvas::drawSample(painter, point, 8, stateSequence[j]+1);
+            }
+        }
+    }
+}
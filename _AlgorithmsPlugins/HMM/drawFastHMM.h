@@ -0,0 +1,33 @@
+/*********************************************************************
+MLDemos: A User-Friendly visualization toolkit for machine learning
+Copyright (C) 2010  Basilio Noris
+Contact: mldemos@b4silio.com
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public License,
+version 3 as published by the Free Software Foundation.
+
+This library is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free
+Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*********************************************************************/
+#ifndef _DRAW_FAST_HMM_H_
+#define _DRAW_FAST_HMM_H_
+
+#include <vector>
+#include <QPainter>
+#include "fastHMM.h"
+
+class Canvas;
+
+// states of the HMMlib models (gaussian models only) and the viterbi path of each training sequence.
+// data holds the sequences of each model, scale brings them back to canvas coordinates
+void DrawFastHMM(Canvas *canvas, QPainter &painter, const std::vector<FastHMM*> &models,
+                 const std::vector< std::vector< std::vector<fvec> > > &data, float scale);
+
+#endif // _DRAW_FAST_HMM_H_
@@ -34,6 +34,7 @@ DynamicalHMM::~DynamicalHMM()
         DEL(b[i]);
         DEL(a[i]);
     }
+    FOR(i, fastHMM.size()) DEL(fastHMM[i]);
 }
 
 void DynamicalHMM::Train(std::vector< std::vector<fvec> > trajectories, ivec trajLabels)
@@ -54,9 +55,11 @@ void DynamicalHMM::Train(std::vector< std::vector<fvec> > trajectories, ivec tra
             DEL(a[i]);
         }
     }
+    FOR(i, fastHMM.size()) DEL(fastHMM[i]);
+    fastHMM.clear();
 
 	int nbDimensions = dim/2;
-	int nbSymbols = 1000;
+	int nbSymbols = DYNAMICAL_HMM_SYMBOLS;
 	int nbStates = states;
 	int seed = QTime::currentTime().msec();
 	bool isGaussian = obsType == 0;
@@ -71,7 +74,7 @@ void DynamicalHMM::Train(std::vector< std::vector<fvec> > trajectories, ivec tra
 			FOR(d, dim)
 			{
 				float v = trajectories[i][j][d];
-				v *= 1000.f;
+				v *= nbSymbols;
 				trajectories[i][j][d] = v;
 			}
 		}
@@ -93,6 +96,19 @@ void DynamicalHMM::Train(std::vector< std::vector<fvec> > trajectories, ivec tra
         data[(int)(trajLabels[i]-1)].push_back(trajectories[i]);
     }
 
+    // histograms of DYNAMICAL_HMM_SYMBOLS bins per dimension seldom fit in a joint HMMlib alphabet, they then stay on LAMP
+    if(engine == 1 && FastHMM::Supports(nbDimensions, isGaussian, nbSymbols))
+    {
+        FOR(i, NClass)
+        {
+            FastHMM *hmm = new FastHMM(nbStates, nbDimensions, isGaussian, nbSymbols);
+            hmm->Init(data[i], whichInitialVector, whichTransitionMatrix, seed);
+            hmm->Train(data[i]);
+            fastHMM.push_back(hmm);
+        }
+        return;
+    }
+
     FOR(i, NClass)
     {
         CObs *obsType;
@@ -195,7 +211,7 @@ fVec DynamicalHMM::Test( const fVec &sample)
 	return res;
 }
 
-void DynamicalHMM::SetParams(int mixtures, int states, int trainType, int obsType, int initType, int transType)
+void DynamicalHMM::SetParams(int mixtures, int states, int trainType, int obsType, int initType, int transType, int engine)
 {
 	this->mixtures = mixtures;
 	this->states = states;
@@ -203,6 +219,7 @@ void DynamicalHMM::SetParams(int mixtures, int states, int trainType, int obsTyp
 	this->obsType = obsType;
     this->initType = initType;
     this->transType = transType;
+    this->engine = engine;
 }
 
 char *DynamicalHMM::GetInfoString()
@@ -32,19 +32,24 @@ Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
 #include <LAMP_HMM/explicitDurationTrans.h>
 #include <LAMP_HMM/initStateProb.h>
 #include <LAMP_HMM/hmm.h>
+#include "fastHMM.h"
+
+// the trajectories are scaled by the number of symbols per dimension before training
+#define DYNAMICAL_HMM_SYMBOLS 1000
 
 class DynamicalHMM : public Dynamical
 {
 public:
-    int mixtures, states, trainType, obsType, initType, transType;
+    int mixtures, states, trainType, obsType, initType, transType, engine;
     std::vector<CStateTrans*> a;
     std::vector<CObsProb*> b;
     std::vector<CInitStateProb*> pi;
     std::vector<CHMM*> learnedHMM;
+    std::vector<FastHMM*> fastHMM; // engine 1: HMMlib, Baum-Welch only
 	std::vector< std::vector<fvec> > trajectories;
     std::vector< std::vector<std::vector<fvec> > > data;
 public:
-    DynamicalHMM() : mixtures(1), states(1), trainType(1), obsType(0), initType(0), transType(0), a(0), b(0), pi(0), learnedHMM(0){};
+    DynamicalHMM() : mixtures(1), states(1), trainType(1), obsType(0), initType(0), transType(0), engine(0), a(0), b(0), pi(0), learnedHMM(0){};
 	~DynamicalHMM();
     void Train(std::vector< std::vector<fvec> > trajectories, ivec labels);
     std::vector<fvec> Test( const fvec &sample, const int count);
@@ -53,7 +58,7 @@ public:
     char *GetInfoString();
     bool IsOrphanedState(int HMMClass, int state);
 
-    void SetParams(int mixtures, int states, int trainType, int obsType, int initType, int transType);
+    void SetParams(int mixtures, int states, int trainType, int obsType, int initType, int transType, int engine=0);
 };
 
 #endif // _DYNAMICAL_HMM_H_
@@ -0,0 +1,431 @@
+/*********************************************************************
+MLDemos: A User-Friendly visualization toolkit for machine learning
+Copyright (C) 2010  Basilio Noris
+Contact: mldemos@b4silio.com
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Library General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free
+Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*********************************************************************/
+#include "public.h"
+#include "fastHMM.h"
+#include "trainingControl.h"
+#include <algorithm>
+
+using namespace std;
+
+// observations whose gaussian emissions are computed together
+#define FASTHMM_BLOCK 64
+// floor of the emission table, keeps every observation reachable from every state
+#define FASTHMM_MIN_EMISSION 1e-100
+// pseudo-count added to each symbol of the discrete emissions
+#define FASTHMM_SYMBOL_PRIOR 1e-3
+// smallest variance of a state, relative to the variance of the data
+#define FASTHMM_MIN_VARIANCE 1e-4
+
+typedef hmmlib::SSEOperatorTraits<double, __m128d> SSE;
+
+// expected counts gathered by the E-step
+struct FastHMMStats
+{
+    FastHMM::HVector pi;
+    FastHMM::HMatrix trans;
+    FastHMM::HMatrix symbols;
+    std::vector<double> occupancy, sum, sum2;
+    double logLikelihood;
+    int length;
+
+    FastHMMStats(int states, int dim, int alphabet)
+        : pi(states), trans(states, states), symbols(max(1, alphabet), states),
+          occupancy(states, 0), sum(states*dim, 0), sum2(states*dim, 0), logLikelihood(0), length(0) {}
+
+    static void Add(FastHMM::HMatrix &table, const FastHMM::HMatrix &other)
+    {
+        int chunks = table.get_no_chunks_per_row();
+        FOR(r, table.get_no_rows())
+        {
+            FOR(c, chunks) table.get_chunk(r, c) += other.get_chunk(r, c);
+        }
+    }
+
+    void Add(const FastHMMStats &other)
+    {
+        FOR(c, pi.get_no_chunks_per_row()) pi.get_chunk(c) += other.pi.get_chunk(c);
+        Add(trans, other.trans);
+        Add(symbols, other.symbols);
+        FOR(i, occupancy.size()) occupancy[i] += other.occupancy[i];
+        FOR(i, sum.size())
+        {
+            sum[i] += other.sum[i];
+            sum2[i] += other.sum2[i];
+        }
+        logLikelihood += other.logLikelihood;
+        length += other.length;
+    }
+};
+
+FastHMM::FastHMM(int states, int dim, bool bGaussian, int nbSymbols)
+    : states(max(1, states)), dim(max(1, dim)), nbSymbols(max(1, nbSymbols)), alphabet(0), bGaussian(bGaussian)
+{
+    pi = boost::shared_ptr<HVector>(new HVector(this->states, 1./this->states));
+    trans = boost::shared_ptr<HMatrix>(new HMatrix(this->states, this->states, 1./this->states));
+    if(bGaussian)
+    {
+        means.resize(this->states*this->dim, 0);
+        variances.resize(this->states*this->dim, 1);
+        minVariances.resize(this->dim, 0);
+    }
+    else
+    {
+        alphabet = (int)min(AlphabetSize(this->dim, this->nbSymbols), (long long)FASTHMM_MAX_ALPHABET);
+        symbols = boost::shared_ptr<HMatrix>(new HMatrix(alphabet, this->states, 1./alphabet));
+    }
+}
+
+long long FastHMM::AlphabetSize(int dim, int nbSymbols)
+{
+    long long size = 1;
+    FOR(d, max(1, dim))
+    {
+        size *= max(1, nbSymbols);
+        if(size > FASTHMM_MAX_ALPHABET) return FASTHMM_MAX_ALPHABET + 1;
+    }
+    return size;
+}
+
+unsigned int FastHMM::Symbol(const fvec &sample) const
+{
+    // each dimension is a digit in base nbSymbols
+    unsigned int symbol = 0;
+    for(int d=dim-1; d>=0; d--)
+    {
+        int bin = max(0, min(nbSymbols-1, (int)sample[d]));
+        symbol = symbol*nbSymbols + bin;
+    }
+    return min(symbol, (unsigned int)alphabet-1);
+}
+
+double FastHMM::GaussianEmissions(const std::vector<fvec> &samples, HMatrix &emissions) const
+{
+    int length = samples.size();
+    double logOffset = 0;
+    std::vector<double> block(dim*FASTHMM_BLOCK);
+    double distance[FASTHMM_BLOCK];
+    for(int start=0; start<length; start+=FASTHMM_BLOCK)
+    {
+        int count = min(FASTHMM_BLOCK, length-start);
+        // the block is stored dimension by dimension so that the inner loops run over the observations
+        FOR(d, dim)
+        {
+            FOR(t, count) block[d*FASTHMM_BLOCK + t] = samples[start+t][d];
+        }
+        FOR(s, states)
+        {
+            const double *mean = &means[s*dim];
+            const double *variance = &variances[s*dim];
+            double logNorm = 0;
+            FOR(d, dim) logNorm -= 0.5*log(2*M_PI*variance[d]);
+            FOR(t, count) distance[t] = 0;
+            FOR(d, dim)
+            {
+                const double *values = &block[d*FASTHMM_BLOCK];
+                double mu = mean[d], invVariance = 1./variance[d];
+                FOR(t, count)
+                {
+                    double diff = values[t] - mu;
+                    distance[t] += diff*diff*invVariance;
+                }
+            }
+            FOR(t, count) emissions(start+t, s) = logNorm - 0.5*distance[t];
+        }
+        // each row is divided by its largest emission before leaving the log domain
+        FOR(t, count)
+        {
+            int row = start+t;
+            double maxLog = emissions(row, 0);
+            for(int s=1; s<states; s++) maxLog = max(maxLog, emissions(row, s));
+            FOR(s, states) emissions(row, s) = max(FASTHMM_MIN_EMISSION, exp(emissions(row, s) - maxLog));
+            logOffset += maxLog;
+        }
+    }
+    return logOffset;
+}
+
+double FastHMM::Emissions(const std::vector<fvec> &samples, ::sequence &observations, boost::shared_ptr<HMatrix> &emissions) const
+{
+    int length = samples.size();
+    observations.resize(length);
+    if(!bGaussian)
+    {
+        FOR(t, length) observations[t] = Symbol(samples[t]);
+        emissions = symbols;
+        return 0;
+    }
+    FOR(t, length) observations[t] = t;
+    emissions = boost::shared_ptr<HMatrix>(new HMatrix(length, states));
+    return GaussianEmissions(samples, *emissions);
+}
+
+double FastHMM::Accumulate(const std::vector<fvec> &samples, FastHMMStats &stats) const
+{
+    int length = samples.size();
+    if(!length) return 0;
+    ::sequence observations;
+    boost::shared_ptr<HMatrix> emissions;
+    double logOffset = Emissions(samples, observations, emissions);
+    hmmlib::HMM<double> hmm(pi, trans, emissions);
+
+    HVector scales(length);
+    HMatrix F(length, states), B(length, states), gamma(length, states);
+    hmm.forward(observations, scales, F);
+    hmm.backward(observations, scales, B);
+
+    const HMatrix &T = *trans;
+    const HMatrix &E = *emissions;
+    int chunks = F.get_no_chunks_per_row();
+    FOR(t, length)
+    {
+        __m128d scale;
+        SSE::set_all(scale, 1./scales(t));
+        FOR(c, chunks) gamma.get_chunk(t, c) = F.get_chunk(t, c) * B.get_chunk(t, c) * scale;
+    }
+    FOR(c, chunks) stats.pi.get_chunk(c) += gamma.get_chunk(0, c);
+
+    // transitions: F(t-1,i) T(i,j) E(x_t,j) B(t,j)
+    HVector emitted(states);
+    for(int t=1; t<length; t++)
+    {
+        unsigned int x = observations[t];
+        FOR(c, chunks) emitted.get_chunk(c) = E.get_chunk(x, c) * B.get_chunk(t, c);
+        FOR(i, states)
+        {
+            __m128d previous;
+            SSE::set_all(previous, F(t-1, i));
+            FOR(c, chunks) stats.trans.get_chunk(i, c) += previous * T.get_chunk(i, c) * emitted.get_chunk(c);
+        }
+    }
+
+    if(bGaussian)
+    {
+        FOR(t, length)
+        {
+            const fvec &sample = samples[t];
+            FOR(s, states)
+            {
+                double g = gamma(t, s);
+                stats.occupancy[s] += g;
+                double *sum = &stats.sum[s*dim];
+                double *sum2 = &stats.sum2[s*dim];
+                FOR(d, dim)
+                {
+                    sum[d] += g*sample[d];
+                    sum2[d] += g*sample[d]*sample[d];
+                }
+            }
+        }
+    }
+    else
+    {
+        FOR(t, length)
+        {
+            FOR(c, chunks) stats.symbols.get_chunk(observations[t], c) += gamma.get_chunk(t, c);
+        }
+    }
+    stats.length += length;
+    return hmm.likelihood(scales) + logOffset;
+}
+
+void FastHMM::Maximize(const FastHMMStats &stats)
+{
+    // states without counts keep their previous parameters
+    double piSum = 0;
+    FOR(i, states) piSum += stats.pi(i);
+    if(piSum > 0)
+    {
+        FOR(i, states) (*pi)(i) = stats.pi(i) / piSum;
+    }
+    FOR(i, states)
+    {
+        double rowSum = 0;
+        FOR(j, states) rowSum += stats.trans(i, j);
+        if(rowSum <= 0) continue;
+        FOR(j, states) (*trans)(i, j) = stats.trans(i, j) / rowSum;
+    }
+    if(bGaussian)
+    {
+        FOR(s, states)
+        {
+            double occupancy = stats.occupancy[s];
+            if(occupancy <= DBL_MIN) continue;
+            FOR(d, dim)
+            {
+                double mean = stats.sum[s*dim + d] / occupancy;
+                means[s*dim + d] = mean;
+                variances[s*dim + d] = max(minVariances[d], stats.sum2[s*dim + d] / occupancy - mean*mean);
+            }
+        }
+    }
+    else
+    {
+        HMatrix &E = *symbols;
+        FOR(s, states)
+        {
+            double columnSum = 0;
+            FOR(a, alphabet) columnSum += stats.symbols(a, s);
+            double norm = 1. / (columnSum + alphabet*FASTHMM_SYMBOL_PRIOR);
+            FOR(a, alphabet) E(a, s) = (stats.symbols(a, s) + FASTHMM_SYMBOL_PRIOR) * norm;
+        }
+    }
+}
+
+void FastHMM::Init(const std::vector< std::vector<fvec> > &sequences, int initType, int transType, int seed)
+{
+    srand(seed);
+    HVector &P = *pi;
+    switch(initType)
+    {
+    case 1:
+        FOR(i, states) P(i) = 0.5 + rand()/(double)RAND_MAX;
+        break;
+    case 2:
+        FOR(i, states) P(i) = i ? 0. : 1.;
+        break;
+    default:
+        FOR(i, states) P(i) = 1.;
+        break;
+    }
+    HMatrix &T = *trans;
+    bool bLeftRight = transType >= 2;
+    bool bUniform = transType == 1 || transType == 3;
+    FOR(i, states)
+    {
+        FOR(j, states)
+        {
+            if(bLeftRight && j < i) T(i, j) = 0;
+            else T(i, j) = bUniform ? 1. : 0.5 + rand()/(double)RAND_MAX;
+        }
+    }
+    // normalized by Maximize, which is given the counts of an even split of the sequences
+    FastHMMStats stats(states, dim, alphabet);
+    FOR(i, states)
+    {
+        stats.pi(i) = P(i);
+        FOR(j, states) stats.trans(i, j) = T(i, j);
+    }
+    std::vector<double> mean(dim, 0), mean2(dim, 0);
+    int total = 0;
+    FOR(i, sequences.size())
+    {
+        int length = sequences[i].size();
+        FOR(t, length)
+        {
+            const fvec &sample = sequences[i][t];
+            int s = t*states/length;
+            if(bGaussian)
+            {
+                stats.occupancy[s] += 1;
+                FOR(d, dim)
+                {
+                    stats.sum[s*dim + d] += sample[d];
+                    stats.sum2[s*dim + d] += sample[d]*sample[d];
+                    mean[d] += sample[d];
+                    mean2[d] += sample[d]*sample[d];
+                }
+            }
+            else stats.symbols(Symbol(sample), s) += 1;
+        }
+        total += length;
+    }
+    if(bGaussian)
+    {
+        FOR(d, dim)
+        {
+            double variance = total ? mean2[d]/total - (mean[d]/total)*(mean[d]/total) : 1.;
+            minVariances[d] = max(DBL_MIN, variance*FASTHMM_MIN_VARIANCE);
+        }
+    }
+    Maximize(stats);
+}
+
+double FastHMM::Train(const std::vector< std::vector<fvec> > &sequences, int maxIterations, double tolerance)
+{
+    int count = sequences.size();
+    double logLikelihood = 0, previous = 0;
+    FOR(iteration, maxIterations)
+    {
+        if(TrainingControl::Cancelled()) break;
+        TrainingControl::Progress(iteration / (float)maxIterations);
+        // the sequences are shared among the threads, which gather their own counts
+        FastHMMStats stats(states, dim, alphabet);
+#pragma omp parallel
+        {
+            FastHMMStats local(states, dim, alphabet);
+#pragma omp for schedule(dynamic) nowait
+            for(int i=0; i<count; i++) local.logLikelihood += Accumulate(sequences[i], local);
+#pragma omp critical
+            stats.Add(local);
+        }
+        if(!stats.length) break;
+        logLikelihood = stats.logLikelihood / stats.length;
+        Maximize(stats);
+        if(iteration && fabs(logLikelihood - previous) <= tolerance*fabs(previous)) break;
+        previous = logLikelihood;
+    }
+    return logLikelihood;
+}
+
+double FastHMM::LogLikelihood(const std::vector<fvec> &samples) const
+{
+    int length = samples.size();
+    if(!length) return 0;
+    ::sequence observations;
+    boost::shared_ptr<HMatrix> emissions;
+    double logOffset = Emissions(samples, observations, emissions);
+    hmmlib::HMM<double> hmm(pi, trans, emissions);
+    HVector scales(length);
+    HMatrix F(length, states);
+    hmm.forward(observations, scales, F);
+    return hmm.likelihood(scales) + logOffset;
+}
+
+double FastHMM::Viterbi(const std::vector<fvec> &samples, ivec &stateSequence) const
+{
+    int length = samples.size();
+    stateSequence.clear();
+    if(!length) return 0;
+    ::sequence observations;
+    boost::shared_ptr<HMatrix> emissions;
+    double logOffset = Emissions(samples, observations, emissions);
+    hmmlib::HMM<double> hmm(pi, trans, emissions);
+    ::sequence hidden(length);
+    double logLikelihood = hmm.viterbi(observations, hidden);
+    stateSequence.resize(length);
+    FOR(t, length) stateSequence[t] = hidden[t];
+    return logLikelihood + logOffset;
+}
+
+fvec FastHMM::Mean(int state) const
+{
+    fvec mean(dim, 0);
+    if(!bGaussian) return mean;
+    FOR(d, dim) mean[d] = means[state*dim + d];
+    return mean;
+}
+
+fvec FastHMM::Sigma(int state) const
+{
+    fvec sigma(dim, 0);
+    if(!bGaussian) return sigma;
+    FOR(d, dim) sigma[d] = sqrt(variances[state*dim + d]);
+    return sigma;
+}
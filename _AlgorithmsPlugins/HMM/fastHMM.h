@@ -0,0 +1,83 @@
+/*********************************************************************
+MLDemos: A User-Friendly visualization toolkit for machine learning
+Copyright (C) 2010  Basilio Noris
+Contact: mldemos@b4silio.com
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public License,
+version 3 as published by the Free Software Foundation.
+
+This library is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free
+Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*********************************************************************/
+#ifndef _FAST_HMM_H_
+#define _FAST_HMM_H_
+
+#include <vector>
+#include "public.h"
+#include <HMMlib/hmm.hpp>
+
+struct FastHMMStats;
+
+// largest joint alphabet of a discrete model: the tables are alphabet x states, and one copy is kept per thread
+#define FASTHMM_MAX_ALPHABET 65536
+
+// hidden markov model running on the SSE tables of HMMlib.
+// Discrete models quantize each dimension into nbSymbols bins and emit the joint bin,
+// gaussian models have one diagonal gaussian per state: the emission table of a sequence
+// then holds one row per observation and the observations are fed to HMMlib as 0..length-1
+class FastHMM
+{
+public:
+    typedef hmmlib::HMMVector<double> HVector;
+    typedef hmmlib::HMMMatrix<double> HMatrix;
+
+    FastHMM(int states, int dim, bool bGaussian, int nbSymbols);
+    // nbSymbols^dim, saturated just above FASTHMM_MAX_ALPHABET
+    static long long AlphabetSize(int dim, int nbSymbols);
+    // false when the discrete alphabet is too large for HMMlib, the callers then train on LAMP
+    static bool Supports(int dim, bool bGaussian, int nbSymbols){return bGaussian || AlphabetSize(dim, nbSymbols) <= FASTHMM_MAX_ALPHABET;}
+    // initType: 0 uniform, 1 random, 2 first state
+    // transType: 0 ergodic random, 1 ergodic uniform, 2 left-right random, 3 left-right uniform
+    // the emissions are estimated on an even split of each sequence among the states
+    void Init(const std::vector< std::vector<fvec> > &sequences, int initType, int transType, int seed);
+    // Baum-Welch over all the sequences, returns the log-likelihood per observation
+    double Train(const std::vector< std::vector<fvec> > &sequences, int maxIterations=100, double tolerance=1e-5);
+    double LogLikelihood(const std::vector<fvec> &samples) const;
+    // most likely state sequence, returns its log-likelihood
+    double Viterbi(const std::vector<fvec> &samples, ivec &stateSequence) const;
+
+    int States() const {return states;}
+    int Dim() const {return dim;}
+    bool IsGaussian() const {return bGaussian;}
+    double Initial(int state) const {return (*pi)(state);}
+    double Transition(int from, int to) const {return (*trans)(from, to);}
+    fvec Mean(int state) const;
+    // standard deviation of each dimension
+    fvec Sigma(int state) const;
+
+private:
+    int states, dim, nbSymbols, alphabet;
+    bool bGaussian;
+    boost::shared_ptr<HVector> pi;
+    boost::shared_ptr<HMatrix> trans;
+    boost::shared_ptr<HMatrix> symbols; // alphabet x states, discrete models only
+    std::vector<double> means, variances, minVariances; // states x dim, gaussian models only
+
+    unsigned int Symbol(const fvec &sample) const;
+    // fills the emission tables of a gaussian sequence in blocks of observations,
+    // returns the log of the factors taken out of each row to avoid underflows
+    double GaussianEmissions(const std::vector<fvec> &samples, HMatrix &emissions) const;
+    // observations and emission table handed to HMMlib, returns the log of the factors taken out of the table
+    double Emissions(const std::vector<fvec> &samples, ::sequence &observations, boost::shared_ptr<HMatrix> &emissions) const;
+    double Accumulate(const std::vector<fvec> &samples, FastHMMStats &stats) const;
+    void Maximize(const FastHMMStats &stats);
+};
+
+#endif // _FAST_HMM_H_
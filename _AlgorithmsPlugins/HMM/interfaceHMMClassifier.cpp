@@ -18,6 +18,7 @@ Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
 *********************************************************************/
 #include "interfaceHMMClassifier.h"
 #include "drawUtils.h"
+#include "drawFastHMM.h"
 #include <QPixmap>
 #include <QBitmap>
 #include <QPainter>
@@ -40,8 +41,9 @@ void ClassHMM::SetParams(Classifier *classifier)
     int obsType = params->hmmObsCombo->currentIndex();
     int initType = params->hmmInitialCombo->currentIndex();
     int transType = params->hmmTransCombo->currentIndex();
+    int engine = params->hmmEngineCombo->currentIndex();
 
-    ((ClassifierHMM *)classifier)->SetParams(nbSymbol, states, trainType, obsType, initType, transType);
+    ((ClassifierHMM *)classifier)->SetParams(nbSymbol, states, trainType, obsType, initType, transType, engine);
 }
 
 QString ClassHMM::GetAlgoString()
@@ -62,6 +64,12 @@ void ClassHMM::DrawModel(Canvas *canvas, QPainter &painter, Classifier *classifi
     painter.setRenderHint(QPainter::Antialiasing);
 
     ClassifierHMM *hmm = (ClassifierHMM*)classifier;
+    if(hmm->fastHMM.size())
+    {
+        // the models are trained on samples multiplied by the number of symbols
+        DrawFastHMM(canvas, painter, hmm->fastHMM, hmm->data, 1.f/hmm->nbSym);
+        return;
+    }
     // Find number of HMMs trained
     int Nmodel = hmm->learnedHMM.size();
     FOR(k, Nmodel)
@@ -164,6 +172,7 @@ void ClassHMM::SaveOptions(QSettings &settings)
     settings.setValue("hmmStatesCount", params->hmmStatesCount->value());
     settings.setValue("hmmTrainCombo", params->hmmTrainCombo->currentIndex());
     settings.setValue("hmmObsCombo", params->hmmObsCombo->currentIndex());
+    settings.setValue("hmmEngineCombo", params->hmmEngineCombo->currentIndex());
 }
 
 bool ClassHMM::LoadOptions(QSettings &settings)
@@ -172,6 +181,7 @@ bool ClassHMM::LoadOptions(QSettings &settings)
     if(settings.contains("hmmStatesCount")) params->hmmStatesCount->setValue(settings.value("hmmStatesCount").toInt());
     if(settings.contains("hmmTrainCombo")) params->hmmTrainCombo->setCurrentIndex(settings.value("hmmTrainCombo").toInt());
     if(settings.contains("hmmObsCombo")) params->hmmObsCombo->setCurrentIndex(settings.value("hmmObsCombo").toInt());
+    if(settings.contains("hmmEngineCombo")) params->hmmEngineCombo->setCurrentIndex(settings.value("hmmEngineCombo").toInt());
     return true;
 }
 
@@ -181,6 +191,7 @@ void ClassHMM::SaveParams(QTextStream &file)
     file << "dynamicalOptions" << ":" << "hmmStatesCount" << " " << params->hmmStatesCount->value() << "\n";
     file << "dynamicalOptions" << ":" << "hmmTrainCombo" << " " << params->hmmTrainCombo->currentIndex() << "\n";
     file << "dynamicalOptions" << ":" << "hmmObsCombo" << " " << params->hmmObsCombo->currentIndex() << "\n";
+    file << "dynamicalOptions" << ":" << "hmmEngineCombo" << " " << params->hmmEngineCombo->currentIndex() << "\n";
 }
 
 bool ClassHMM::LoadParams(QString name, float value)
@@ -189,5 +200,6 @@ bool ClassHMM::LoadParams(QString name, float value)
     if(name.endsWith("hmmStatesCount")) params->hmmStatesCount->setValue((int)value);
     if(name.endsWith("hmmTrainCombo")) params->hmmTrainCombo->setCurrentIndex((int)value);
     if(name.endsWith("hmmObsCombo")) params->hmmObsCombo->setCurrentIndex((int)value);
+    if(name.endsWith("hmmEngineCombo")) params->hmmEngineCombo->setCurrentIndex((int)value);
     return true;
 }
@@ -18,6 +18,7 @@ Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
 *********************************************************************/
 #include "interfaceHMMDynamic.h"
 #include "drawUtils.h"
+#include "drawFastHMM.h"
 #include <QPixmap>
 #include <QBitmap>
 #include <QPainter>
@@ -41,8 +42,9 @@ void DynamicHMM::SetParams(Dynamical *dynamical)
     int obsType = params->hmmObsCombo->currentIndex();
     int initType = params->hmmInitialCombo->currentIndex();
     int transType = params->hmmTransCombo->currentIndex();
+    int engine = params->hmmEngineCombo->currentIndex();
 
-    ((DynamicalHMM *)dynamical)->SetParams(nbSymbol, states, trainType, obsType, initType, transType);
+    ((DynamicalHMM *)dynamical)->SetParams(nbSymbol, states, trainType, obsType, initType, transType, engine);
 }
 
 Dynamical *DynamicHMM::GetDynamical()
@@ -58,6 +60,11 @@ void DynamicHMM::DrawInfo(Canvas *canvas, QPainter &painter, Dynamical *dynamica
     painter.setRenderHint(QPainter::Antialiasing);
 
     DynamicalHMM *hmm = (DynamicalHMM*)dynamical;
+    if(hmm->fastHMM.size())
+    {
+        DrawFastHMM(canvas, painter, hmm->fastHMM, hmm->data, 1.f/DYNAMICAL_HMM_SYMBOLS);
+        return;
+    }
     // Find number of HMMs trained
     int Nmodel = hmm->learnedHMM.size();
     FOR(k, Nmodel)
@@ -160,6 +167,7 @@ void DynamicHMM::SaveOptions(QSettings &settings)
     settings.setValue("hmmStatesCount", params->hmmStatesCount->value());
     settings.setValue("hmmTrainCombo", params->hmmTrainCombo->currentIndex());
     settings.setValue("hmmObsCombo", params->hmmObsCombo->currentIndex());
+    settings.setValue("hmmEngineCombo", params->hmmEngineCombo->currentIndex());
 }
 
 bool DynamicHMM::LoadOptions(QSettings &settings)
@@ -168,6 +176,7 @@ bool DynamicHMM::LoadOptions(QSettings &settings)
     if(settings.contains("hmmStatesCount")) params->hmmStatesCount->setValue(settings.value("hmmStatesCount").toInt());
     if(settings.contains("hmmTrainCombo")) params->hmmTrainCombo->setCurrentIndex(settings.value("hmmTrainCombo").toInt());
     if(settings.contains("hmmObsCombo")) params->hmmObsCombo->setCurrentIndex(settings.value("hmmObsCombo").toInt());
+    if(settings.contains("hmmEngineCombo")) params->hmmEngineCombo->setCurrentIndex(settings.value("hmmEngineCombo").toInt());
     return true;
 }
 
@@ -177,6 +186,7 @@ void DynamicHMM::SaveParams(QTextStream &file)
     file << "dynamicalOptions" << ":" << "hmmStatesCount" << " " << params->hmmStatesCount->value() << "\n";
     file << "dynamicalOptions" << ":" << "hmmTrainCombo" << " " << params->hmmTrainCombo->currentIndex() << "\n";
     file << "dynamicalOptions" << ":" << "hmmObsCombo" << " " << params->hmmObsCombo->currentIndex() << "\n";
+    file << "dynamicalOptions" << ":" << "hmmEngineCombo" << " " << params->hmmEngineCombo->currentIndex() << "\n";
 }
 
 bool DynamicHMM::LoadParams(QString name, float value)
@@ -185,6 +195,7 @@ bool DynamicHMM::LoadParams(QString name, float value)
     if(name.endsWith("hmmStatesCount")) params->hmmStatesCount->setValue((int)value);
     if(name.endsWith("hmmTrainCombo")) params->hmmTrainCombo->setCurrentIndex((int)value);
     if(name.endsWith("hmmObsCombo")) params->hmmObsCombo->setCurrentIndex((int)value);
+    if(name.endsWith("hmmEngineCombo")) params->hmmEngineCombo->setCurrentIndex((int)value);
     return true;
 }
 
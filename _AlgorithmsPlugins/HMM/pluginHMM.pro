@@ -21,6 +21,8 @@ HEADERS +=	\
     interfaceHMMClassifier.h \
     interfaceHMMDynamic.h \
     pluginHMM.h \
+    fastHMM.h \
+    drawFastHMM.h \
     detectorHMM.h \
     interfaceHMMDetect.h
 
@@ -28,6 +30,8 @@ SOURCES += 	\
     pluginHMM.cpp \
     dynamicalHMM.cpp \
     classifierHMM.cpp \
+    fastHMM.cpp \
+    drawFastHMM.cpp \
     detectorHMM.cpp \
     interfaceHMMClassifier.cpp \
     interfaceHMMDetect.cpp \
@@ -50,3 +54,16 @@ HEADERS += \
 	LAMP_HMM/stateTrans.h \
 	LAMP_HMM/utils.h \
 	LAMP_HMM/vectorObsProb.h
+
+HEADERS += \
+	HMMlib/allocator_traits.hpp \
+	HMMlib/float_traits.hpp \
+	HMMlib/hmm_matrix.hpp \
+	HMMlib/hmm_table.hpp \
+	HMMlib/hmm_vector.hpp \
+	HMMlib/hmm.hpp \
+	HMMlib/operator_traits.hpp \
+	HMMlib/sse_operator_traits.hpp
+
+# HMMlib works on SSE3 registers (_mm_hadd_pd)
+!win32-msvc*:QMAKE_CXXFLAGS += -msse3
@@ -20,7 +20,9 @@ Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
 #include "public.h"
 #include "basicMath.h"
 #include "classifierKNN.h"
+#include "modelArchive.h"
 #include <map>
+#include <sstream>
 #include <QDebug>
 using namespace std;
 
@@ -41,7 +43,13 @@ void ClassifierKNN::Train( std::vector< fvec > samples, ivec labels )
 		FOR(j, dim) dataPts[i][j] = samples[i][j];
 	}
 	kdTree = new ANNkd_tree(dataPts, samples.size(), dim);
+    MapClasses();
+}
 
+void ClassifierKNN::MapClasses()
+{
+    classMap.clear();
+    inverseMap.clear();
     int cnt=0;
     bool bClassZero=false, bClassOne=false;
     FOR(i, labels.size()) {
@@ -54,6 +62,48 @@ void ClassifierKNN::Train( std::vector< fvec > samples, ivec labels )
     for(map<int,int>::iterator it=classMap.begin(); it != classMap.end(); it++) inverseMap[it->second] = it->first;
 }
 
+bool ClassifierKNN::SaveModel(ModelArchive &archive) const
+{
+    if(!kdTree || !samples.size()) return false;
+    // the tree is dumped along with its points, which spares its construction when loading
+    std::ostringstream dump;
+    kdTree->Dump(ANNtrue, dump);
+    archive.AddString("knn.tree", dump.str());
+    archive.AddSamples("knn.samples", samples);
+    archive.AddVector("knn.labels", labels);
+    return true;
+}
+
+bool ClassifierKNN::LoadModel(const ModelArchive &archive)
+{
+    vector<fvec> samples;
+    ivec labels;
+    if(!archive.Has("knn.tree") || !archive.GetSamples("knn.samples", samples) || !archive.GetVector("knn.labels", labels)) return false;
+    if(!samples.size() || samples.size() != labels.size()) return false;
+    DEL(kdTree);
+    annClose();
+    ANN::MetricType = (ANN_METRIC)metricType;
+    ANN::MetricPower = metricP;
+    std::istringstream dump(archive.GetString("knn.tree"));
+    kdTree = new ANNkd_tree(dump);
+    if(kdTree->nPoints() != (int)samples.size() || kdTree->theDim() != (int)samples[0].size())
+    {
+        DEL(kdTree);
+        return false;
+    }
+    // the dump is in text, the points are restored to their exact values
+    dataPts = kdTree->thePoints();
+    FOR(i, samples.size())
+    {
+        FOR(j, samples[i].size()) dataPts[i][j] = samples[i][j];
+    }
+    this->samples = samples;
+    this->labels = labels;
+    dim = samples[0].size();
+    MapClasses();
+    return true;
+}
+
 ClassifierKNN::~ClassifierKNN()
 {
 	annClose();
@@ -37,6 +37,7 @@ private:
 	int metricP;
 	std::map<int,int> counts;
     bool bBinary;
+    void MapClasses();
 
 public:
     ClassifierKNN(): k(1), nPts(0), dataPts(0), nnIdx(0), dists(0), kdTree(0), metricType(2), metricP(2), bBinary(false) {bMultiClass = true;}
@@ -47,6 +48,8 @@ public:
     float Test( const fVec &sample) const ;
 	void SetParams(u32 k, int metricType, u32 metricP);
     const char *GetInfoString() const ;
+    bool SaveModel(ModelArchive &archive) const ;
+    bool LoadModel(const ModelArchive &archive);
 };
 
 #endif // _CLASSIFIER_KNN_H_
@@ -20,6 +20,8 @@ Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
 #include "public.h"
 #include "basicMath.h"
 #include "regressorKNN.h"
+#include "modelArchive.h"
+#include <sstream>
 using namespace std;
 
 void RegressorKNN::Train( std::vector< fvec > samples, ivec labels )
@@ -45,6 +47,52 @@ void RegressorKNN::Train( std::vector< fvec > samples, ivec labels )
 	kdTree = new ANNkd_tree(dataPts, samples.size(), dim);
 }
 
+bool RegressorKNN::SaveModel(ModelArchive &archive)
+{
+    if(!kdTree || !samples.size()) return false;
+    // the tree is dumped along with its points, which spares its construction when loading
+    std::ostringstream dump;
+    kdTree->Dump(ANNtrue, dump);
+    archive.AddString("knn.tree", dump.str());
+    archive.AddSamples("knn.samples", samples);
+    archive.AddVector("knn.labels", labels);
+    archive.AddValue("knn.outputDim", outputDim);
+    return true;
+}
+
+bool RegressorKNN::LoadModel(const ModelArchive &archive)
+{
+    vector<fvec> samples;
+    ivec labels;
+    int outputDim;
+    if(!archive.Has("knn.tree") || !archive.GetSamples("knn.samples", samples) || !archive.GetVector("knn.labels", labels) ||
+            !archive.GetValue("knn.outputDim", outputDim)) return false;
+    if(!samples.size() || samples[0].size() < 2) return false;
+    DEL(kdTree);
+    annClose();
+    ANN::MetricType = (ANN_METRIC)metricType;
+    ANN::MetricPower = metricP;
+    std::istringstream dump(archive.GetString("knn.tree"));
+    kdTree = new ANNkd_tree(dump);
+    if(kdTree->nPoints() != (int)samples.size() || kdTree->theDim() != (int)samples[0].size()-1)
+    {
+        DEL(kdTree);
+        return false;
+    }
+    this->samples = samples;
+    this->labels = labels;
+    this->outputDim = outputDim;
+    dim = samples[0].size()-1;
+    // the dump is in text, the points are restored to their exact values
+    dataPts = kdTree->thePoints();
+    FOR(i, samples.size())
+    {
+        FOR(j, dim) dataPts[i][j] = samples[i][j];
+        if(outputDim != -1 && outputDim < dim) dataPts[i][outputDim] = samples[i][dim];
+    }
+    return true;
+}
+
 RegressorKNN::~RegressorKNN()
 {
 	annClose();
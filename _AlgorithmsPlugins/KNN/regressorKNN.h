@@ -41,6 +41,8 @@ public:
 	fvec Test( const fvec &sample);
 	fVec Test( const fVec &sample);
     const char *GetInfoString();
+    bool SaveModel(ModelArchive &archive);
+    bool LoadModel(const ModelArchive &archive);
 
 	void SetParams(u32 k, int metricType, u32 metricP);
 };
@@ -25,6 +25,7 @@ Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
 #include <string.h>
 #include <stdarg.h>
 #include "svm.h"
+#include "trainingControl.h"
 #ifdef WIN32
 #pragma warning(disable : 4996)
 #endif
@@ -643,6 +644,13 @@ void Solver::Solve(int l, const Q_Matrix& Q, const double *p_, const schar *y_,
 			info("."); info_flush();
 			counter = min(l,1000);
 			if(shrinking) do_shrinking();
+			// the iterations are capped above, which gives the progress of a background training
+			TrainingControl::Progress(iter/10000.f);
+			if(TrainingControl::Cancelled())
+			{
+				reconstruct_gradient();
+				break;
+			}
 		}
 
 		int i,j;
@@ -145,10 +145,13 @@ void RegrLWPR::DrawModel(Canvas *canvas, QPainter &painter, Regressor *regressor
 	int steps = w;
 	painter.setBrush(Qt::NoBrush);
     QPainterPath path, pathUp, pathDown;
+	std::vector<fvec> samples(steps);
+	FOR(x, steps) samples[x] = canvas->toSampleCoords(x,0);
+	std::vector<fvec> results = ((RegressorLWPR*)regressor)->TestBatch(samples);
 	FOR(x, steps)
 	{
-		sample = canvas->toSampleCoords(x,0);
-		fvec res = regressor->Test(sample);
+		sample = samples[x];
+		fvec &res = results[x];
 		if(res[0] != res[0]) continue;
         QPointF point = canvas->toCanvasCoords(sample[xIndex], res[0]);
         QPointF pointUp = canvas->toCanvasCoords(sample[xIndex],res[0] + res[1]);
@@ -19,6 +19,9 @@ Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
 *********************************************************************/
 #include "public.h"
 #include "regressorLWPR.h"
+#include "modelArchive.h"
+#include <iostream>
+#include <stdio.h>
 
 using namespace std;
 
@@ -74,6 +77,122 @@ fvec RegressorLWPR::Test( const fvec &sample)
 	return res;
 }
 
+std::vector<fvec> RegressorLWPR::TestBatch(const std::vector<fvec> &samples)
+{
+    int count = samples.size();
+    std::vector<fvec> res(count, fvec(2,0));
+    if(!model || !count) return res;
+    int dim = samples[0].size();
+    dvec x(count*(dim-1));
+    FOR(i, count)
+    {
+        double *xi = &x[i*(dim-1)];
+        FOR(d, dim-1) xi[d] = samples[i][d];
+        if(outputDim != -1 && outputDim < dim-1) xi[outputDim] = samples[i][dim-1];
+    }
+    dvec sigma;
+    dvec y = model->predictBatch(x, sigma);
+    FOR(i, count)
+    {
+        res[i][0] = y[i];
+        res[i][1] = sqrtf(sigma[i]);
+    }
+    return res;
+}
+
+void RegressorLWPR::SaveModel(std::string filename)
+{
+    std::cout << "saving LWPR model" << std::endl;
+    if(!model)
+    {
+        std::cout << "Error: Nothing to save!" << std::endl;
+        return;
+    }
+    FILE *file = fopen(filename.c_str(), "wb");
+    if(!file)
+    {
+        std::cout << "Error: Could not open the file!" << std::endl;
+        return;
+    }
+    // a short text header, followed by the model in the lwpr binary format
+    fprintf(file, "LWPR %d %d\n", dim, outputDim);
+    if(!lwpr_write_binary_fp(&model->model, file)) std::cout << "Error: Could not write the model!" << std::endl;
+    fclose(file);
+}
+
+// reads a model in the lwpr binary format, NULL if it fails or does not match the dimension
+static LWPR_Object *ReadModel(FILE *file, int dim)
+{
+    LWPR_Object *loaded = new LWPR_Object(dim-1, 1);
+    lwpr_free_model(&loaded->model);
+    bool bOk = lwpr_read_binary_fp(&loaded->model, file);
+    // the reader releases the model when it fails, the object still needs a valid one to free
+    if(!bOk) lwpr_init_model(&loaded->model, 1, 1, NULL);
+    if(!bOk || loaded->model.nIn != dim-1 || loaded->model.nOut != 1)
+    {
+        delete loaded;
+        return 0;
+    }
+    return loaded;
+}
+
+bool RegressorLWPR::LoadModel(std::string filename)
+{
+    std::cout << "loading LWPR model: " << filename << std::endl;
+    FILE *file = fopen(filename.c_str(), "rb");
+    if(!file)
+    {
+        std::cout << "Error: Could not open the file!" << std::endl;
+        return false;
+    }
+    int fileDim, fileOutputDim;
+    if(fscanf(file, "LWPR %d %d", &fileDim, &fileOutputDim) != 2 || fgetc(file) != '\n')
+    {
+        std::cout << "Error: Not an LWPR model file!" << std::endl;
+        fclose(file);
+        return false;
+    }
+    LWPR_Object *loaded = ReadModel(file, fileDim);
+    fclose(file);
+    if(!loaded)
+    {
+        std::cout << "Error: Could not read the model!" << std::endl;
+        return false;
+    }
+    DEL(model);
+    model = loaded;
+    dim = fileDim;
+    outputDim = fileOutputDim;
+    return true;
+}
+
+bool RegressorLWPR::SaveModel(ModelArchive &archive)
+{
+    if(!model) return false;
+    FILE *file = tmpfile();
+    bool bOk = file && lwpr_write_binary_fp(&model->model, file) && archive.AddFile("lwpr.model", file);
+    if(file) fclose(file);
+    archive.AddValue("lwpr.dim", (int)dim);
+    archive.AddValue("lwpr.outputDim", outputDim);
+    return bOk;
+}
+
+bool RegressorLWPR::LoadModel(const ModelArchive &archive)
+{
+    int fileDim, fileOutputDim;
+    if(!archive.GetValue("lwpr.dim", fileDim) || !archive.GetValue("lwpr.outputDim", fileOutputDim)) return false;
+    FILE *file = archive.OpenFile("lwpr.model");
+    if(!file) return false;
+    LWPR_Object *loaded = ReadModel(file, fileDim);
+    fclose(file);
+    if(!loaded) return false;
+    DEL(model);
+    model = loaded;
+    dim = fileDim;
+    outputDim = fileOutputDim;
+    return true;
+}
+
 void RegressorLWPR::SetParams(double initD, double initAlpha, double wGen)
 {
 	this->initD = initD;
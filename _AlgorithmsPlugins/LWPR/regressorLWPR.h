@@ -36,8 +36,15 @@ public:
 	RegressorLWPR();
 	void Train(std::vector< fvec > samples, ivec labels);
 	fvec Test( const fvec &sample);
+    // predicts all the samples at once, spread over the lwpr workspaces
+    std::vector<fvec> TestBatch(const std::vector<fvec> &samples);
     const char *GetInfoString();
 
+    void SaveModel(std::string filename);
+    bool LoadModel(std::string filename);
+    bool SaveModel(ModelArchive &archive);
+    bool LoadModel(const ModelArchive &archive);
+
 	void SetParams(double initD, double initAlpha, double wGen);
     LWPR_Object *GetModel(){return model;}
 };
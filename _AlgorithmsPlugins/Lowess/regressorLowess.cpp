@@ -84,6 +84,7 @@ RegressorLowess::RegressorLowess()
       c            (NULL),
       x            (NULL)
 {
+    bBackgroundTraining = false; // the input errors are reported with message boxes from Train
 }
 
 RegressorLowess::~RegressorLowess()
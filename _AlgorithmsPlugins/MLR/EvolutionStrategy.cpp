@@ -22,8 +22,10 @@ Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
 *********************************************************************/
 
 #include <iostream>
+#include <algorithm>
 
 #include "EvolutionStrategy.h"
+#include "trainingControl.h"
 
 namespace ES
 {
@@ -87,51 +89,72 @@ namespace ES
 			*it = Individual::createRandom(cutCount, dataSize, dataAvrSd, beta);
 	}
 	
+	// orders the individuals by error, and by position in the population for ties
+	struct ErrorCompare
+	{
+		const vector<double>& errors;
+		ErrorCompare(const vector<double>& errors): errors(errors) {}
+		bool operator()(const int a, const int b) const
+		{
+			return errors[a] < errors[b] || (errors[a] == errors[b] && a < b);
+		}
+	};
+	
 	Population::ErrorPair Population::evolveOneGen(const VectorXd& y, const MatrixXd& x, double dataAvrSd)
 	{
 		assert(y.size() == x.rows());
-		typedef std::multimap<double, Individual> EvaluationMap;
-		typedef EvaluationMap::iterator EvaluationMapIterator;
-		EvaluationMap evalutationMap;
+		const int count(size());
 		
-		// evaluation
+		// evaluation, the individuals are scored concurrently
+		vector<double> errors(count);
+		#pragma omp parallel for schedule(dynamic)
+		for (int i = 0; i < count; ++i)
+			errors[i] = (*this)[i].classifier.sumSquareError(y, x);
 		double totalError(0);
-		for (const_iterator it(begin()); it != end(); ++it)
-		{
-			const Individual& ind(*it);
-			const double error(ind.classifier.sumSquareError(y, x));
-			totalError += error;
-			evalutationMap.insert(std::make_pair(error, ind));
-		}
-		const double averageError(totalError / double(size()));
+		for (int i = 0; i < count; ++i)
+			totalError += errors[i];
+		const double averageError(totalError / double(count));
 		
-		// selection
+		// selection, only the best quarter needs to be sorted
 		assert((size() / 4) * 4 == size());
-		size_t ind = 0;
-		for (EvaluationMapIterator it = evalutationMap.begin(); ind < size() / 4; ++it, ++ind)
+		const int parentCount(count / 4);
+		vector<int> ranking(count);
+		for (int i = 0; i < count; ++i)
+			ranking[i] = i;
+		partial_sort(ranking.begin(), ranking.begin() + parentCount, ranking.end(), ErrorCompare(errors));
+		vector<Individual> parents;
+		parents.reserve(parentCount);
+		for (int ind = 0; ind < parentCount; ++ind)
+			parents.push_back((*this)[ranking[ind]]);
+		for (int ind = 0; ind < parentCount; ++ind)
 		{
-			//cout << "S " << it->first << "\n";
-			(*this)[ind * 4] = it->second;
-			(*this)[ind * 4 + 1] = it->second.createChild(dataAvrSd);
-			(*this)[ind * 4 + 2] = it->second.createChild(dataAvrSd);
-			(*this)[ind * 4 + 3] = it->second.createChild(dataAvrSd);
+			(*this)[ind * 4] = parents[ind];
+			(*this)[ind * 4 + 1] = parents[ind].createChild(dataAvrSd);
+			(*this)[ind * 4 + 2] = parents[ind].createChild(dataAvrSd);
+			(*this)[ind * 4 + 3] = parents[ind].createChild(dataAvrSd);
 		}
 		
 		// return statistics
-		return ErrorPair(evalutationMap.begin()->first, averageError);
+		return ErrorPair(errors[ranking[0]], averageError);
 	}
 	
 	Classifier Population::optimise(const VectorXd& y, const MatrixXd& x, double dataAvrSd, size_t genCount)
 	{
 		// optimise
+		VectorXd output;
 		for (size_t g = 0; g < genCount; ++g)
 		{
+			// an aborted training keeps the best individual so far
+			if (TrainingControl::Cancelled())
+				break;
+			TrainingControl::Progress(float(g) / genCount);
 			const ErrorPair e = evolveOneGen(y, x, dataAvrSd);
 			std::cout << g << " : " << e.first << ", " << e.second << ", ";
 			// compute number of missclassified
+			(*this)[0].classifier.evalBatch(x, output);
 			unsigned missClassified(0);
 			for (int sample = 0; sample < y.size(); ++sample)
-				missClassified += fabs(sgn((*this)[0].classifier.eval(x.row(sample))) - y(sample)) / 2;
+				missClassified += fabs(sgn(output(sample)) - y(sample)) / 2;
 			std::cout << missClassified << std::endl;
 		}
 		return (*this)[0].classifier;
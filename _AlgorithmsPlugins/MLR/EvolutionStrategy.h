@@ -24,7 +24,7 @@ Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
 #ifndef _MLR_EVOLUTION_STRATEGY_H
 #define _MLR_EVOLUTION_STRATEGY_H
 
-#include <map>
+#include <vector>
 
 #include "MixtureLogisticRegression.h"
 
@@ -209,16 +209,28 @@ namespace MLR
 		//return sum > 0 ? 1 : -1;
 	}
 	
-	double Classifier::sumSquareError(const VectorXd& y, const MatrixXd& x) const
+	void Classifier::evalBatch(const MatrixXd& x, VectorXd& out) const
 	{
-		double error(0);
-		for (int sample = 0; sample < y.size(); ++sample)
+		assert(w.cols() == x.cols());
+		// projections of all the samples on all the hyperplanes in a single product
+		MatrixXd cuts(x.rows(), w.rows());
+		cuts.noalias() = x * w.transpose();
+		const double gamma(2 * w.rows());
+		out.resize(x.rows());
+		for (int sample = 0; sample < x.rows(); ++sample)
 		{
-			const double v(eval(x.row(sample)));
-			const double delta(y(sample) - v);
-			error += delta*delta;
+			double sum(v_b);
+			for (int i = 0; i < w.rows(); ++i)
+				sum += v(i) * sigm(beta * (cuts(sample,i) + b(i)));
+			out(sample) = sigm(gamma * sum);
 		}
-		return error;
+	}
+	
+	double Classifier::sumSquareError(const VectorXd& y, const MatrixXd& x) const
+	{
+		VectorXd v;
+		evalBatch(x, v);
+		return (y - v).squaredNorm();
 	}
 	
 	std::ostream& operator<< (std::ostream& stream, const Classifier& that)
@@ -62,6 +62,8 @@ namespace MLR
 		
 		double evalCut(const VectorXd& x, int i) const;
 		double eval(const VectorXd& x) const;
+		// output for each row of x
+		void evalBatch(const MatrixXd& x, VectorXd& out) const;
 		double sumSquareError(const VectorXd& y, const MatrixXd& x) const;
 		
 		friend std::ostream& operator<< (std::ostream& stream, const Classifier& that);
@@ -24,6 +24,7 @@ Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
 #include "classifierESMLR.h"
 #include "MixtureLogisticRegression.h"
 #include "EvolutionStrategy.h"
+#include "trainingControl.h"
 
 #include <iostream>
 #include <algorithm>
@@ -62,7 +63,6 @@ void ClassifierESMLR::Train(std::vector< fvec > samples, ivec labels)
 		for (size_t j = 0; j < samples[i].size(); ++j)
 			data.x(i,j) = samples[i][j];
 	}
-	std::cerr << "Learning data:\ny:\n" << data.y << "\nx:\n" << data.x << std::endl;
 	
 	// compute stddev
 	const Eigen::VectorXd avr = data.x.colwise().sum() / double(data.x.rows());
@@ -88,6 +88,8 @@ void ClassifierESMLR::Train(std::vector< fvec > samples, ivec labels)
 		delete classifier;
 	classifier = new MLR::Classifier(pop.optimise(data.y, data.x, dataAvrSd, genCount));
 	std::cerr << "Score before local opt: " << classifier->sumSquareError(data.y, data.x) << std::endl;
+	if (TrainingControl::Cancelled())
+		return;
 	
 	// local opt
 	nlopt::opt localOpt(nlopt::LD_SLSQP, classifier->getSize());
@@ -103,13 +103,8 @@ fvec GAPeon::ToSample()
 
 #include <QDebug>
 
-double GAPeon::Fitness( float *data, int w, int h)
+double GAPeon::Fitness( Objective *objective)
 {
-	if(!data) return 0;
-	int x = (int)(dna[0] * w);
-	int y = (int)(dna[1] * h);
-	x = max(0,min(w-1,x));
-	y = max(0,min(h-1,y));
-//	qDebug() << "sample: " << x << ":" << y << " Fitness: " << data[y*w + x];
-	return data[y*w + x];
+	if(!objective) return 0;
+	return objective->Value(ToSample());
 }
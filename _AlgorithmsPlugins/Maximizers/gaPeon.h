@@ -2,6 +2,7 @@
 #define _GA_PEON_H_
 
 #include <public.h>
+#include <objective.h>
 #include <vector>
 
 enum FitnessType
@@ -45,7 +46,7 @@ public:
 	float *Dna(){return dna;};
 	u32 Count(){return dim;};
 
-	double Fitness(float *data, int w, int h);
+	double Fitness(Objective *objective);
 	fvec ToSample();
 };
 
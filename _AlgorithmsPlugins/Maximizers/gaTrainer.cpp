@@ -9,8 +9,8 @@ using namespace std;
 /*                 Genetic Algorithm Training Procedure                 */
 /************************************************************************/
 
-GATrain::GATrain(float *data, int w, int h, int populationSize, int dim)
-:	dim(dim), popSize(populationSize), data(data), w(w), h(h),
+GATrain::GATrain(Objective *objective, int populationSize, int dim)
+:	dim(dim), popSize(populationSize), objective(objective),
 	alphaMute(0.01f), alphaCross(0.5f), alphaSurvivors(0.2f),
 	bestFitness(0), meanFitness(0), best(GAPeon(dim))
 {
@@ -49,11 +49,11 @@ int GATrain::GetBest()
 
 void GATrain::NextGen()
 {
-	// we compute the fitness for each peon
-	FOR(i, population.size())
-	{
-		fitness[i] = population[i].Fitness(data, w, h);
-	}
+	// we compute the fitness for the whole population at once
+	std::vector<fvec> samples(population.size());
+	FOR(i, population.size()) samples[i] = population[i].ToSample();
+	fvec values = objective ? objective->Values(samples) : fvec(samples.size(), 0.f);
+	FOR(i, population.size()) fitness[i] = values[i];
 
 	std::vector< std::pair<double, u32> > fits;
 	FOR(i, fitness.size()) fits.push_back(std::pair<double, u32>(fitness[i], i));
@@ -18,10 +18,9 @@ private:
 	double bestFitness;
 	double meanFitness;
 	u32 popSize;
-	float *data;
-	int w, h;
+	Objective *objective;
 public:
-	GATrain(float *data, int w, int h, int populationSize=50, int dim=2);
+	GATrain(Objective *objective, int populationSize=50, int dim=2);
 	void Generate(u32 count);
 	void Kill(u32 index);
 	void NextGen();
@@ -120,14 +120,10 @@ void MaximizeDonut::Draw(QPainter &painter)
 
 void MaximizeDonut::Train(float *dataMap, fVec size, fvec startingPoint)
 {
-	w = size.x;
-	h = size.y;
-	KILL(data);
 	best.clear();
 	history.clear();
 	historyValue.clear();
-	data = new float[w*h];
-	memcpy(data, dataMap, w*h*sizeof(float));
+	SetData(dataMap, size);
 	bConverged = false;
 	if(startingPoint.size())
 	{
@@ -267,7 +263,7 @@ fvec MaximizeDonut::Test( const fvec &sample)
 		while(best.size() < k)
 		{
 			fvec randSample = Generate(newSample, lastSigma, true);
-			visited.push_back(randSample);
+			AddVisited(randSample);
 			float value = GetValue(randSample);
 			evaluations++;
 			if(bAdaptive)
@@ -285,7 +281,7 @@ fvec MaximizeDonut::Test( const fvec &sample)
 	newSample = randSample;
 	float value = GetValue(randSample);
 	evaluations++;
-	visited.push_back(newSample);
+	AddVisited(newSample);
 	if(bAdaptive)
 	{
 		FOR(d, dim*dim)
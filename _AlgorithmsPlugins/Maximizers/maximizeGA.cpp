@@ -86,11 +86,7 @@ void MaximizeGA::Draw(QPainter &painter)
 
 void MaximizeGA::Train(float *dataMap, fVec size, fvec startingPoint)
 {
-    w = size.x;
-    h = size.y;
-    if(data) delete [] data;
-    data = new float[w*h];
-    memcpy(data, dataMap, w*h*sizeof(float));
+    SetData(dataMap, size);
     bConverged = false;
     if(startingPoint.size())
     {
@@ -102,7 +98,7 @@ void MaximizeGA::Train(float *dataMap, fVec size, fvec startingPoint)
         //qDebug() << "Starting maximization at " << maximum[0] << " " << maximum[1];
     }
     DEL(trainer);
-    trainer = new GATrain(data, w, h, population, dim);
+    trainer = new GATrain(objective, population, dim);
     trainer->AlphaMute(mutation);
     trainer->AlphaCross(cross);
     trainer->AlphaSurvivors(survival);
@@ -113,7 +109,7 @@ void MaximizeGA::Train(float *dataMap, fVec size, fvec startingPoint)
 fvec MaximizeGA::Test( const fvec &sample)
 {
     if(bConverged) return maximum;
-    FOR(i, trainer->Population().size()) visited.push_back(trainer->Population()[i].ToSample());
+    FOR(i, trainer->Population().size()) AddVisited(trainer->Population()[i].ToSample());
     evaluations += trainer->Population().size();
     trainer->NextGen();
     maximum = trainer->Best().ToSample();
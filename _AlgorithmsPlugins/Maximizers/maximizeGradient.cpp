@@ -93,11 +93,7 @@ std::vector<GLObject> MaximizeGradient::DrawGL()
 
 void MaximizeGradient::Train(float *dataMap, fVec size, fvec startingPoint)
 {
-	w = size.x;
-	h = size.y;
-	if(data) delete [] data;
-	data = new float[w*h];
-	memcpy(data, dataMap, w*h*sizeof(float));
+	SetData(dataMap, size);
 	bConverged = false;
 	if(!startingPoint.size())
 	{
@@ -182,7 +178,7 @@ fvec MaximizeGradient::Test( const fvec &sample)
 	}
 	else unmoving=0;
 
-	visited.push_back(newSample);
+	AddVisited(newSample);
 	value = GetValue(newSample);
 	if(value > maximumValue)
 	{
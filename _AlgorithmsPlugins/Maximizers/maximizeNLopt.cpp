@@ -95,8 +95,7 @@ std::vector<GLObject> MaximizeNlopt::DrawGL()
 struct OptData
 {
     int dim;
-    int w, h;
-    float *data;
+    Objective *objective;
 };
 
 double objectiveFunction(unsigned n, const double *x, double *gradient /* NULL if not needed */, void *func_data)
@@ -106,19 +105,12 @@ double objectiveFunction(unsigned n, const double *x, double *gradient /* NULL i
     FOR(d, data->dim) sample[d] = x[d];
     MaximizeNlopt::evaluationList.push_back(sample);
 
-    double objective = Maximizer::GetValue(sample, data->data, data->w, data->h);
+    if(!data->objective) return 0;
+    double objective = data->objective->Value(sample);
     if(gradient)
     {
-        double *dx = new double[n];
-        double delta = 1e-2;
-        FOR(i, n)
-        {
-            memcpy(dx, x, n*sizeof(double));
-            dx[i] += delta;
-            double dError = Maximizer::GetValue(sample, data->data, data->w, data->h);
-            gradient[i] = (dError - objective)/delta;
-        }
-        delete [] dx;
+        fvec grad = data->objective->Gradient(sample);
+        FOR(i, n) gradient[i] = i < grad.size() ? grad[i] : 0;
     }
 
     return objective;
@@ -126,11 +118,7 @@ double objectiveFunction(unsigned n, const double *x, double *gradient /* NULL i
 
 void MaximizeNlopt::Train(float *dataMap, fVec size, fvec startingPoint)
 {
-    w = size.x;
-    h = size.y;
-    if(data) delete [] data;
-    data = new float[w*h];
-    memcpy(data, dataMap, w*h*sizeof(float));
+    SetData(dataMap, size);
     bConverged = false;
     if(!startingPoint.size())
     {
@@ -148,9 +136,7 @@ void MaximizeNlopt::Train(float *dataMap, fVec size, fvec startingPoint)
     evaluationList.clear();
 
     OptData *data = new OptData;
-    data->data = this->data;
-    data->w = this->w;
-    data->h = this->h;
+    data->objective = objective;
     data->dim = dim;
 
     int optDim = dim;
@@ -217,7 +203,7 @@ fvec MaximizeNlopt::Test( const fvec &sample)
         ++evaluationFrame;
     }
     if(newValue >= maxValue) maximum = newSample;
-    visited.push_back(newSample);
+    AddVisited(newSample);
     history.push_back(maximum);
     historyValue.push_back(maxValue);
     return newSample;
@@ -84,19 +84,12 @@ void MaximizeParticles::Draw(QPainter &painter)
 
 void MaximizeParticles::Train(float *dataMap, fVec size, fvec startingPoint)
 {
-    w = size.x;
-    h = size.y;
-    if(data) delete [] data;
-    data = new float[w*h];
-    memcpy(data, dataMap, w*h*sizeof(float));
+    SetData(dataMap, size);
     bConverged = false;
     if(startingPoint.size())
     {
         maximum = startingPoint;
-        int xIndex = startingPoint[0]*w;
-        int yIndex = startingPoint[1]*h;
-        int index = min(w*h, max(0, yIndex*w + xIndex));
-        float value = data[index];
+        float value = GetValue(startingPoint);
         maximumValue = value;
         history.push_back(maximum);
         historyValue.push_back(value);
@@ -120,16 +113,26 @@ fvec MaximizeParticles::Test( const fvec &sample)
 
     float decay = 0.2f;
     float totalWeights= 0;
-    FOR(i, particleCount)
+    // first we guess the next pose for each particle, each particle has its own random stream
+    // seeded from the global one, so that the run does not depend on how the particles are shared among threads
+    unsigned int seed = lrand48();
+    int count = particles.size();
+#pragma omp parallel for
+    for(int i=0; i<count; i++)
+    {
+        std::mt19937 stream(seed + i);
+        std::normal_distribution<float> noise(0.f, variance*variance);
+        FOR(d, dim) particles[i][d] += noise(stream);
+    }
+    // we compute the weights
+    fvec values = GetValues(particles);
+    FOR(i, count)
     {
-        // first we guess the next pose for each particle
-        particles[i] += RandN(dim, 0, variance*variance);
-        // we compute the weights
-        //weights[i] = weights[i] *(1-decay) + GetValue(particles[i])*decay;
-        weights[i] = weights[i] * GetValue(particles[i]);
+        //weights[i] = weights[i] *(1-decay) + values[i]*decay;
+        weights[i] = weights[i] * values[i];
         totalWeights += weights[i];
         evaluations++;
-        visited.push_back(particles[i]);
+        AddVisited(particles[i]);
     }
 
     /*
@@ -96,14 +96,10 @@ void MaximizePower::Draw(QPainter &painter)
 
 void MaximizePower::Train(float *dataMap, fVec size, fvec startingPoint)
 {
-	w = size.x;
-	h = size.y;
-	if(data) delete [] data;
 	best.clear();
 	history.clear();
 	historyValue.clear();
-	data = new float[w*h];
-	memcpy(data, dataMap, w*h*sizeof(float));
+	SetData(dataMap, size);
 	bConverged = false;
 	if(startingPoint.size())
 	{
@@ -138,7 +134,7 @@ fvec MaximizePower::Test( const fvec &sample)
 					randSample[d] = newSample[d] + RandN(0.f, variance);
 				} while(randSample[d] < 0 || randSample[d] > 1.f || tries-- > 0);
 			}
-			visited.push_back(randSample);
+			AddVisited(randSample);
 			float value = GetValue(randSample);
 			evaluations++;
 			best.push_back(make_pair(value, make_pair(randSample, sigma)));
@@ -165,7 +161,7 @@ fvec MaximizePower::Test( const fvec &sample)
 	newSample = randSample;
 	float value = GetValue(randSample);
 	evaluations++;
-	visited.push_back(newSample);
+	AddVisited(newSample);
 
 	if(!bAdaptive)
 	{
@@ -115,11 +115,7 @@ std::vector<GLObject> MaximizeRandom::DrawGL()
 
 void MaximizeRandom::Train(float *dataMap, fVec size, fvec startingPoint)
 {
-	w = size.x;
-	h = size.y;
-	if(data) delete [] data;
-	data = new float[w*h];
-	memcpy(data, dataMap, w*h*sizeof(float));
+	SetData(dataMap, size);
 	bConverged = false;
 	if(startingPoint.size())
 	{
@@ -158,7 +154,7 @@ fvec MaximizeRandom::Test( const fvec &sample)
 		}while(tries && !bInsideLimits);
 		newSample = randSample;
 	}
-	visited.push_back(newSample);
+	AddVisited(newSample);
 	float value = GetValue(newSample);
 	evaluations++;
 	if(value > maximumValue)
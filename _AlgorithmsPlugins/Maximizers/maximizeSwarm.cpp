@@ -74,17 +74,6 @@ void MaximizeSwarm::Draw(QPainter &painter)
             painter.setBrush(Qt::green);
             painter.drawEllipse(QPointF(x*w, y*h), radius, radius);
         }
-
-        // draw all the particles visited in the past
-        FOR(i, pso->evaluationHistory.size())
-        {
-            pair<int,int> sample = pso->evaluationHistory[i];
-            QPointF point(sample.first, sample.second);
-            int radius = 3;
-            painter.setBrush(Qt::NoBrush);
-            painter.setPen(Qt::black);
-            painter.drawEllipse(point, radius, radius);
-        }
     }
 
     painter.setPen(QPen(Qt::black, 1.5));
@@ -116,22 +105,30 @@ Eigen::VectorXd f_1disolated(Eigen::VectorXd& x);
 Eigen::VectorXd f_1disolated2(Eigen::VectorXd& x);
 */
 
+void MaximizeSwarm::EvaluateSwarm(int count, int dim, double **x, double *y, void *userData)
+{
+    MaximizeSwarm *swarm = (MaximizeSwarm*)userData;
+    PSO *pso = swarm->pso;
+    std::vector<fvec> samples(count, fvec(dim));
+    FOR(i, count)
+    {
+        FOR(d, dim) samples[i][d] = (x[i][d] - pso->getLBound()(d))/(pso->getUBound()(d)-pso->getLBound()(d));
+        swarm->AddVisited(samples[i]);
+    }
+    fvec values = swarm->GetValues(samples);
+    // the swarm minimizes its objective
+    FOR(i, count) y[i] = 1. - values[i];
+}
+
 void MaximizeSwarm::Train(float *dataMap, fVec size, fvec startingPoint)
 {
-    w = size.x;
-    h = size.y;
-    if(data) delete [] data;
-    data = new float[w*h];
-    memcpy(data, dataMap, w*h*sizeof(float));
+    SetData(dataMap, size);
     //FOR(i, w*h) data[i] = 1.f - data[i];
     bConverged = false;
     if(startingPoint.size())
     {
         maximum = startingPoint;
-        int xIndex = startingPoint[0]*w;
-        int yIndex = startingPoint[1]*h;
-        int index = min(w*h, max(0, yIndex*w + xIndex));
-        float value = data[index];
+        float value = GetValue(startingPoint);
         maximumValue = value;
         history.push_back(maximum);
         historyValue.push_back(1-value);
@@ -150,6 +147,7 @@ void MaximizeSwarm::Train(float *dataMap, fVec size, fvec startingPoint)
 
     pso = new PSO(dim,constraintCount,iterationCount,particleCount,Eigen::VectorXd::Constant(dim,0.),Eigen::VectorXd::Constant(dim,1.));
     pso->SetData(data, w, h);
+    pso->setBatchModel(EvaluateSwarm, this);
     pso->setProblemName("Data");
     pso->setMutationProbability(mutation);
     if(inertia)
@@ -35,6 +35,7 @@ private:
 	float inertiaFinal;
 	float particleConfidence;
 	float swarmConfidence;
+	static void EvaluateSwarm(int count, int dim, double **x, double *y, void *userData);
 public:
 	MaximizeSwarm();
 	~MaximizeSwarm();
@@ -43,6 +43,8 @@ ClassifierBoost::~ClassifierBoost()
 }
 
 vector<fvec> ClassifierBoost::learners;
+fvec ClassifierBoost::learnerData;
+int ClassifierBoost::learnerStride = 0;
 int ClassifierBoost::currentLearnerType = -1;
 int ClassifierBoost::learnerCount=1000;
 int ClassifierBoost::svmCount=2;
@@ -197,207 +199,110 @@ void ClassifierBoost::InitLearners(fvec xMin, fvec xMax)
         break;
     }
     currentLearnerType = weakType;
+
+    // all the learners of one type have the same size, we store them contiguously
+    learnerStride = learners.size() ? learners[0].size() : 0;
+    learnerData.resize(learners.size()*learnerStride);
+    FOR(i, learners.size()) std::copy(learners[i].begin(), learners[i].end(), learnerData.begin() + i*learnerStride);
     if(x) cvReleaseMat(&x);
     x = cvCreateMat(1, learners.size(), CV_32FC1);
 }
 
-fvec ClassifierBoost::GetFeatures(const fvec sample, const int weakType, const ivec features=ivec()) const
+// small generator for the noise added to the rectangle features, drand48 can't be shared among threads
+static inline float jitter(unsigned int &seed)
 {
-    fvec res(learnerCount,0);
-    if(features.size()) {
-        FOR(i, features.size()) {
-            fvec& learner = learners[features[i]];
-            float val=0;
-            switch(weakType) {
-            case 0:// stumps
-            {
-                int index = learner[0];
-                val = index < (int)dim ? sample[index] : 0;
-            }
-                break;
-            case 1:// random projection
-            {
-                if(dim == 2) val = sample[0]* learner[0] + sample[1]* learner[1];
-                else {
-                    FOR(d, dim) val += sample[d] * learner[d];
-                }
-            }
-                break;
-            case 2:// random rectangles
-            {
-                // check if the sample is inside the recangle generated by the classifier
-                val = 1;
-                FOR(d, dim)
-                {
-                    if(sample[d] < learner[2*d] || sample[d] > learner[2*d]+learner[2*d+1])
-                    {
-                        val = 0;
-                        break;
-                    }
-                }
-                val += drand48()*0.01; // we add a small noise to the value just to not have only 0s and 1s
-            }
-                break;
-            case 3: // random circle
-            {
-                if(dim==2) val = sqrtf((sample[0] - learner[0])*(sample[0] - learner[0]) + (sample[1] - learner[1])*(sample[1] - learner[1]));
-                else {
-                    FOR(d,dim) val += (sample[d] - learner[d])*(sample[d] - learner[d]);
-                    val = sqrtf(val);
-                }
-            }
-                break;
-            case 4: // random GMM
-            {
-                fvec &gmm = learner;
-                fvec x(dim);
-                FOR(d, dim) x[d] = sample[d]-gmm[d];
-                FOR(d, dim)
-                {
-                    float xC = 0;
-                    FOR(d1,dim)
-                    {
-                        int index = d1>d? d1*(d1+1)/2 + d : d*(d+1)/2 + d1;
-                        xC += x[d1]*gmm[dim+index];
-                    }
-                    val += xC*x[d];
-                }
-            }
-                break;
-            case 5: // random SVM
-            {
-                // compute the svm function
-                fvec &svm = learner;
-                float gamma = svm[0];
-                FOR(k, svmCount)
-                {
-                    float alpha = svm[1+k*(dim+1)];
-                    // we compute the rbf kernel;
-                    float K = 0;
-                    int index = 1+k*(dim+1)+1;
-                    FOR(d, dim)
-                    {
-                        float dist = sample[d]-svm[index+d];
-                        K += dist*dist;
-                    }
-                    K *= gamma;
-                    val += alpha*expf(-K);
-                }
-            }
-                break;
-            }
-            res[features[i]] = val;
-        }
-        return res;
-    }
-
+    seed = seed*1664525u + 1013904223u;
+    return (seed >> 8) * (1.f/16777216.f);
+}
 
-    switch(weakType)
-    {
-    case 0:// stumps
+void ClassifierBoost::ComputeFeatures(const float *sample, const int *indices, const int count, float *values, unsigned int seed) const
+{
+    const int stride = learnerStride;
+    const int dim = this->dim;
+    FOR(i, count)
     {
-        FOR(j, learnerCount)
+        int j = indices ? indices[i] : i;
+        const float *learner = &learnerData[j*stride];
+        float val = 0;
+        switch(weakType)
+        {
+        case 0:// stumps
         {
-            int index = learners[j][0];
-            float val = index < (int)dim ? sample[index] : 0;
-            res[j] = val;
+            int index = learner[0];
+            val = index < dim ? sample[index] : 0;
         }
-    }
-        break;
-    case 1:// random projection
-    {
-        FOR(j, learnerCount)
+            break;
+        case 1:// random projection
         {
-            if(dim == 2) res[j] = sample[0]* learners[j][0] + sample[1]* learners[j][1];
-            else {
-                float val = 0;
-                FOR(d, dim) val += sample[d] * learners[j][d];
-                res[j] = val;
-            }
+#pragma omp simd reduction(+:val)
+            for(int d=0; d<dim; d++) val += sample[d] * learner[d];
         }
-    }
-        break;
-    case 2:// random rectangles
-    {
-        // check if the sample is inside the recangle generated by the classifier
-        FOR(j, learnerCount)
+            break;
+        case 2:// random rectangles
         {
-            float val = 1;
-            FOR(d, dim)
-            {
-                if(sample[d] < learners[j][2*d] || sample[d] > learners[j][2*d]+learners[j][2*d+1])
-                {
-                    val = 0;
-                    break;
-                }
-            }
-            res[j] = val + drand48()*0.01; // we add a small noise to the value just to not have only 0s and 1s
+            // check if the sample is inside the recangle generated by the classifier
+            int outside = 0;
+#pragma omp simd reduction(+:outside)
+            for(int d=0; d<dim; d++) outside += (sample[d] < learner[2*d]) | (sample[d] > learner[2*d]+learner[2*d+1]);
+            val = outside ? 0.f : 1.f;
+            val += jitter(seed)*0.01f; // we add a small noise to the value just to not have only 0s and 1s
         }
-    }
-        break;
-    case 3: // random circle
-    {
-        FOR(j, learnerCount)
+            break;
+        case 3: // random circle
         {
-            float val = 0;
-            if(dim==2) val = sqrtf((sample[0] - learners[j][0])*(sample[0] - learners[j][0]) + (sample[1] - learners[j][1])*(sample[1] - learners[j][1]));
-            else {
-                FOR(d,dim) val += (sample[d] - learners[j][d])*(sample[d] - learners[j][d]);
-                val = sqrtf(val);
-            }
-            res[j] = val;
+#pragma omp simd reduction(+:val)
+            for(int d=0; d<dim; d++) val += (sample[d] - learner[d])*(sample[d] - learner[d]);
+            val = sqrtf(val);
         }
-    }
-        break;
-    case 4: // random GMM
-    {
-        FOR(j, learnerCount)
+            break;
+        case 4: // random GMM
         {
-            fvec &gmm = learners[j];
-            float val = 0;
-            fvec x(dim);
-            FOR(d, dim) x[d] = sample[d]-gmm[d];
-            FOR(d, dim)
+            // x^T C x with C stored as a lower triangle, row after row
+            const float *C = learner + dim;
+            for(int d=0; d<dim; d++)
             {
+                const float *row = C + d*(d+1)/2;
+                float xd = sample[d] - learner[d];
                 float xC = 0;
-                FOR(d1,dim)
-                {
-                    int index = d1>d? d1*(d1+1)/2 + d : d*(d+1)/2 + d1;
-                    xC += x[d1]*gmm[dim+index];
-                }
-                val += xC*x[d];
+#pragma omp simd reduction(+:xC)
+                for(int d1=0; d1<d; d1++) xC += (sample[d1] - learner[d1])*row[d1];
+                val += xd*(2*xC + row[d]*xd);
             }
-            res[j] = val;
         }
-    }
-        break;
-    case 5: // random SVM
-    {
-        // compute the svm function
-        FOR(j, learnerCount)
+            break;
+        case 5: // random SVM
         {
-            fvec &svm = learners[j];
-            float val = 0;
-            float gamma = svm[0];
+            // compute the svm function
+            float gamma = learner[0];
             FOR(k, svmCount)
             {
-                float alpha = svm[1+k*(dim+1)];
+                float alpha = learner[1+k*(dim+1)];
+                const float *sv = learner + 1+k*(dim+1)+1;
                 // we compute the rbf kernel;
                 float K = 0;
-                int index = 1+k*(dim+1)+1;
-                FOR(d, dim)
-                {
-                    float dist = sample[d]-svm[index+d];
-                    K += dist*dist;
-                }
-                K *= gamma;
-                val += alpha*expf(-K);
+#pragma omp simd reduction(+:K)
+                for(int d=0; d<dim; d++) K += (sample[d]-sv[d])*(sample[d]-sv[d]);
+                val += alpha*expf(-K*gamma);
             }
-            res[j] = val;
         }
+            break;
+        }
+        values[i] = val;
     }
-        break;
+}
+
+fvec ClassifierBoost::GetFeatures(const fvec sample, const int weakType, const ivec features=ivec()) const
+{
+    fvec res(learnerCount,0);
+    if(!learnerData.size() || !learnerCount || !dim || sample.size() < dim) return res;
+    if(!features.size())
+    {
+        ComputeFeatures(&sample[0], 0, learnerCount, &res[0], 1);
+        return res;
     }
+    fvec values(features.size());
+    ComputeFeatures(&sample[0], &features[0], features.size(), &values[0], 1);
+    FOR(i, features.size()) res[features[i]] = values[i];
     return res;
 }
 
@@ -440,11 +345,14 @@ void ClassifierBoost::Train( std::vector< fvec > samples, ivec labels )
     Mat trainLabels(sampleCnt, 1, CV_32FC1);
     Mat sampleWeights(sampleCnt, 1, CV_32FC1);
 
+    // the feature matrix is filled directly, one row per sample
+#pragma omp parallel for schedule(dynamic, 16)
+    for(int i=0; i<(int)sampleCnt; i++)
+    {
+        ComputeFeatures(&samples[perm[i]][0], 0, learnerCount, trainSamples.ptr<float>(i), i+1);
+    }
     FOR(i, sampleCnt)
     {
-        fvec sample = samples[perm[i]];
-        fvec trainSample = GetFeatures(sample, weakType);
-        FOR(j, learnerCount) trainSamples.at<float>(i,j) = trainSample[j];
         trainLabels.at<float>(i) = (float)labels[perm[i]];
         sampleWeights.at<float>(i) = 1.f;
     }
@@ -457,12 +365,7 @@ void ClassifierBoost::Train( std::vector< fvec > samples, ivec labels )
     model->setWeightTrimRate(0.95);
 
     model->train(trainSamples, ROW_SAMPLE, trainLabels);
-    vector<Boost::Split> splits = model->getSplits();
-    features.clear();
-    FOR(i, splits.size()) {
-        Boost::Split& s = splits.at(i);
-        features.push_back(s.varIdx);
-    }
+    CompileWeakLearners();
 
     scoreMultiplier = 1.f;
     float maxScore=-FLT_MAX, minScore=FLT_MAX;
@@ -534,17 +437,75 @@ float ClassifierBoost::Test( const fvec &sample, fvec */*responses*/) const
 {
     if(!model) return 0;
     if(!learners.size()) return 0;
-    if(!features.size()) return 0;
-
-    fvec testSample = GetFeatures(sample, weakType, features);
-    Mat input(1,learnerCount,CV_32FC1);
-    FOR(d, learnerCount)  input.at<float>(d) = testSample[d];
+    if(!weakRoots.size()) return 0;
 
-    Mat res;//(1,features.size(),CV_32FC1);
+    // we only compute the features used by the weak learners
+    fvec padded;
+    const float *x = sample.size() ? &sample[0] : 0;
+    if(sample.size() < dim)
+    {
+        padded = sample;
+        padded.resize(dim, 0);
+        x = &padded[0];
+    }
+    // trees reduced to a single leaf reference no feature at all
+    fvec values(features.size());
+    if(features.size()) ComputeFeatures(x, &features[0], features.size(), &values[0], 1);
 
-    float result = model->predict(input, res, Boost::PREDICT_SUM);
+    // same as predicting with Boost::PREDICT_SUM: the sum of the leaf values of all the trees
+    float result = 0;
+    FOR(i, weakRoots.size())
+    {
+        int n = weakRoots[i];
+        while(weakNodes[n].feature >= 0) n = values[weakNodes[n].feature] <= weakNodes[n].threshold ? weakNodes[n].left : weakNodes[n].right;
+        result += weakNodes[n].value;
+    }
     return result * scoreMultiplier;
-    //return result / (float)weakCount * 3;
+}
+
+void ClassifierBoost::CompileWeakLearners()
+{
+    weakNodes.clear();
+    weakRoots.clear();
+    features.clear();
+    if(!model) return;
+    const vector<int> &roots = model->getRoots();
+    const vector<DTrees::Node> &nodes = model->getNodes();
+    const vector<DTrees::Split> &splits = model->getSplits();
+
+    // the features referenced by the splits, and their position in the list
+    map<int,int> featureIndex;
+    FOR(i, splits.size()) featureIndex[splits[i].varIdx] = 0;
+    for(map<int,int>::iterator it=featureIndex.begin(); it!=featureIndex.end(); it++)
+    {
+        it->second = features.size();
+        features.push_back(it->first);
+    }
+
+    // we copy the trees, the samples go left when feature <= threshold
+    map<int,int> nodeIndex;
+    FOR(i, nodes.size())
+    {
+        nodeIndex[i] = weakNodes.size();
+        WeakNode node;
+        node.feature = -1;
+        node.threshold = 0;
+        node.left = node.right = -1;
+        node.value = nodes[i].value;
+        weakNodes.push_back(node);
+    }
+    FOR(i, nodes.size())
+    {
+        const DTrees::Node &node = nodes[i];
+        if(node.split < 0 || node.left < 0 || node.right < 0) continue;
+        const DTrees::Split &split = splits[node.split];
+        WeakNode &weak = weakNodes[nodeIndex[i]];
+        weak.feature = featureIndex[split.varIdx];
+        weak.threshold = split.c;
+        weak.left = nodeIndex[split.inversed ? node.right : node.left];
+        weak.right = nodeIndex[split.inversed ? node.left : node.right];
+    }
+    FOR(i, roots.size()) weakRoots.push_back(nodeIndex[roots[i]]);
 }
 
 void ClassifierBoost::SetParams( u32 weakCount, int weakType, int boostType, int svmCount)
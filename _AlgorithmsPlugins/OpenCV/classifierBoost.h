@@ -26,11 +26,22 @@ Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
 class ClassifierBoost : public Classifier
 {
 private:
+    // node of a boosted tree, on the selected features only (feature is -1 for leaves)
+    struct WeakNode
+    {
+        int feature;
+        float threshold;
+        int left, right;
+        float value;
+    };
+
     cv::Ptr<cv::ml::Boost> model;
 	u32 weakCount;
     int weakType; // 0: random projection, 1: random rectangle, 2: random circle, 3: random GMM, 4: random SVM
 	float scoreMultiplier;
-	ivec features;
+	ivec features; // learners referenced by the trained model
+    std::vector<WeakNode> weakNodes;
+    ivec weakRoots;
     fvec errorWeights;
     int boostType;
 public:
@@ -38,6 +49,8 @@ public:
     ivec labels;
     static int learnerCount;
     static std::vector<fvec> learners;
+    static fvec learnerData; // the learners, stored contiguously
+    static int learnerStride;
     static int currentLearnerType;
     static int svmCount; // number of 'support vectors' for the random SVM
 
@@ -52,6 +65,9 @@ public:
     void SetParams(u32 weakCount, int weakType, int boostType, int svmCount);
     void InitLearners(fvec xMin, fvec xMax);
     fvec GetFeatures(const fvec sample, const int weakType, const ivec features) const;
+    // values of the learners in indices (all of them if indices is NULL)
+    void ComputeFeatures(const float *sample, const int *indices, const int count, float *values, unsigned int seed) const;
+    void CompileWeakLearners();
 };
 
 #endif // _CLASSIFIER_BOOST_H_
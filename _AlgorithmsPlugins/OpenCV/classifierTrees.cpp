@@ -20,13 +20,17 @@ Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
 #include "public.h"
 #include "basicMath.h"
 #include "classifierTrees.h"
+#include "modelArchive.h"
 #include <QDebug>
 #include <QLabel>
-#include <QPixmap>
+#include <QImage>
 #include <QPainter>
+#include <iostream>
+#include <fstream>
 
 using namespace std;
 using namespace cv;
+using namespace cv::ml;
 
 ClassifierTrees::ClassifierTrees()
 {
@@ -42,8 +46,6 @@ ClassifierTrees::ClassifierTrees()
     maxTrees = 100;
     accuracyTolerance = 0.001f;
 
-    tree = 0;
-
     bSingleClass = false;
     bMultiClass = true;
 
@@ -54,7 +56,7 @@ ClassifierTrees::ClassifierTrees()
 
 ClassifierTrees::~ClassifierTrees()
 {
-    DEL(tree);
+    DEL(treePainter);
 }
 
 void ClassifierTrees::Train( std::vector< fvec > samples, ivec labels )
@@ -72,8 +74,6 @@ void ClassifierTrees::Train( std::vector< fvec > samples, ivec labels )
     ivec newLabels(labels.size());
     FOR(i, labels.size()) newLabels[i] = classMap[labels[i]];
     labels = newLabels;
-//    for(map<int,int>::iterator it=inverseMap.begin(); it != inverseMap.end(); it++) qDebug() << "inverse: " << it->first << it->second;
-//    for(map<int,int>::iterator it=classMap.begin(); it != classMap.end(); it++) qDebug() << "class: " << it->first << it->second;
 
     int classCount = classMap.size();
     if(classMap.count(-1)) negativeClass = classMap[-1];
@@ -91,194 +91,291 @@ void ClassifierTrees::Train( std::vector< fvec > samples, ivec labels )
     int trainCount = samples.size();
 
     // creating training data array
-    float *trainingData = new float[trainCount*dim];
-    //FOR(i, trainCount) trainingData[i] = new float[dim];
-    float *trainingLabels = new float[trainCount];
-
-    int *classCounts = new int[classCount];
-    FOR(c, classCount) classCounts[c] = 0;
+    Mat trainingData(trainCount, dim, CV_32FC1);
+    Mat trainingLabels(trainCount, 1, CV_32FC1);
+    fvec classCounts(classCount, 0.f);
     FOR(i, samples.size())
     {
-        FOR(d, dim)
-        {
-            trainingData[i*dim + d] = samples[i][d];
-        }
-        trainingLabels[i] = labels[i];
+        FOR(d, dim) trainingData.at<float>(i, d) = samples[i][d];
+        trainingLabels.at<float>(i) = labels[i];
         classCounts[labels[i]]++;
     }
 
-    // Creating Mat data structures out of the arrays
-    Mat trainingData_ = Mat(trainCount, dim, CV_32FC1, trainingData);
-    Mat trainingLabels_ = Mat(trainCount, 1, CV_32FC1, trainingLabels);
-
     // This is a classification problem (i.e. predict a discrete number of classes),
     // So we define all the attributes as numerical and the class as categorical.
-    Mat var_type = Mat(dim + 1, 1, CV_8UC1 );
-    var_type.setTo(Scalar(CV_VAR_NUMERICAL) ); // all inputs are numerical
-    var_type.at<uchar>(dim, 0) = CV_VAR_CATEGORICAL;
-
-    //printf( "AI learning : creating tree.\n" ); fflush(stdout);
-
+    Mat varType(dim + 1, 1, CV_8UC1, Scalar(VAR_NUMERICAL)); // all inputs are numerical
+    varType.at<uchar>(dim) = VAR_CATEGORICAL;
 
     // array of a priori class probabilities. can be used to tune the decision tree preferences toward a certain class.
-    float *priors = new float[classCount];
-    FOR(c, classCount) priors[c] = bBalanceClasses ? classCounts[c] : 1.f / labels.size();
-    //qDebug() << "classCounts" << classCounts[0] << classCounts[1];
-
-    CvRTParams params = CvRTParams(maxDepth, //25,      // max depth (is that used ?)
-                                   minSampleCount, //4, // min sample count
-                                   0,                   // regression accuracy: N/A here
-                                   bComputeImportance,  //false, // compute surrogate split, no missing data
-                                   classCount, //15,    // max number of categories (use sub-optimal algorithm for larger numbers)
-                                   priors,              // the array of priors
-                                   bComputeImportance,  //false, // calculate variable importance
-                                   0,                   // number of variables randomly selected at node and used to find the best split(s).
-                                   maxTrees, //100,     // max number of trees in the forest
-                                   accuracyTolerance,   // forrest accuracy
-                                   CV_TERMCRIT_ITER | CV_TERMCRIT_EPS // termination criteria : max nb trees OR accuracy = CV_TERMCRIT_ITER |	CV_TERMCRIT_EPS
-                                   );
-    //printf( "AI learning : Forest parameters: %i max trees, %i max depth, %i nb of variables for node split.\n", maxTrees, maxDepth, minSampleCount); fflush(stdout);
+    Mat priors(1, classCount, CV_32FC1);
+    FOR(c, classCount) priors.at<float>(c) = bBalanceClasses ? classCounts[c] : 1.f / labels.size();
+
+    Ptr<RTrees> rtrees = RTrees::create();
+    rtrees->setMaxDepth(maxDepth);
+    rtrees->setMinSampleCount(minSampleCount);
+    rtrees->setRegressionAccuracy(0); // N/A here
+    rtrees->setUseSurrogates(false); // no missing data
+    rtrees->setMaxCategories(classCount);
+    rtrees->setPriors(priors);
+    rtrees->setCalculateVarImportance(bComputeImportance);
+    rtrees->setActiveVarCount(0); // number of variables randomly selected at each node (0: sqrt(dim))
+    rtrees->setTermCriteria(TermCriteria(TermCriteria::MAX_ITER + TermCriteria::EPS, maxTrees, accuracyTolerance));
 
     // train random forest classifier (using training data)
-    DEL(tree);
-    tree = new CvRTrees;
-    tree->train(trainingData_, CV_ROW_SAMPLE, trainingLabels_, Mat(), Mat(), var_type, Mat(), params);
-
-    //printf( "AI learning : %i trees created.\n", tree->get_tree_count() ); fflush(stdout);
+    Ptr<TrainData> trainData = TrainData::create(trainingData, ROW_SAMPLE, trainingLabels, noArray(), noArray(), noArray(), varType);
+    rtrees->train(trainData);
 
+    importance.clear();
     if (bComputeImportance)
     {
-        Mat varImportance = tree->getVarImportance();
+        Mat varImportance = rtrees->getVarImportance();
+        importance.resize(varImportance.total());
         printf( "Random Forest - Variable importance : [ ");
-        FOR(i, varImportance.cols)
+        FOR(i, importance.size())
         {
-            printf("%f ", varImportance.at<float>(i));
+            importance[i] = varImportance.at<float>(i);
+            printf("%f ", importance[i]);
         }
         printf("]\n");fflush(stdout);
     }
 
-    treeCount = tree->get_tree_count();
+    // we only keep the compiled forest, opencv is not used for testing
+    forest.Compile(*rtrees, classCount);
+    DrawTrees();
+}
+
+void ClassifierTrees::DrawTrees()
+{
+    treeCount = max(1, forest.TreeCount());
     treeDepth = 0;
-    FOR(i, tree->get_tree_count())
+    FOR(i, forest.TreeCount())
     {
-        treeDepth = max(treeDepth, GetTreeDepth(tree->get_tree(i)->get_root()));
+        treeDepth = max(treeDepth, forest.Depth(i));
     }
-    treePixmap = QPixmap(min(100*(treeCount+1), 1024), 200 + (treeDepth > 5 ? (treeDepth-5)*20 : 0));
-    treePixmap.fill(Qt::white);
     DEL(treePainter);
-    treePainter = new QPainter(&treePixmap);
+    treeImage = QImage(min(100*(treeCount+1), 1024), 200 + (treeDepth > 5 ? (treeDepth-5)*20 : 0), QImage::Format_ARGB32_Premultiplied);
+    treeImage.fill(Qt::white);
+    treePainter = new QPainter(&treeImage);
     treePainter->setRenderHint(QPainter::Antialiasing);
     QFont font = treePainter->font();
     font.setPointSize(9);
     font.setWeight(QFont::Bold);
     treePainter->setFont(font);
-    FOR(i, tree->get_tree_count())
+    FOR(i, forest.TreeCount())
     {
-        cv::ml::DTrees *myTree = tree->get_tree(i);
-        PrintTree(myTree, i);
+        PrintTree(i);
     }
+    DEL(treePainter);
 }
 
-int ClassifierTrees::GetTreeDepth(const cv::ml::DTrees::Node * *node) const
-{
-    if(!node) return -1;
-    if(!node->left && !node->right) return node->depth;
-    int left = node->left ? GetTreeDepth(node->left) : node->depth;
-    int right = node->right ? GetTreeDepth(node->right) : node->depth;
-    return max(right, left);
-}
-
-void ClassifierTrees::PrintNode(const cv::ml::DTrees::Node * *node, int rootX, bool bLeft) const
+void ClassifierTrees::PrintNode(int index, int depth, int rootX) const
 {
-    if(node == NULL)
-    {
-        return;
-    }
-    int depth = node->depth+1;
-    int y = depth * treePixmap.height() / (treeDepth+2);
-    int deltaY = treePixmap.height()/(treeDepth+2);
-    int W = treePixmap.width() / treeCount;
+    const FlatForest::Node &node = forest.GetNode(index);
+    depth++;
+    int y = depth * treeImage.height() / (treeDepth+2);
+    int deltaY = treeImage.height()/(treeDepth+2);
+    int W = treeImage.width() / treeCount;
     int w = W/(depth*2);
     int shift = w/(depth+1);
     int x = rootX;
     int radius = 5;
-    const CvDTreeNode *nodeL = node->left;
-    const CvDTreeNode *nodeR = node->right;
-    int classId = inverseMap.at(node->class_idx);
 
     treePainter->setPen(QPen(Qt::black,2));
-    treePainter->setBrush(SampleColor[classId%SampleColorCnt]);
-    if(nodeL)
+    if(node.feature >= 0)
     {
         treePainter->drawLine(x, y, x - shift, y+deltaY);
-        treePainter->setBrush(Qt::black);
-    }
-    if(nodeR)
-    {
         treePainter->drawLine(x, y, x + shift, y+deltaY);
         treePainter->setBrush(Qt::black);
-    }
-    treePainter->drawEllipse(x-radius, y-radius, radius*2, radius*2);
-    if(node->split)
-    {
-        treePainter->drawText(x+6, y, QString("[%1]").arg(node->split->var_idx+1));
+        treePainter->drawEllipse(x-radius, y-radius, radius*2, radius*2);
+        treePainter->drawText(x+6, y, QString("[%1]").arg(node.feature+1));
+        PrintNode(node.children, depth, x-shift);
+        PrintNode(node.children+1, depth, x+shift);
     }
     else
     {
+        int classId = inverseMap.at(node.children);
+        treePainter->setBrush(SampleColor[classId%SampleColorCnt]);
+        treePainter->drawEllipse(x-radius, y-radius, radius*2, radius*2);
         treePainter->drawText(x-2, y+16, QString("%1").arg(classId));
     }
-    PrintNode(nodeL, x-shift, true);
-    PrintNode(nodeR, x+shift, false);
 }
 
-void ClassifierTrees::PrintTree(cv::ml::DTrees *tree, int count=0) const
+void ClassifierTrees::PrintTree(int count) const
 {
-    int W = treePixmap.width() / treeCount;
+    int W = treeImage.width() / treeCount;
     int rootX = W*(count + 0.5f);
-    const CvDTreeNode *root = tree->get_root();
-    PrintNode(root, rootX);
-    fflush(stdout);
+    PrintNode(forest.Root(count), 0, rootX);
 }
 
 fvec ClassifierTrees::GetImportance() const
 {
-    Mat varImportance = tree->getVarImportance();
-    fvec importance(varImportance.cols);
-    FOR(i, varImportance.cols)
-    {
-        importance[i] = varImportance.at<float>(i);
-    }
     return importance;
 }
 
-fvec ClassifierTrees::TestMulti(const fvec &sample) const
+std::vector<fvec> ClassifierTrees::TestBatch(const std::vector<fvec> &samples) const
 {
-    float c = Test(sample);
-    if(classMap.size() == 2)
+    int count = samples.size();
+    int classCount = forest.ClassCount();
+    int forestDim = forest.Dim();
+    std::vector<fvec> res(count);
+    if(!count || !forest.TreeCount()) return res;
+
+    // samples and votes are stored contiguously, shorter samples are padded with zeros
+    fvec data(count*forestDim, 0.f);
+    FOR(i, count)
+    {
+        int length = min(forestDim, (int)samples[i].size());
+        FOR(d, length) data[i*forestDim + d] = samples[i][d];
+    }
+    fvec votes(count*classCount);
+    forest.Evaluate(&data[0], count, &votes[0]);
+
+    FOR(i, count)
     {
-        float value = (c-0.5)*3;
-        fvec res(1,value);
-        return res;
+        if(classCount == 2) res[i] = fvec(1, (votes[i*2+1]-0.5f)*3);
+        else res[i] = fvec(votes.begin() + i*classCount, votes.begin() + (i+1)*classCount);
     }
-    fvec res(maxClass, 0);
-    res[c] = 1.0f;
     return res;
 }
 
+fvec ClassifierTrees::TestMulti(const fvec &sample) const
+{
+    if(!forest.TreeCount()) return fvec(1, 0.f);
+    return TestBatch(std::vector<fvec>(1, sample))[0];
+}
+
 float ClassifierTrees::Test( const fvec &sample) const
 {
-    if (tree == NULL){
+    if (!forest.TreeCount()){
         printf( "Classification error: no classifier learned. \n" ); fflush(stdout);
         return 0.0;
     }
-    float *sample_ = new float[dim];
-    FOR(d, dim) sample_[d] = sample[d];
-    Mat test_sample = Mat(1, dim, CV_32FC1, sample_);
-    // predict_prob() returns a fuzzy-predicted class label for binary classification problems.
-    float res = 0;
-    if(classMap.size() == 2) res = tree->predict_prob(test_sample);
-    else res = tree->predict(test_sample);
-    return res;
+    // for binary problems we return the fraction of trees voting for the second class
+    fvec res = TestMulti(sample);
+    if(res.size() == 1) return res[0]/3 + 0.5f;
+    int maxClass = 0;
+    FOR(c, res.size()) if(res[c] > res[maxClass]) maxClass = c;
+    return maxClass;
+}
+
+void ClassifierTrees::SaveModel(const std::string filename) const
+{
+    std::cout << "saving Random Forest model" << std::endl;
+    if(!forest.TreeCount())
+    {
+        std::cout << "Error: Nothing to save!" << std::endl;
+        return; // nothing to save!
+    }
+
+    std::ofstream file(filename.c_str());
+    if(!file)
+    {
+        std::cout << "Error: Could not open the file!" << std::endl;
+        return;
+    }
+
+    file << dim << endl;
+    file << classMap.size() << endl;
+    for(std::map<int,int>::const_iterator it=classMap.begin(); it!=classMap.end(); it++)
+    {
+        file << it->first << " " << it->second << endl;
+    }
+    file.precision(10);
+    file << importance.size() << endl;
+    FOR(i, importance.size()) file << importance[i] << " ";
+    file << endl;
+    forest.Save(file);
+    file.close();
+}
+
+bool ClassifierTrees::LoadModel(const std::string filename)
+{
+    std::cout << "loading Random Forest model: " << filename << std::endl;
+
+    std::ifstream file(filename.c_str());
+    if(!file.is_open())
+    {
+        std::cout << "Error: Could not open the file!" << std::endl;
+        return false;
+    }
+
+    int classCount = 0, importanceCount = 0;
+    file >> dim >> classCount;
+    classMap.clear();
+    inverseMap.clear();
+    FOR(c, classCount)
+    {
+        int label, index;
+        file >> label >> index;
+        classMap[label] = index;
+        inverseMap[index] = label;
+    }
+    file >> importanceCount;
+    importance.resize(max(0, importanceCount));
+    FOR(i, importance.size()) file >> importance[i];
+    if(!file || !forest.Load(file) || forest.ClassCount() != classCount || forest.Dim() > (int)dim || (int)inverseMap.size() != classCount)
+    {
+        std::cout << "Error: Could not read the model!" << std::endl;
+        forest.Clear();
+        return false;
+    }
+
+    UpdateClassRange();
+    return true;
+}
+
+bool ClassifierTrees::SaveModel(ModelArchive &archive) const
+{
+    if(!forest.TreeCount()) return false;
+    ivec classPairs;
+    for(std::map<int,int>::const_iterator it=classMap.begin(); it!=classMap.end(); it++)
+    {
+        classPairs.push_back(it->first);
+        classPairs.push_back(it->second);
+    }
+    archive.AddValue("trees.dim", dim);
+    archive.AddVector("trees.classes", classPairs);
+    archive.AddVector("trees.importance", importance);
+    forest.Save(archive, "trees.forest");
+    return true;
+}
+
+bool ClassifierTrees::LoadModel(const ModelArchive &archive)
+{
+    // everything is parsed into locals first, a rejected archive leaves the current model untouched
+    ivec classPairs;
+    fvec newImportance;
+    u32 dim;
+    if(!archive.GetValue("trees.dim", dim) || !archive.GetVector("trees.classes", classPairs) ||
+            !archive.GetVector("trees.importance", newImportance) || classPairs.size() % 2) return false;
+    std::map<int,int> newClassMap, newInverseMap;
+    for(size_t i=0; i<classPairs.size(); i+=2)
+    {
+        newClassMap[classPairs[i]] = classPairs[i+1];
+        newInverseMap[classPairs[i+1]] = classPairs[i];
+    }
+    int classCount = classPairs.size()/2;
+    if((int)newInverseMap.size() != classCount) return false;
+    FlatForest newForest;
+    if(!newForest.Load(archive, "trees.forest") || newForest.ClassCount() != classCount || newForest.Dim() > (int)dim) return false;
+    forest = newForest;
+    classMap.swap(newClassMap);
+    inverseMap.swap(newInverseMap);
+    importance.swap(newImportance);
+    this->dim = dim;
+    UpdateClassRange();
+    return true;
+}
+
+void ClassifierTrees::UpdateClassRange()
+{
+    negativeClass = classMap.count(-1) ? classMap[-1] : 0;
+    maxClass = classMap.size();
+    for(std::map<int,int>::iterator it=inverseMap.begin(); it!=inverseMap.end(); it++)
+    {
+        maxClass = max(maxClass, it->second);
+    }
+    DrawTrees();
 }
 
 void ClassifierTrees::SetParams(bool bBalanceClasses,
@@ -295,6 +392,8 @@ void ClassifierTrees::SetParams(bool bBalanceClasses,
 const char *ClassifierTrees::GetInfoString() const
 {
 	char *text = new char[1024];
-    sprintf(text, "Decision Trees\n");
+    sprintf(text, "Random Forest\n");
+    sprintf(text, "%sTrees: %d\n", text, forest.TreeCount());
+    sprintf(text, "%sNodes: %d\n", text, forest.NodeCount());
 	return text;
 }
@@ -22,7 +22,8 @@ Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
 #include <vector>
 #include "classifier.h"
 #include "basicOpenCV.h"
-#include <QPixmap>
+#include "flatForest.h"
+#include <QImage>
 #include <QPainter>
 
 class ClassifierTrees : public Classifier
@@ -35,16 +36,19 @@ private:
     int maxTrees;
     float accuracyTolerance;
 
-    cv::ml::RTrees *tree;
+    // the trained forest, compiled for evaluation
+    FlatForest forest;
+    fvec importance;
 
     int negativeClass;
     int maxClass;
+    void UpdateClassRange();
 
 public:
     std::vector<fvec> samples;
     ivec labels;
 
-    QPixmap treePixmap;
+    QImage treeImage; // drawn during Train, which can run outside of the GUI thread
     QPainter *treePainter;
     int treeDepth;
     int treeCount;
@@ -55,14 +59,19 @@ public:
 	void Train(std::vector< fvec > samples, ivec labels);
     float Test(const fvec &sample) const ;
     fvec TestMulti(const fvec &sample) const ;
+    std::vector<fvec> TestBatch(const std::vector<fvec> &samples) const ;
     const char *GetInfoString() const ;
     fvec GetImportance() const ;
-    void PrintTree(cv::ml::DTrees *tree, int count) const;
-    void PrintNode(const cv::ml::DTrees::Node *node, int rootX=0, bool bLeft=true) const;
-    int GetTreeDepth(const cv::ml::DTrees::Node **node) const ;
+    void SaveModel(const std::string filename) const ;
+    bool LoadModel(const std::string filename);
+    bool SaveModel(ModelArchive &archive) const ;
+    bool LoadModel(const ModelArchive &archive);
+    void DrawTrees();
+    void PrintTree(int count) const;
+    void PrintNode(int index, int depth, int rootX=0) const;
     void SetParams(bool bBalanceClasses,
                    int minSampleCount, int maxDepth, int maxTrees,
                    float accuracyTolerance);
 };
 
-#endif // _CLASSIFIER_BOOST_H_
+#endif // _CLASSIFIER_TREES_H_
@@ -0,0 +1,201 @@
+/*********************************************************************
+MLDemos: A User-Friendly visualization toolkit for machine learning
+Copyright (C) 2010  Basilio Noris
+Contact: mldemos@b4silio.com
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Library General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free
+Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*********************************************************************/
+#include "public.h"
+#include "flatForest.h"
+#include "modelArchive.h"
+#include <algorithm>
+
+using namespace std;
+
+// below this many (sample, tree) pairs a single block is not worth splitting over threads
+#define FOREST_PARALLEL_WORK 4096
+
+void FlatForest::Clear()
+{
+    nodes.clear();
+    roots.clear();
+    dim = classCount = 0;
+}
+
+void FlatForest::Compile(const cv::ml::DTrees &forest, const int classCount)
+{
+    Clear();
+    this->classCount = classCount;
+    dim = forest.getVarCount();
+    const std::vector<int> &cvRoots = forest.getRoots();
+    const std::vector<cv::ml::DTrees::Node> &cvNodes = forest.getNodes();
+    const std::vector<cv::ml::DTrees::Split> &cvSplits = forest.getSplits();
+    roots.resize(cvRoots.size());
+    FOR(t, cvRoots.size())
+    {
+        // breadth-first copy of the tree, the queue holds the opencv index of each new node
+        int root = nodes.size();
+        roots[t] = root;
+        ivec queue(1, cvRoots[t]);
+        nodes.resize(root+1);
+        for(int q=0; q<(int)queue.size(); q++)
+        {
+            const cv::ml::DTrees::Node &node = cvNodes[queue[q]];
+            Node &flat = nodes[root+q];
+            if(node.split < 0 || node.left < 0 || node.right < 0)
+            {
+                flat.feature = -1;
+                flat.threshold = 0;
+                flat.children = max(0, min(classCount-1, node.classIdx));
+                continue;
+            }
+            // opencv sends the sample left when x <= c, unless the split is inversed
+            const cv::ml::DTrees::Split &split = cvSplits[node.split];
+            flat.feature = split.varIdx;
+            flat.threshold = split.c;
+            flat.children = root + queue.size();
+            queue.push_back(split.inversed ? node.right : node.left);
+            queue.push_back(split.inversed ? node.left : node.right);
+            nodes.resize(root + queue.size());
+        }
+    }
+}
+
+void FlatForest::EvaluateTrees(const float *samples, const int count, const int firstTree, const int lastTree, float *votes) const
+{
+    const Node *base = &nodes[0];
+    for(int t=firstTree; t<lastTree; t++)
+    {
+        const Node *root = base + roots[t];
+        FOR(i, count)
+        {
+            const float *x = samples + i*dim;
+            const Node *node = root;
+            while(node->feature >= 0) node = base + node->children + (x[node->feature] > node->threshold);
+            votes[i*classCount + node->children] += 1.f;
+        }
+    }
+}
+
+void FlatForest::Evaluate(const float *samples, const int count, float *votes) const
+{
+    fill(votes, votes + count*classCount, 0.f);
+    int treeCount = roots.size();
+    if(!treeCount || !count) return;
+    int blockCount = (count + FOREST_BLOCK - 1) / FOREST_BLOCK;
+    if(blockCount > 1)
+    {
+        // each block of samples goes through the whole forest, tree after tree
+#pragma omp parallel for schedule(dynamic)
+        for(int b=0; b<blockCount; b++)
+        {
+            int start = b*FOREST_BLOCK;
+            int length = min(FOREST_BLOCK, count - start);
+            EvaluateTrees(samples + start*dim, length, 0, treeCount, votes + start*classCount);
+        }
+    }
+    else
+    {
+        // a single block: the trees are shared among the threads, which vote separately
+#pragma omp parallel if(count*treeCount >= FOREST_PARALLEL_WORK)
+        {
+            fvec local(count*classCount, 0.f);
+#pragma omp for schedule(static) nowait
+            for(int t=0; t<treeCount; t++) EvaluateTrees(samples, count, t, t+1, &local[0]);
+#pragma omp critical
+            FOR(i, local.size()) votes[i] += local[i];
+        }
+    }
+    float norm = 1.f / treeCount;
+    FOR(i, count*classCount) votes[i] *= norm;
+}
+
+int FlatForest::Depth(const int tree) const
+{
+    int depth = 0;
+    std::vector< pair<int,int> > stack(1, make_pair(roots[tree], 0));
+    while(!stack.empty())
+    {
+        pair<int,int> current = stack.back();
+        stack.pop_back();
+        depth = max(depth, current.second);
+        const Node &node = nodes[current.first];
+        if(node.feature < 0) continue;
+        stack.push_back(make_pair(node.children, current.second+1));
+        stack.push_back(make_pair(node.children+1, current.second+1));
+    }
+    return depth;
+}
+
+void FlatForest::Save(std::ostream &file) const
+{
+    file << roots.size() << " " << nodes.size() << " " << dim << " " << classCount << endl;
+    FOR(t, roots.size()) file << roots[t] << " ";
+    file << endl;
+    file.precision(10);
+    FOR(i, nodes.size()) file << nodes[i].feature << " " << nodes[i].threshold << " " << nodes[i].children << endl;
+}
+
+bool FlatForest::Load(std::istream &file)
+{
+    Clear();
+    int treeCount = 0, nodeCount = 0;
+    file >> treeCount >> nodeCount >> dim >> classCount;
+    if(!file || treeCount < 0 || nodeCount < treeCount || dim <= 0 || classCount <= 0)
+    {
+        Clear();
+        return false;
+    }
+    roots.resize(treeCount);
+    nodes.resize(nodeCount);
+    FOR(t, treeCount) file >> roots[t];
+    FOR(i, nodeCount) file >> nodes[i].feature >> nodes[i].threshold >> nodes[i].children;
+    bool bOk = !file.fail() && Check();
+    if(!bOk) Clear();
+    return bOk;
+}
+
+void FlatForest::Save(ModelArchive &archive, const std::string &prefix) const
+{
+    archive.AddValue(prefix + ".dim", dim);
+    archive.AddValue(prefix + ".classCount", classCount);
+    archive.AddVector(prefix + ".roots", roots);
+    archive.AddVector(prefix + ".nodes", nodes);
+}
+
+bool FlatForest::Load(const ModelArchive &archive, const std::string &prefix)
+{
+    Clear();
+    bool bOk = archive.GetValue(prefix + ".dim", dim) && archive.GetValue(prefix + ".classCount", classCount) &&
+            archive.GetVector(prefix + ".roots", roots) && archive.GetVector(prefix + ".nodes", nodes);
+    bOk = bOk && dim > 0 && classCount > 0 && nodes.size() >= roots.size() && Check();
+    if(!bOk) Clear();
+    return bOk;
+}
+
+bool FlatForest::Check() const
+{
+    int nodeCount = nodes.size();
+    bool bOk = true;
+    // children always come after their parent, which guarantees that every traversal ends
+    FOR(t, roots.size()) bOk &= roots[t] >= 0 && roots[t] < nodeCount;
+    FOR(i, nodeCount)
+    {
+        const Node &node = nodes[i];
+        if(node.feature < 0) bOk &= node.children >= 0 && node.children < classCount;
+        else bOk &= node.feature < dim && node.children > (int)i && node.children+1 < nodeCount;
+    }
+    return bOk;
+}
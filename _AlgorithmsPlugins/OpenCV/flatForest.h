@@ -0,0 +1,73 @@
+/*********************************************************************
+MLDemos: A User-Friendly visualization toolkit for machine learning
+Copyright (C) 2010  Basilio Noris
+Contact: mldemos@b4silio.com
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public License,
+version 3 as published by the Free Software Foundation.
+
+This library is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free
+Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*********************************************************************/
+#ifndef _FLAT_FOREST_H_
+#define _FLAT_FOREST_H_
+
+#include <vector>
+#include <string>
+#include <iostream>
+#include "basicOpenCV.h"
+
+class ModelArchive;
+
+// samples that go through one tree before moving to the next one
+#define FOREST_BLOCK 64
+
+// classification forest compiled into a single array of nodes.
+// Each tree is stored breadth-first with the two children of a node next to each other,
+// a sample goes to the right child when x[feature] > threshold
+class FlatForest
+{
+public:
+    struct Node
+    {
+        int feature; // -1 for leaves
+        float threshold;
+        int children; // index of the left child, or class voted by a leaf
+    };
+
+    FlatForest() : dim(0), classCount(0) {}
+    // classes are the (integer) responses used for training, in [0, classCount)
+    void Compile(const cv::ml::DTrees &forest, const int classCount);
+    void Clear();
+    // fraction of the trees voting for each class, samples and votes are stored row by row
+    void Evaluate(const float *samples, const int count, float *votes) const;
+    int Dim() const {return dim;}
+    int TreeCount() const {return roots.size();}
+    int NodeCount() const {return nodes.size();}
+    int ClassCount() const {return classCount;}
+    int Root(const int tree) const {return roots[tree];}
+    const Node &GetNode(const int index) const {return nodes[index];}
+    int Depth(const int tree) const;
+
+    void Save(std::ostream &file) const;
+    bool Load(std::istream &file);
+    // the nodes are stored as a single buffer, prefix names the entries
+    void Save(ModelArchive &archive, const std::string &prefix) const;
+    bool Load(const ModelArchive &archive, const std::string &prefix);
+
+private:
+    std::vector<Node> nodes;
+    std::vector<int> roots;
+    int dim, classCount;
+    bool Check() const;
+    void EvaluateTrees(const float *samples, const int count, const int firstTree, const int lastTree, float *votes) const;
+};
+
+#endif // _FLAT_FOREST_H_
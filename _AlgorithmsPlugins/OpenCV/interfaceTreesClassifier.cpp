@@ -166,7 +166,7 @@ void ClassTrees::DrawInfo(Canvas *canvas, QPainter &painter, Classifier *classif
 
     ClassifierTrees *trees = dynamic_cast<ClassifierTrees*>(classifier);
     if(!trees) return;
-    treePixmap = trees->treePixmap;
+    treePixmap = QPixmap::fromImage(trees->treeImage);
     if(params->displayButton->isChecked()) DisplayTrees();
     fvec importance = trees->GetImportance();
     params->importanceList->clear();
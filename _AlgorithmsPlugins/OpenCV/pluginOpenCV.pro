@@ -18,7 +18,8 @@ HEADERS +=	\
 			mymaths.h \
 			basicOpenCV.h \
 			classifierBoost.h \
-			#classifierTrees.h \
+			flatForest.h \
+			classifierTrees.h \
             classifierMLP.h \
 			regressorMLP.h \
             dynamicalMLP.h \
@@ -28,14 +29,15 @@ HEADERS +=	\
 			interfaceMLPRegress.h \
             interfaceMLPDynamic.h \
 			#interfaceGBRegress.h \
-			#interfaceTreesClassifier.h \
+			interfaceTreesClassifier.h \
             pluginOpenCV.h
 
 SOURCES += 	\
 			basicOpenCV.cpp \
 			classifierBoost.cpp \
 			classifierMLP.cpp \
-			#classifierTrees.cpp \
+			flatForest.cpp \
+			classifierTrees.cpp \
 			regressorMLP.cpp \
 			dynamicalMLP.cpp \
 			#regressorGB.cpp \
@@ -44,7 +46,7 @@ SOURCES += 	\
 			interfaceMLPRegress.cpp \
 			interfaceMLPDynamic.cpp \
 			#interfaceGBRegress.cpp \
-			#interfaceTreesClassifier.cpp \
+			interfaceTreesClassifier.cpp \
             pluginOpenCV.cpp
 #}
 
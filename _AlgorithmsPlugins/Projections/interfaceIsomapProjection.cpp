@@ -0,0 +1,102 @@
+#include "interfaceIsomapProjection.h"
+#include "projectorIsomap.h"
+
+using namespace std;
+
+IsomapProjection::IsomapProjection()
+    : widget(new QWidget())
+{
+    params = new Ui::paramsIsomap();
+    params->setupUi(widget);
+}
+
+IsomapProjection::~IsomapProjection()
+{
+    delete params;
+}
+
+// virtual functions to manage the algorithm creation
+Projector *IsomapProjection::GetProjector()
+{
+    return new ProjectorIsomap();
+}
+
+fvec IsomapProjection::GetParams()
+{
+    fvec par(2);
+    par[0] = params->knnSpin->value();
+    par[1] = params->landmarkSpin->value();
+    return par;
+}
+
+void IsomapProjection::SetParams(Projector *projector, fvec parameters)
+{
+    if(!projector) return;
+    ProjectorIsomap *isomap = dynamic_cast<ProjectorIsomap*>(projector);
+    if(!isomap) return;
+    isomap->num_dims = params->dimCountSpin->value();
+    isomap->knn = parameters.size() > 0 ? parameters[0] : 12;
+    isomap->landmarks = parameters.size() > 1 ? parameters[1] : 0;
+}
+
+void IsomapProjection::GetParameterList(std::vector<QString> &parameterNames,
+                             std::vector<QString> &parameterTypes,
+                             std::vector< std::vector<QString> > &parameterValues)
+{
+    parameterNames.push_back("K-NN");
+    parameterTypes.push_back("Integer");
+    parameterValues.push_back(vector<QString>());
+    parameterValues.back().push_back("1");
+    parameterValues.back().push_back("200");
+    parameterNames.push_back("Landmarks");
+    parameterTypes.push_back("Integer");
+    parameterValues.push_back(vector<QString>());
+    parameterValues.back().push_back("0");
+    parameterValues.back().push_back("9999");
+}
+
+// virtual functions to manage the GUI and I/O
+QString IsomapProjection::GetAlgoString()
+{
+    return QString("Isomap %1 %2").arg(params->knnSpin->value()).arg(params->landmarkSpin->value());
+}
+
+void IsomapProjection::SetParams(Projector *projector)
+{
+    if(!projector) return;
+    ProjectorIsomap *isomap = dynamic_cast<ProjectorIsomap*>(projector);
+    if(!isomap) return;
+    isomap->num_dims = params->dimCountSpin->value();
+    isomap->knn = params->knnSpin->value();
+    isomap->landmarks = params->landmarkSpin->value();
+}
+
+void IsomapProjection::SaveOptions(QSettings &settings)
+{
+    settings.setValue("dimCount", params->dimCountSpin->value());
+    settings.setValue("knn", params->knnSpin->value());
+    settings.setValue("landmarks", params->landmarkSpin->value());
+}
+
+bool IsomapProjection::LoadOptions(QSettings &settings)
+{
+    if(settings.contains("dimCount")) params->dimCountSpin->setValue(settings.value("dimCount").toInt());
+    if(settings.contains("knn")) params->knnSpin->setValue(settings.value("knn").toInt());
+    if(settings.contains("landmarks")) params->landmarkSpin->setValue(settings.value("landmarks").toInt());
+    return true;
+}
+
+void IsomapProjection::SaveParams(QTextStream &file)
+{
+    file << "projectOptions" << ":" << "dimCount" << " " << params->dimCountSpin->value() << "\n";
+    file << "projectOptions" << ":" << "knn" << " " << params->knnSpin->value() << "\n";
+    file << "projectOptions" << ":" << "landmarks" << " " << params->landmarkSpin->value() << "\n";
+}
+
+bool IsomapProjection::LoadParams(QString name, float value)
+{
+    if(name.endsWith("dimCount")) params->dimCountSpin->setValue((int)value);
+    if(name.endsWith("knn")) params->knnSpin->setValue((int)value);
+    if(name.endsWith("landmarks")) params->landmarkSpin->setValue((int)value);
+    return true;
+}
@@ -7,75 +7,119 @@
 //
 
 #include "isomap.h"
-#include "fibheap.h"
 #include <math.h>
 #include <float.h>
+#include <stdlib.h>
 #include <algorithm>
 #include <iostream>
 #include <queue>
-#include <MathLib/MathLib.h>
-//#ifdef MACX
-//#include <Accelerate/Accelerate.h>
-//#else
-//#include <clapack.h>
-//#endif
+#include <vector>
+#include <Eigen/Core>
+#include <Eigen/Eigenvalues>
+#include "ANN/ANN.h"
 
-void dodijk_sparse(long int M,
-                   long int N,
-                   long int S,
-                   long int *P, // parents
-                   double   *D, // distances
-                   double   *sr,
-                   int      *irs,
-                   int      *jcs,
-                   HeapNode *A,
-                   FibHeap  *theHeap  );
+// Dijkstra on the (compact sparse) neighbourhood graph, with an indexed binary heap
+// the buffers are allocated once and reused for every source handled by the same thread
+struct DijkstraWorkspace {
+    std::vector<double> dist;
+    std::vector<int> heap;      // nodes, ordered by distance
+    std::vector<int> position;  // position of each node in the heap, -1 if it is not in it
 
+    DijkstraWorkspace(int N) : dist(N), position(N, -1) { heap.reserve(N); }
 
-void run_isomap(float* X, int N, int D, float* Y, int no_dims, int K) {
-    
-    // Compute pairwise distance matrix
-    float* DD = (float*) calloc(N * N, sizeof(float));
-    float val;
-	for(int n = 0; n < N; n++) {
-		DD[n * N + n] = 0.0;
-		for(int m = n + 1; m < N; m++) {
-			val = 0.0;
-			for(int d = 0; d < D; d++) val += (X[n * D + d] - X[m * D + d]) * (X[n * D + d] - X[m * D + d]);
-			DD[n * N + m] = val;
-			DD[m * N + n] = val;
-		}
-	}    
-    
-    // Compute pairwise distance matrix (using BLAS)
-    // ...put squared row and column sums in DD...
-    //cblas_sgemm(CblasRowMajor, CblasTrans, CblasNoTrans, N, N, D, -2.0, X, N, X, N, 0.0, DD, N);
+    void sift_up(int i) {
+        int node = heap[i];
+        while(i > 0) {
+            int parent = (i - 1) / 2;
+            if(dist[heap[parent]] <= dist[node]) break;
+            heap[i] = heap[parent];
+            position[heap[i]] = i;
+            i = parent;
+        }
+        heap[i] = node;
+        position[node] = i;
+    }
+
+    void sift_down(int i) {
+        int node = heap[i];
+        int size = heap.size();
+        while(true) {
+            int child = 2 * i + 1;
+            if(child >= size) break;
+            if(child + 1 < size && dist[heap[child + 1]] < dist[heap[child]]) child++;
+            if(dist[node] <= dist[heap[child]]) break;
+            heap[i] = heap[child];
+            position[heap[i]] = i;
+            i = child;
+        }
+        heap[i] = node;
+        position[node] = i;
+    }
+
+    // fills dist with the length of the shortest path from source to every node (DBL_MAX if unreachable)
+    void run(int source, const double* sr, const int* irs, const int* jcs) {
+        std::fill(dist.begin(), dist.end(), DBL_MAX);
+        heap.clear();
+        dist[source] = 0.0;
+        heap.push_back(source);
+        position[source] = 0;
+        while(!heap.empty()) {
+            int closest = heap[0];
+            position[closest] = -1;
+            int last = heap.back();
+            heap.pop_back();
+            if(!heap.empty()) {
+                heap[0] = last;
+                sift_down(0);
+            }
+            // relax all nodes adjacent to closest
+            for(int i = jcs[closest]; i < jcs[closest + 1]; i++) {
+                int neighbor = irs[i];
+                double newdist = dist[closest] + sr[i];
+                if(newdist >= dist[neighbor]) continue;
+                bool queued = dist[neighbor] != DBL_MAX;
+                dist[neighbor] = newdist;
+                if(!queued) {
+                    heap.push_back(neighbor);
+                    sift_up(heap.size() - 1);
+                }
+                else if(position[neighbor] >= 0) sift_up(position[neighbor]);
+            }
+        }
+    }
+};
+
+void run_isomap(float* X, int N, int D, float* Y, int no_dims, int K, int no_landmarks) {
     
     // Construct k-nearest neighbors graph (compact sparse format)
+    // (the query point is its own first neighbor, as in the full distance matrix)
+    K = std::min(K, N);
     double* sr = (double*) malloc(N * K * sizeof(double));  // nonzero values (N * K elements)
     int* irs   = (int*)    malloc(N * K * sizeof(int));     // row at which a nonzero element can be found (N * K elements)
     int* jcs   = (int*)    malloc((N + 1) * sizeof(int));   // indicates columns containing nonzero elements (N + 1 elements)
+    ANNpointArray dataPts = annAllocPts(N, D);
+    for(int n = 0; n < N; n++) {
+        for(int d = 0; d < D; d++) dataPts[n][d] = X[n * D + d];
+    }
+    ANN::MetricType = ANN_METRIC2;  // ANN defaults to the L-inf norm
+    ANN::MetricPower = 2;
+    ANNkd_tree* kdTree = new ANNkd_tree(dataPts, N, D);
+    ANNidxArray nnIdx = new ANNidx[K];
+    ANNdistArray dists = new ANNdist[K];
     jcs[0] = 0;
     for(int n = 0; n < N; n++) {
-        for(int k = 0; k < K; k++) {                // this is inefficient for large K
-            
-            // Find k-th nearest neighbor
-            int min_ind   = 0;
-            float min_val = FLT_MAX;
-            for(int m = 0; m < N; m++) {
-                if(DD[n * N + m] < min_val) {
-                    min_val = DD[n * N + m];
-                    min_ind = m;
-                }
-            }
-            DD[n * N + min_ind] = FLT_MAX;
-            
-            // Store neighbor in compact sparse format
-            sr[n * K + k]  = min_val;
-            irs[n * K + k] = min_ind;
+        kdTree->annkSearch(dataPts[n], K, nnIdx, dists, 0);  // squared distances
+        for(int k = 0; k < K; k++) {
+            sr[n * K + k]  = dists[k];
+            irs[n * K + k] = nnIdx[k];
         }
         jcs[n + 1] = jcs[n] + K;
     }
+    delete [] nnIdx;
+    delete [] dists;
+    delete kdTree;
+    annDeallocPts(dataPts);
+    annClose();
     int orig_N = N;
     
     // Select largest connected component
@@ -127,94 +171,94 @@ void run_isomap(float* X, int N, int D, float* Y, int no_dims, int K) {
         new_jcs = jcs;
     }
     
-    // Perform Dijkstra's algorithm
-    HeapNode *A = NULL;
-    FibHeap  *theHeap = NULL;
-    float*   gD      = (float *)    malloc(N * N * sizeof(float));
-    double*   Dsmall = (double *)   calloc(N, sizeof(double));
-    long int* Psmall = (long int *) calloc(N, sizeof(long int));
-    for(int i = 0; i < N; i++) {        
-        if((theHeap = new FibHeap) == NULL || (A = new HeapNode[N + 1]) == NULL) {
-            return;
-        }     
-        theHeap->ClearHeapOwnership();     
-        dodijk_sparse(N, N, i, Psmall, Dsmall, new_sr, new_irs, new_jcs, A, theHeap);
-        for(int j = 0; j < N; j++) {
-            *(gD + j * N + i) = (float) *(Dsmall + j);
-        }
-        delete theHeap;
-        delete[] A;
+    // Choose the sources of the geodesics: every point, or a random subset of landmarks
+    bool landmarks = no_landmarks > 0 && no_landmarks < N;
+    int L = landmarks ? std::max(no_landmarks, std::min(no_dims + 1, N)) : N;
+    std::vector<int> sources(N);
+    for(int n = 0; n < N; n++) sources[n] = n;
+    if(landmarks) {
+        for(int l = 0; l < L; l++) std::swap(sources[l], sources[l + rand() % (N - l)]);
+        sources.resize(L);
+        std::sort(sources.begin(), sources.end());
     }
-    
-    // Perform centering of geodesic distance matrix
-    float* row_sums = N ? (float*) calloc(N, sizeof(float)) : 0;
-    float* col_sums = N ? (float*) calloc(N, sizeof(float)) : 0;
-    for(int n = 0; n < N; n++) {
-        for(int m = 0; m < N; m++) {
-            row_sums[m] += gD[n * N + m];
-            col_sums[n] += gD[n * N + m];
+
+    // Perform Dijkstra's algorithm from each source, concurrently
+    // gD(l, j) holds the geodesic distance from the l-th source to point j
+    float* gD = (float*) malloc((size_t)L * N * sizeof(float));
+    #pragma omp parallel
+    {
+        DijkstraWorkspace workspace(N);
+        #pragma omp for schedule(dynamic, 1)
+        for(int l = 0; l < L; l++) {
+            workspace.run(sources[l], new_sr, new_irs, new_jcs);
+            for(int j = 0; j < N; j++) gD[(size_t)l * N + j] = (float) workspace.dist[j];
         }
     }
-    float tot_sum = 0.0;
-    for(int n = 0; n < N; n++) tot_sum += col_sums[n];
-    for(int n = 0; n < N; n++) row_sums[n] /= (float) N;
-    for(int n = 0; n < N; n++) col_sums[n] /= (float) N;
-    tot_sum /= (N * N);
-    for(int n = 0; n < N; n++) {
-        for(int m = 0; m < N; m++) {
-            gD[n * N + m] = -.5 * (gD[n * N + m] - row_sums[m] - col_sums[n] + tot_sum);
+
+    // Perform centering of geodesic distance matrix between sources
+    std::vector<double> row_sums(L, 0.0), col_sums(L, 0.0);
+    double tot_sum = 0.0;
+    for(int n = 0; n < L; n++) {
+        for(int m = 0; m < L; m++) {
+            double val = gD[(size_t)n * N + sources[m]];
+            row_sums[m] += val;
+            col_sums[n] += val;
+            tot_sum += val;
         }
     }
-    
-    MathLib::Matrix gDMatrix(N,N);
-    for(int n=0; n<N; n++)
-    {
-        for(int m=0; m<N; m++)
-        {
-            gDMatrix(n,m) = gD[n*N + m];
+    for(int n = 0; n < L; n++) row_sums[n] /= L;
+    for(int n = 0; n < L; n++) col_sums[n] /= L;
+    tot_sum /= ((double)L * L);
+    Eigen::MatrixXd kernel(L, L);
+    for(int n = 0; n < L; n++) {
+        for(int m = 0; m < L; m++) {
+            kernel(n, m) = -.5 * (gD[(size_t)n * N + sources[m]] - row_sums[m] - col_sums[n] + tot_sum);
         }
     }
-    MathLib::Vector eigVals(N);
-    MathLib::Matrix eigVec(N,N);
-    gDMatrix.EigenValuesDecomposition(eigVals, eigVec);
-    // we need to sort the eigenvalues
-    std::vector< pair<float,int> > lambdas(N);
-    for(int n = 0; n < N; n++) lambdas[n] = make_pair(eigVals(n), n);
-    std::sort(lambdas.begin(), lambdas.end());
-    float* lambda = (float*) malloc(N * sizeof(float));
-    for(int n=0; n<N; n++)
-    {
-        lambda[n] = lambdas[n].first;
-        for (int m=0; m<N; m++) gD[m*N + n] = eigVec(m, lambdas[n].second);
-    }
+    // paths in the neighbourhood graph are not exactly symmetric
+    kernel = (kernel + kernel.transpose()) * .5;
+
+    // Perform eigendecomposition of kernel matrix (eigenvalues in ascending order)
+    Eigen::SelfAdjointEigenSolver<Eigen::MatrixXd> eig(kernel);
+    kernel.resize(0, 0);
+    const Eigen::VectorXd& lambda = eig.eigenvalues();
+    const Eigen::MatrixXd& vectors = eig.eigenvectors();
 
-    // Perform eigendecomposition of kernel matrix
-//    int n = N, lda = N, lwork = -1, info;
-//	float wkopt;
-//	float* lambda = (float*) malloc(N * sizeof(float));
-    //ssyev_((char*) "V", (char*) "U", &n, gD, &lda, lambda, &wkopt, &lwork, &info); // gets optimal size of working memory
-    //lwork = (int) wkopt;
-    //float* work = (float*) malloc(lwork * sizeof(float));
-    //ssyev_((char*) "V", (char*) "U", &n, gD, &lda, lambda, work, &lwork, &info);   // eigenvectors for real, symmetric matrix
-    // NOTE: ssyev outputs eigenvalues in ascending order!
-    
     // Compute final embedding
+    // landmarks: each point is placed by triangulation from its distances to the landmarks
+    // (for the landmarks themselves, this gives back their classical MDS coordinates)
+    std::vector<double> mean_dist(L, 0.0);
+    for(int l = 0; l < L; l++) {
+        for(int m = 0; m < L; m++) mean_dist[l] += gD[(size_t)l * N + sources[m]];
+        mean_dist[l] /= L;
+    }
+    int* indices = (int*) malloc(N * sizeof(int));
     int cur_n = 0;
     for(int n = 0; n < orig_N; n++) {
-        if(comp_no[n] == max_ind) {
-            int count_d = 0;
-            for(int d = N - 1; d >= N - no_dims; d--) {
-                Y[n * no_dims + count_d] = gD[d * N + cur_n] * sqrt((d>=0 && d<N) ? lambda[d] : 0);
-                count_d++;
-            }
-            cur_n++;
-        }
+        if(comp_no[n] == max_ind) indices[cur_n++] = n;
         else {
             for(int d = 0; d < no_dims; d++) {
                 Y[n * no_dims + d] = NAN;
             }
         }
-	}
+    }
+    #pragma omp parallel for
+    for(int j = 0; j < N; j++) {
+        int count_d = 0;
+        for(int d = L - 1; d >= L - no_dims; d--) {
+            double value = 0;
+            if(d >= 0 && lambda(d) > 0) {
+                if(landmarks) {
+                    for(int l = 0; l < L; l++) value += vectors(l, d) * (gD[(size_t)l * N + j] - mean_dist[l]);
+                    value *= -.5 / sqrt(lambda(d));
+                }
+                else value = vectors(j, d) * sqrt(lambda(d));
+            }
+            Y[indices[j] * no_dims + count_d] = value;
+            count_d++;
+        }
+    }
+    free(indices);
     
     // Normalize data to have a minimum value of zero
 	float* min_val = (float*) calloc(no_dims, sizeof(float));
@@ -245,16 +289,11 @@ void run_isomap(float* X, int N, int D, float* Y, int no_dims, int K) {
     // Clean up memory
     free(min_val);
     free(max_val);
-    free(DD);
     free(new_sr);
     free(new_irs);
     free(new_jcs);
     free(comp_no);
     free(gD);
-    free(Dsmall);
-    free(Psmall);
-    free(lambda);
-//    free(work);
 }
 
 void find_connected_components(int* irs, int N, int K, int* comp_no) {
@@ -9,7 +9,9 @@
 #ifndef Divvy_isomap_h
 #define Divvy_isomap_h
 
-void run_isomap(float* X, int N, int D, float* Y, int no_dims, int K);
+// no_landmarks > 0 computes the geodesics from that many random landmarks only (landmark Isomap)
+// and places the other points by triangulation, instead of using all N x N geodesic distances
+void run_isomap(float* X, int N, int D, float* Y, int no_dims, int K, int no_landmarks = 0);
 void find_connected_components(int* irs, int N, int K, int* comp_no);
 void find_largest_connected_component(int* comp_no, int N, int* max_ind, int* max_count);
 
@@ -25,6 +25,7 @@ Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
 #include "interfaceSammonProjection.h"
 #include "interfaceNormalizeProjection.h"
 #include "interfaceLLEProjection.h"
+#include "interfaceIsomapProjection.h"
 
 using namespace std;
 
@@ -38,6 +39,7 @@ PluginProjections::PluginProjections()
     projectors.push_back(new SammonProjection());
     projectors.push_back(new NormalizeProjection());
     projectors.push_back(new LLEProjection());
+    projectors.push_back(new IsomapProjection());
 }
 
 //Q_EXPORT_PLUGIN2(mld_Projections, PluginProjections)
@@ -19,7 +19,8 @@ FORMS += \
     paramsPCA.ui \
     contourPlots.ui \
     paramsNormalize.ui \
-    paramsLLE.ui
+    paramsLLE.ui \
+    paramsIsomap.ui
 HEADERS +=	\
     basicOpenCV.h \
     canvas.h \
@@ -43,7 +44,10 @@ HEADERS +=	\
     projectorNormalize.h \
     interfaceNormalizeProjection.h \
     projectorLLE.h \
-    interfaceLLEProjection.h
+    sparseCholesky.h \
+    interfaceLLEProjection.h \
+    projectorIsomap.h \
+    interfaceIsomapProjection.h
 
 SOURCES += 	\
     basicOpenCV.cpp \
@@ -65,14 +69,15 @@ SOURCES += 	\
     projectorNormalize.cpp \
     interfaceNormalizeProjection.cpp \
     interfaceLLEProjection.cpp \
-    projectorLLE.cpp
+    projectorLLE.cpp \
+    sparseCholesky.cpp \
+    projectorIsomap.cpp \
+    interfaceIsomapProjection.cpp
 
 #INCLUDEPATH += /opt/local/include
 #LIBS += -llapack -lblas
-HEADERS +=  isomap/fibheap.h \
-            isomap/isomap.h
-SOURCES +=  isomap/dijkstra.cpp \
-            isomap/isomap.cpp
+HEADERS +=  isomap/isomap.h
+SOURCES +=  isomap/isomap.cpp
 
 ###########################
 # Dependencies            #
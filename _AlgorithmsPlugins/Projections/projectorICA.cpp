@@ -1,11 +1,13 @@
 #include "projectorICA.h"
 #include <JnS/JnS.h>
 #include <JnS/Matutil.h>
+#include <random>
 
 using namespace std;
+using namespace Eigen;
 
 ProjectorICA::ProjectorICA(int method)
-    : Transf(0), method(method)
+    : Transf(0), method(method), maxIterations(200), tolerance(1e-6)
 {
 }
 
@@ -14,6 +16,121 @@ ProjectorICA::~ProjectorICA()
     KILL(Transf);
 }
 
+// samples processed by each thread at a time in the reductions over the dataset
+#define ICA_BLOCK 1024
+
+// mean and covariance of the samples, in a single pass shared among the threads
+static void streamingMoments(const std::vector<fvec> &samples, VectorXd &mean, MatrixXd &covariance)
+{
+    int count = samples.size();
+    int dim = samples[0].size();
+    // the sums are computed around the first sample, which keeps them well conditioned
+    VectorXd shift(dim);
+    FOR(d, dim) shift[d] = samples[0][d];
+    VectorXd sum = VectorXd::Zero(dim);
+    MatrixXd sumSq = MatrixXd::Zero(dim, dim);
+    int blockCount = (count + ICA_BLOCK - 1) / ICA_BLOCK;
+#pragma omp parallel
+    {
+        VectorXd localSum = VectorXd::Zero(dim);
+        MatrixXd localSq = MatrixXd::Zero(dim, dim);
+        MatrixXd X(dim, ICA_BLOCK);
+#pragma omp for schedule(static)
+        for(int b=0; b<blockCount; b++)
+        {
+            int start = b*ICA_BLOCK;
+            int length = min(count - start, ICA_BLOCK);
+            FOR(i, length) FOR(d, dim) X(d,i) = samples[start+i][d] - shift[d];
+            localSum += X.leftCols(length).rowwise().sum();
+            localSq.noalias() += X.leftCols(length) * X.leftCols(length).transpose();
+        }
+#pragma omp critical
+        {
+            sum += localSum;
+            sumSq += localSq;
+        }
+    }
+    mean = sum / count;
+    covariance = sumSq / count - mean*mean.transpose();
+    mean += shift;
+}
+
+// symmetric decorrelation: W = (W W^T)^-1/2 W
+static MatrixXd decorrelate(const MatrixXd &W)
+{
+    SelfAdjointEigenSolver<MatrixXd> eig(W*W.transpose());
+    VectorXd values = eig.eigenvalues();
+    FOR(i, values.size()) values[i] = 1. / sqrt(max(values[i], 1e-12));
+    return eig.eigenvectors() * values.asDiagonal() * eig.eigenvectors().transpose() * W;
+}
+
+MatrixXd ProjectorICA::FastICA(const std::vector<fvec> &samples, const VectorXd &mean, const MatrixXd &covariance)
+{
+    int count = samples.size();
+    int dim = mean.size();
+
+    // whitening matrix V = D^-1/2 E^T
+    SelfAdjointEigenSolver<MatrixXd> eig(covariance);
+    VectorXd scale = eig.eigenvalues();
+    double maxEigen = scale.maxCoeff();
+    FOR(d, dim) scale[d] = 1. / sqrt(max(scale[d], maxEigen*1e-12 + 1e-300));
+    MatrixXd V = scale.asDiagonal() * eig.eigenvectors().transpose();
+
+    // random orthogonal initialization, always the same one
+    std::mt19937 generator(1);
+    std::normal_distribution<double> normal;
+    MatrixXd W(dim, dim);
+    FOR(i, dim) FOR(j, dim) W(i,j) = normal(generator);
+    W = decorrelate(W);
+
+    // fixed-point iterations with g = tanh, on all components at once. The samples are only
+    // centered on the fly: with U = W V, the components of a sample are U (x - mean)
+    int blockCount = (count + ICA_BLOCK - 1) / ICA_BLOCK;
+    FOR(iteration, maxIterations)
+    {
+        MatrixXd U = W * V;
+        MatrixXd GX = MatrixXd::Zero(dim, dim);
+        VectorXd dG = VectorXd::Zero(dim);
+#pragma omp parallel
+        {
+            MatrixXd localGX = MatrixXd::Zero(dim, dim);
+            VectorXd localDG = VectorXd::Zero(dim);
+            MatrixXd X(dim, ICA_BLOCK), Y(dim, ICA_BLOCK);
+#pragma omp for schedule(static)
+            for(int b=0; b<blockCount; b++)
+            {
+                // a whole block of samples goes through each product
+                int start = b*ICA_BLOCK;
+                int length = min(count - start, ICA_BLOCK);
+                FOR(i, length) FOR(d, dim) X(d,i) = samples[start+i][d] - mean[d];
+                Y.leftCols(length).noalias() = U * X.leftCols(length);
+                FOR(i, length) FOR(d, dim)
+                {
+                    double g = tanh(Y(d,i));
+                    Y(d,i) = g;
+                    localDG[d] += 1. - g*g;
+                }
+                localGX.noalias() += Y.leftCols(length) * X.leftCols(length).transpose();
+            }
+#pragma omp critical
+            {
+                GX += localGX;
+                dG += localDG;
+            }
+        }
+        // W+ = E{g(Wz) z^T} - diag(E{g'(Wz)}) W, with z = V (x - mean)
+        MatrixXd newW = (GX / count) * V.transpose() - (dG / count).asDiagonal() * W;
+        newW = decorrelate(newW);
+
+        // we stop when the directions do not change anymore (up to their sign)
+        double change = 0;
+        FOR(i, dim) change = max(change, 1. - fabs(newW.row(i).dot(W.row(i))));
+        W = newW;
+        if(change < tolerance) break;
+    }
+    return W * V;
+}
+
 void ProjectorICA::Train(std::vector<fvec> samples, ivec labels)
 {
     projected.clear();
@@ -21,12 +138,6 @@ void ProjectorICA::Train(std::vector<fvec> samples, ivec labels)
     if(!samples.size()) return;
     source = samples;
     dim = samples[0].size();
-    meanAll.resize(dim,0);
-    FOR(i, samples.size())
-    {
-        meanAll += samples[i];
-    }
-    meanAll /= samples.size();
 
     const int nbsensors = dim;
     const int nbsamples = samples.size();
@@ -35,6 +146,42 @@ void ProjectorICA::Train(std::vector<fvec> samples, ivec labels)
     {
         Transf = new double[nbsensors*nbsensors];
     }
+
+    if(method == 2)
+    {
+        // FastICA never builds a copy of the data, it streams through the samples
+        VectorXd mean;
+        MatrixXd covariance;
+        streamingMoments(samples, mean, covariance);
+        meanAll.resize(dim);
+        FOR(d, dim) meanAll[d] = mean[d];
+        MatrixXd B = FastICA(samples, mean, covariance);
+        // same (column-major) layout as the separating matrices of JnS
+        FOR(i, nbsensors) FOR(j, nbsensors) Transf[i + j*nbsensors] = B(i,j);
+
+        projected = vector<fvec>(samples.size());
+#pragma omp parallel for schedule(static)
+        for(int i=0; i<nbsamples; i++)
+        {
+            projected[i].resize(dim);
+            FOR(d, dim)
+            {
+                double value = 0;
+                FOR(d1, dim) value += B(d,d1) * (samples[i][d1] - mean[d1]);
+                projected[i][d] = value * 0.25f;
+            }
+        }
+        FOR(i,nbsensors*nbsensors) Transf[i] /= 10;
+        return;
+    }
+
+    meanAll.resize(dim,0);
+    FOR(i, samples.size())
+    {
+        meanAll += samples[i];
+    }
+    meanAll /= samples.size();
+
     double *Data, *Mixing;
     Data = new double[nbsensors*nbsamples];
     Mixing = new double[nbsensors*nbsensors];
@@ -83,7 +230,7 @@ fvec ProjectorICA::Project(const fvec &sample)
     if(!dim) return sample;
     double *X = new double[dim];
     FOR(d, dim) X[d] = sample[d];
-    Transform(X, Transf, dim, 1);
+    ::Transform(X, Transf, dim, 1);
     fvec newSample(dim);
     FOR(d, dim) newSample[d] = X[d];
     delete [] X;
@@ -4,14 +4,20 @@
 #include <public.h>
 #include <mymaths.h>
 #include <projector.h>
+#include <Eigen/Core>
+#include <Eigen/Eigen>
 
 class ProjectorICA : public Projector
 {
 private:
     fvec meanAll;
     double* Transf;
+    // separating matrix for the centered samples (FastICA)
+    Eigen::MatrixXd FastICA(const std::vector<fvec> &samples, const Eigen::VectorXd &mean, const Eigen::MatrixXd &covariance);
 public:
-    int method;
+    int method; // 0: Jade, 1: Shibbs, 2: FastICA
+    int maxIterations;
+    double tolerance;
     ProjectorICA(int method=0);
     ~ProjectorICA();
 
@@ -0,0 +1,56 @@
+#include "projectorIsomap.h"
+#include "isomap/isomap.h"
+#include <mymaths.h>
+
+using namespace std;
+
+ProjectorIsomap::ProjectorIsomap()
+    : num_dims(2), knn(12), landmarks(0)
+{}
+
+void ProjectorIsomap::Train(std::vector< fvec > samples, ivec labels)
+{
+    projected.clear();
+    source.clear();
+    if(!samples.size()) return;
+    source = samples;
+    dim = samples[0].size();
+    int N = samples.size();
+    // run_isomap counts each point as its own first neighbour
+    int K = min(knn+1, N);
+    if(K < 2) return;
+
+    float *X = new float[N*dim];
+    float *Y = new float[N*num_dims];
+    FOR(i, N) FOR(d, dim) X[i*dim + d] = samples[i][d];
+
+    run_isomap(X, N, dim, Y, num_dims, K, landmarks);
+
+    // points outside of the largest connected component of the neighbourhood graph come back as NaN
+    projected.resize(N);
+    FOR(i, N)
+    {
+        projected[i].resize(num_dims);
+        FOR(d, num_dims) projected[i][d] = Y[i*num_dims + d] == Y[i*num_dims + d] ? Y[i*num_dims + d] : 0;
+    }
+    delete [] X;
+    delete [] Y;
+}
+
+fvec ProjectorIsomap::Project(const fvec &sample)
+{
+    // same as sammon: we return the projection of the closest source point
+    int closest = 0;
+    float minDist = FLT_MAX;
+    FOR(i, source.size())
+    {
+        float dist = (source[i]-sample)*(source[i]-sample);
+        if(dist < minDist)
+        {
+            minDist = dist;
+            closest = i;
+        }
+    }
+    if(closest >= projected.size()) return fvec (num_dims, 0);
+    else return projected[closest];
+}
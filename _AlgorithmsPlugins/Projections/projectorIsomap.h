@@ -0,0 +1,22 @@
+#ifndef PROJECTORISOMAP_H
+#define PROJECTORISOMAP_H
+
+#include <public.h>
+#include <mymaths.h>
+#include <projector.h>
+
+class ProjectorIsomap : public Projector
+{
+public:
+    int num_dims;
+    int knn;
+    int landmarks; // 0 uses the geodesics between all points
+
+    ProjectorIsomap();
+
+    void Train(std::vector< fvec > samples, ivec labels);
+    fvec Project(const fvec &sample);
+    const char *GetInfoString(){return "Isomap";}
+};
+
+#endif // PROJECTORISOMAP_H
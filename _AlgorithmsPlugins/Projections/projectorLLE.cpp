@@ -21,6 +21,7 @@ Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
 #include "projectorLLE.h"
 #include <QDebug>
 #include <assert.h>
+#include <random>
 
 using namespace std;
 using namespace Eigen;
@@ -36,97 +37,225 @@ ProjectorLLE::~ProjectorLLE()
     if (dataPts != 0) annDeallocPts(dataPts);
 }
 
-void ProjectorLLE::computeReconstructionWeights(MatrixXd &W, MatrixXd &p)
+void ProjectorLLE::computeReconstructionWeights(SparseMatrixXd &W, MatrixXd &p)
 {
-    ANNidxArray nnIdxQ = new ANNidx[knn+1]; // allocate near neighbour indices
-    ANNidxArray nnIdx = new ANNidx[knn];
-    ANNdistArray dists = new ANNdist[knn+1]; // allocate near neighbour dists
-
-    assert(W.cols() == data.cols() && W.rows() == p.cols());
     assert(p.rows() == dim);
+    int count = p.cols();
 
-    W.setZero();
-    MatrixXd nn(dim, knn);
-
-    ANNpoint queryPt; // query point
-    queryPt = annAllocPt(dim); // allocate query point
     qDebug() << "LLE: Computing reconstruction weights .. hold on";
-    FOR(i, p.cols())
-    {        
-        //qDebug() << endl << i << ": ";
-        //
-        // compute the k-nearest neighbours of i in the data
-        //
+    //
+    // compute the k-nearest neighbours of each point in the data
+    // (the ANN search relies on global variables, the queries can't be run concurrently)
+    //
+    ivec neighbours(count*knn);
+    ANNidxArray nnIdxQ = new ANNidx[knn+1]; // allocate near neighbour indices
+    ANNdistArray dists = new ANNdist[knn+1]; // allocate near neighbour dists
+    ANNpoint queryPt = annAllocPt(dim); // query point
+    FOR(i, count)
+    {
         double eps = 0; // error bound
         FOR(j, dim) queryPt[j] = p(j,i);
         kdTree->annkSearch(queryPt, knn+1, nnIdxQ, dists, eps);
-        FOR(j, knn) nnIdx[j] = nnIdxQ[j+1];  // skip the first one, as it is same as the query point.
+        FOR(j, knn) neighbours[i*knn + j] = nnIdxQ[j+1];  // skip the first one, as it is same as the query point.
+    }
+    annDeallocPt(queryPt);
+    delete [] nnIdxQ;
+    delete [] dists;
 
-        // collect the k-nn centered on the query point
-        nn.setZero();
-        FOR(j, knn)
+    //
+    // find the weights that minimize the rss of reconstructing i from linear combination its k-nn
+    // each point is independent, every thread gets its own buffers
+    //
+    MatrixXd weights(knn, count);
+    // regularization on w in case C is singular. This will happen if knn > #input dimensions
+    double tol = (knn>dim) ? 0.001 : 0;
+#pragma omp parallel
+    {
+        MatrixXd nn(dim, knn), G(knn, knn);
+        VectorXd w(knn), b = VectorXd::Ones(knn);
+#pragma omp for schedule(dynamic, 64)
+        for(int i=0; i<count; i++)
         {
-            //qDebug() << nnIdx[j] << " ";
-            FOR(k, dim) nn(k,j) = data(k,nnIdx[j]) - p(k,i);
+            // collect the k-nn centered on the query point
+            FOR(j, knn) nn.col(j) = data.col(neighbours[i*knn + j]) - p.col(i);
+            G = nn.transpose() * nn;
+            G += MatrixXd::Identity(knn, knn)*tol*G.trace();
+            w = G.lu().solve(b);
+            weights.col(i) = w/w.sum();
         }
+    }
 
-        //
-        // find the weights that minimize the rss of reconstructing i from linear combination its k-nn
-        //
-        MatrixXd G = nn.transpose() * nn;
-        MatrixXd eye = MatrixXd::Identity(knn, knn);
-        // regularization on w in case C is singular. This will happen if knn > #input dimensions
-        double tol;
-        tol = (knn>dim) ? 0.001 : 0;
-        G = G + eye*tol*G.trace();
-
-        MatrixXd w = MatrixXd::Zero(knn, 1);
-        MatrixXd b = MatrixXd::Ones(knn, 1);
-        w = G.lu().solve(b);
-        w = w/w.sum();
-
-        // record the weights
-        FOR(j, knn) W(i, nnIdx[j]) = w(j,0);
+    // record the weights, the sparse matrix is filled row by row with increasing column indices
+    W.resize(count, count);
+    W.reserve(count*knn);
+    std::vector< std::pair<int,double> > row(knn);
+    FOR(i, count)
+    {
+        FOR(j, knn) row[j] = std::make_pair(neighbours[i*knn + j], weights(j,i));
+        std::sort(row.begin(), row.end());
+        W.startVec(i);
+        FOR(j, knn)
+        {
+            if(j && row[j].first == row[j-1].first) continue; // duplicate neighbours
+            W.insertBack(i, row[j].first) = row[j].second;
+        }
     }
+    W.finalize();
     qDebug() << "done";
+}
 
-    annDeallocPt(queryPt);
-    delete [] nnIdx;
-    delete [] nnIdxQ;
-    delete [] dists;
+// Y = A*X, one row of Y per row of A
+static void sparseProduct(const SparseMatrixXd &A, const MatrixXd &X, MatrixXd &Y)
+{
+    int rows = A.rows();
+    Y.setZero(rows, X.cols());
+#pragma omp parallel for schedule(dynamic, 256)
+    for(int i=0; i<rows; i++)
+    {
+        for(SparseMatrixXd::InnerIterator it(A, i); it; ++it) Y.row(i) += it.value()*X.row(it.col());
+    }
 }
 
-void ProjectorLLE::computeEmbedding(MatrixXd& W, MatrixXd& Y)
+// orthonormalizes the columns of S, dropping the directions that are linearly dependent
+static void orthonormalize(MatrixXd &S)
 {
-    assert(W.rows() == data.cols() && W.cols() == data.cols());
+    MatrixXd G = S.transpose()*S;
+    VectorXd scale = G.diagonal();
+    FOR(i, scale.rows()) scale(i) = scale(i) > 1e-300 ? 1./sqrt(scale(i)) : 1.;
+    G = scale.asDiagonal()*G*scale.asDiagonal();
+    SelfAdjointEigenSolver<MatrixXd> eig(G);
+    VectorXd lambda = eig.eigenvalues();
+    double threshold = lambda(lambda.rows()-1)*1e-12;
+    int first = 0;
+    while(first < lambda.rows()-1 && lambda(first) <= threshold) first++;
+    int kept = lambda.rows() - first;
+    VectorXd invSqrt = lambda.tail(kept).cwiseSqrt().cwiseInverse();
+    MatrixXd C = scale.asDiagonal()*eig.eigenvectors().rightCols(kept)*invSqrt.asDiagonal();
+    S = S*C;
+}
+
+bool ProjectorLLE::bottomEigenvectors(const SparseMatrixXd &M, int count, VectorXd &values, MatrixXd &vectors)
+{
+    // As the rows of W sum to one, the constant vector is in the null space of M:
+    // we look for the smallest eigenvectors in its orthogonal complement by
+    // shift-invert subspace iteration, with a sparse factorization of M
+    int n = M.rows();
+    int blockSize = min(n-1, count + 4); // a few extra vectors speed up the convergence
+    VectorXd e = VectorXd::Constant(n, 1./sqrt((double)n));
+
+    double normM = 0;
+    FOR(i, n) normM = max(normM, (double)M.coeff(i,i));
+
+    // the shift only needs to make the factorization definite, the closer to zero the faster we converge
+    ivec ordering = SparseCholesky::NestedDissection(M, data);
+    SparseCholesky cholesky;
+    double shift = normM*1e-12;
+    bool factorized = false;
+    for(int attempt=0; attempt<6 && !factorized; attempt++)
+    {
+        SparseMatrixXd A = M;
+        FOR(i, n)
+        {
+            for(SparseMatrixXd::InnerIterator it(A, i); it; ++it) if(it.col() == i) it.valueRef() += shift;
+        }
+        factorized = cholesky.Compute(A, ordering);
+        shift *= 100;
+    }
+    if(!factorized) return false;
+
+    // deterministic starting block, so that successive runs give the same embedding,
+    // drawn from a local generator to leave the seed of rand() to the rest of the application
+    std::mt19937 generator(0);
+    std::uniform_real_distribution<double> uniform(-1., 1.);
+    MatrixXd X(n, blockSize), MX;
+    FOR(j, blockSize) FOR(i, n) X(i,j) = uniform(generator);
+    VectorXd lambda = VectorXd::Zero(blockSize);
+    const int maxIterations = 300;
+    FOR(iteration, maxIterations)
+    {
+        cholesky.Solve(X);
+        X -= e*(e.transpose()*X);
+        orthonormalize(X);
+        // Rayleigh-Ritz
+        sparseProduct(M, X, MX);
+        MatrixXd H = X.transpose()*MX;
+        H = (H + H.transpose())*0.5;
+        SelfAdjointEigenSolver<MatrixXd> eig(H);
+        X = X*eig.eigenvectors();
+        bool converged = iteration > 0;
+        FOR(j, count)
+        {
+            double change = fabs(eig.eigenvalues()(j) - lambda(j));
+            if(change > 1e-8*fabs(eig.eigenvalues()(j)) + 1e-14*normM) converged = false;
+        }
+        lambda = eig.eigenvalues();
+        if(converged) break;
+    }
+
+    values.resize(count+1);
+    vectors.resize(n, count+1);
+    values(0) = 0;
+    vectors.col(0) = e;
+    FOR(j, count)
+    {
+        values(j+1) = lambda(j);
+        vectors.col(j+1) = X.col(j);
+    }
+    return true;
+}
 
-    MatrixXd eye = MatrixXd::Identity(W.rows(), W.cols());
-    MatrixXd T(W.rows(), W.cols()), M(W.rows(), W.cols());
+void ProjectorLLE::computeEmbedding(SparseMatrixXd& W, MatrixXd& Y)
+{
+    assert(W.rows() == data.cols() && W.cols() == data.cols());
+    int count = W.rows();
 
-    T = eye-W;
-    M = T.transpose() * T;
+    // T = I - W
+    SparseMatrixXd T(count, count);
+    T.reserve(W.nonZeros() + count);
+    FOR(i, count)
+    {
+        T.startVec(i);
+        bool diagonal = false;
+        for(SparseMatrixXd::InnerIterator it(W, i); it; ++it)
+        {
+            if(!diagonal && it.col() >= i)
+            {
+                T.insertBack(i, i) = 1. - (it.col() == i ? it.value() : 0);
+                diagonal = true;
+                if(it.col() == i) continue;
+            }
+            T.insertBack(i, it.col()) = -it.value();
+        }
+        if(!diagonal) T.insertBack(i, i) = 1.;
+    }
+    T.finalize();
+    SparseMatrixXd Tt = T.transpose();
+    SparseMatrixXd M = Tt*T;
 
     qDebug() << "LLE: Finding eigen vectors .. hold on";
-    EigenSolver<MatrixXd> eigM(M);
-    qDebug() << "done";   
-    eigenvalues = eigM.eigenvalues().real();
-    eigenVectors = eigM.eigenvectors().real();
+    // small problems, or M too ill-conditioned to be factorized: we do the full decomposition of M
+    if(count <= 1000 || !bottomEigenvectors(M, targetDims, eigenvalues, eigenVectors))
+    {
+        SelfAdjointEigenSolver<MatrixXd> eigM(M.toDense());
+        eigenvalues = eigM.eigenvalues();
+        eigenVectors = eigM.eigenvectors();
+    }
+    qDebug() << "done";
 
-    // FOR(i, M.cols()) qDebug() << eigenvalues(i);
+    // FOR(i, eigenvalues.rows()) qDebug() << eigenvalues(i);
 
     // sort and get the permutation indices
     pi.clear();
-    for (int i = 0 ; i < M.cols(); i++)
+    for (int i = 0 ; i < eigenvalues.rows(); i++)
         pi.push_back(std::make_pair(eigenvalues(i), i));
 
     std::sort(pi.begin(), pi.end());
 
     // get bottom targetDims eigenvectors leaving out the smallest which corresponds to evec of all 1s.
     Y.setZero();
-    // FOR(j, M.cols()) qDebug() << eigenVectors(j, pi[0].second);
     for (unsigned int i = 1; i < targetDims+1; i++)
     {
-        Y.row(i-1) = eigenVectors.col(pi[i].second)*sqrt(M.cols());
+        Y.row(i-1) = eigenVectors.col(pi[i].second)*sqrt(count);
     }
 }
 
@@ -149,9 +278,11 @@ void ProjectorLLE::Train(std::vector< fvec > samples, ivec labels)
         FOR(d, dim) data(d,i) = samples[i][d];
     }
 
-    // initialize k-nearest neighbours structure
+    // initialize k-nearest neighbours structure (euclidean, ANN defaults to the L-inf norm)
     annClose();
     DEL(kdTree);    
+    ANN::MetricType = ANN_METRIC2;
+    ANN::MetricPower = 2;
     if (dataPts != NULL) annDeallocPts(dataPts);
     dataPts = annAllocPts(count, dim);			// allocate data points
     FOR(i, count)
@@ -161,7 +292,7 @@ void ProjectorLLE::Train(std::vector< fvec > samples, ivec labels)
     kdTree = new ANNkd_tree(dataPts, count, dim);
 
     // compute reconstruction weights
-    MatrixXd W(count, count);
+    SparseMatrixXd W(count, count);
     computeReconstructionWeights(W, data);
 
     // compute the embedding
@@ -24,6 +24,7 @@ Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
 #include "ANN/ANN.h"
 #include <Eigen/Core>
 #include <Eigen/Eigen>
+#include "sparseCholesky.h"
 
 typedef std::pair<double, int> myPair;
 typedef std::vector<myPair> PermutationIndices;
@@ -39,8 +40,12 @@ private:
     PermutationIndices pi;
 
 
-    void computeReconstructionWeights(Eigen::MatrixXd& W, Eigen::MatrixXd& points);
-    void computeEmbedding(Eigen::MatrixXd& W, Eigen::MatrixXd& Y);
+    // W holds knn non-zeros per row
+    void computeReconstructionWeights(SparseMatrixXd& W, Eigen::MatrixXd& points);
+    void computeEmbedding(SparseMatrixXd& W, Eigen::MatrixXd& Y);
+    // smallest eigenpairs of M = (I-W)^T (I-W), orthogonal to the constant vector.
+    // Returns false if M could not be factorized
+    bool bottomEigenvectors(const SparseMatrixXd& M, int count, Eigen::VectorXd& values, Eigen::MatrixXd& vectors);
 
 public:
     int targetDims;
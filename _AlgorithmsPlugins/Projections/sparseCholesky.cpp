@@ -0,0 +1,238 @@
+/*********************************************************************
+MLDemos: A User-Friendly visualization toolkit for machine learning
+Copyright (C) 2010  Basilio Noris
+Contact: mldemos@b4silio.com
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Library General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free
+Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*********************************************************************/
+#include <math.h>
+#include <algorithm>
+#include "sparseCholesky.h"
+
+using namespace std;
+using namespace Eigen;
+
+// nonzero pattern of row k of L (without the diagonal), in topological order in s[top..n-1]
+// C holds the upper triangle of the permuted matrix, column by column
+static int ereach(const int k, const ivec &Cp, const ivec &Ci, const ivec &parent, ivec &s, ivec &marker)
+{
+    int n = parent.size();
+    int top = n;
+    marker[k] = k;
+    for(int p=Cp[k]; p<Cp[k+1]; p++)
+    {
+        int i = Ci[p];
+        if(i > k) continue;
+        int len = 0;
+        // we climb the elimination tree until we reach a node we have already seen
+        for(; marker[i] != k; i = parent[i])
+        {
+            s[len++] = i;
+            marker[i] = k;
+        }
+        while(len > 0) s[--top] = s[--len];
+    }
+    return top;
+}
+
+bool SparseCholesky::Compute(const SparseMatrixXd &A, const ivec &ordering)
+{
+    n = A.rows();
+    this->ordering = ordering;
+    if(this->ordering.size() != n)
+    {
+        this->ordering.resize(n);
+        FOR(i, n) this->ordering[i] = i;
+    }
+    ivec inverse(n);
+    FOR(i, n) inverse[this->ordering[i]] = i;
+
+    // upper triangle of P A P^T, column by column (A is symmetric, its rows are its columns)
+    ivec Cp(n+1, 0), Ci;
+    std::vector<double> Cx;
+    Ci.reserve(A.nonZeros()/2 + n);
+    Cx.reserve(A.nonZeros()/2 + n);
+    FOR(k, n)
+    {
+        Cp[k] = Ci.size();
+        for(SparseMatrixXd::InnerIterator it(A, this->ordering[k]); it; ++it)
+        {
+            int i = inverse[it.col()];
+            if(i > k) continue;
+            Ci.push_back(i);
+            Cx.push_back(it.value());
+        }
+    }
+    Cp[n] = Ci.size();
+
+    // elimination tree
+    ivec parent(n, -1), ancestor(n, -1);
+    FOR(k, n)
+    {
+        for(int p=Cp[k]; p<Cp[k+1]; p++)
+        {
+            int i = Ci[p];
+            while(i != -1 && i < k)
+            {
+                int next = ancestor[i];
+                ancestor[i] = k;
+                if(next == -1) parent[i] = k;
+                i = next;
+            }
+        }
+    }
+
+    // column counts, obtained from the pattern of each row of L
+    ivec s(n), marker(n, -1), counts(n, 1);
+    FOR(k, n)
+    {
+        for(int top = ereach(k, Cp, Ci, parent, s, marker); top < n; top++) counts[s[top]]++;
+    }
+    colStart.resize(n+1);
+    colStart[0] = 0;
+    FOR(k, n) colStart[k+1] = colStart[k] + counts[k];
+    rowIndex.resize(colStart[n]);
+    values.resize(colStart[n]);
+
+    // numerical factorization, one row of L at a time. The diagonal is the first element of each column
+    ivec next(colStart.begin(), colStart.end()-1);
+    std::vector<double> x(n, 0.);
+    FOR(i, n) marker[i] = -1;
+    FOR(k, n)
+    {
+        int top = ereach(k, Cp, Ci, parent, s, marker);
+        x[k] = 0;
+        for(int p=Cp[k]; p<Cp[k+1]; p++) x[Ci[p]] += Cx[p];
+        double d = x[k];
+        x[k] = 0;
+        for(; top < n; top++)
+        {
+            int i = s[top];
+            double lki = x[i] / values[colStart[i]];
+            x[i] = 0;
+            for(int p=colStart[i]+1; p<next[i]; p++) x[rowIndex[p]] -= values[p]*lki;
+            d -= lki*lki;
+            int p = next[i]++;
+            rowIndex[p] = k;
+            values[p] = lki;
+        }
+        if(d <= 0) return false;
+        int p = next[k]++;
+        rowIndex[p] = k;
+        values[p] = sqrt(d);
+    }
+    return true;
+}
+
+void SparseCholesky::Solve(double *x) const
+{
+    std::vector<double> y(n);
+    FOR(k, n) y[k] = x[ordering[k]];
+    // L y = b
+    FOR(j, n)
+    {
+        y[j] /= values[colStart[j]];
+        for(int p=colStart[j]+1; p<colStart[j+1]; p++) y[rowIndex[p]] -= values[p]*y[j];
+    }
+    // L^T x = y
+    for(int j=n-1; j>=0; j--)
+    {
+        for(int p=colStart[j]+1; p<colStart[j+1]; p++) y[j] -= values[p]*y[rowIndex[p]];
+        y[j] /= values[colStart[j]];
+    }
+    FOR(k, n) x[ordering[k]] = y[k];
+}
+
+void SparseCholesky::Solve(MatrixXd &X) const
+{
+    int cols = X.cols();
+#pragma omp parallel for
+    for(int c=0; c<cols; c++) Solve(X.col(c).data());
+}
+
+struct CoordinateCompare
+{
+    const MatrixXd &coords;
+    int d;
+    CoordinateCompare(const MatrixXd &coords, int d) : coords(coords), d(d){}
+    bool operator()(const int a, const int b) const {return coords(d,a) < coords(d,b);}
+};
+
+static void dissect(const SparseMatrixXd &A, const MatrixXd &coords, ivec &nodes, ivec &side, ivec &stamp, int &calls, const int leafSize, ivec &order)
+{
+    int count = nodes.size();
+    if(!count) return;
+    // we split the nodes in two halves along the dimension with the largest spread
+    int dim = coords.rows();
+    int splitDim = 0;
+    double maxSpread = 0;
+    FOR(d, dim)
+    {
+        double minVal = coords(d,nodes[0]), maxVal = minVal;
+        FOR(i, count)
+        {
+            minVal = min(minVal, coords(d,nodes[i]));
+            maxVal = max(maxVal, coords(d,nodes[i]));
+        }
+        if(maxVal - minVal > maxSpread)
+        {
+            maxSpread = maxVal - minVal;
+            splitDim = d;
+        }
+    }
+    if(count <= leafSize || maxSpread == 0)
+    {
+        order.insert(order.end(), nodes.begin(), nodes.end());
+        return;
+    }
+    int half = count/2;
+    nth_element(nodes.begin(), nodes.begin()+half, nodes.end(), CoordinateCompare(coords, splitDim));
+
+    // the nodes of the first half connected to the second one form the separator, eliminated last
+    int call = ++calls;
+    FOR(i, count)
+    {
+        stamp[nodes[i]] = call;
+        side[nodes[i]] = i < half ? 0 : 1;
+    }
+    ivec left, separator;
+    FOR(i, half)
+    {
+        bool boundary = false;
+        for(SparseMatrixXd::InnerIterator it(A, nodes[i]); it && !boundary; ++it)
+        {
+            boundary = stamp[it.col()] == call && side[it.col()] == 1;
+        }
+        if(boundary) separator.push_back(nodes[i]);
+        else left.push_back(nodes[i]);
+    }
+    ivec right(nodes.begin()+half, nodes.end());
+    ivec().swap(nodes);
+    dissect(A, coords, left, side, stamp, calls, leafSize, order);
+    dissect(A, coords, right, side, stamp, calls, leafSize, order);
+    order.insert(order.end(), separator.begin(), separator.end());
+}
+
+ivec SparseCholesky::NestedDissection(const SparseMatrixXd &A, const MatrixXd &coords, const int leafSize)
+{
+    int n = A.rows();
+    ivec order, nodes(n), side(n, 0), stamp(n, 0);
+    if(!n) return order;
+    order.reserve(n);
+    FOR(i, n) nodes[i] = i;
+    int calls = 0;
+    dissect(A, coords, nodes, side, stamp, calls, max(1, leafSize), order);
+    return order;
+}
@@ -0,0 +1,54 @@
+/*********************************************************************
+MLDemos: A User-Friendly visualization toolkit for machine learning
+Copyright (C) 2010  Basilio Noris
+Contact: mldemos@b4silio.com
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public License,
+version 3 as published by the Free Software Foundation.
+
+This library is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free
+Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*********************************************************************/
+#ifndef _SPARSE_CHOLESKY_H_
+#define _SPARSE_CHOLESKY_H_
+
+#include <vector>
+#include <types.h>
+#include <Eigen/Core>
+#define EIGEN_YES_I_KNOW_SPARSE_MODULE_IS_NOT_STABLE_YET
+#include <Eigen/Sparse>
+
+typedef Eigen::SparseMatrix<double, Eigen::RowMajor> SparseMatrixXd;
+
+// sparse LL^T factorization of a symmetric positive definite matrix (up-looking, as in CSparse)
+class SparseCholesky
+{
+public:
+    SparseCholesky() : n(0) {}
+    // A must contain both triangles. ordering[k] is the row of A that becomes the k-th pivot
+    // (empty for the natural ordering). Returns false if A is not positive definite
+    bool Compute(const SparseMatrixXd &A, const ivec &ordering = ivec());
+    // solves A x = b, in place
+    void Solve(double *x) const;
+    // solves for each column of X, concurrently
+    void Solve(Eigen::MatrixXd &X) const;
+    int NonZeros() const {return values.size();}
+
+    // fill-reducing ordering of A, obtained by recursive bisection of the points (one per column of coords)
+    static ivec NestedDissection(const SparseMatrixXd &A, const Eigen::MatrixXd &coords, const int leafSize = 64);
+
+private:
+    int n;
+    ivec ordering;
+    ivec colStart, rowIndex;
+    std::vector<double> values;
+};
+
+#endif // _SPARSE_CHOLESKY_H_
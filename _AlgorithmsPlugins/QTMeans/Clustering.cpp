@@ -1,160 +1,181 @@
 #include "Clustering.h"
+#include "spatialHash.h"
 #include <limits>
-#include <boost/foreach.hpp>
-#include <map>
+#include <iostream>
 using namespace std;
 namespace AG
 {
 namespace Clustering{
 
-Vect operator+ (Vect &a, Vect &b)
+// Candidate cluster grown around a seed: the samples are tested in index order and
+// a sample joins if the bounding box of the cluster stays within the maximum diameter
+// along every dimension. A sample that was rejected can't lie inside the final box
+// (the box only grows), so the members are exactly the free samples inside the box.
+struct Candidate
 {
-	Vect c = a;
-	for (int i=0; i<c.size(); i++) c[i] += b[i];
-	return c;
-}
+	int count;
+	std::vector<double> limits; // lower and upper bound along each dimension
+};
 
-void operator+= (Vect &a, const Vect b)
+// samples stored contiguously, and indexed on the two dimensions with the largest spread
+struct QTIndex
 {
-	for(int i=0; i<a.size(); i++) a[i] += b[i];
-}
+	int count, dim;
+	std::vector<double> points;
+	SpatialHash hash;
+	int hx, hy;
+	const double *point(const int i) const {return &points[i*dim];}
+	// free samples whose projection is inside the box (enlarged by margin), sorted by index
+	ivec Query(const double *limits, const double margin) const
+	{
+		// the hash works in single precision, we make sure the rounding does not drop any sample
+		double extra = margin*1e-4 + 1e-6;
+		float y0 = hy >= 0 ? limits[2*hy] - margin - extra : -1.f;
+		float y1 = hy >= 0 ? limits[2*hy+1] + margin + extra : 1.f;
+		return hash.QueryRect(limits[2*hx] - margin - extra, y0, limits[2*hx+1] + margin + extra, y1);
+	}
+};
 
-void operator *= (Vect &a, const float b)
+static bool inside(const double *x, const double *limits, const int dim)
 {
-	for(int i=0; i<a.size(); i++) a[i] *= b;
+	for (int d=0; d < dim; d++)
+	{
+		if(x[d] < limits[2*d] || x[d] > limits[2*d+1]) return false;
+	}
+	return true;
 }
 
-void operator /= (Vect &a, const float b)
+static bool overlaps(const double *a, const double *b, const int dim)
 {
-	for(int i=0; i<a.size(); i++) a[i] /= b;
+	for (int d=0; d < dim; d++)
+	{
+		if(a[2*d+1] < b[2*d] || b[2*d+1] < a[2*d]) return false;
+	}
+	return true;
 }
 
-bool diameterInf(Vect x, double maxDist, double *limits)
+static void growCandidate(const int seed, const QTIndex &index, const std::vector<char> &taken, double maxDist, Candidate &candidate)
 {
-	int dim = x.size();
-	double *newLimits = new double[dim*2];
-	memcpy(newLimits, limits, sizeof(double)*dim*2);
+	int dim = index.dim;
+	const double *s = index.point(seed);
+	double *limits = &candidate.limits[0];
+	for (int d=0; d < dim; d++) limits[2*d] = limits[2*d+1] = s[d];
+	candidate.count = 1;
 
-	bool bInside = true;
-	for (int d=0; d < dim; d++)
+	// all the members are within maxDist of the seed along every dimension
+	ivec neighbors = index.Query(limits, maxDist);
+	for (int i=0; i<(int)neighbors.size(); i++)
 	{
-		double dLow = limits[2*d];
-		double dHigh = limits[2*d+1];
-		if(dLow > x[d] || dHigh < x[d])
+		int j = neighbors[i];
+		if(j == seed || taken[j]) continue;
+		const double *x = index.point(j);
+		bool bOk = true;
+		for (int d=0; d < dim && bOk; d++)
 		{
-			bInside = false;
-			break;
+			bOk = max(x[d], limits[2*d+1]) - min(x[d], limits[2*d]) <= maxDist;
 		}
-	}
-	if(bInside) return true;
-
-	bool bOk = true;
-	for (int d=0; d < dim; d++)
-	{
-		double xd = x[d];
-		double dLow = min(xd, limits[d*2]);
-		double dHigh = max(xd, limits[d*2+1]);
-		if(dHigh - dLow > maxDist)
+		if(!bOk) continue;
+		for (int d=0; d < dim; d++)
 		{
-			bOk = false;
-			break;
+			limits[2*d] = min(x[d], limits[2*d]);
+			limits[2*d+1] = max(x[d], limits[2*d+1]);
 		}
-		newLimits[2*d] = dLow;
-		newLimits[2*d+1] = dHigh;
+		candidate.count++;
 	}
-
-	if(bOk) memcpy(limits, newLimits, sizeof(double)*dim*2);
-	delete [] newLimits;
-	return bOk;
 }
 
-bool diameter2(Vect x, double maxDist, std::vector<Vect> clust, Vect sum, int count)
+Clusters qt_clustering(const VectorSpace & vs, double max_diameter, int minCount)
 {
-	int dim = x.size();
-	maxDist = maxDist*maxDist;
-	// we keep the center of the cluster
-	Vect center = sum + x;
-	center /= count + 1;
-
-	double dist = 0;
-	for (int d=0; d < dim; d++) dist += (x[d]-center[d])*(x[d]-center[d]);
-	if(dist > maxDist) return false;
+	Clusters clusters(vs.size(), std::numeric_limits<index>::max());  // assign all the vectors to no cluster
+	int count = vs.size();
+	if(!count) return clusters;
+	int dim = vs[0].size();
 
-	for (int i=0; i<clust.size(); i++)
+	// Vect is a sparse vector, we make a dense copy of the samples
+	QTIndex index;
+	index.count = count;
+	index.dim = dim;
+	index.points.resize(count*dim);
+	for (int i=0; i<count; i++)
 	{
-		double dist = 0;
-		for (int d=0; d<dim; d++) dist += (clust[i][d]-center[d])*(clust[i][d]-center[d]);
-		if(dist > maxDist) return false;
+		for (int d=0; d<dim; d++) index.points[i*dim + d] = vs[i][d];
+	}
+	fvec spread(dim, 0.f);
+	for (int d=0; d<dim; d++)
+	{
+		double minVal = index.points[d], maxVal = minVal;
+		for (int i=0; i<count; i++)
+		{
+			minVal = min(minVal, index.points[i*dim + d]);
+			maxVal = max(maxVal, index.points[i*dim + d]);
+		}
+		spread[d] = maxVal - minVal;
+	}
+	index.hx = 0;
+	index.hy = dim > 1 ? 1 : -1;
+	for (int d=0; d<dim; d++)
+	{
+		if(spread[d] > spread[index.hx]) index.hx = d;
+	}
+	for (int d=0; d<dim; d++)
+	{
+		if(d == index.hx) continue;
+		if(index.hy == index.hx || spread[d] > spread[index.hy]) index.hy = d;
+	}
+	// the candidates of a seed are found within the 3x3 cells around it
+	float maxSpread = dim ? spread[index.hx] : 0.f;
+	index.hash.SetCellSize(max((float)max_diameter, maxSpread*1e-4f + 1e-6f));
+	for (int i=0; i<count; i++)
+	{
+		const double *x = index.point(i);
+		index.hash.Insert(i, x[index.hx], index.hy >= 0 ? x[index.hy] : 0.f);
 	}
-	return true;
-}
 
-Clusters qt_clustering(VectorSpace & vs, double max_diameter, int minCount)
-{
-	Clusters clusters(vs.size(), std::numeric_limits<index>::max());  // assign all the vectors to no cluster
+	// candidates of all the free seeds, ranked by size (and by index, for ties)
+	std::vector<char> taken(count, 0);
+	std::vector<Candidate> candidates(count);
+	std::set< std::pair<int,int> > ranking;
+	for (int i=0; i<count; i++) candidates[i].limits.resize(dim*2);
+#pragma omp parallel for schedule(dynamic, 16)
+	for (int i=0; i<count; i++) growCandidate(i, index, taken, max_diameter, candidates[i]);
+	for (int i=0; i<count; i++) ranking.insert(std::make_pair(-candidates[i].count, i));
+
 	int assignedCount = 0;
 	int clusterId = 0;
-	int count = vs.size();
-	int dim = vs[0].size();
-	while(assignedCount < vs.size())
+	while(assignedCount < count && !ranking.empty())
 	{
-		std::vector < std::vector<Vect> > clusts;
-		std::vector < std::vector<int> > clustsIdx;
-		clusts.resize(vs.size());
-		clustsIdx.resize(vs.size());
-		double *limits = new double[dim*2];
-		int skipped = 0;
-		int docId_i = 0;
-		BOOST_FOREACH(Vect d_i, vs)         // foreach document
-		{
-			if (clusters[docId_i] != std::numeric_limits<index>::max())
-			{
-				skipped++;
-				docId_i++;
-				continue; // sample taken already
-			}
-			for(int d=0; d<dim; d++)
-			{
-				limits[2*d] = d_i[d];
-				limits[2*d+1] = d_i[d];
-			}
-			std::vector<Vect> &clust = clusts[docId_i];
-			std::vector<int> &clustIdx = clustsIdx[docId_i];
-			clust.push_back(d_i);
-			clustIdx.push_back(docId_i);
-
-			for(index docId_j = 0; docId_j < vs.size(); docId_j++)
-			{
-				if(docId_j == docId_i) continue;
-				if (clusters[docId_j] != std::numeric_limits<index>::max()) continue; // sample taken already
-				if(diameterInf(vs[docId_j], max_diameter, limits))
-				{
-					clust.push_back(vs[docId_j]);
-					clustIdx.push_back(docId_j);
-				}
-			}
-			docId_i++;
-		} // foreach document
-		delete [] limits;
 		// find the cluster with the maximum count
-		int maxIndex = 0, maxCnt = 0;
-		for(int i=0; i<clustsIdx.size(); i++)
-		{
-			if(maxCnt < clustsIdx[i].size())
-			{
-				maxIndex = i;
-				maxCnt = clustsIdx[i].size();
-			}
-		}
+		int maxIndex = ranking.begin()->second;
+		int maxCnt = -ranking.begin()->first;
 		std::cout << "maximum cluster: " << maxIndex << " with " << maxCnt << " samples"<< std::endl;
 		if(maxCnt < minCount) break;
-		for(int i=0; i<clustsIdx[maxIndex].size(); i++)
+		std::vector<double> limits = candidates[maxIndex].limits;
+		ivec members = index.Query(&limits[0], 0);
+		for (int i=0; i<(int)members.size(); i++)
 		{
-			int index = clustsIdx[maxIndex][i];
-			clusters[index] = clusterId;
+			int j = members[i];
+			if(taken[j] || !inside(index.point(j), &limits[0], dim)) continue;
+			taken[j] = 1;
+			clusters[j] = clusterId;
+			ranking.erase(std::make_pair(-candidates[j].count, j));
+			assignedCount++;
 		}
 		clusterId++;
-		assignedCount += maxCnt;
+
+		// only the candidates that contained some of the samples we just took have changed,
+		// their boxes overlap the one of the cluster (and their seeds are at most maxDist away from it)
+		ivec neighbors = index.Query(&limits[0], max_diameter);
+		ivec changed;
+		for (int i=0; i<(int)neighbors.size(); i++)
+		{
+			int s = neighbors[i];
+			if(taken[s] || !overlaps(&candidates[s].limits[0], &limits[0], dim)) continue;
+			ranking.erase(std::make_pair(-candidates[s].count, s));
+			changed.push_back(s);
+		}
+#pragma omp parallel for schedule(dynamic, 4)
+		for (int i=0; i<(int)changed.size(); i++) growCandidate(changed[i], index, taken, max_diameter, candidates[changed[i]]);
+		for (int i=0; i<(int)changed.size(); i++) ranking.insert(std::make_pair(-candidates[changed[i]].count, changed[i]));
 	}
 	return clusters;
 };
@@ -13,7 +13,7 @@ namespace AG
 		typedef unsigned int index;
 		typedef std::vector<index> Clusters;
 
-		Clusters qt_clustering(VectorSpace & vs, double max_diameter, int minCount);
+		Clusters qt_clustering(const VectorSpace & vs, double max_diameter, int minCount);
 	};
 };
 #endif
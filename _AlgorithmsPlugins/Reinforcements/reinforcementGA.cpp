@@ -73,11 +73,10 @@ fvec ReinforcementGA::Update()
     FOR(i, trainer->Population().size()) visited.push_back(trainer->Population()[i].ToSample());
     evaluations += trainer->Population().size();
 
-    dvec fitness(trainer->Population().size());
-    FOR(i, trainer->Population().size())
-    {
-        fitness[i] = problem->GetReward(trainer->Population()[i].ToSample());
-    }
+    std::vector<fvec> policies(trainer->Population().size());
+    FOR(i, trainer->Population().size()) policies[i] = trainer->Population()[i].ToSample();
+    fvec rewards = problem->GetRewards(policies);
+    dvec fitness(rewards.begin(), rewards.end());
     trainer->SetFitness(fitness);
     trainer->NextGen();
     maximum = trainer->Best().ToSample();
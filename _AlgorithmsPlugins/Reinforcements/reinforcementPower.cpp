@@ -140,7 +140,9 @@ fvec ReinforcementPower::Update()
 	if(bAdaptive && best.size() <= k)
 	{
 		fvec sigma;sigma.resize(dim,variance);
-		while(best.size() < k)
+        // we first draw all the candidates, then evaluate them together
+        std::vector<fvec> candidates;
+		while(best.size() + candidates.size() < k)
 		{
             switch(quantizeType)
             {
@@ -185,10 +187,11 @@ fvec ReinforcementPower::Update()
                 break;
             }
             visited.push_back(newSample);
-            float value = problem->GetReward(newSample);
-			evaluations++;
-            best.push_back(make_pair(value, make_pair(newSample, sigma)));
+            candidates.push_back(newSample);
 		}
+        fvec values = problem->GetRewards(candidates);
+        evaluations += candidates.size();
+        FOR(i, candidates.size()) best.push_back(make_pair(values[i], make_pair(candidates[i], sigma)));
 		std::sort(best.begin(), best.end());
 	}
 
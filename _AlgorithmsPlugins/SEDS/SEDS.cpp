@@ -65,11 +65,17 @@ SEDS::SEDS()
     Options.SEDS_Ver = 2;
     d = 0;
     nData = 0;
+    work = 0;
 #ifdef USEQT
     displayLabel = 0;
 #endif
 }
 
+SEDS::~SEDS()
+{
+    delete [] work;
+}
+
 /* Parsing the input commands to the solver */
 bool SEDS::Parse_Input(int argc, char **argv, char** file_data, char** file_model, char** file_output)
 {
@@ -548,6 +554,15 @@ bool SEDS::initialize_value(){
 
     sum_dp.Resize(K);
 
+    delete [] work;
+    work = new SEDSComponentWork[K];
+    for(int k=0; k<K; k++){
+        work[k].tmp_A.Resize(d,2*d);
+        for(int i=0; i<d; i++)
+            work[k].tmp_A(i,i) = 1; //eq to Matlab [eye(d) A(:,:,k)']
+        work[k].prob.Resize(nData);
+    }
+
     if (Options.objective)
         tmp_mat.Resize(2*d,nData);
     else
@@ -756,7 +771,7 @@ bool SEDS::Optimize(){
  * The result is saved in the Vector dJ. The returned value of function is J.
  * Don't mess with this function. Very sensitive and a bit complicated!
 */
-double SEDS::Compute_J(Vector pp, Vector& dJ) //compute the objective function and derivative w.r.t parameters (updated in vector dJ)
+double SEDS::Compute_J(const Vector &pp, Vector& dJ) //compute the objective function and derivative w.r.t parameters (updated in vector dJ)
 {
     double J = Compute_J(pp); //computing the cost function
 
@@ -764,13 +779,13 @@ double SEDS::Compute_J(Vector pp, Vector& dJ) //compute the objective function a
     int counter_sigma = counter_mu + Options.mu_opt*K*d; //the index at which sigma should start
     int counter_A = counter_sigma + Options.sigma_x_opt*K*d*(d+1)/2; //the index at which A should start
 
+    //number of sigma parameters of each component
+    int nSigma;
+    if (Options.objective) //likelihood
+        nSigma = (Options.sigma_x_opt) ? d*(2*d+1) : d*d;
+    else //mse
+        nSigma = Options.sigma_x_opt*d*(d+1)/2;
 
-    for(int i=0; i<d; i++)
-        tmp_A(i,i) = 1;
-
-    double det_term;
-    double sum;
-    Vector dJ_dMu_k(d);
     int ind_max_col;
 
     if (Options.sigma_x_opt){
@@ -780,10 +795,20 @@ double SEDS::Compute_J(Vector pp, Vector& dJ) //compute the objective function a
     }
 
     dJ.Zero();
+
+    //each component only writes its own entries of dJ, they are computed concurrently
+#pragma omp parallel for schedule(dynamic)
     for(int k=0; k<K; k++){
+        SEDSComponentWork &w = work[k];
+        int counter_mu_k = counter_mu + k*d;
+        int counter_sigma_k = counter_sigma + k*nSigma;
+        int counter_A_k = counter_A + k*d*d;
+        double det_term;
+        double sum;
+
         //sensitivity wrt Priors
         if (Options.perior_opt && Options.objective){ //likelihood
-            dJ[k] = -exp(-pp[k])*Priors[k]*sum_dp[k];
+            dJ[k] = -exp(-pp.At(k))*Priors[k]*sum_dp[k];
             /*
             h[k] = Pxi[k]*Priors[k]/Pxi_Priors;
             dJ(k)=-exp(pp(k))/Priors[k]*((h[k]-Priors[k]).Sum());
@@ -792,8 +817,7 @@ double SEDS::Compute_J(Vector pp, Vector& dJ) //compute the objective function a
             sum = 0;
             double tmp_dbl;
             h_tmp[k].Zero();
-            tmp_mat = A[k]*X;
-            REALTYPE *p_tmp_mat = tmp_mat.Array();
+            REALTYPE *p_tmp_mat = w.AX.Array(); //A[k]*X, from Compute_J(pp)
             REALTYPE *p_Xd_hat = Xd_hat.Array();
             REALTYPE *p_Xd = Xd.Array();
 
@@ -807,7 +831,7 @@ double SEDS::Compute_J(Vector pp, Vector& dJ) //compute the objective function a
                 }
             }
             if (Options.perior_opt)
-                dJ[k] = exp(-pp[k])*Priors[k]*sum;
+                dJ[k] = exp(-pp.At(k))*Priors[k]*sum;
             /*
                 h_tmp[k] = h[k]^(((A[k]*X-Xd_hat)^(Xd_hat-Xd)).SumRow()); //This vector is common in all dJ computation.
                 Thus, I defined it as a variable to save some computation power
@@ -818,22 +842,22 @@ double SEDS::Compute_J(Vector pp, Vector& dJ) //compute the objective function a
         if (Options.mu_opt)
         {
             if (Options.objective){ //likelihood
-                tmp_A.InsertSubMatrix(0,d,A[k].Transpose(),0,d,0,d); // eq to Matlab [eye(2) A(:,:,i)']
-                dJ_dMu_k=-((tmp_A*invSigma[k])*tmpData[k])*h[k];
-                dJ.InsertSubVector(counter_mu,dJ_dMu_k,0,d);
-                counter_mu += d;
+                w.tmp_A.InsertSubMatrix(0,d,A[k].Transpose(),0,d,0,d); // eq to Matlab [eye(2) A(:,:,i)']
+                w.tmp_A.Mult(invSigma[k],w.S);
+                w.S.Mult(tmpData[k],w.tmp_mat);
+                w.tmp_mat.Mult(h[k],w.dJ_dMu);
+                for (int i=0; i<d; i++)
+                    dJ(counter_mu_k+i) = -w.dJ_dMu(i);
             }
             else{ //mse
-                tmp_mat = invSigma_x[k]*tmpData[k];
-                REALTYPE *p_tmp_mat = tmp_mat.Array();
-                REALTYPE *p_dJ = &dJ(counter_mu);
+                REALTYPE *p_tmp_mat = w.SX.Array(); //invSigma_x[k]*tmpData[k], from Compute_J(pp)
+                REALTYPE *p_dJ = &dJ(counter_mu_k);
 
                 for (int i=0; i<d; i++){
                     REALTYPE *p_h_tmp = h_tmp[k].Array();
                     for (int j=0; j<nData; j++)
                         *p_dJ += *(p_tmp_mat++) * (*(p_h_tmp++));
                     p_dJ++;
-                    counter_mu++;
                 }
 
                 /*
@@ -853,16 +877,17 @@ double SEDS::Compute_J(Vector pp, Vector& dJ) //compute the objective function a
             for (int i=0;i<ind_max_col;i++){
                 int j = (Options.sigma_x_opt) ? i:d;
                 while (j<2*d){
-                    rSrs.Zero();
-                    rSrs(j,i)=1;
-                    rSrs = rSrs*L[k].Transpose() + L[k]*rSrs.Transpose();
+                    w.rSrs.Resize(2*d,2*d);
+                    w.rSrs.Zero();
+                    w.rSrs(j,i)=1;
+                    w.rSrs = w.rSrs*L[k].Transpose() + L[k]*w.rSrs.Transpose();
 
-                    rAvrs = (-A[k] * rSrs.GetMatrix(0,d-1,0,d-1)+ rSrs.GetMatrix(d,2*d-1,0,d-1))*invSigma_x[k] * Mu_x[k];
-                    tmp_mat = (invSigma[k]*(rSrs*invSigma[k]))*tmpData[k];
-                    double tmp_dbl = (-0.5)*det_term*(invSigma[k]*rSrs).Trace();
-                    Vector tmp_vec = invSigma[k].GetMatrix(0,2*d-1,d,2*d-1)*rAvrs;
+                    w.rAvrs = (-A[k] * w.rSrs.GetMatrix(0,d-1,0,d-1)+ w.rSrs.GetMatrix(d,2*d-1,0,d-1))*invSigma_x[k] * Mu_x[k];
+                    (invSigma[k]*(w.rSrs*invSigma[k])).Mult(tmpData[k],w.tmp_mat);
+                    double tmp_dbl = (-0.5)*det_term*(invSigma[k]*w.rSrs).Trace();
+                    invSigma[k].GetMatrix(0,2*d-1,d,2*d-1).Mult(w.rAvrs,w.tmp_vec);
 
-                    REALTYPE *p_tmp_mat = tmp_mat.Array();
+                    REALTYPE *p_tmp_mat = w.tmp_mat.Array();
                     REALTYPE *p_tmpData = tmpData[k].Array();
                     sum = 0;
 
@@ -871,11 +896,11 @@ double SEDS::Compute_J(Vector pp, Vector& dJ) //compute the objective function a
                         for (int j=0; j<nData; j++){
                             sum -= (0.5 * (*p_tmp_mat++) * (*p_tmpData) +
                                     (i==0)*tmp_dbl + //derivative with respect to det Sigma which is in the numenator
-                                    (*p_tmpData++) * tmp_vec[i]) * (*p_h++); //since Mu_xi_d = A*Mu_xi, thus we should consider its effect here
+                                    (*p_tmpData++) * w.tmp_vec[i]) * (*p_h++); //since Mu_xi_d = A*Mu_xi, thus we should consider its effect here
                         }
                     }
-                    dJ(counter_sigma) = sum;
-                    counter_sigma++;
+                    dJ(counter_sigma_k) = sum;
+                    counter_sigma_k++;
                     j++;
 
                     /*
@@ -892,14 +917,15 @@ double SEDS::Compute_J(Vector pp, Vector& dJ) //compute the objective function a
             for (int i=0;i<d;i++){
                 for (int j=0;j<d;j++){
                     if (Options.sigma_x_opt && j>=i){
-                        rSrs.Zero();
-                        rSrs(j,i)=1;
-                        rSrs = rSrs*L_x[k].Transpose() + L_x[k]*rSrs.Transpose();
+                        w.rSrs.Resize(d,d);
+                        w.rSrs.Zero();
+                        w.rSrs(j,i)=1;
+                        w.rSrs = w.rSrs*L_x[k].Transpose() + L_x[k]*w.rSrs.Transpose();
 
-                        tmp_mat = (invSigma_x[k]*rSrs*invSigma_x[k])*tmpData[k];
-                        double tmp_dbl = -(invSigma_x[k]*rSrs).Trace();
+                        (invSigma_x[k]*w.rSrs*invSigma_x[k]).Mult(tmpData[k],w.tmp_mat);
+                        double tmp_dbl = -(invSigma_x[k]*w.rSrs).Trace();
 
-                        REALTYPE *p_tmp_mat = tmp_mat.Array();
+                        REALTYPE *p_tmp_mat = w.tmp_mat.Array();
                         REALTYPE *p_tmpData = tmpData[k].Array();
                         sum = 0;
 
@@ -912,8 +938,8 @@ double SEDS::Compute_J(Vector pp, Vector& dJ) //compute the objective function a
                                 //the above term (i==0) is just to sum temp_dbl once
                             }
                         }
-                        dJ(counter_sigma) = 0.5*sum;
-                        counter_sigma++;
+                        dJ(counter_sigma_k) = 0.5*sum;
+                        counter_sigma_k++;
 
                         /*
                         dJ(K+K*d+k*d*(2*d+1)+i_c-1) =  0.5*(
@@ -923,22 +949,17 @@ double SEDS::Compute_J(Vector pp, Vector& dJ) //compute the objective function a
                         */
                     }
 
+                    //rSrs*X only has one non-zero row: the i-th row of X, moved to row j
                     sum = 0;
-                    rSrs.Zero();
-                    rSrs(j,i)=1;
-                    tmp_mat = rSrs*X;
-                    REALTYPE *p_tmp_mat = tmp_mat.Array();
-                    REALTYPE *p_Xd_hat = Xd_hat.Array();
-                    REALTYPE *p_Xd = Xd.Array();
-
-                    for (int ii=0; ii<d; ii++){
-                        REALTYPE *p_h = h[k].Array();
-                        for (int jj=0; jj<nData; jj++){
-                            sum += *(p_h++) * (*(p_tmp_mat++)) * (*(p_Xd_hat++) - *(p_Xd++));
-                        }
+                    REALTYPE *p_X = X.Array() + i*nData;
+                    REALTYPE *p_Xd_hat = Xd_hat.Array() + j*nData;
+                    REALTYPE *p_Xd = Xd.Array() + j*nData;
+                    REALTYPE *p_h = h[k].Array();
+                    for (int jj=0; jj<nData; jj++){
+                        sum += *(p_h++) * (*(p_X++)) * (*(p_Xd_hat++) - *(p_Xd++));
                     }
-                    dJ(counter_A) = sum;
-                    counter_A++;
+                    dJ(counter_A_k) = sum;
+                    counter_A_k++;
                     // dJ(counter_A) = sum(sum((rSrs*x).*dJdxd).*h(:,k)');  %derivative of A
 
                 }
@@ -954,7 +975,7 @@ double SEDS::Compute_J(Vector pp, Vector& dJ) //compute the objective function a
  * The result is saved in the Vector dJ. The returned value of function is J.
  * Don't mess with this function. Very sensitive and a bit complicated!
 */
-double SEDS::Compute_J(Vector pp){
+double SEDS::Compute_J(const Vector &pp){
 
     double J = 0;
     if (Options.objective){
@@ -963,11 +984,10 @@ double SEDS::Compute_J(Vector pp){
         Parameters_2_GMM_MSE(pp);
     }
 
-    //computing likelihood:
-    Pxi_Priors.Zero();
-
-
+    //computing likelihood, the components are independent from each other
+#pragma omp parallel for schedule(dynamic)
     for (int k=0; k<K; k++){
+        SEDSComponentWork &w = work[k];
         int d_tmp;
         double tmp_den;
         REALTYPE *p_X;
@@ -991,28 +1011,26 @@ double SEDS::Compute_J(Vector pp){
         }
 
         if (Options.objective){ //likelihod
-            tmp_mat = invSigma[k]*tmpData[k];
+            invSigma[k].Mult(tmpData[k],w.SX);
         }
         else{ //mse
-            tmp_mat = invSigma_x[k]*tmpData[k];
+            invSigma_x[k].Mult(tmpData[k],w.SX);
         }
 
-        REALTYPE *p_tmp_mat = tmp_mat.Array();
+        REALTYPE *p_tmp_mat = w.SX.Array();
         REALTYPE *p_Pxi = Pxi[k].Array();
-        REALTYPE *p_Pxi_Priors = Pxi_Priors.Array();
         p_tmpData = tmpData[k].Array();
-        prob.Zero();
+        w.prob.Zero();
 
         for(int i=0; i<d_tmp; i++){
-            REALTYPE *p_prob = prob.Array();
+            REALTYPE *p_prob = w.prob.Array();
             for(int j=0; j<nData; j++){
                 if (i<d_tmp-1){
                     *p_prob++ += (*p_tmp_mat++) * (*p_tmpData++);
                 }
                 else{
                     *p_prob += (*p_tmp_mat++) * (*p_tmpData++);
-                    *p_Pxi = exp(-0.5*(*p_prob++))/tmp_den;
-                    *(p_Pxi_Priors++) += (*p_Pxi++)*Priors[k];
+                    *p_Pxi++ = exp(-0.5*(*p_prob++))/tmp_den;
                 }
             }
         }
@@ -1033,8 +1051,18 @@ double SEDS::Compute_J(Vector pp){
         */
     }
 
+    //the mixture is accumulated in the order of the components
+    Pxi_Priors.Zero();
+    for (int k=0; k<K; k++){
+        REALTYPE *p_Pxi = Pxi[k].Array();
+        REALTYPE *p_Pxi_Priors = Pxi_Priors.Array();
+        for(int j=0; j<nData; j++)
+            *(p_Pxi_Priors++) += (*p_Pxi++)*Priors[k];
+    }
+
     //computing GMR
     if (Options.objective){ //likelihood
+#pragma omp parallel for
         for (int k=0; k<K; k++){
             REALTYPE *p_h = h[k].Array();
             REALTYPE *p_Pxi = Pxi[k].Array();
@@ -1047,20 +1075,25 @@ double SEDS::Compute_J(Vector pp){
             }
         }
     }else{
+#pragma omp parallel for
         for (int k=0; k<K; k++){
-            tmp_mat = A[k]*X;
-            REALTYPE *p_tmp_mat = tmp_mat.Array();
-            REALTYPE *p_Xd_hat = Xd_hat.Array();
+            A[k].Mult(X,work[k].AX);
+            REALTYPE *p_h = h[k].Array();
             REALTYPE *p_Pxi = Pxi[k].Array();
             REALTYPE *p_Pxi_Priors = Pxi_Priors.Array();
+            for(int j=0; j<nData; j++)
+                *(p_h++) = *(p_Pxi++)/(*(p_Pxi_Priors++)) * Priors[k];
+        }
+
+        for (int k=0; k<K; k++){
+            REALTYPE *p_tmp_mat = work[k].AX.Array();
+            REALTYPE *p_Xd_hat = Xd_hat.Array();
 
             for(int i=0; i<d; i++)
             {
                 REALTYPE *p_h = h[k].Array();
 
                 for(int j=0; j<nData; j++){
-                    if (i==0)
-                        *p_h = *(p_Pxi++)/(*(p_Pxi_Priors++)) * Priors[k];
                     if (k==0)
                         *(p_Xd_hat++) = *(p_h++) * (*p_tmp_mat++);
                     else
@@ -1099,7 +1132,7 @@ double SEDS::Compute_J(Vector pp){
 /* Computing the stability constraints and their derivatives */
 void SEDS::Compute_Constraints(Vector &c, Matrix &dc, bool used_for_penalty){
     int i1_tmp;
-    double tmp_detB, term;
+    double term;
     int counter_sigma = Options.perior_opt*K + Options.mu_opt*K*d; //the index at which sigma should start
     int counter_A = counter_sigma + Options.sigma_x_opt*K*d*(d+1)/2; //the index at which A should start
     int counter_C = counter_A + K*d*d; //the index at which C_Lyapunov should start
@@ -1117,6 +1150,7 @@ void SEDS::Compute_Constraints(Vector &c, Matrix &dc, bool used_for_penalty){
     }
 
     if (Options.constraintCriterion){ //Principal Minor
+        Vector detB(d);
         //constraints
         for (int k=0; k<K; k++)//for all states
         {
@@ -1126,84 +1160,103 @@ void SEDS::Compute_Constraints(Vector &c, Matrix &dc, bool used_for_penalty){
             //computing the constraints (this part is basicly an exact rewrite of the matlab version)
             for (int i=0; i<d; i++) //for all dimensions
             {
-                B_Inv[i]=B.GetMatrix(0,i,0,i).Inverse(&tmp_detB);//get inverse and determinants of minors
+                B_Inv[i]=B.GetMatrix(0,i,0,i).Inverse(&detB(i));//get inverse and determinants of minors
 
-                if (!used_for_penalty || i1_tmp*tmp_detB+Options.eps_margin > 0)
-                    c(k*d+i) = i1_tmp*tmp_detB + Options.eps_margin;
-
-                //computing the sensitivity of the constraints to the parameters
-                if (Options.objective){ //likelihood
-                    int i_c = Options.sigma_x_opt*k*d*(d+1) + k*d*d;
-                    for (int ii=0;ii<ind_max_col;ii++){
-                        int jj = (Options.sigma_x_opt) ? ii:d;
-                        while (jj<2*d){
-                            rSrs.Zero();
-                            rSrs(jj,ii) = 1;
-                            rSrs = rSrs*L[k].Transpose() + L[k]*rSrs.Transpose();
-                            rArs = (-A[k] * rSrs.GetMatrix(0,d-1,0,d-1) + rSrs.GetMatrix(d,2*d-1,0,d-1)) * invSigma_x[k];
-                            rBrs = C_Lyapunov*rArs + rArs.Transpose()*C_Lyapunov;
+                if (!used_for_penalty || i1_tmp*detB(i)+Options.eps_margin > 0)
+                    c(k*d+i) = i1_tmp*detB(i) + Options.eps_margin;
+                i1_tmp *= -1; //used to alternate sign over iterations
+            }
+
+            //computing the sensitivity of the constraints to the parameters
+            //the derivative of B is the same for all minors, it is computed once per parameter
+            if (Options.objective){ //likelihood
+                int i_c = Options.sigma_x_opt*k*d*(d+1) + k*d*d;
+                for (int ii=0;ii<ind_max_col;ii++){
+                    int jj = (Options.sigma_x_opt) ? ii:d;
+                    while (jj<2*d){
+                        rSrs.Zero();
+                        rSrs(jj,ii) = 1;
+                        rSrs = rSrs*L[k].Transpose() + L[k]*rSrs.Transpose();
+                        rArs = (-A[k] * rSrs.GetMatrix(0,d-1,0,d-1) + rSrs.GetMatrix(d,2*d-1,0,d-1)) * invSigma_x[k];
+                        rBrs = C_Lyapunov*rArs + rArs.Transpose()*C_Lyapunov;
 
+                        i1_tmp = 1;
+                        for (int i=0; i<d; i++){
                             if (i==0)
                                 term = rBrs(0,0);
                             else
-                                term = (B_Inv[i]*rBrs.GetMatrix(0,i,0,i)).Trace()*tmp_detB;
+                                term = (B_Inv[i]*rBrs.GetMatrix(0,i,0,i)).Trace()*detB(i);
 
                             dc(k*d+i, counter_sigma + i_c) = i1_tmp*term;
+                            i1_tmp *= -1;
+                        }
 
-                            if (Options.SEDS_Ver == 2 && jj>=d && ii<d){
-                                //derivative with respect to the Lyapunov stuffs
-                                rArs.Zero(); //in fact it is rCrc, but to avoid defining an extra variable, I used rArs
-                                rArs(ii,jj-d) = 1;
-                                rBrs = rArs*A[k]+A[k].Transpose()*rArs;
+                        if (Options.SEDS_Ver == 2 && jj>=d && ii<d){
+                            //derivative with respect to the Lyapunov stuffs
+                            rArs.Zero(); //in fact it is rCrc, but to avoid defining an extra variable, I used rArs
+                            rArs(ii,jj-d) = 1;
+                            rBrs = rArs*A[k]+A[k].Transpose()*rArs;
 
+                            i1_tmp = 1;
+                            for (int i=0; i<d; i++){
                                 if (i==0)
                                     term = rBrs(0,0);
                                 else
-                                    term = (B_Inv[i]*rBrs.GetMatrix(0,i,0,i)).Trace()*tmp_detB;
+                                    term = (B_Inv[i]*rBrs.GetMatrix(0,i,0,i)).Trace()*detB(i);
 
                                 dc(k*d+i,counter_C + ii*d+(jj-d)) = i1_tmp*term;
+                                i1_tmp *= -1;
                             }
-
-                            jj++;
-                            i_c++;
                         }
-                    }
-                }else{ //mse
-                    for (int ii=0; ii<=i; ii++){
-                        for (int jj=0; jj<=i; jj++){
-                            rArs.Zero();
-                            rArs(jj,ii) = 1;
-                            rBrs = C_Lyapunov*rArs + rArs.Transpose()*C_Lyapunov;
 
+                        jj++;
+                        i_c++;
+                    }
+                }
+            }else{ //mse
+                //an entry (jj,ii) of A only changes the minors that contain it
+                for (int ii=0; ii<d; ii++){
+                    for (int jj=0; jj<d; jj++){
+                        int first = (ii>jj) ? ii:jj;
+                        rArs.Zero();
+                        rArs(jj,ii) = 1;
+                        rBrs = C_Lyapunov*rArs + rArs.Transpose()*C_Lyapunov;
+
+                        i1_tmp = (first%2) ? -1:1;
+                        for (int i=first; i<d; i++){
                             if (i==0)
                                 term = rBrs(0,0);
                             else
-                                term = (B_Inv[i]*rBrs.GetMatrix(0,i,0,i)).Trace()*tmp_detB;
+                                term = (B_Inv[i]*rBrs.GetMatrix(0,i,0,i)).Trace()*detB(i);
 
                             dc(k*d+i,counter_A + k*d*d + ii*d + jj) = i1_tmp*term;
+                            i1_tmp *= -1;
+                        }
 
-                            if (Options.SEDS_Ver == 2){
-                                //derivative with respect to the Lyapunov stuffs
-                                rArs.Zero(); //in fact it is rCrc, but to avoid defining an extra variable, I used rArs
-                                rArs(ii,jj) = 1;
-                                rBrs = rArs*A[k]+A[k].Transpose()*rArs;
+                        if (Options.SEDS_Ver == 2){
+                            //derivative with respect to the Lyapunov stuffs
+                            rArs.Zero(); //in fact it is rCrc, but to avoid defining an extra variable, I used rArs
+                            rArs(ii,jj) = 1;
+                            rBrs = rArs*A[k]+A[k].Transpose()*rArs;
 
+                            i1_tmp = (first%2) ? -1:1;
+                            for (int i=first; i<d; i++){
                                 if (i==0)
                                     term = rBrs(0,0);
                                 else
-                                    term = (B_Inv[i]*rBrs.GetMatrix(0,i,0,i)).Trace()*tmp_detB;
+                                    term = (B_Inv[i]*rBrs.GetMatrix(0,i,0,i)).Trace()*detB(i);
 
                                 dc(k*d+i,counter_C + ii*d+jj) = i1_tmp*term;
+                                i1_tmp *= -1;
                             }
                         }
                     }
                 }
-                i1_tmp *= -1; //used to alternate sign over iterations
             }
         }
     }else{ //eigenvalue
         Vector eigVal(d), eigVal_new(d);
-        Matrix M_tmp(d,d),eigVec(d,d);
+        Matrix M_tmp(d,d),eigVec(d,d),invSigma_x0(d,d);
 
         for (int k=0; k<K; k++)//for all states
         {
@@ -1216,6 +1269,9 @@ void SEDS::Compute_Constraints(Vector &c, Matrix &dc, bool used_for_penalty){
             }
 
             if (Options.objective){ //likelihood
+                //the entries of the last d rows of L do not change Sigma_x, its inverse is computed once
+                rSrs = L[k]*(L[k].Transpose());
+                invSigma_x0 = rSrs.GetMatrix(0,d-1,0,d-1).Inverse();
                 int i_c = Options.sigma_x_opt*k*d*(d+1) + k*d*d;
                 for (int ii=0;ii<ind_max_col;ii++){
                     int jj = (Options.sigma_x_opt) ? ii:d;
@@ -1223,7 +1279,10 @@ void SEDS::Compute_Constraints(Vector &c, Matrix &dc, bool used_for_penalty){
                         rSrs = L[k];
                         rSrs(jj,ii) += Options.delta;
                         rSrs = rSrs*(rSrs.Transpose());
-                        M_tmp = rSrs.GetMatrix(d,2*d-1,0,d-1)*rSrs.GetMatrix(0,d-1,0,d-1).Inverse();
+                        if (jj>=d)
+                            M_tmp = rSrs.GetMatrix(d,2*d-1,0,d-1)*invSigma_x0;
+                        else
+                            M_tmp = rSrs.GetMatrix(d,2*d-1,0,d-1)*rSrs.GetMatrix(0,d-1,0,d-1).Inverse();
                         B = C_Lyapunov*M_tmp + M_tmp.Transpose()*C_Lyapunov;
                         B.EigenValuesDecomposition(eigVal_new,eigVec,100);
                         eigVal_new.Sort();
@@ -1392,7 +1451,7 @@ bool SEDS::GMM_2_Parameters_Likelihood(Vector &p){ //this is used to transform G
 }
 
 /* Transforming the vector of optimization's parameters into a GMM model.*/
-bool SEDS::Parameters_2_GMM_Likelihood(Vector pp){ //this is used to unpack the parameters in p after optimization, to reconstruct the
+bool SEDS::Parameters_2_GMM_Likelihood(const Vector &pp){ //this is used to unpack the parameters in p after optimization, to reconstruct the
     //GMM-parameters in their ususal form: Priors, Mu and Sigma.
 
     double sum=0;
@@ -1405,7 +1464,7 @@ bool SEDS::Parameters_2_GMM_Likelihood(Vector pp){ //this is used to unpack the
     for (int k=0; k<K; k++){
         //constructing Priors
         if (Options.perior_opt){
-            Priors[k] = 1.0/(1.0+exp(-pp[k])); //extract the Priors from correspondng position in optimization vector
+            Priors[k] = 1.0/(1.0+exp(-pp.At(k))); //extract the Priors from correspondng position in optimization vector
             sum += Priors[k];
         }
 
@@ -1414,7 +1473,7 @@ bool SEDS::Parameters_2_GMM_Likelihood(Vector pp){ //this is used to unpack the
             for(int j=0; j<2*d; j++){ //for all dimensions
                 col.Zero();
                 for(int i=j; i<2*d; i++){
-                    col(i)=pp(counter_sigma);
+                    col(i)=pp.At(counter_sigma);
                     counter_sigma++;
                 }
                 L[k].SetColumn(col, j);
@@ -1422,7 +1481,7 @@ bool SEDS::Parameters_2_GMM_Likelihood(Vector pp){ //this is used to unpack the
         }else{
             for(int j=0; j<d; j++){ //for all dimensions
                 for(int i=0; i<d; i++){
-                    L[k](i+d,j) = pp(counter_sigma);
+                    L[k](i+d,j) = pp.At(counter_sigma);
                     counter_sigma++;
                 }
             }
@@ -1509,7 +1568,7 @@ bool SEDS::GMM_2_Parameters_MSE(Vector &p){ //this is used to transform GMM to t
 }
 
 /* Transforming the vector of optimization's parameters into a GMM model.*/
-bool SEDS::Parameters_2_GMM_MSE(Vector pp){ //this is used to unpack the parameters in p after optimization, to reconstruct the
+bool SEDS::Parameters_2_GMM_MSE(const Vector &pp){ //this is used to unpack the parameters in p after optimization, to reconstruct the
     //GMM-parameters in their ususal form: Priors, Mu and Sigma.
 
     Vector col(d); // a temporary vector needed below
@@ -1521,17 +1580,17 @@ bool SEDS::Parameters_2_GMM_MSE(Vector pp){ //this is used to unpack the paramet
     for (int k=0; k<K; k++){
         //constructing Priors
         if (Options.perior_opt)
-            Priors[k] = 1.0/(1.0+exp(-pp[k]));
+            Priors[k] = 1.0/(1.0+exp(-pp.At(k)));
 
         //reconstructing Sigma
         for(int j=0; j<d; j++){ //for all dimensions
             col.Zero();
             for(int i=0; i<d; i++){
                 if (i>=j && Options.sigma_x_opt){
-                    col(i)=pp(counter_sigma);
+                    col(i)=pp.At(counter_sigma);
                     counter_sigma++;
                 }
-                A[k](i,j) = pp(counter_A);
+                A[k](i,j) = pp.At(counter_A);
                 counter_A++;
             }
             if (Options.sigma_x_opt)
@@ -31,6 +31,14 @@ struct options{  //A struct containing all passed options by user
     int SEDS_Ver; //the SEDS version to use
 };
 
+// scratch buffers of one Gaussian component, so that the components can be processed concurrently
+struct SEDSComponentWork{
+    MathLib::Matrix tmp_A, rSrs, S, tmp_mat;
+    MathLib::Matrix SX; // inverse covariance times the centered data, kept from the last evaluation of J
+    MathLib::Matrix AX; // A*X, kept from the last evaluation of J (mse only)
+    MathLib::Vector prob, rAvrs, tmp_vec, dJ_dMu;
+};
+
 class SEDS {
 public:
     Vector Priors,p; //Priors of GMM, a vector containing the optimization variable
@@ -50,6 +58,7 @@ public:
     options Options;
     //constructor
     SEDS();
+    ~SEDS();
 
     /* Parsing the input commands to the solver */
     bool Parse_Input(int argc, char **argv, char** file_data, char** file_model, char** file_output);
@@ -123,9 +132,9 @@ public:
      * The result is saved in the Vector dJ. The returned value of function is J.
      * Don't mess with this function. Very sensitive and a bit complicated!
      */
-    double Compute_J(Vector p, Vector &dJ);
+    double Compute_J(const Vector &p, Vector &dJ);
 
-    double Compute_J(Vector p);
+    double Compute_J(const Vector &p);
 
     void Compute_Constraints(Vector &c);
 
@@ -140,6 +149,7 @@ protected:
     MathLib::Matrix rSrs, rArs, rBrs, tmp_mat;
     Vector prob, *Pxi, *h_tmp, *h, *Mu_x, *Mu_xd, rAvrs, c, sum_dp;
     Vector Pxi_Priors; //a vector representing Pxi*Priors
+    SEDSComponentWork *work; //one per component
 
     bool initialize_value();
 
@@ -158,12 +168,12 @@ protected:
     bool GMM_2_Parameters_Likelihood(Vector &p);
 
     /* Transforming the vector of optimization's parameters into a GMM model.*/
-    bool Parameters_2_GMM_Likelihood(Vector pp); //when optimization is done, use this to correctly extract Priors, mu and sigma for model
+    bool Parameters_2_GMM_Likelihood(const Vector &pp); //when optimization is done, use this to correctly extract Priors, mu and sigma for model
 
     /* Transforming the GMM model into the vector of optimization's parameters.*/
     bool GMM_2_Parameters_MSE(Vector &p);
 
     /* Transforming the vector of optimization's parameters into a GMM model.*/
-    bool Parameters_2_GMM_MSE(Vector pp); //when optimization is done, use this to correctly extract Priors, mu and sigma for model
+    bool Parameters_2_GMM_MSE(const Vector &pp); //when optimization is done, use this to correctly extract Priors, mu and sigma for model
 };
 #endif
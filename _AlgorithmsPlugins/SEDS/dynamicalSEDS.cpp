@@ -34,6 +34,7 @@ DynamicalSEDS::DynamicalSEDS()
 #endif
 
     type = DYN_SEDS;
+    bBackgroundTraining = false; // SEDS plots the optimization on displayLabel while it runs
 	endpoint = fvec();
 	endpoint.resize(4,0.f);
 }
@@ -0,0 +1,282 @@
+/*********************************************************************
+MLDemos: A User-Friendly visualization toolkit for machine learning
+Copyright (C) 2010  Basilio Noris
+Contact: mldemos@b4silio.com
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public License,
+version 3 as published by the Free Software Foundation.
+
+This library is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free
+Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*********************************************************************/
+#include "MatImport.h"
+#include <matio/matio.h>
+#include <QApplication>
+#include <QFileDialog>
+#include <QFileInfo>
+#include <QMessageBox>
+#include <math.h>
+
+using namespace std;
+
+// number of elements handed over by matio at a time
+#define MAT_BLOCK 65536
+
+static const char *matClassNames[] = {"empty", "cell", "struct", "object", "char", "sparse",
+                                      "double", "single", "int8", "uint8", "int16", "uint16",
+                                      "int32", "uint32", "int64", "uint64", "function"};
+
+// destination of the blocks of a variable, matio gives the elements column by column
+struct MatBlockTarget
+{
+    MatImport *importer;
+    size_t rows;
+    bool bSampleRows;
+    vector<fvec> *samples;
+    ivec *labels;
+    size_t offset; // elements read from the previous variables
+};
+
+static int MatBlockCallback(const double *data, size_t start, int count, void *user)
+{
+    MatBlockTarget &target = *(MatBlockTarget *)user;
+    if(target.labels)
+    {
+        FOR(i, count) (*target.labels)[start+i] = (int)floor(data[i] + 0.5);
+    }
+    else
+    {
+        size_t r = start % target.rows, c = start / target.rows;
+        FOR(i, count)
+        {
+            if(target.bSampleRows) (*target.samples)[r][c] = data[i];
+            else (*target.samples)[c][r] = data[i];
+            if(++r == target.rows)
+            {
+                r = 0;
+                c++;
+            }
+        }
+    }
+    return target.importer->Progress(target.offset + start + count) ? 1 : 0;
+}
+
+MatImport::MatImport()
+    : gui(0), guiDialog(0), importTotal(0), bCancel(false), bImporting(false)
+{
+}
+
+MatImport::~MatImport()
+{
+    if(gui && guiDialog) guiDialog->hide();
+}
+
+void MatImport::Start()
+{
+    if(!gui)
+    {
+        gui = new Ui::MatImportDialog();
+        gui->setupUi(guiDialog = new QDialog());
+        guiDialog->setWindowTitle("MAT Import");
+        connect(gui->closeButton, SIGNAL(clicked()), this, SLOT(Closing()));
+        connect(guiDialog, SIGNAL(finished(int)), this, SLOT(Closing()));
+        connect(gui->loadButton, SIGNAL(clicked()), this, SLOT(LoadFile()));
+        connect(gui->importButton, SIGNAL(clicked()), this, SLOT(Import()));
+        connect(gui->cancelButton, SIGNAL(clicked()), this, SLOT(Cancel()));
+        connect(gui->dataCombo, SIGNAL(currentIndexChanged(int)), this, SLOT(OptionsChanged()));
+        connect(gui->labelCombo, SIGNAL(currentIndexChanged(int)), this, SLOT(OptionsChanged()));
+        connect(gui->sampleRowsCheck, SIGNAL(clicked()), this, SLOT(OptionsChanged()));
+    }
+    guiDialog->show();
+}
+
+void MatImport::Stop()
+{
+    if(guiDialog) guiDialog->hide();
+}
+
+void MatImport::Closing()
+{
+    bCancel = true;
+    emit(Done(this));
+}
+
+void MatImport::Cancel()
+{
+    bCancel = true;
+}
+
+bool MatImport::Progress(size_t done)
+{
+    if(importTotal) gui->progressBar->setValue((int)(1000.*done/importTotal));
+    qApp->processEvents();
+    return bCancel;
+}
+
+void MatImport::LoadFile()
+{
+    if(bImporting) return;
+    QString filename = QFileDialog::getOpenFileName(NULL, tr("Load Data"), QDir::currentPath(), tr("MATLAB files (*.mat);;All files (*.*)"));
+    if(filename.isEmpty()) return;
+    Parse(filename);
+}
+
+void MatImport::Parse(QString filename)
+{
+    this->filename = QString();
+    variables.clear();
+    gui->variableTable->clearContents();
+    gui->variableTable->setRowCount(0);
+    gui->dataCombo->blockSignals(true);
+    gui->labelCombo->blockSignals(true);
+    gui->dataCombo->clear();
+    gui->labelCombo->clear();
+    gui->labelCombo->addItem("none", QVariant(-1));
+    gui->filenameLabel->setText(QFileInfo(filename).fileName());
+
+    mat_t *mat = Mat_Open(filename.toLocal8Bit().constData(), MAT_ACC_RDONLY);
+    if(!mat)
+    {
+        QMessageBox::warning(guiDialog, tr("MAT Import"),
+                             tr("Unable to open %1.\nMAT v7.3 files require the hdf5 option of MLDemos_variables.pri").arg(filename));
+        gui->dataCombo->blockSignals(false);
+        gui->labelCombo->blockSignals(false);
+        OptionsChanged();
+        return;
+    }
+    this->filename = filename;
+
+    // only the headers are read here, the data stays on disk until the import
+    matvar_t *matvar;
+    while((matvar = Mat_VarReadNextInfo(mat)))
+    {
+        QString size;
+        FOR(d, matvar->rank) size += (d ? "x" : "") + QString::number(matvar->dims[d]);
+        int row = gui->variableTable->rowCount();
+        gui->variableTable->setRowCount(row+1);
+        gui->variableTable->setItem(row, 0, new QTableWidgetItem(QString(matvar->name)));
+        gui->variableTable->setItem(row, 1, new QTableWidgetItem(size));
+        gui->variableTable->setItem(row, 2, new QTableWidgetItem(QString(matClassNames[matvar->class_type <= MAT_C_FUNCTION ? matvar->class_type : 0])));
+
+        if(matvar->class_type >= MAT_C_DOUBLE && matvar->class_type <= MAT_C_UINT64 && matvar->rank == 2)
+        {
+            MatVariable variable;
+            variable.name = matvar->name;
+            variable.rows = matvar->dims[0];
+            variable.cols = matvar->dims[1];
+            variable.classType = matvar->class_type;
+            gui->dataCombo->addItem(variable.name, QVariant((int)variables.size()));
+            if(variable.rows == 1 || variable.cols == 1) gui->labelCombo->addItem(variable.name, QVariant((int)variables.size()));
+            variables.push_back(variable);
+        }
+        Mat_VarFree(matvar);
+    }
+    Mat_Close(mat);
+    gui->dataCombo->blockSignals(false);
+    gui->labelCombo->blockSignals(false);
+    OptionsChanged();
+}
+
+void MatImport::OptionsChanged()
+{
+    if(!gui || bImporting) return;
+    int dataIndex = gui->dataCombo->count() ? gui->dataCombo->itemData(gui->dataCombo->currentIndex()).toInt() : -1;
+    gui->importButton->setEnabled(dataIndex >= 0);
+    if(dataIndex < 0)
+    {
+        gui->infoLabel->setText("no numeric matrix");
+        return;
+    }
+    const MatVariable &data = variables[dataIndex];
+    bool bSampleRows = gui->sampleRowsCheck->isChecked();
+    size_t count = bSampleRows ? data.rows : data.cols;
+    size_t dim = bSampleRows ? data.cols : data.rows;
+    QString info = QString("%1 samples, %2 dimensions").arg(count).arg(dim);
+    int labelIndex = gui->labelCombo->itemData(gui->labelCombo->currentIndex()).toInt();
+    if(labelIndex >= 0 && variables[labelIndex].rows*variables[labelIndex].cols != count)
+    {
+        info += QString("\nthe labels (%1) do not match the samples").arg(variables[labelIndex].rows*variables[labelIndex].cols);
+        gui->importButton->setEnabled(false);
+    }
+    gui->infoLabel->setText(info);
+}
+
+void MatImport::SetImporting(bool importing)
+{
+    bImporting = importing;
+    gui->importButton->setEnabled(!importing);
+    gui->loadButton->setEnabled(!importing);
+    gui->dataCombo->setEnabled(!importing);
+    gui->labelCombo->setEnabled(!importing);
+    gui->sampleRowsCheck->setEnabled(!importing);
+    gui->cancelButton->setEnabled(importing);
+}
+
+void MatImport::Import()
+{
+    if(bImporting || filename.isEmpty() || !gui->dataCombo->count()) return;
+    const MatVariable &data = variables[gui->dataCombo->itemData(gui->dataCombo->currentIndex()).toInt()];
+    int labelIndex = gui->labelCombo->itemData(gui->labelCombo->currentIndex()).toInt();
+    bool bSampleRows = gui->sampleRowsCheck->isChecked();
+    size_t count = bSampleRows ? data.rows : data.cols;
+    size_t dim = bSampleRows ? data.cols : data.rows;
+    if(!count || !dim) return;
+
+    mat_t *mat = Mat_Open(filename.toLocal8Bit().constData(), MAT_ACC_RDONLY);
+    if(!mat) return;
+
+    vector<fvec> samples(count, fvec(dim, 0.f));
+    ivec labels(count, 0);
+    vector<double> buffer(MAT_BLOCK);
+    importTotal = count*dim + (labelIndex >= 0 ? count : 0);
+    bCancel = false;
+    gui->progressBar->setValue(0);
+    SetImporting(true);
+
+    MatBlockTarget target = {this, data.rows, bSampleRows, &samples, 0, 0};
+    int err = 1;
+    matvar_t *matvar = Mat_VarReadInfo(mat, data.name.toLatin1().constData());
+    if(matvar)
+    {
+        err = Mat_VarReadDataBlocks(mat, matvar, &buffer[0], MAT_BLOCK, MatBlockCallback, &target);
+        Mat_VarFree(matvar);
+    }
+    if(!err && labelIndex >= 0)
+    {
+        target.labels = &labels;
+        target.offset = count*dim;
+        matvar = Mat_VarReadInfo(mat, variables[labelIndex].name.toLatin1().constData());
+        err = 1;
+        if(matvar)
+        {
+            err = Mat_VarReadDataBlocks(mat, matvar, &buffer[0], MAT_BLOCK, MatBlockCallback, &target);
+            Mat_VarFree(matvar);
+        }
+    }
+    Mat_Close(mat);
+
+    SetImporting(false);
+    OptionsChanged();
+    if(err == 1)
+    {
+        QMessageBox::warning(guiDialog, tr("MAT Import"), tr("Unable to read %1 from %2").arg(data.name).arg(filename));
+    }
+    if(err) // failed or cancelled
+    {
+        gui->progressBar->setValue(0);
+        return;
+    }
+    emit(SetData(samples, labels, vector<ipair>(), false));
+}
+
+void MatImport::FetchResults(std::vector<fvec> results)
+{
+
+}
@@ -0,0 +1,97 @@
+/*********************************************************************
+MLDemos: A User-Friendly visualization toolkit for machine learning
+Copyright (C) 2010  Basilio Noris
+Contact: mldemos@b4silio.com
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public License,
+version 3 as published by the Free Software Foundation.
+
+This library is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free
+Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*********************************************************************/
+#ifndef _MATIMPORT_H_
+#define _MATIMPORT_H_
+
+#include <vector>
+#include <interfaces.h>
+#include "ui_MatImport.h"
+
+// one numeric matrix found in the file
+struct MatVariable
+{
+    QString name;
+    size_t rows, cols;
+    int classType;
+};
+
+// imports the numeric matrices of MATLAB .mat files (v4, v5/v7 and v7.3 when matio is built with hdf5).
+// The variables are streamed block by block through matio so that large files never
+// need to be held twice in memory
+class MatImport : public QObject, public InputOutputInterface
+{
+    Q_OBJECT
+    Q_PLUGIN_METADATA(IID "MatImport" FILE "plugin.json")
+    Q_INTERFACES(InputOutputInterface)
+public:
+    const char* QueryClassifierSignal() {return SIGNAL(QueryClassifier(std::vector<fvec>));}
+    const char* QueryRegressorSignal() {return SIGNAL(QueryRegressor(std::vector<fvec>));}
+    const char* QueryDynamicalSignal() {return SIGNAL(QueryDynamical(std::vector<fvec>));}
+    const char* QueryClustererSignal() {return SIGNAL(QueryClusterer(std::vector<fvec>));}
+    const char* QueryMaximizerSignal() {return SIGNAL(QueryMaximizer(std::vector<fvec>));}
+    const char* QueryReinforcementSignal() {return SIGNAL(QueryReinforcement(std::vector<fvec>));}
+    const char* SetDataSignal() {return SIGNAL(SetData(std::vector<fvec>, ivec, std::vector<ipair>, bool));}
+    const char* SetTimeseriesSignal() {return SIGNAL(SetTimeseries(std::vector<TimeSerie>));}
+    const char* FetchResultsSlot() {return SLOT(FetchResults(std::vector<fvec>));}
+    const char* DoneSignal() {return SIGNAL(Done(QObject *));}
+    QObject *object(){return this;}
+    QString GetName(){return "MAT Import";}
+
+    void Start();
+    void Stop();
+
+    MatImport();
+    ~MatImport();
+
+    // called by matio for each block of elements, returns true to stop the reading
+    bool Progress(size_t done);
+    bool Cancelled() const {return bCancel;}
+
+private:
+    Ui::MatImportDialog *gui;
+    QDialog *guiDialog;
+    QString filename;
+    std::vector<MatVariable> variables;
+    size_t importTotal;
+    bool bCancel;
+    bool bImporting; // Progress processes the events, the slots must not restart or change an import under way
+
+    void Parse(QString filename);
+    void SetImporting(bool importing);
+
+signals:
+    void Done(QObject *);
+    void SetData(std::vector<fvec> samples, ivec labels, std::vector<ipair> trajectories, bool bProjected);
+    void SetTimeseries(std::vector<TimeSerie> series);
+    void QueryClassifier(std::vector<fvec> samples);
+    void QueryRegressor(std::vector<fvec> samples);
+    void QueryDynamical(std::vector<fvec> samples);
+    void QueryClusterer(std::vector<fvec> samples);
+    void QueryMaximizer(std::vector<fvec> samples);
+    void QueryReinforcement(std::vector<fvec> samples);
+public slots:
+    void FetchResults(std::vector<fvec> results);
+    void Closing();
+    void LoadFile();
+    void Import();
+    void Cancel();
+    void OptionsChanged();
+};
+
+#endif // _MATIMPORT_H_
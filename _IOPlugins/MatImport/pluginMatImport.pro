@@ -0,0 +1,21 @@
+# ##########################
+# Configuration      #
+# ##########################
+TEMPLATE = lib
+CONFIG += plugin
+NAME = IO_MatImport
+MLPATH =../..
+
+include($$MLPATH/MLDemos_variables.pri)
+
+###########################
+# Source Files            #
+###########################
+FORMS += MatImport.ui
+
+HEADERS += MatImport.h
+
+SOURCES += MatImport.cpp
+
+OTHER_FILES += \
+    plugin.json